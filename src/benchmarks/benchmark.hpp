@@ -73,6 +73,8 @@
 #define RRAND_R(seed, max, min) (os_rand_r(seed) % ((max) - (min)) + (min))
 
 struct benchmark;
+struct benchmark_perf;
+struct benchmark_perf_events;
 
 /*
  * benchmark_args - Arguments for benchmark.
@@ -95,6 +97,13 @@ struct benchmark_args {
 	unsigned seed;		 /* PRNG seed */
 	unsigned repeats;	/* number of repeats of one scenario */
 	unsigned min_exe_time;   /* minimal execution time */
+	char *percentiles;       /* latency percentiles to report */
+	char *output_format;     /* format of the results */
+	char *perf_events;       /* hardware events to count */
+	const struct benchmark_perf_events *perf; /* parsed perf_events */
+	size_t rate;		 /* offered load in ops/sec, 0 if closed loop */
+	bool rate_per_thread;    /* rate is per thread, not for all threads */
+	char *arrival;		 /* arrival schedule of operations */
 	bool help;		 /* print help for benchmark */
 	void *opts;		 /* benchmark specific arguments */
 };
@@ -199,6 +208,7 @@ struct worker_info {
 	void *priv;		       /* worker's private data */
 	benchmark_time_t beg;	  /* start time */
 	benchmark_time_t end;	  /* end time */
+	struct benchmark_perf *perf;   /* hardware counters, if enabled */
 };
 
 /*
@@ -208,6 +218,7 @@ struct operation_info {
 	struct worker_info *worker;  /* worker's info */
 	struct benchmark_args *args; /* benchmark arguments */
 	size_t index;		     /* operation's index */
+	benchmark_time_t start;      /* intended start time, if rate is set */
 	benchmark_time_t end;	/* operation's end time */
 };
 
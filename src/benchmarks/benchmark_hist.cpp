@@ -0,0 +1,201 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * benchmark_hist.cpp -- benchmark_hist module definitions
+ */
+#include "benchmark_hist.hpp"
+#include "util.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+/*
+ * benchmark_hist_init -- initialize an empty histogram
+ */
+void
+benchmark_hist_init(struct benchmark_hist *hist)
+{
+	memset(hist, 0, sizeof(*hist));
+	hist->min = UINT64_MAX;
+}
+
+/*
+ * benchmark_hist_bucket -- return index of the bucket counting the value
+ */
+size_t
+benchmark_hist_bucket(uint64_t value)
+{
+	if (value < HIST_SUB_COUNT)
+		return (size_t)value;
+
+	/* the top HIST_SUB_BITS bits select the bucket within the range */
+	unsigned shift = util_mssb_index64(value) - (HIST_SUB_BITS - 1);
+	uint64_t sub = value >> shift;
+	assert(sub >= HIST_HALF_COUNT && sub < HIST_SUB_COUNT);
+
+	return (size_t)(HIST_SUB_COUNT + (shift - 1) * HIST_HALF_COUNT +
+			(sub - HIST_HALF_COUNT));
+}
+
+/*
+ * benchmark_hist_bucket_low -- return the lowest value counted in the bucket
+ */
+uint64_t
+benchmark_hist_bucket_low(size_t bucket)
+{
+	if (bucket < HIST_SUB_COUNT)
+		return bucket;
+
+	size_t off = bucket - HIST_SUB_COUNT;
+	unsigned shift = (unsigned)(off / HIST_HALF_COUNT) + 1;
+	uint64_t sub = off % HIST_HALF_COUNT + HIST_HALF_COUNT;
+
+	return sub << shift;
+}
+
+/*
+ * benchmark_hist_bucket_high -- return the highest value counted in the
+ * bucket
+ */
+uint64_t
+benchmark_hist_bucket_high(size_t bucket)
+{
+	if (bucket < HIST_SUB_COUNT)
+		return bucket;
+
+	size_t off = bucket - HIST_SUB_COUNT;
+	unsigned shift = (unsigned)(off / HIST_HALF_COUNT) + 1;
+
+	return benchmark_hist_bucket_low(bucket) + ((1ULL << shift) - 1);
+}
+
+/*
+ * benchmark_hist_record -- add a value to the histogram
+ */
+void
+benchmark_hist_record(struct benchmark_hist *hist, uint64_t value)
+{
+	hist->buckets[benchmark_hist_bucket(value)]++;
+	hist->count++;
+	hist->sum += value;
+	hist->sum_sq += (double)value * (double)value;
+
+	if (value < hist->min)
+		hist->min = value;
+	if (value > hist->max)
+		hist->max = value;
+}
+
+/*
+ * benchmark_hist_merge -- add all the values of src to dst
+ */
+void
+benchmark_hist_merge(struct benchmark_hist *dst,
+		     const struct benchmark_hist *src)
+{
+	for (size_t i = 0; i < HIST_NBUCKETS; i++)
+		dst->buckets[i] += src->buckets[i];
+
+	dst->count += src->count;
+	dst->sum += src->sum;
+	dst->sum_sq += src->sum_sq;
+
+	if (src->min < dst->min)
+		dst->min = src->min;
+	if (src->max > dst->max)
+		dst->max = src->max;
+}
+
+/*
+ * benchmark_hist_avg -- return the average of recorded values
+ */
+uint64_t
+benchmark_hist_avg(const struct benchmark_hist *hist)
+{
+	if (hist->count == 0)
+		return 0;
+
+	return hist->sum / hist->count;
+}
+
+/*
+ * benchmark_hist_std_dev -- return the standard deviation of recorded values
+ */
+double
+benchmark_hist_std_dev(const struct benchmark_hist *hist)
+{
+	if (hist->count == 0)
+		return 0.0;
+
+	double avg = (double)hist->sum / (double)hist->count;
+	double var = hist->sum_sq / (double)hist->count - avg * avg;
+
+	return var > 0.0 ? sqrt(var) : 0.0;
+}
+
+/*
+ * benchmark_hist_percentile -- return the value below which pctl percent of
+ * recorded values fall
+ *
+ * The result is the upper bound of the bucket holding the value of that
+ * rank, limited to the exact maximum.
+ */
+uint64_t
+benchmark_hist_percentile(const struct benchmark_hist *hist, double pctl)
+{
+	if (hist->count == 0)
+		return 0;
+
+	/* same rank as the element at index count * pctl / 100 when sorted */
+	uint64_t rank = (uint64_t)(pctl * (double)hist->count / 100.0) + 1;
+	if (rank > hist->count)
+		rank = hist->count;
+
+	uint64_t cum = 0;
+	size_t i;
+	for (i = 0; i < HIST_NBUCKETS; i++) {
+		cum += hist->buckets[i];
+		if (cum >= rank)
+			break;
+	}
+
+	assert(i < HIST_NBUCKETS);
+
+	uint64_t value = benchmark_hist_bucket_high(i);
+	if (value > hist->max)
+		value = hist->max;
+	if (value < hist->min)
+		value = hist->min;
+
+	return value;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * benchmark_hist.hpp -- declarations of benchmark_hist module
+ */
+#ifndef BENCHMARK_HIST_HPP
+#define BENCHMARK_HIST_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Log-linear histogram of latencies.
+ *
+ * Values below HIST_SUB_COUNT are counted exactly. Above that, every power
+ * of two is split into HIST_HALF_COUNT buckets of equal width, so a bucket's
+ * bounds are within 1/HIST_HALF_COUNT of any value counted in it. The size
+ * does not depend on the number of recorded values, and histograms of
+ * different threads or repeats are merged by adding up their counters.
+ */
+#define HIST_SUB_BITS 8
+#define HIST_SUB_COUNT (1ULL << HIST_SUB_BITS)
+#define HIST_HALF_COUNT (HIST_SUB_COUNT / 2)
+#define HIST_NBUCKETS (HIST_SUB_COUNT + (64 - HIST_SUB_BITS) * HIST_HALF_COUNT)
+
+struct benchmark_hist {
+	uint64_t count;  /* number of recorded values */
+	uint64_t min;    /* exact minimum */
+	uint64_t max;    /* exact maximum */
+	uint64_t sum;    /* sum of values, for the exact mean */
+	double sum_sq;   /* sum of squared values, for the std deviation */
+	uint64_t buckets[HIST_NBUCKETS];
+};
+
+void benchmark_hist_init(struct benchmark_hist *hist);
+void benchmark_hist_record(struct benchmark_hist *hist, uint64_t value);
+void benchmark_hist_merge(struct benchmark_hist *dst,
+			  const struct benchmark_hist *src);
+uint64_t benchmark_hist_avg(const struct benchmark_hist *hist);
+double benchmark_hist_std_dev(const struct benchmark_hist *hist);
+uint64_t benchmark_hist_percentile(const struct benchmark_hist *hist,
+				   double pctl);
+size_t benchmark_hist_bucket(uint64_t value);
+uint64_t benchmark_hist_bucket_low(size_t bucket);
+uint64_t benchmark_hist_bucket_high(size_t bucket);
+
+#endif /* BENCHMARK_HIST_HPP */
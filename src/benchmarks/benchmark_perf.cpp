@@ -0,0 +1,358 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * benchmark_perf.cpp -- benchmark_perf module definitions
+ */
+#include "benchmark_perf.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define PERF_CACHE(cache, op, result)                                          \
+	((PERF_COUNT_HW_CACHE_##cache) |                                       \
+	 ((PERF_COUNT_HW_CACHE_OP_##op) << 8) |                                \
+	 ((PERF_COUNT_HW_CACHE_RESULT_##result) << 16))
+
+/*
+ * perf_event_names -- events which can be given by name
+ *
+ * The generic events are mapped by the kernel to whatever the PMU of the
+ * CPU provides. Instructions such as clflush, clwb or sfence have no
+ * generic counterparts, so they have to be given as raw, model-specific
+ * events.
+ */
+static const struct {
+	const char *name;
+	uint32_t type;
+	uint64_t config;
+} perf_event_names[] = {
+	{"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+	{"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+	{"llc-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+	{"llc-load-misses", PERF_TYPE_HW_CACHE, PERF_CACHE(LL, READ, MISS)},
+	{"llc-store-misses", PERF_TYPE_HW_CACHE, PERF_CACHE(LL, WRITE, MISS)},
+	{"dtlb-load-misses", PERF_TYPE_HW_CACHE,
+	 PERF_CACHE(DTLB, READ, MISS)},
+	{"dtlb-store-misses", PERF_TYPE_HW_CACHE,
+	 PERF_CACHE(DTLB, WRITE, MISS)},
+	{"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+	{"page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+	{"context-switches", PERF_TYPE_SOFTWARE,
+	 PERF_COUNT_SW_CONTEXT_SWITCHES},
+	{"task-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+};
+
+#define PERF_NEVENT_NAMES                                                      \
+	(sizeof(perf_event_names) / sizeof(perf_event_names[0]))
+
+/*
+ * perf_parse_event -- (internal) parse a single event
+ *
+ * An event is either one of the named events, a raw event given as
+ * r<hex> or a raw event with a name given as <name>=r<hex>.
+ */
+static int
+perf_parse_event(char *tok, struct benchmark_perf_events *ev)
+{
+	size_t i = ev->n;
+	char *raw = tok;
+
+	ev->name[i] = tok;
+
+	char *eq = strchr(tok, '=');
+	if (eq != NULL)
+		raw = eq + 1;
+
+	if (*raw == 'r' && raw[1] != '\0' && eq != tok) {
+		char *endptr;
+		errno = 0;
+		uint64_t config = strtoull(raw + 1, &endptr, 16);
+		if (errno == 0 && *endptr == '\0') {
+			if (eq != NULL)
+				*eq = '\0';
+			ev->type[i] = PERF_TYPE_RAW;
+			ev->config[i] = config;
+			return 0;
+		}
+	}
+
+	if (eq != NULL)
+		return -1;
+
+	for (size_t j = 0; j < PERF_NEVENT_NAMES; j++) {
+		if (strcmp(tok, perf_event_names[j].name) == 0) {
+			ev->type[i] = perf_event_names[j].type;
+			ev->config[i] = perf_event_names[j].config;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * benchmark_perf_parse -- parse list of events separated by semicolon
+ */
+int
+benchmark_perf_parse(const char *str, struct benchmark_perf_events *ev)
+{
+	ev->n = 0;
+	ev->list = strdup(str);
+	if (ev->list == NULL) {
+		perror("strdup");
+		return -1;
+	}
+
+	char *saveptr = NULL;
+	char *tok = strtok_r(ev->list, ";", &saveptr);
+	for (; tok != NULL; tok = strtok_r(NULL, ";", &saveptr)) {
+		if (ev->n == PERF_MAX_EVENTS) {
+			fprintf(stderr, "too many events, at most %d are "
+					"allowed\n",
+				PERF_MAX_EVENTS);
+			goto err;
+		}
+
+		if (perf_parse_event(tok, ev)) {
+			fprintf(stderr, "invalid event: '%s'\n", tok);
+			goto err;
+		}
+		ev->n++;
+	}
+
+	return 0;
+err:
+	benchmark_perf_events_free(ev);
+	return -1;
+}
+
+/*
+ * benchmark_perf_events_free -- release list of events
+ */
+void
+benchmark_perf_events_free(struct benchmark_perf_events *ev)
+{
+	free(ev->list);
+	ev->list = NULL;
+	ev->n = 0;
+}
+
+/*
+ * perf_close -- (internal) close counters of a worker
+ */
+static void
+perf_close(struct benchmark_perf *perf, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+		close(perf->fd[i]);
+}
+
+/*
+ * benchmark_perf_start -- open and enable counters of the calling thread
+ *
+ * The counters are opened disabled and enabled one after another, so the
+ * cost of opening them is not counted. The software events include the
+ * kernel, context switches for instance never happen in user mode.
+ */
+int
+benchmark_perf_start(struct benchmark_perf *perf)
+{
+	const struct benchmark_perf_events *ev = perf->events;
+	struct perf_event_attr attr;
+	size_t i;
+	for (i = 0; i < ev->n; i++) {
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = ev->type[i];
+		attr.config = ev->config[i];
+		attr.disabled = 1;
+		attr.exclude_kernel = attr.type != PERF_TYPE_SOFTWARE;
+		attr.exclude_hv = 1;
+		/* counters may be multiplexed if there are not enough */
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+			PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		long fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+		if (fd < 0) {
+			fprintf(stderr, "perf_event_open(%s): %s\n",
+				ev->name[i], strerror(errno));
+			if (!attr.exclude_kernel &&
+			    (errno == EACCES || errno == EPERM))
+				fprintf(stderr, "software events count the "
+						"kernel too, which requires "
+						"kernel.perf_event_paranoid "
+						"<= 1\n");
+			goto err;
+		}
+		perf->fd[i] = (int)fd;
+	}
+
+	for (i = 0; i < ev->n; i++) {
+		if (ioctl(perf->fd[i], PERF_EVENT_IOC_RESET, 0) ||
+		    ioctl(perf->fd[i], PERF_EVENT_IOC_ENABLE, 0)) {
+			perror("ioctl(PERF_EVENT_IOC_ENABLE)");
+			i = ev->n;
+			goto err;
+		}
+	}
+
+	return 0;
+err:
+	perf_close(perf, i);
+	return -1;
+}
+
+/*
+ * benchmark_perf_stop -- disable, read and close counters
+ *
+ * Values of counters which were not running all the time are scaled up to
+ * the time they were enabled.
+ */
+int
+benchmark_perf_stop(struct benchmark_perf *perf)
+{
+	const struct benchmark_perf_events *ev = perf->events;
+	int ret = 0;
+
+	for (size_t i = 0; i < ev->n; i++)
+		ioctl(perf->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+
+	for (size_t i = 0; i < ev->n; i++) {
+		/* value, time enabled, time running */
+		uint64_t buf[3];
+		if (read(perf->fd[i], buf, sizeof(buf)) != sizeof(buf)) {
+			perror("read(perf_event)");
+			ret = -1;
+			continue;
+		}
+
+		if (buf[2] != 0 && buf[2] < buf[1])
+			buf[0] = (uint64_t)((double)buf[0] * (double)buf[1] /
+					    (double)buf[2]);
+		perf->value[i] = buf[0];
+	}
+
+	perf_close(perf, ev->n);
+	return ret;
+}
+
+/*
+ * benchmark_perf_pause -- stop counting until benchmark_perf_resume
+ *
+ * The counters stay open, and the time they are paused is left out of
+ * both the time enabled and the time running.
+ */
+void
+benchmark_perf_pause(struct benchmark_perf *perf)
+{
+	for (size_t i = 0; i < perf->events->n; i++)
+		ioctl(perf->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+}
+
+/*
+ * benchmark_perf_resume -- continue counting paused counters
+ */
+void
+benchmark_perf_resume(struct benchmark_perf *perf)
+{
+	for (size_t i = 0; i < perf->events->n; i++)
+		ioctl(perf->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+}
+
+#else
+
+/*
+ * benchmark_perf_parse -- parse list of events separated by semicolon
+ */
+int
+benchmark_perf_parse(const char *str, struct benchmark_perf_events *ev)
+{
+	ev->list = NULL;
+	ev->n = 0;
+	if (*str == '\0')
+		return 0;
+
+	fprintf(stderr, "hardware events are not supported\n");
+	return -1;
+}
+
+/*
+ * benchmark_perf_events_free -- release list of events
+ */
+void
+benchmark_perf_events_free(struct benchmark_perf_events *ev)
+{
+	ev->n = 0;
+}
+
+/*
+ * benchmark_perf_start -- open and enable counters of the calling thread
+ */
+int
+benchmark_perf_start(struct benchmark_perf *perf)
+{
+	return -1;
+}
+
+/*
+ * benchmark_perf_stop -- disable, read and close counters
+ */
+int
+benchmark_perf_stop(struct benchmark_perf *perf)
+{
+	return -1;
+}
+
+/*
+ * benchmark_perf_pause -- stop counting until benchmark_perf_resume
+ */
+void
+benchmark_perf_pause(struct benchmark_perf *perf)
+{
+}
+
+/*
+ * benchmark_perf_resume -- continue counting paused counters
+ */
+void
+benchmark_perf_resume(struct benchmark_perf *perf)
+{
+}
+
+#endif
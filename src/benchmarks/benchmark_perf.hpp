@@ -0,0 +1,72 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * benchmark_perf.hpp -- declarations of benchmark_perf module
+ */
+#ifndef BENCHMARK_PERF_HPP
+#define BENCHMARK_PERF_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/* maximum number of hardware events counted at once */
+#define PERF_MAX_EVENTS 8
+
+/*
+ * struct benchmark_perf_events -- list of events to count
+ */
+struct benchmark_perf_events {
+	char *list;			 /* copy of the option's value */
+	size_t n;			 /* number of events */
+	const char *name[PERF_MAX_EVENTS]; /* names of events */
+	uint32_t type[PERF_MAX_EVENTS];    /* perf_event_attr.type */
+	uint64_t config[PERF_MAX_EVENTS];  /* perf_event_attr.config */
+};
+
+/*
+ * struct benchmark_perf -- counters of a single worker
+ */
+struct benchmark_perf {
+	const struct benchmark_perf_events *events;
+	int fd[PERF_MAX_EVENTS];
+	uint64_t value[PERF_MAX_EVENTS];
+};
+
+int benchmark_perf_parse(const char *str, struct benchmark_perf_events *ev);
+void benchmark_perf_events_free(struct benchmark_perf_events *ev);
+
+int benchmark_perf_start(struct benchmark_perf *perf);
+int benchmark_perf_stop(struct benchmark_perf *perf);
+void benchmark_perf_pause(struct benchmark_perf *perf);
+void benchmark_perf_resume(struct benchmark_perf *perf);
+
+#endif /* BENCHMARK_PERF_HPP */
@@ -108,6 +108,18 @@ benchmark_time_set(benchmark_time_t *time, unsigned long long nsecs)
 	time->tv_nsec = nsecs % NSECPSEC;
 }
 
+/*
+ * benchmark_time_add -- move time forward by number of nanoseconds
+ */
+void
+benchmark_time_add(benchmark_time_t *time, unsigned long long nsecs)
+{
+	unsigned long long tv_nsec = time->tv_nsec + nsecs % NSECPSEC;
+
+	time->tv_sec += nsecs / NSECPSEC + tv_nsec / NSECPSEC;
+	time->tv_nsec = tv_nsec % NSECPSEC;
+}
+
 /*
  * number of samples used to calculate average time required to get a current
  * time from the system
@@ -44,4 +44,5 @@ unsigned long long benchmark_time_get_nsecs(benchmark_time_t *t);
 int benchmark_time_compare(const benchmark_time_t *t1,
 			   const benchmark_time_t *t2);
 void benchmark_time_set(benchmark_time_t *time, unsigned long long nsecs);
+void benchmark_time_add(benchmark_time_t *time, unsigned long long nsecs);
 unsigned long long benchmark_get_avg_get_time(void);
@@ -30,10 +30,11 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 /*
- * map_bench.cpp -- benchmarks for: ctree, btree, rtree, rbtree, hashmap_atomic
- * and hashmap_tx from examples.
+ * map_bench.cpp -- benchmarks for: ctree, btree, rtree, rbtree, skiplist,
+ * bplustree, hashmap_atomic and hashmap_tx from examples.
  */
 #include <cassert>
+#include <cmath>
 
 #include "benchmark.hpp"
 #include "os.h"
@@ -44,12 +45,14 @@
 extern "C" {
 #endif
 #include "map.h"
+#include "map_bplustree.h"
 #include "map_btree.h"
 #include "map_ctree.h"
 #include "map_hashmap_atomic.h"
 #include "map_hashmap_tx.h"
 #include "map_rbtree.h"
 #include "map_rtree.h"
+#include "map_skiplist.h"
 #ifndef _WIN32
 }
 #endif
@@ -83,26 +86,123 @@ static const struct {
 	{"ctree", MAP_CTREE},		{"btree", MAP_BTREE},
 	{"rtree", MAP_RTREE},		{"rbtree", MAP_RBTREE},
 	{"hashmap_tx", MAP_HASHMAP_TX}, {"hashmap_atomic", MAP_HASHMAP_ATOMIC},
+	{"skiplist", MAP_SKIPLIST},	{"bplustree", MAP_BPLUSTREE},
 };
 
 #define MAP_TYPES_NUM (sizeof(map_types) / sizeof(map_types[0]))
 
+/* skew of the zipfian distribution, the same as in YCSB */
+#define ZIPF_THETA 0.99
+
+/* scans visit 1 to YCSB_MAX_SCAN keys */
+#define YCSB_MAX_SCAN 100
+
+enum map_ycsb_op_type {
+	YCSB_READ,
+	YCSB_UPDATE,
+	YCSB_INSERT,
+	YCSB_SCAN,
+	YCSB_RMW,
+
+	YCSB_OP_TYPES_NUM
+};
+
+enum map_ycsb_dist {
+	YCSB_DIST_UNIFORM,
+	YCSB_DIST_ZIPFIAN,
+	YCSB_DIST_LATEST,
+};
+
+/*
+ * map_ycsb_workloads -- operation mixes of the YCSB core workloads
+ *
+ * The ratios are percentages of operations of each type, in the order of
+ * enum map_ycsb_op_type.
+ */
+static const struct map_ycsb_workload {
+	const char *str;
+	unsigned ratio[YCSB_OP_TYPES_NUM];
+	enum map_ycsb_dist dist;
+} map_ycsb_workloads[] = {
+	/* update heavy */
+	{"A", {50, 50, 0, 0, 0}, YCSB_DIST_ZIPFIAN},
+	/* read mostly */
+	{"B", {95, 5, 0, 0, 0}, YCSB_DIST_ZIPFIAN},
+	/* read only */
+	{"C", {100, 0, 0, 0, 0}, YCSB_DIST_ZIPFIAN},
+	/* read latest */
+	{"D", {95, 0, 5, 0, 0}, YCSB_DIST_LATEST},
+	/* short ranges */
+	{"E", {0, 0, 5, 95, 0}, YCSB_DIST_ZIPFIAN},
+	/* read-modify-write */
+	{"F", {50, 0, 0, 0, 50}, YCSB_DIST_ZIPFIAN},
+};
+
+#define MAP_YCSB_WORKLOADS_NUM                                                 \
+	(sizeof(map_ycsb_workloads) / sizeof(map_ycsb_workloads[0]))
+
+static const struct {
+	const char *str;
+	enum map_ycsb_dist dist;
+} map_ycsb_dists[] = {
+	{"uniform", YCSB_DIST_UNIFORM},
+	{"zipfian", YCSB_DIST_ZIPFIAN},
+	{"latest", YCSB_DIST_LATEST},
+};
+
+#define MAP_YCSB_DISTS_NUM (sizeof(map_ycsb_dists) / sizeof(map_ycsb_dists[0]))
+
 struct map_bench_args {
 	unsigned seed;
 	uint64_t max_key;
 	char *type;
+	char *lock;
 	bool ext_tx;
 	bool alloc;
+	char *workload;
+	char *distribution;
+	size_t records;
+};
+
+/*
+ * map_ycsb_cmd -- operation of the map_ycsb benchmark
+ *
+ * The rank selects the key, see map_ycsb_key().
+ */
+struct map_ycsb_cmd {
+	enum map_ycsb_op_type type;
+	unsigned scan_len;
+	uint64_t rank;
 };
 
 struct map_bench_worker {
 	uint64_t *keys;
 	size_t nkeys;
+
+	/* map_ycsb only */
+	struct map_ycsb_cmd *cmds;
+	char *buf;
+	unsigned seed;
+};
+
+/*
+ * map_zipf -- zipfian distribution over [0, n)
+ *
+ * The generator is the one from "Quickly Generating Billion-Record Synthetic
+ * Databases" by Gray et al., also used by YCSB. Rank 0 is the most popular.
+ */
+struct map_zipf {
+	uint64_t n;
+	double theta;
+	double alpha;
+	double zetan;
+	double eta;
 };
 
 struct map_bench {
 	struct map_ctx *mapc;
 	os_mutex_t lock;
+	os_rwlock_t rwlock;
 	PMEMobjpool *pop;
 	size_t pool_size;
 
@@ -119,6 +219,16 @@ struct map_bench {
 	int (*insert)(struct map_bench *, uint64_t);
 	int (*remove)(struct map_bench *, uint64_t);
 	int (*get)(struct map_bench *, uint64_t);
+
+	void (*rdlock)(struct map_bench *);
+	void (*wrlock)(struct map_bench *);
+	void (*unlock)(struct map_bench *);
+
+	/* map_ycsb only */
+	const struct map_ycsb_workload *workload;
+	enum map_ycsb_dist dist;
+	struct map_zipf zipf;
+	size_t nrecords; /* number of valid entries in keys */
 };
 
 /*
@@ -147,6 +257,81 @@ mutex_unlock_nofail(os_mutex_t *lock)
 	}
 }
 
+/*
+ * map_mutex_lock -- take the map mutex, for both readers and writers
+ */
+static void
+map_mutex_lock(struct map_bench *map_bench)
+{
+	mutex_lock_nofail(&map_bench->lock);
+}
+
+/*
+ * map_mutex_unlock -- release the map mutex
+ */
+static void
+map_mutex_unlock(struct map_bench *map_bench)
+{
+	mutex_unlock_nofail(&map_bench->lock);
+}
+
+/*
+ * map_rwlock_rdlock -- take the map rwlock for reading
+ */
+static void
+map_rwlock_rdlock(struct map_bench *map_bench)
+{
+	errno = os_rwlock_rdlock(&map_bench->rwlock);
+	if (errno) {
+		perror("os_rwlock_rdlock");
+		abort();
+	}
+}
+
+/*
+ * map_rwlock_wrlock -- take the map rwlock for writing
+ */
+static void
+map_rwlock_wrlock(struct map_bench *map_bench)
+{
+	errno = os_rwlock_wrlock(&map_bench->rwlock);
+	if (errno) {
+		perror("os_rwlock_wrlock");
+		abort();
+	}
+}
+
+/*
+ * map_rwlock_unlock -- release the map rwlock
+ */
+static void
+map_rwlock_unlock(struct map_bench *map_bench)
+{
+	errno = os_rwlock_unlock(&map_bench->rwlock);
+	if (errno) {
+		perror("os_rwlock_unlock");
+		abort();
+	}
+}
+
+/*
+ * map_lock_types -- ways of serializing access to the shared map
+ *
+ * The maps are not thread-safe, so all the threads go through one lock.
+ * With the rwlock, lookups and scans run concurrently with each other.
+ */
+static const struct map_lock_type {
+	const char *str;
+	void (*rdlock)(struct map_bench *);
+	void (*wrlock)(struct map_bench *);
+	void (*unlock)(struct map_bench *);
+} map_lock_types[] = {
+	{"mutex", map_mutex_lock, map_mutex_lock, map_mutex_unlock},
+	{"rwlock", map_rwlock_rdlock, map_rwlock_wrlock, map_rwlock_unlock},
+};
+
+#define MAP_LOCK_TYPES_NUM (sizeof(map_lock_types) / sizeof(map_lock_types[0]))
+
 /*
  * get_key -- return 64-bit random key
  */
@@ -163,6 +348,59 @@ get_key(unsigned *seed, uint64_t max_key)
 	return key;
 }
 
+/*
+ * get_rand01 -- return random number from [0, 1)
+ */
+static double
+get_rand01(unsigned *seed)
+{
+	/* os_rand_r returns 31 random bits on Linux */
+	unsigned r = (unsigned)os_rand_r(seed) & 0x7fffffff;
+
+	return (double)r / 2147483648.0;
+}
+
+/*
+ * map_zipf_init -- prepare zipfian distribution over n items
+ */
+static void
+map_zipf_init(struct map_zipf *zipf, uint64_t n, double theta)
+{
+	double zeta2 = 1.0 + pow(0.5, theta);
+
+	zipf->n = n;
+	zipf->theta = theta;
+	zipf->alpha = 1.0 / (1.0 - theta);
+	zipf->zetan = 0.0;
+	for (uint64_t i = 1; i <= n; i++)
+		zipf->zetan += 1.0 / pow((double)i, theta);
+
+	zipf->eta = (1.0 - pow(2.0 / (double)n, 1.0 - theta)) /
+		(1.0 - zeta2 / zipf->zetan);
+}
+
+/*
+ * map_zipf_next -- return zipfian distributed rank from [0, n)
+ */
+static uint64_t
+map_zipf_next(const struct map_zipf *zipf, unsigned *seed)
+{
+	double u = get_rand01(seed);
+	double uz = u * zipf->zetan;
+
+	if (uz < 1.0)
+		return 0;
+
+	if (uz < 1.0 + pow(0.5, zipf->theta))
+		return zipf->n > 1 ? 1 : 0;
+
+	uint64_t rank = (uint64_t)((double)zipf->n *
+				   pow(zipf->eta * u - zipf->eta + 1.0,
+				       zipf->alpha));
+
+	return rank < zipf->n ? rank : zipf->n - 1;
+}
+
 /*
  * parse_map_type -- parse type of map
  */
@@ -177,6 +415,50 @@ parse_map_type(const char *str)
 	return NULL;
 }
 
+/*
+ * parse_lock_type -- parse type of lock
+ */
+static const struct map_lock_type *
+parse_lock_type(const char *str)
+{
+	for (unsigned i = 0; i < MAP_LOCK_TYPES_NUM; i++) {
+		if (strcmp(str, map_lock_types[i].str) == 0)
+			return &map_lock_types[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * parse_ycsb_workload -- parse YCSB workload
+ */
+static const struct map_ycsb_workload *
+parse_ycsb_workload(const char *str)
+{
+	for (unsigned i = 0; i < MAP_YCSB_WORKLOADS_NUM; i++) {
+		if (strcmp(str, map_ycsb_workloads[i].str) == 0)
+			return &map_ycsb_workloads[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * parse_ycsb_dist -- parse key distribution, returns -1 if invalid
+ */
+static int
+parse_ycsb_dist(const char *str, enum map_ycsb_dist *dist)
+{
+	for (unsigned i = 0; i < MAP_YCSB_DISTS_NUM; i++) {
+		if (strcmp(str, map_ycsb_dists[i].str) == 0) {
+			*dist = map_ycsb_dists[i].dist;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
 /*
  * map_remove_free_op -- remove and free object from map
  */
@@ -225,11 +507,11 @@ map_remove_op(struct benchmark *bench, struct operation_info *info)
 
 	uint64_t key = tworker->keys[info->index];
 
-	mutex_lock_nofail(&map_bench->lock);
+	map_bench->wrlock(map_bench);
 
 	int ret = map_bench->remove(map_bench, key);
 
-	mutex_unlock_nofail(&map_bench->lock);
+	map_bench->unlock(map_bench);
 
 	return ret;
 }
@@ -279,11 +561,11 @@ map_insert_op(struct benchmark *bench, struct operation_info *info)
 		(struct map_bench_worker *)info->worker->priv;
 	uint64_t key = tworker->keys[info->index];
 
-	mutex_lock_nofail(&map_bench->lock);
+	map_bench->wrlock(map_bench);
 
 	int ret = map_bench->insert(map_bench, key);
 
-	mutex_unlock_nofail(&map_bench->lock);
+	map_bench->unlock(map_bench);
 
 	return ret;
 }
@@ -323,11 +605,194 @@ map_get_op(struct benchmark *bench, struct operation_info *info)
 
 	uint64_t key = tworker->keys[info->index];
 
-	mutex_lock_nofail(&map_bench->lock);
+	map_bench->rdlock(map_bench);
 
 	int ret = map_bench->get(map_bench, key);
 
-	mutex_unlock_nofail(&map_bench->lock);
+	map_bench->unlock(map_bench);
+
+	return ret;
+}
+
+/*
+ * map_ycsb_key -- return key of the record selected by the operation
+ *
+ * Must be called with the map locked, as inserts append to the keys array.
+ */
+static uint64_t
+map_ycsb_key(struct map_bench *map_bench, const struct map_ycsb_cmd *cmd)
+{
+	size_t nrecords = map_bench->nrecords;
+	size_t index;
+
+	switch (map_bench->dist) {
+		case YCSB_DIST_UNIFORM:
+			index = cmd->rank % nrecords;
+			break;
+		case YCSB_DIST_ZIPFIAN:
+			/* ranks are drawn from the preloaded records */
+			index = cmd->rank;
+			break;
+		case YCSB_DIST_LATEST:
+		default:
+			/* the most recently inserted records are the hottest */
+			index = nrecords - 1 - cmd->rank;
+			break;
+	}
+
+	return map_bench->keys[index];
+}
+
+/*
+ * map_ycsb_read -- copy the value of a record to the worker's buffer
+ */
+static int
+map_ycsb_read(struct map_bench *map_bench, struct map_bench_worker *tworker,
+	      uint64_t key)
+{
+	PMEMoid val = map_get(map_bench->mapc, map_bench->map, key);
+	if (OID_IS_NULL(val))
+		return -1;
+
+	memcpy(tworker->buf, pmemobj_direct(val), map_bench->args->dsize);
+
+	return 0;
+}
+
+/*
+ * map_ycsb_update -- overwrite the value of a record with the worker's buffer
+ */
+static int
+map_ycsb_update(struct map_bench *map_bench, struct map_bench_worker *tworker,
+		uint64_t key)
+{
+	volatile int ret = 0;
+	TX_BEGIN(map_bench->pop)
+	{
+		PMEMoid val = map_get(map_bench->mapc, map_bench->map, key);
+		if (OID_IS_NULL(val))
+			pmemobj_tx_abort(EINVAL);
+
+		pmemobj_tx_add_range(val, 0, map_bench->args->dsize);
+		memcpy(pmemobj_direct(val), tworker->buf,
+		       map_bench->args->dsize);
+	}
+	TX_ONABORT
+	{
+		ret = -1;
+	}
+	TX_END
+
+	return ret;
+}
+
+/*
+ * map_ycsb_insert -- insert a record with a new random key
+ */
+static int
+map_ycsb_insert(struct map_bench *map_bench, struct map_bench_worker *tworker)
+{
+	uint64_t key;
+	PMEMoid oid;
+	do {
+		key = get_key(&tworker->seed, map_bench->margs->max_key);
+		oid = map_get(map_bench->mapc, map_bench->map, key);
+	} while (!OID_IS_NULL(oid));
+
+	int ret = map_bench->insert(map_bench, key);
+	if (ret)
+		return ret;
+
+	assert(map_bench->nrecords < map_bench->nkeys);
+	map_bench->keys[map_bench->nrecords++] = key;
+
+	return 0;
+}
+
+struct map_ycsb_scan {
+	struct map_bench *map_bench;
+	char *buf;
+	unsigned left;
+};
+
+/*
+ * map_ycsb_scan_cb -- copy the value of a scanned record
+ */
+static int
+map_ycsb_scan_cb(uint64_t key, PMEMoid value, void *arg)
+{
+	struct map_ycsb_scan *scan = (struct map_ycsb_scan *)arg;
+
+	memcpy(scan->buf, pmemobj_direct(value), scan->map_bench->args->dsize);
+
+	return --scan->left == 0;
+}
+
+/*
+ * map_ycsb_scan -- read scan_len records in key order starting at key
+ */
+static int
+map_ycsb_scan(struct map_bench *map_bench, struct map_bench_worker *tworker,
+	      uint64_t key, unsigned scan_len)
+{
+	struct map_ycsb_scan scan = {map_bench, tworker->buf, scan_len};
+
+	map_range(map_bench->mapc, map_bench->map, key, UINT64_MAX,
+		  map_ycsb_scan_cb, &scan);
+
+	return 0;
+}
+
+/*
+ * map_ycsb_op -- main operation for map_ycsb benchmark
+ */
+static int
+map_ycsb_op(struct benchmark *bench, struct operation_info *info)
+{
+	struct map_bench *map_bench =
+		(struct map_bench *)pmembench_get_priv(bench);
+	struct map_bench_worker *tworker =
+		(struct map_bench_worker *)info->worker->priv;
+	const struct map_ycsb_cmd *cmd = &tworker->cmds[info->index];
+	int ret;
+
+	if (cmd->type == YCSB_READ || cmd->type == YCSB_SCAN)
+		map_bench->rdlock(map_bench);
+	else
+		map_bench->wrlock(map_bench);
+
+	switch (cmd->type) {
+		case YCSB_READ:
+			ret = map_ycsb_read(map_bench, tworker,
+					    map_ycsb_key(map_bench, cmd));
+			break;
+		case YCSB_UPDATE:
+			ret = map_ycsb_update(map_bench, tworker,
+					      map_ycsb_key(map_bench, cmd));
+			break;
+		case YCSB_INSERT:
+			ret = map_ycsb_insert(map_bench, tworker);
+			break;
+		case YCSB_SCAN:
+			ret = map_ycsb_scan(map_bench, tworker,
+					    map_ycsb_key(map_bench, cmd),
+					    cmd->scan_len);
+			break;
+		case YCSB_RMW: {
+			uint64_t key = map_ycsb_key(map_bench, cmd);
+			ret = map_ycsb_read(map_bench, tworker, key);
+			if (ret)
+				break;
+			tworker->buf[0]++;
+			ret = map_ycsb_update(map_bench, tworker, key);
+			break;
+		}
+		default:
+			ret = -1;
+			break;
+	}
+
+	map_bench->unlock(map_bench);
 
 	return ret;
 }
@@ -361,7 +826,7 @@ map_common_init_worker(struct benchmark *bench, struct benchmark_args *args,
 	tree = (struct map_bench *)pmembench_get_priv(bench);
 	targs = (struct map_bench_args *)args->opts;
 	if (targs->ext_tx) {
-		int ret = pmemobj_tx_begin(tree->pop, NULL);
+		int ret = pmemobj_tx_begin(tree->pop, NULL, TX_PARAM_NONE);
 		if (ret) {
 			(void)pmemobj_tx_end();
 			goto err_free_keys;
@@ -395,6 +860,8 @@ map_common_free_worker(struct benchmark *bench, struct benchmark_args *args,
 		(void)pmemobj_tx_end();
 	}
 	free(tworker->keys);
+	free(tworker->cmds);
+	free(tworker->buf);
 	free(tworker);
 }
 
@@ -493,6 +960,70 @@ err_common_free_worker:
 	return -1;
 }
 
+/*
+ * map_ycsb_init_worker -- init worker function for map_ycsb benchmark
+ *
+ * Draws the type, the key rank and the scan length of every operation up
+ * front, so that the PRNG is not a part of the measured time.
+ */
+static int
+map_ycsb_init_worker(struct benchmark *bench, struct benchmark_args *args,
+		     struct worker_info *worker)
+{
+	int ret = map_common_init_worker(bench, args, worker);
+	if (ret)
+		return ret;
+
+	struct map_bench *map_bench =
+		(struct map_bench *)pmembench_get_priv(bench);
+	assert(map_bench);
+	struct map_bench_args *targs = (struct map_bench_args *)args->opts;
+	assert(targs);
+	struct map_bench_worker *tworker =
+		(struct map_bench_worker *)worker->priv;
+	assert(tworker);
+
+	const struct map_ycsb_workload *workload = map_bench->workload;
+
+	tworker->cmds = (struct map_ycsb_cmd *)malloc(tworker->nkeys *
+						      sizeof(*tworker->cmds));
+	tworker->buf = (char *)malloc(args->dsize);
+	if (!tworker->cmds || !tworker->buf) {
+		perror("malloc");
+		goto err_common_free_worker;
+	}
+
+	memset(tworker->buf, (int)worker->index, args->dsize);
+	tworker->seed = (unsigned)os_rand_r(&targs->seed);
+
+	for (size_t i = 0; i < tworker->nkeys; i++) {
+		struct map_ycsb_cmd *cmd = &tworker->cmds[i];
+		unsigned r = (unsigned)os_rand_r(&targs->seed) % 100;
+		unsigned type = 0;
+
+		while (r >= workload->ratio[type]) {
+			r -= workload->ratio[type];
+			type++;
+		}
+
+		assert(type < YCSB_OP_TYPES_NUM);
+		cmd->type = (enum map_ycsb_op_type)type;
+		cmd->scan_len =
+			1 + (unsigned)os_rand_r(&targs->seed) % YCSB_MAX_SCAN;
+
+		if (map_bench->dist == YCSB_DIST_UNIFORM)
+			cmd->rank = get_key(&targs->seed, 0);
+		else
+			cmd->rank = map_zipf_next(&map_bench->zipf,
+						  &targs->seed);
+	}
+
+	return 0;
+err_common_free_worker:
+	map_common_free_worker(bench, args, worker);
+	return -1;
+}
+
 /*
  * map_common_init -- common init function for map_* benchmarks
  */
@@ -504,6 +1035,7 @@ map_common_init(struct benchmark *bench, struct benchmark_args *args)
 	assert(args->opts);
 
 	size_t size_per_key;
+	const struct map_lock_type *lock;
 	struct map_bench *map_bench =
 		(struct map_bench *)calloc(1, sizeof(*map_bench));
 
@@ -522,6 +1054,17 @@ map_common_init(struct benchmark *bench, struct benchmark_args *args)
 		goto err_free_bench;
 	}
 
+	lock = parse_lock_type(map_bench->margs->lock);
+	if (!lock) {
+		fprintf(stderr, "invalid lock type value specified -- '%s'\n",
+			map_bench->margs->lock);
+		goto err_free_bench;
+	}
+
+	map_bench->rdlock = lock->rdlock;
+	map_bench->wrlock = lock->wrlock;
+	map_bench->unlock = lock->unlock;
+
 	if (map_bench->margs->ext_tx && args->n_threads > 1) {
 		fprintf(stderr, "external transaction "
 				"requires single thread\n");
@@ -540,6 +1083,14 @@ map_common_init(struct benchmark *bench, struct benchmark_args *args)
 
 	map_bench->nkeys = args->n_threads * args->n_ops_per_thread;
 	map_bench->init_nkeys = map_bench->nkeys;
+	if (map_bench->margs->records) {
+		/*
+		 * map_ycsb preloads the given number of records and reserves
+		 * room for the keys of all the operations, as each may insert.
+		 */
+		map_bench->init_nkeys = map_bench->margs->records;
+		map_bench->nkeys += map_bench->init_nkeys;
+	}
 	size_per_key = map_bench->margs->alloc
 		? SIZE_PER_KEY + map_bench->args->dsize + ALLOC_OVERHEAD
 		: SIZE_PER_KEY;
@@ -571,10 +1122,16 @@ map_common_init(struct benchmark *bench, struct benchmark_args *args)
 		goto err_close;
 	}
 
+	errno = os_rwlock_init(&map_bench->rwlock);
+	if (errno) {
+		perror("os_rwlock_init");
+		goto err_destroy_lock;
+	}
+
 	map_bench->mapc = map_ctx_init(ops, map_bench->pop);
 	if (!map_bench->mapc) {
 		perror("map_ctx_init");
-		goto err_destroy_lock;
+		goto err_destroy_rwlock;
 	}
 
 	map_bench->root = POBJ_ROOT(map_bench->pop, struct root);
@@ -596,6 +1153,8 @@ map_common_init(struct benchmark *bench, struct benchmark_args *args)
 	return 0;
 err_free_map:
 	map_ctx_free(map_bench->mapc);
+err_destroy_rwlock:
+	os_rwlock_destroy(&map_bench->rwlock);
 err_destroy_lock:
 	os_mutex_destroy(&map_bench->lock);
 err_close:
@@ -613,6 +1172,7 @@ map_common_exit(struct benchmark *bench, struct benchmark_args *args)
 {
 	struct map_bench *tree = (struct map_bench *)pmembench_get_priv(bench);
 
+	os_rwlock_destroy(&tree->rwlock);
 	os_mutex_destroy(&tree->lock);
 	map_ctx_free(tree->mapc);
 	pmemobj_close(tree->pop);
@@ -643,11 +1203,11 @@ map_keys_init(struct benchmark *bench, struct benchmark_args *args)
 
 	int ret = 0;
 
-	mutex_lock_nofail(&map_bench->lock);
+	map_bench->wrlock(map_bench);
 
 	TX_BEGIN(map_bench->pop)
 	{
-		for (size_t i = 0; i < map_bench->nkeys; i++) {
+		for (size_t i = 0; i < map_bench->init_nkeys; i++) {
 			uint64_t key;
 			PMEMoid oid;
 			do {
@@ -676,7 +1236,7 @@ map_keys_init(struct benchmark *bench, struct benchmark_args *args)
 	}
 	TX_END
 
-	mutex_unlock_nofail(&map_bench->lock);
+	map_bench->unlock(map_bench);
 
 	if (!ret)
 		return 0;
@@ -754,11 +1314,89 @@ map_get_exit(struct benchmark *bench, struct benchmark_args *args)
 	return map_common_exit(bench, args);
 }
 
-static struct benchmark_clo map_bench_clos[5];
+/*
+ * map_ycsb_init -- init function for map_ycsb benchmark
+ */
+static int
+map_ycsb_init(struct benchmark *bench, struct benchmark_args *args)
+{
+	struct map_bench_args *margs = (struct map_bench_args *)args->opts;
+	assert(margs);
+
+	const struct map_ycsb_workload *workload =
+		parse_ycsb_workload(margs->workload);
+	if (!workload) {
+		fprintf(stderr, "invalid workload value specified -- '%s'\n",
+			margs->workload);
+		return -1;
+	}
+
+	enum map_ycsb_dist dist = workload->dist;
+	if (strcmp(margs->distribution, "workload") != 0 &&
+	    parse_ycsb_dist(margs->distribution, &dist)) {
+		fprintf(stderr, "invalid distribution value specified -- "
+				"'%s'\n",
+			margs->distribution);
+		return -1;
+	}
+
+	const struct map_ops *ops = parse_map_type(margs->type);
+	if (ops && !ops->range && workload->ratio[YCSB_SCAN]) {
+		fprintf(stderr, "workload %s requires a map type "
+				"with range scans\n",
+			workload->str);
+		return -1;
+	}
+
+	/* updates write to the values, so each record needs its own object */
+	margs->alloc = true;
+
+	int ret = map_common_init(bench, args);
+	if (ret)
+		return ret;
+
+	struct map_bench *map_bench =
+		(struct map_bench *)pmembench_get_priv(bench);
+
+	if (margs->max_key && margs->max_key < map_bench->nkeys) {
+		fprintf(stderr, "max-key too small for %zu records\n",
+			map_bench->nkeys);
+		goto err_exit_common;
+	}
+
+	map_bench->workload = workload;
+	map_bench->dist = dist;
+	map_zipf_init(&map_bench->zipf, map_bench->init_nkeys, ZIPF_THETA);
+
+	ret = map_keys_init(bench, args);
+	if (ret)
+		goto err_exit_common;
+
+	map_bench->nrecords = map_bench->init_nkeys;
+
+	return 0;
+err_exit_common:
+	map_common_exit(bench, args);
+	return -1;
+}
+
+/*
+ * map_ycsb_exit -- exit function for map_ycsb benchmark
+ */
+static int
+map_ycsb_exit(struct benchmark *bench, struct benchmark_args *args)
+{
+	map_keys_exit(bench, args);
+	return map_common_exit(bench, args);
+}
+
+static struct benchmark_clo map_bench_clos[6];
+static struct benchmark_clo map_ycsb_clos[8];
 
 static struct benchmark_info map_insert_info;
 static struct benchmark_info map_remove_info;
 static struct benchmark_info map_get_info;
+static struct benchmark_info map_ycsb_info;
 
 CONSTRUCTOR(map_bench_costructor)
 void
@@ -767,8 +1405,8 @@ map_bench_costructor(void)
 	map_bench_clos[0].opt_short = 'T';
 	map_bench_clos[0].opt_long = "type";
 	map_bench_clos[0].descr =
-		"Type of container "
-		"[ctree|btree|rtree|rbtree|hashmap_tx|hashmap_atomic]";
+		"Type of container [ctree|btree|rtree|rbtree|skiplist|"
+		"bplustree|hashmap_tx|hashmap_atomic]";
 
 	map_bench_clos[0].off = clo_field_offset(struct map_bench_args, type);
 	map_bench_clos[0].type = CLO_TYPE_STR;
@@ -807,12 +1445,54 @@ map_bench_costructor(void)
 	map_bench_clos[3].off = clo_field_offset(struct map_bench_args, ext_tx);
 	map_bench_clos[3].type = CLO_TYPE_FLAG;
 
-	map_bench_clos[4].opt_short = 'A';
-	map_bench_clos[4].opt_long = "alloc";
-	map_bench_clos[4].descr = "Allocate object of specified size "
+	map_bench_clos[4].opt_short = 'L';
+	map_bench_clos[4].opt_long = "lock";
+	map_bench_clos[4].descr = "Lock guarding the map shared by all "
+				  "threads [mutex|rwlock]";
+	map_bench_clos[4].off = clo_field_offset(struct map_bench_args, lock);
+	map_bench_clos[4].type = CLO_TYPE_STR;
+	map_bench_clos[4].def = "mutex";
+
+	map_bench_clos[5].opt_short = 'A';
+	map_bench_clos[5].opt_long = "alloc";
+	map_bench_clos[5].descr = "Allocate object of specified size "
 				  "when inserting";
-	map_bench_clos[4].off = clo_field_offset(struct map_bench_args, alloc);
-	map_bench_clos[4].type = CLO_TYPE_FLAG;
+	map_bench_clos[5].off = clo_field_offset(struct map_bench_args, alloc);
+	map_bench_clos[5].type = CLO_TYPE_FLAG;
+
+	/* map_ycsb always allocates the values, so it has no alloc option */
+	for (unsigned i = 0; i < 5; i++)
+		map_ycsb_clos[i] = map_bench_clos[i];
+
+	map_ycsb_clos[5].opt_short = 'W';
+	map_ycsb_clos[5].opt_long = "workload";
+	map_ycsb_clos[5].descr = "YCSB core workload [A|B|C|D|E|F]";
+	map_ycsb_clos[5].off =
+		clo_field_offset(struct map_bench_args, workload);
+	map_ycsb_clos[5].type = CLO_TYPE_STR;
+	map_ycsb_clos[5].def = "A";
+
+	map_ycsb_clos[6].opt_short = 'D';
+	map_ycsb_clos[6].opt_long = "distribution";
+	map_ycsb_clos[6].descr = "Key distribution [workload|uniform|zipfian|"
+				 "latest], 'workload' picks the one of the "
+				 "YCSB workload";
+	map_ycsb_clos[6].off =
+		clo_field_offset(struct map_bench_args, distribution);
+	map_ycsb_clos[6].type = CLO_TYPE_STR;
+	map_ycsb_clos[6].def = "workload";
+
+	map_ycsb_clos[7].opt_short = 'R';
+	map_ycsb_clos[7].opt_long = "records";
+	map_ycsb_clos[7].descr = "Number of records inserted before the run";
+	map_ycsb_clos[7].off = clo_field_offset(struct map_bench_args, records);
+	map_ycsb_clos[7].type = CLO_TYPE_UINT;
+	map_ycsb_clos[7].def = "100000";
+	map_ycsb_clos[7].type_uint.size =
+		clo_field_size(struct map_bench_args, records);
+	map_ycsb_clos[7].type_uint.base = CLO_INT_BASE_DEC;
+	map_ycsb_clos[7].type_uint.min = 1;
+	map_ycsb_clos[7].type_uint.max = SIZE_MAX;
 
 	map_insert_info.name = "map_insert";
 	map_insert_info.brief = "Inserting to tree map";
@@ -864,4 +1544,21 @@ map_bench_costructor(void)
 	map_get_info.rm_file = true;
 	map_get_info.allow_poolset = true;
 	REGISTER_BENCHMARK(map_get_info);
+
+	map_ycsb_info.name = "map_ycsb";
+	map_ycsb_info.brief = "YCSB core workloads on a shared map";
+	map_ycsb_info.init = map_ycsb_init;
+	map_ycsb_info.exit = map_ycsb_exit;
+	map_ycsb_info.multithread = true;
+	map_ycsb_info.multiops = true;
+	map_ycsb_info.init_worker = map_ycsb_init_worker;
+	map_ycsb_info.free_worker = map_common_free_worker;
+	map_ycsb_info.operation = map_ycsb_op;
+	map_ycsb_info.measure_time = true;
+	map_ycsb_info.clos = map_ycsb_clos;
+	map_ycsb_info.nclos = ARRAY_SIZE(map_ycsb_clos);
+	map_ycsb_info.opts_size = sizeof(struct map_bench_args);
+	map_ycsb_info.rm_file = true;
+	map_ycsb_info.allow_poolset = true;
+	REGISTER_BENCHMARK(map_ycsb_info);
 }
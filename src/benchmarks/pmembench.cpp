@@ -50,6 +50,8 @@
 #include <unistd.h>
 
 #include "benchmark.hpp"
+#include "benchmark_hist.hpp"
+#include "benchmark_perf.hpp"
 #include "benchmark_worker.hpp"
 #include "clo.hpp"
 #include "clo_vec.hpp"
@@ -73,6 +75,9 @@ unsigned long long Get_time_avg;
 
 #define MIN_EXE_TIME_E 0.5
 
+/* maximum number of latency percentiles reported */
+#define MAX_PERCENTILES 16
+
 /*
  * struct pmembench -- main context
  */
@@ -115,8 +120,6 @@ struct latency {
 	uint64_t min;
 	uint64_t avg;
 	double std_dev;
-	uint64_t pctl99_0p;
-	uint64_t pctl99_9p;
 };
 
 /*
@@ -125,7 +128,8 @@ struct latency {
 struct thread_results {
 	benchmark_time_t beg;
 	benchmark_time_t end;
-	benchmark_time_t end_op[];
+	struct benchmark_hist hist;
+	uint64_t perf[PERF_MAX_EVENTS];
 };
 
 /*
@@ -145,9 +149,38 @@ struct total_results {
 	double nopsps;
 	struct results total;
 	struct latency latency;
+	struct benchmark_hist hist;
+	double perf[PERF_MAX_EVENTS]; /* hardware events per operation */
 	struct bench_results *res;
 };
 
+/*
+ * enum output_format -- format of benchmark's results
+ */
+enum output_format {
+	OUTPUT_CSV,  /* header and a semicolon-separated line per run */
+	OUTPUT_JSON, /* a JSON object per run, one per line */
+};
+
+/*
+ * struct percentiles -- latency percentiles to report
+ */
+struct percentiles {
+	char *list;			   /* copy of the option's value */
+	size_t n;			   /* number of percentiles */
+	const char *str[MAX_PERCENTILES]; /* percentiles as given */
+	double val[MAX_PERCENTILES];	   /* percentiles as numbers */
+};
+
+/*
+ * struct output -- how to report the results of a benchmark
+ */
+struct output {
+	enum output_format format;
+	struct percentiles pctls;
+	struct benchmark_perf_events perf;
+};
+
 /*
  * struct bench_list -- list of available benchmarks
  */
@@ -174,7 +207,7 @@ static struct version_s {
 static struct bench_list benchmarks;
 
 /* common arguments for benchmarks */
-static struct benchmark_clo pmembench_clos[12];
+static struct benchmark_clo pmembench_clos[18];
 
 /* list of arguments for pmembench */
 static struct benchmark_clo pmembench_opts[2];
@@ -336,6 +369,68 @@ pmembench_costructor(void)
 	pmembench_clos[11].type_uint.base = CLO_INT_BASE_DEC;
 	pmembench_clos[11].type_uint.min = 0;
 	pmembench_clos[11].type_uint.max = ULONG_MAX;
+
+	pmembench_clos[12].opt_long = "percentiles";
+	pmembench_clos[12].descr =
+		"Latency percentiles to report, separated by semicolon";
+	pmembench_clos[12].type = CLO_TYPE_STR;
+	pmembench_clos[12].off =
+		clo_field_offset(struct benchmark_args, percentiles);
+	pmembench_clos[12].def = "99.0;99.9";
+	pmembench_clos[12].ignore_in_res = true;
+
+	pmembench_clos[13].opt_long = "output-format";
+	pmembench_clos[13].descr = "Format of the results [csv|json]";
+	pmembench_clos[13].type = CLO_TYPE_STR;
+	pmembench_clos[13].off =
+		clo_field_offset(struct benchmark_args, output_format);
+	pmembench_clos[13].def = "csv";
+	pmembench_clos[13].ignore_in_res = true;
+
+	pmembench_clos[14].opt_long = "perf-events";
+	pmembench_clos[14].descr =
+		"Hardware events to count per operation, separated by "
+		"semicolon [cycles|instructions|llc-misses|llc-load-misses|"
+		"llc-store-misses|dtlb-load-misses|dtlb-store-misses|"
+		"branch-misses|page-faults|context-switches|task-clock|"
+		"r<hex>|<name>=r<hex>]. The software events (page-faults, "
+		"context-switches, task-clock) include the kernel and need "
+		"kernel.perf_event_paranoid <= 1. With --rate the counters "
+		"are paused while a worker waits for the start of its next "
+		"operation, so only the operations are counted";
+	pmembench_clos[14].type = CLO_TYPE_STR;
+	pmembench_clos[14].off =
+		clo_field_offset(struct benchmark_args, perf_events);
+	pmembench_clos[14].def = "";
+	pmembench_clos[14].ignore_in_res = true;
+
+	pmembench_clos[15].opt_long = "rate";
+	pmembench_clos[15].descr = "Start operations at the given rate in "
+				   "ops/sec instead of back to back";
+	pmembench_clos[15].type = CLO_TYPE_UINT;
+	pmembench_clos[15].off = clo_field_offset(struct benchmark_args, rate);
+	pmembench_clos[15].def = "0";
+	pmembench_clos[15].type_uint.size =
+		clo_field_size(struct benchmark_args, rate);
+	pmembench_clos[15].type_uint.base = CLO_INT_BASE_DEC;
+	pmembench_clos[15].type_uint.min = 0;
+	pmembench_clos[15].type_uint.max = ULONG_MAX;
+
+	pmembench_clos[16].opt_long = "rate-per-thread";
+	pmembench_clos[16].descr = "The rate is for each thread instead of "
+				   "for all threads together";
+	pmembench_clos[16].type = CLO_TYPE_FLAG;
+	pmembench_clos[16].off =
+		clo_field_offset(struct benchmark_args, rate_per_thread);
+	pmembench_clos[16].def = "false";
+
+	pmembench_clos[17].opt_long = "arrival";
+	pmembench_clos[17].descr = "Schedule of operations started at the "
+				   "given rate [constant|poisson]";
+	pmembench_clos[17].type = CLO_TYPE_STR;
+	pmembench_clos[17].off =
+		clo_field_offset(struct benchmark_args, arrival);
+	pmembench_clos[17].def = "constant";
 }
 
 /*
@@ -431,20 +526,105 @@ pmembench_merge_clos(struct benchmark *bench)
 	bench->args_size = size;
 }
 
+/*
+ * struct arrival -- schedule of operations of a worker running at a rate
+ */
+struct arrival {
+	double interval; /* mean time between operations in nsecs */
+	bool poisson;    /* exponentially distributed times between ops */
+	unsigned seed;   /* PRNG seed for the poisson schedule */
+	double next;     /* start of the next operation in nsecs from beg */
+};
+
+/*
+ * pmembench_arrival_init -- initialize schedule of operations of a worker
+ */
+static void
+pmembench_arrival_init(struct benchmark *bench, struct worker_info *winfo,
+		       struct arrival *arr)
+{
+	struct benchmark_args *args = winfo->opinfo[0].args;
+	double rate = (double)args->rate;
+	if (!args->rate_per_thread && bench->info->multithread)
+		rate /= (double)args->n_threads;
+
+	arr->interval = 1e9 / rate;
+	arr->poisson = strcmp(args->arrival, "poisson") == 0;
+	arr->seed = args->seed + (unsigned)winfo->index;
+	arr->next = 0.0;
+}
+
+/*
+ * pmembench_arrival_wait -- wait for the intended start of an operation
+ *
+ * When the worker is late, the operation starts right away. Its latency is
+ * measured from the intended start anyway, so the time spent waiting for
+ * the previous operations is not omitted.
+ */
+static void
+pmembench_arrival_wait(struct arrival *arr, struct worker_info *winfo,
+		       struct operation_info *info)
+{
+	info->start = winfo->beg;
+	benchmark_time_add(&info->start, (unsigned long long)arr->next);
+
+	benchmark_time_t now;
+	benchmark_time_get(&now);
+	if (benchmark_time_compare(&now, &info->start) < 0) {
+		/* the events of the waiting loop are not the operation's */
+		if (winfo->perf)
+			benchmark_perf_pause(winfo->perf);
+
+		/* let other workers run if there are more of them than CPUs */
+		do {
+			sched_yield();
+			benchmark_time_get(&now);
+		} while (benchmark_time_compare(&now, &info->start) < 0);
+
+		if (winfo->perf)
+			benchmark_perf_resume(winfo->perf);
+	}
+
+	if (arr->poisson) {
+		/* uniform in (0, 1], so that the logarithm is finite */
+		double u = ((double)os_rand_r(&arr->seed) + 1.0) /
+			((double)RAND_MAX + 1.0);
+		arr->next += -log(u) * arr->interval;
+	} else {
+		arr->next += arr->interval;
+	}
+}
+
 /*
  * pmembench_run_worker -- run worker with benchmark operation
  */
 static int
 pmembench_run_worker(struct benchmark *bench, struct worker_info *winfo)
 {
+	struct benchmark_args *args = winfo->opinfo[0].args;
+	struct arrival arr;
+	if (args->rate)
+		pmembench_arrival_init(bench, winfo, &arr);
+
+	if (winfo->perf && benchmark_perf_start(winfo->perf))
+		return -1;
+
 	benchmark_time_get(&winfo->beg);
 	for (size_t i = 0; i < winfo->nops; i++) {
-		if (bench->info->operation(bench, &winfo->opinfo[i]))
+		if (args->rate)
+			pmembench_arrival_wait(&arr, winfo, &winfo->opinfo[i]);
+		if (bench->info->operation(bench, &winfo->opinfo[i])) {
+			if (winfo->perf)
+				benchmark_perf_stop(winfo->perf);
 			return -1;
+		}
 		benchmark_time_get(&winfo->opinfo[i].end);
 	}
 	benchmark_time_get(&winfo->end);
 
+	if (winfo->perf && benchmark_perf_stop(winfo->perf))
+		return -1;
+
 	return 0;
 }
 
@@ -453,8 +633,12 @@ pmembench_run_worker(struct benchmark *bench, struct worker_info *winfo)
  */
 static void
 pmembench_print_header(struct pmembench *pb, struct benchmark *bench,
-		       struct clo_vec *clovec)
+		       struct clo_vec *clovec, const struct output *out)
 {
+	/* JSON objects carry the names of the values themselves */
+	if (out->format == OUTPUT_JSON)
+		return;
+
 	if (pb->scenario) {
 		printf("%s: %s [%" PRIu64 "]%s%s%s\n", pb->scenario->name,
 		       bench->info->name, clovec->nargs,
@@ -473,10 +657,12 @@ pmembench_print_header(struct pmembench *pb, struct benchmark *bench,
 	       "latency-avg[nsec];"
 	       "latency-min[nsec];"
 	       "latency-max[nsec];"
-	       "latency-std-dev[nsec];"
-	       "latency-pctl-99.0%%[nsec];"
-	       "latency-pctl-99.9%%[nsec]");
+	       "latency-std-dev[nsec]");
 	size_t i;
+	for (i = 0; i < out->pctls.n; i++)
+		printf(";latency-pctl-%s%%[nsec]", out->pctls.str[i]);
+	for (i = 0; i < out->perf.n; i++)
+		printf(";%s[1/op]", out->perf.name[i]);
 	for (i = 0; i < bench->nclos; i++) {
 		if (!bench->clos[i].ignore_in_res) {
 			printf(";%s", bench->clos[i].opt_long);
@@ -485,21 +671,145 @@ pmembench_print_header(struct pmembench *pb, struct benchmark *bench,
 	printf("\n");
 }
 
+/*
+ * pmembench_print_json_str -- print string as a JSON string literal
+ */
+static void
+pmembench_print_json_str(const char *str)
+{
+	putchar('"');
+	for (; *str != '\0'; str++) {
+		unsigned char c = (unsigned char)*str;
+		if (c == '"' || c == '\\')
+			printf("\\%c", c);
+		else if (c < 0x20)
+			printf("\\u%04x", c);
+		else
+			putchar(c);
+	}
+	putchar('"');
+}
+
+/*
+ * pmembench_print_results_json -- print benchmark's results as a JSON object
+ *
+ * Apart from the statistics, the object holds all the non-empty buckets of
+ * the latency histogram as [low, high, count] triples, so that results of
+ * separate runs can be merged later on.
+ */
+static void
+pmembench_print_results_json(struct pmembench *pb, struct benchmark *bench,
+			     struct benchmark_args *args,
+			     struct total_results *res,
+			     const struct output *out)
+{
+	printf("{\"benchmark\":");
+	pmembench_print_json_str(bench->info->name);
+	if (pb->scenario) {
+		printf(",\"scenario\":");
+		pmembench_print_json_str(pb->scenario->name);
+		if (pb->scenario->group) {
+			printf(",\"group\":");
+			pmembench_print_json_str(pb->scenario->group);
+		}
+	}
+
+	printf(",\"ops_per_second\":%f", res->nopsps);
+	printf(",\"total_sec\":{\"avg\":%f,\"max\":%f,\"min\":%f,"
+	       "\"median\":%f,\"std_dev\":%f}",
+	       res->total.avg, res->total.max, res->total.min, res->total.med,
+	       res->total.std_dev);
+	printf(",\"latency_nsec\":{\"avg\":%" PRIu64 ",\"min\":%" PRIu64
+	       ",\"max\":%" PRIu64 ",\"std_dev\":%f",
+	       res->latency.avg, res->latency.min, res->latency.max,
+	       res->latency.std_dev);
+
+	size_t i;
+	printf(",\"percentiles\":{");
+	for (i = 0; i < out->pctls.n; i++) {
+		if (i)
+			putchar(',');
+		pmembench_print_json_str(out->pctls.str[i]);
+		printf(":%" PRIu64,
+		       benchmark_hist_percentile(&res->hist,
+						 out->pctls.val[i]));
+	}
+
+	printf("},\"histogram\":[");
+	bool first = true;
+	for (i = 0; i < HIST_NBUCKETS; i++) {
+		if (!res->hist.buckets[i])
+			continue;
+		printf("%s[%" PRIu64 ",%" PRIu64 ",%" PRIu64 "]",
+		       first ? "" : ",", benchmark_hist_bucket_low(i),
+		       benchmark_hist_bucket_high(i), res->hist.buckets[i]);
+		first = false;
+	}
+
+	printf("]}");
+
+	if (out->perf.n) {
+		printf(",\"perf_per_op\":{");
+		for (i = 0; i < out->perf.n; i++) {
+			if (i)
+				putchar(',');
+			pmembench_print_json_str(out->perf.name[i]);
+			printf(":%f", res->perf[i]);
+		}
+		putchar('}');
+	}
+
+	printf(",\"args\":{");
+	first = true;
+	for (i = 0; i < bench->nclos; i++) {
+		struct benchmark_clo *clo = &bench->clos[i];
+		if (clo->ignore_in_res)
+			continue;
+
+		if (!first)
+			putchar(',');
+		first = false;
+
+		pmembench_print_json_str(clo->opt_long);
+		putchar(':');
+
+		const char *val =
+			benchmark_clo_str(clo, args, bench->args_size);
+		if (val == NULL)
+			printf("null");
+		else if (clo->type == CLO_TYPE_STR)
+			pmembench_print_json_str(val);
+		else
+			printf("%s", val);
+	}
+	printf("}}\n");
+}
+
 /*
  * pmembench_print_results -- print benchmark's results
  */
 static void
-pmembench_print_results(struct benchmark *bench, struct benchmark_args *args,
-			struct total_results *res)
+pmembench_print_results(struct pmembench *pb, struct benchmark *bench,
+			struct benchmark_args *args, struct total_results *res,
+			const struct output *out)
 {
-	printf("%f;%f;%f;%f;%f;%f;%" PRIu64 ";%" PRIu64 ";%" PRIu64
-	       ";%f;%" PRIu64 ";%" PRIu64,
+	if (out->format == OUTPUT_JSON) {
+		pmembench_print_results_json(pb, bench, args, res, out);
+		return;
+	}
+
+	printf("%f;%f;%f;%f;%f;%f;%" PRIu64 ";%" PRIu64 ";%" PRIu64 ";%f",
 	       res->total.avg, res->nopsps, res->total.max, res->total.min,
 	       res->total.med, res->total.std_dev, res->latency.avg,
-	       res->latency.min, res->latency.max, res->latency.std_dev,
-	       res->latency.pctl99_0p, res->latency.pctl99_9p);
+	       res->latency.min, res->latency.max, res->latency.std_dev);
 
 	size_t i;
+	for (i = 0; i < out->pctls.n; i++)
+		printf(";%" PRIu64, benchmark_hist_percentile(
+					    &res->hist, out->pctls.val[i]));
+	for (i = 0; i < out->perf.n; i++)
+		printf(";%f", res->perf[i]);
+
 	for (i = 0; i < bench->nclos; i++) {
 		if (!bench->clos[i].ignore_in_res)
 			printf(";%s", benchmark_clo_str(&bench->clos[i], args,
@@ -642,6 +952,12 @@ pmembench_init_workers(struct benchmark_worker **workers, size_t nworkers,
 			workers[i]->info.opinfo[j].args = args;
 			workers[i]->info.opinfo[j].index = j;
 		}
+		if (args->perf) {
+			workers[i]->info.perf = (struct benchmark_perf *)calloc(
+				1, sizeof(struct benchmark_perf));
+			assert(workers[i]->info.perf != NULL);
+			workers[i]->info.perf->events = args->perf;
+		}
 		workers[i]->bench = bench;
 		workers[i]->args = args;
 		workers[i]->func = pmembench_run_worker;
@@ -666,9 +982,31 @@ results_store(struct bench_results *res, struct benchmark_worker **workers,
 	for (unsigned i = 0; i < nthreads; i++) {
 		res->thres[i]->beg = workers[i]->info.beg;
 		res->thres[i]->end = workers[i]->info.end;
+
+		memset(res->thres[i]->perf, 0, sizeof(res->thres[i]->perf));
+		struct benchmark_perf *perf = workers[i]->info.perf;
+		if (perf) {
+			for (size_t e = 0; e < perf->events->n; e++)
+				res->thres[i]->perf[e] = perf->value[e];
+		}
+
+		/*
+		 * latency of each operation, measured from the previous one
+		 * or from its intended start if the worker ran at a rate
+		 */
+		bool rate = workers[i]->args->rate != 0;
+		struct benchmark_hist *hist = &res->thres[i]->hist;
+		benchmark_hist_init(hist);
+		benchmark_time_t *beg = &workers[i]->info.beg;
 		for (size_t j = 0; j < nops; j++) {
-			res->thres[i]->end_op[j] =
-				workers[i]->info.opinfo[j].end;
+			struct operation_info *op = &workers[i]->info.opinfo[j];
+			if (rate)
+				beg = &op->start;
+			benchmark_time_t lat;
+			benchmark_time_diff(&lat, beg, &op->end);
+			benchmark_hist_record(hist,
+					      benchmark_time_get_nsecs(&lat));
+			beg = &op->end;
 		}
 	}
 }
@@ -696,17 +1034,6 @@ compare_doubles(const void *a1, const void *b1)
 	return (*a > *b) - (*a < *b);
 }
 
-/*
-* compare_uint64t -- comparing function used for sorting
-*/
-static int
-compare_uint64t(const void *a1, const void *b1)
-{
-	const uint64_t *a = (const uint64_t *)a1;
-	const uint64_t *b = (const uint64_t *)b1;
-	return (*a > *b) - (*a < *b);
-}
-
 /*
  * results_alloc -- prepare structure to store all benchmark results
  */
@@ -730,8 +1057,7 @@ results_alloc(size_t nrepeats, size_t nthreads, size_t nops)
 		assert(res->thres != NULL);
 		for (size_t j = 0; j < nthreads; j++) {
 			res->thres[j] = (struct thread_results *)malloc(
-				sizeof(*res->thres[j]) +
-				nops * sizeof(benchmark_time_t));
+				sizeof(*res->thres[j]));
 			assert(res->thres[j] != NULL);
 		}
 	}
@@ -766,8 +1092,6 @@ get_total_results(struct total_results *tres)
 
 	tres->total.min = DBL_MAX;
 	tres->total.max = DBL_MIN;
-	tres->latency.min = UINT64_MAX;
-	tres->latency.max = 0;
 
 	/* allocate helper arrays */
 	benchmark_time_t *tbeg =
@@ -850,73 +1174,29 @@ get_total_results(struct total_results *tres)
 	tres->total.std_dev = sqrt(tres->total.std_dev / tres->nrepeats);
 
 	/* latency */
+	benchmark_hist_init(&tres->hist);
 	for (size_t i = 0; i < tres->nrepeats; i++) {
-		struct bench_results *res = &tres->res[i];
-		for (size_t j = 0; j < tres->nthreads; j++) {
-			struct thread_results *thres = res->thres[j];
-			benchmark_time_t *beg = &thres->beg;
-			for (size_t o = 0; o < tres->nops; o++) {
-				benchmark_time_t lat;
-				benchmark_time_diff(&lat, beg,
-						    &thres->end_op[o]);
-				uint64_t nsecs = benchmark_time_get_nsecs(&lat);
-
-				/* min, max latency */
-				if (nsecs > tres->latency.max)
-					tres->latency.max = nsecs;
-				if (nsecs < tres->latency.min)
-					tres->latency.min = nsecs;
-
-				tres->latency.avg += nsecs;
-
-				beg = &thres->end_op[o];
-			}
-		}
+		for (size_t j = 0; j < tres->nthreads; j++)
+			benchmark_hist_merge(&tres->hist,
+					     &tres->res[i].thres[j]->hist);
 	}
 
-	/* average latency */
-	size_t count = tres->nrepeats * tres->nthreads * tres->nops;
-	tres->latency.avg /= count;
-
-	uint64_t *ntotals = (uint64_t *)calloc(count, sizeof(uint64_t));
-	assert(ntotals != NULL);
-	count = 0;
-
-	/* std deviation of latency and percentiles */
-	for (size_t i = 0; i < tres->nrepeats; i++) {
-		struct bench_results *res = &tres->res[i];
-		for (size_t j = 0; j < tres->nthreads; j++) {
-			struct thread_results *thres = res->thres[j];
-			benchmark_time_t *beg = &thres->beg;
-			for (size_t o = 0; o < tres->nops; o++) {
-				benchmark_time_t lat;
-				benchmark_time_diff(&lat, beg,
-						    &thres->end_op[o]);
-				uint64_t nsecs = benchmark_time_get_nsecs(&lat);
-
-				uint64_t dev = (nsecs - tres->latency.avg);
-				dev *= dev;
-
-				tres->latency.std_dev += dev;
-
-				beg = &thres->end_op[o];
-
-				ntotals[count] = nsecs;
-				++count;
-			}
+	tres->latency.min = tres->hist.min;
+	tres->latency.max = tres->hist.max;
+	tres->latency.avg = benchmark_hist_avg(&tres->hist);
+	tres->latency.std_dev = benchmark_hist_std_dev(&tres->hist);
+
+	/* hardware events per operation */
+	double count = (double)(tres->nrepeats * tres->nthreads * tres->nops);
+	for (size_t e = 0; e < PERF_MAX_EVENTS; e++) {
+		uint64_t sum = 0;
+		for (size_t i = 0; i < tres->nrepeats; i++) {
+			for (size_t j = 0; j < tres->nthreads; j++)
+				sum += tres->res[i].thres[j]->perf[e];
 		}
+		tres->perf[e] = (double)sum / count;
 	}
 
-	tres->latency.std_dev = sqrt(tres->latency.std_dev / count);
-
-	/* find 99.0% and 99.9% percentiles */
-	qsort(ntotals, count, sizeof(uint64_t), compare_uint64t);
-	uint64_t p99_0 = count * 99 / 100;
-	uint64_t p99_9 = count * 999 / 1000;
-	tres->latency.pctl99_0p = ntotals[p99_0];
-	tres->latency.pctl99_9p = ntotals[p99_9];
-	free(ntotals);
-
 	free(totals);
 	free(tend);
 	free(tbeg);
@@ -1237,6 +1517,7 @@ pmembench_single_repeat(struct benchmark *bench, struct benchmark_args *args,
 		benchmark_worker_exit(workers[j]);
 
 		free(workers[j]->info.opinfo);
+		free(workers[j]->info.perf);
 		benchmark_worker_free(workers[j]);
 	}
 
@@ -1293,6 +1574,100 @@ scale_up_min_exe_time(struct benchmark *bench, struct benchmark_args *args,
 	return 0;
 }
 
+/*
+ * pmembench_parse_percentiles -- parse list of latency percentiles
+ */
+static int
+pmembench_parse_percentiles(const char *str, struct percentiles *pctls)
+{
+	pctls->n = 0;
+	pctls->list = strdup(str);
+	if (pctls->list == NULL) {
+		perror("strdup");
+		return -1;
+	}
+
+	char *saveptr = NULL;
+	char *tok = strtok_r(pctls->list, ";", &saveptr);
+	for (; tok != NULL; tok = strtok_r(NULL, ";", &saveptr)) {
+		if (pctls->n == MAX_PERCENTILES) {
+			fprintf(stderr, "too many percentiles, at most %d "
+					"are allowed\n",
+				MAX_PERCENTILES);
+			goto err;
+		}
+
+		char *endptr;
+		errno = 0;
+		double val = strtod(tok, &endptr);
+		if (errno || endptr == tok || *endptr != '\0' || val < 0.0 ||
+		    val > 100.0) {
+			fprintf(stderr, "invalid percentile: '%s'\n", tok);
+			goto err;
+		}
+
+		pctls->str[pctls->n] = tok;
+		pctls->val[pctls->n] = val;
+		pctls->n++;
+	}
+
+	return 0;
+err:
+	free(pctls->list);
+	pctls->list = NULL;
+	return -1;
+}
+
+/* an empty list of events is not stored by the parser */
+#define PERF_EVENTS(args) ((args)->perf_events ? (args)->perf_events : "")
+
+/*
+ * pmembench_parse_output -- parse output format, percentiles and events
+ *
+ * The header is printed once for all runs of a benchmark, so the options
+ * must have the same values in all of them.
+ */
+static int
+pmembench_parse_output(struct clo_vec *clovec, struct output *out)
+{
+	struct benchmark_args *args =
+		(struct benchmark_args *)clo_vec_get_args(clovec, 0);
+
+	for (size_t i = 1; i < clovec->nargs; i++) {
+		struct benchmark_args *a =
+			(struct benchmark_args *)clo_vec_get_args(clovec, i);
+		if (strcmp(a->percentiles, args->percentiles) != 0 ||
+		    strcmp(a->output_format, args->output_format) != 0 ||
+		    strcmp(PERF_EVENTS(a), PERF_EVENTS(args)) != 0) {
+			fprintf(stderr, "percentiles, output format and "
+					"events must be the same for all "
+					"runs\n");
+			return -1;
+		}
+	}
+
+	if (strcmp(args->output_format, "csv") == 0) {
+		out->format = OUTPUT_CSV;
+	} else if (strcmp(args->output_format, "json") == 0) {
+		out->format = OUTPUT_JSON;
+	} else {
+		fprintf(stderr, "unknown output format: '%s'\n",
+			args->output_format);
+		return -1;
+	}
+
+	if (pmembench_parse_percentiles(args->percentiles, &out->pctls))
+		return -1;
+
+	if (benchmark_perf_parse(PERF_EVENTS(args), &out->perf)) {
+		free(out->pctls.list);
+		out->pctls.list = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
 /*
  * pmembench_run -- runs one benchmark. Parses arguments and performs
  * specific functions.
@@ -1309,6 +1684,10 @@ pmembench_run(struct pmembench *pb, struct benchmark *bench)
 	double *workers_times = NULL;
 
 	struct clo_vec *clovec = NULL;
+	struct output out;
+	out.pctls.list = NULL;
+	out.perf.list = NULL;
+	out.perf.n = 0;
 
 	assert(bench->info != NULL);
 	pmembench_merge_clos(bench);
@@ -1374,7 +1753,12 @@ pmembench_run(struct pmembench *pb, struct benchmark *bench)
 		goto out;
 	}
 
-	pmembench_print_header(pb, bench, clovec);
+	if (pmembench_parse_output(clovec, &out)) {
+		ret = -1;
+		goto out;
+	}
+
+	pmembench_print_header(pb, bench, clovec, &out);
 
 	size_t args_i;
 	for (args_i = 0; args_i < clovec->nargs; args_i++) {
@@ -1390,6 +1774,14 @@ pmembench_run(struct pmembench *pb, struct benchmark *bench)
 
 		args->opts = (void *)((uintptr_t)args +
 				      sizeof(struct benchmark_args));
+		args->perf = out.perf.n ? &out.perf : NULL;
+		if (strcmp(args->arrival, "constant") != 0 &&
+		    strcmp(args->arrival, "poisson") != 0) {
+			fprintf(stderr, "unknown arrival schedule: '%s'\n",
+				args->arrival);
+			ret = -1;
+			goto out;
+		}
 		args->is_poolset = util_is_poolset_file(args->fname) == 1;
 		if (args->is_poolset) {
 			if (!bench->info->allow_poolset) {
@@ -1439,7 +1831,7 @@ pmembench_run(struct pmembench *pb, struct benchmark *bench)
 		}
 
 		get_total_results(total_res);
-		pmembench_print_results(bench, args, total_res);
+		pmembench_print_results(pb, bench, args, total_res, &out);
 
 		args->n_ops_per_thread = n_ops_per_thread_copy;
 
@@ -1457,6 +1849,8 @@ out:
 		free(stats);
 	if (workers_times)
 		free(workers_times);
+	free(out.pctls.list);
+	benchmark_perf_events_free(&out.perf);
 out_release_args:
 	clo_vec_free(clovec);
 
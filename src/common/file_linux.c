@@ -39,6 +39,8 @@
 
 #include <errno.h>
 #include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <dirent.h>
@@ -46,6 +48,9 @@
 #include <sys/stat.h>
 #include <sys/sysmacros.h>
 #include <sys/types.h>
+#ifdef __linux__
+#include <sys/vfs.h>
+#endif
 
 #include "os.h"
 #include "file.h"
@@ -287,3 +292,100 @@ util_file_device_dax_alignment(const char *path)
 
 	return device_dax_alignment(path);
 }
+
+#ifndef HUGETLBFS_MAGIC
+#define HUGETLBFS_MAGIC 0x958458f6
+#endif
+
+#ifndef TMPFS_MAGIC
+#define TMPFS_MAGIC 0x01021994
+#endif
+
+#define THP_SHMEM_ENABLED "/sys/kernel/mm/transparent_hugepage/shmem_enabled"
+#define THP_PMD_SIZE "/sys/kernel/mm/transparent_hugepage/hpage_pmd_size"
+
+/*
+ * util_file_hugetlbfs_pagesize -- returns the page size of the hugetlbfs
+ *	file system the path resides on, or 0 if it is not a hugetlbfs
+ */
+size_t
+util_file_hugetlbfs_pagesize(const char *path)
+{
+	LOG(3, "path \"%s\"", path);
+
+#ifdef __linux__
+	struct statfs fs;
+	if (statfs(path, &fs) < 0) {
+		LOG(2, "!statfs \"%s\"", path);
+		return 0;
+	}
+
+	if ((unsigned long)fs.f_type != HUGETLBFS_MAGIC)
+		return 0;
+
+	LOG(4, "hugetlbfs page size %ld", (long)fs.f_bsize);
+	return (size_t)fs.f_bsize;
+#else
+	return 0;
+#endif
+}
+
+/*
+ * util_file_thp_pagesize -- returns the size of the transparent huge pages
+ *	which may back the files in the path, or 0 if there are none
+ *
+ * Only the files on tmpfs, with the transparent huge pages enabled for shared
+ * memory, are taken into account. Whether a DAX file system maps a file with
+ * huge pages depends on the allocation of its blocks, so it cannot be told
+ * in advance.
+ */
+size_t
+util_file_thp_pagesize(const char *path)
+{
+	LOG(3, "path \"%s\"", path);
+
+#ifdef __linux__
+	struct statfs fs;
+	if (statfs(path, &fs) < 0) {
+		LOG(2, "!statfs \"%s\"", path);
+		return 0;
+	}
+
+	if ((unsigned long)fs.f_type != TMPFS_MAGIC)
+		return 0;
+
+	char buf[MAX_SIZE_LENGTH + 1];
+	FILE *fp;
+
+	/* the active mode is the one in brackets */
+	if ((fp = os_fopen(THP_SHMEM_ENABLED, "r")) == NULL) {
+		LOG(2, "!%s", THP_SHMEM_ENABLED);
+		return 0;
+	}
+	char line[128];
+	char *mode = fgets(line, sizeof(line), fp);
+	(void) fclose(fp);
+	if (mode == NULL || (mode = strchr(line, '[')) == NULL ||
+			strncmp(mode, "[never]", 7) == 0 ||
+			strncmp(mode, "[deny]", 6) == 0) {
+		LOG(4, "transparent huge pages disabled for shmem");
+		return 0;
+	}
+
+	if ((fp = os_fopen(THP_PMD_SIZE, "r")) == NULL) {
+		LOG(2, "!%s", THP_PMD_SIZE);
+		return 0;
+	}
+	char *str = fgets(buf, sizeof(buf), fp);
+	(void) fclose(fp);
+	if (str == NULL)
+		return 0;
+
+	size_t size = strtoull(buf, NULL, 10);
+
+	LOG(4, "transparent huge page size %zu", size);
+	return size;
+#else
+	return 0;
+#endif
+}
@@ -208,3 +208,27 @@ util_file_device_dax_alignment(const char *path)
 
 	return 0;
 }
+
+/*
+ * util_file_hugetlbfs_pagesize -- returns the page size of the hugetlbfs
+ *	file system the path resides on, or 0 if it is not a hugetlbfs
+ */
+size_t
+util_file_hugetlbfs_pagesize(const char *path)
+{
+	LOG(3, "path \"%s\"", path);
+
+	return 0;
+}
+
+/*
+ * util_file_thp_pagesize -- returns the size of the transparent huge pages
+ *	which may back the files in the path, or 0 if there are none
+ */
+size_t
+util_file_thp_pagesize(const char *path)
+{
+	LOG(3, "path \"%s\"", path);
+
+	return 0;
+}
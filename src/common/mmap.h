@@ -93,6 +93,7 @@ int util_range_none(void *addr, size_t len);
 
 char *util_map_hint_unused(void *minaddr, size_t len, size_t align);
 char *util_map_hint(size_t len, size_t req_align);
+int util_map_advise_huge(void *addr, size_t len);
 
 #define MEGABYTE ((uintptr_t)1 << 20)
 #define GIGABYTE ((uintptr_t)1 << 30)
@@ -34,6 +34,7 @@
  * mmap_linux.c -- memory-mapped files for Linux
  */
 
+#include <errno.h>
 #include <stdio.h>
 #include <sys/mman.h>
 #include <sys/param.h>
@@ -179,3 +180,24 @@ util_map_hint(size_t len, size_t req_align)
 
 	return hint_addr;
 }
+
+/*
+ * util_map_advise_huge -- advise the kernel to back the mapping with
+ *	transparent huge pages
+ */
+int
+util_map_advise_huge(void *addr, size_t len)
+{
+	LOG(3, "addr %p len %zu", addr, len);
+
+#ifdef MADV_HUGEPAGE
+	if (madvise(addr, len, MADV_HUGEPAGE) == 0)
+		return 0;
+
+	LOG(2, "!madvise MADV_HUGEPAGE");
+#else
+	LOG(2, "transparent huge pages not supported");
+	errno = ENOTSUP;
+#endif
+	return -1;
+}
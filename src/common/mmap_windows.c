@@ -35,6 +35,7 @@
  * mmap_windows.c -- memory-mapped files for Windows
  */
 
+#include <errno.h>
 #include <sys/mman.h>
 #include "mmap.h"
 #include "out.h"
@@ -131,3 +132,18 @@ util_map_hint(size_t len, size_t req_align)
 	LOG(4, "hint %p", hint_addr);
 	return hint_addr;
 }
+
+/*
+ * util_map_advise_huge -- advise the kernel to back the mapping with
+ *	transparent huge pages
+ *
+ * Not supported on Windows.
+ */
+int
+util_map_advise_huge(void *addr, size_t len)
+{
+	LOG(3, "addr %p len %zu", addr, len);
+
+	errno = ENOTSUP;
+	return -1;
+}
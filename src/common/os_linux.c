@@ -193,6 +193,15 @@ os_clock_gettime(int id, struct timespec *ts)
 	return clock_gettime(id, ts);
 }
 
+/*
+ * os_nanosleep -- nanosleep abstraction layer
+ */
+int
+os_nanosleep(const struct timespec *req)
+{
+	return nanosleep(req, NULL);
+}
+
 /*
  * os_rand_r -- rand_r abstraction layer
  */
@@ -458,6 +458,17 @@ os_clock_gettime(int id, struct timespec *ts)
 }
 
 
+/*
+ * os_nanosleep -- suspends the calling thread, the resolution is limited to
+ * milliseconds
+ */
+int
+os_nanosleep(const struct timespec *req)
+{
+	Sleep((DWORD)(req->tv_sec * 1000 + req->tv_nsec / 1000000));
+	return 0;
+}
+
 /*
  * os_setenv -- change or add an environment variable
  */
@@ -81,8 +81,13 @@ static RPMEMpool *(*Rpmem_open)(const char *target, const char *pool_set_name,
 int (*Rpmem_close)(RPMEMpool *rpp);
 int (*Rpmem_persist)(RPMEMpool *rpp, size_t offset, size_t length,
 			unsigned lane);
+int (*Rpmem_flush)(RPMEMpool *rpp, size_t offset, size_t length,
+			unsigned lane);
+int (*Rpmem_drain)(RPMEMpool *rpp, unsigned lane);
 int (*Rpmem_read)(RPMEMpool *rpp, void *buff, size_t offset,
 		size_t length, unsigned lane);
+int (*Rpmem_register)(RPMEMpool *rpp, void *buff, size_t length);
+int (*Rpmem_unregister)(RPMEMpool *rpp, void *buff);
 int (*Rpmem_remove)(const char *target, const char *pool_set_name, int flags);
 int (*Rpmem_set_attr)(RPMEMpool *rpp, const struct rpmem_pool_attr *attr);
 
@@ -161,7 +166,11 @@ util_remote_unload_core(void)
 	Rpmem_open = NULL;
 	Rpmem_close = NULL;
 	Rpmem_persist = NULL;
+	Rpmem_flush = NULL;
+	Rpmem_drain = NULL;
 	Rpmem_read = NULL;
+	Rpmem_register = NULL;
+	Rpmem_unregister = NULL;
 	Rpmem_remove = NULL;
 	Rpmem_set_attr = NULL;
 }
@@ -211,7 +220,11 @@ util_remote_load(void)
 	CHECK_FUNC_COMPATIBLE(rpmem_open, *Rpmem_open);
 	CHECK_FUNC_COMPATIBLE(rpmem_close, *Rpmem_close);
 	CHECK_FUNC_COMPATIBLE(rpmem_persist, *Rpmem_persist);
+	CHECK_FUNC_COMPATIBLE(rpmem_flush, *Rpmem_flush);
+	CHECK_FUNC_COMPATIBLE(rpmem_drain, *Rpmem_drain);
 	CHECK_FUNC_COMPATIBLE(rpmem_read, *Rpmem_read);
+	CHECK_FUNC_COMPATIBLE(rpmem_register, *Rpmem_register);
+	CHECK_FUNC_COMPATIBLE(rpmem_unregister, *Rpmem_unregister);
 	CHECK_FUNC_COMPATIBLE(rpmem_remove, *Rpmem_remove);
 
 	util_mutex_lock(&Remote_lock);
@@ -251,12 +264,37 @@ util_remote_load(void)
 		goto err;
 	}
 
+	Rpmem_flush = util_dlsym(Rpmem_handle_remote, "rpmem_flush");
+	if (util_dl_check_error(Rpmem_flush, "dlsym")) {
+		ERR("symbol 'rpmem_flush' not found");
+		goto err;
+	}
+
+	Rpmem_drain = util_dlsym(Rpmem_handle_remote, "rpmem_drain");
+	if (util_dl_check_error(Rpmem_drain, "dlsym")) {
+		ERR("symbol 'rpmem_drain' not found");
+		goto err;
+	}
+
 	Rpmem_read = util_dlsym(Rpmem_handle_remote, "rpmem_read");
 	if (util_dl_check_error(Rpmem_read, "dlsym")) {
 		ERR("symbol 'rpmem_read' not found");
 		goto err;
 	}
 
+	Rpmem_register = util_dlsym(Rpmem_handle_remote, "rpmem_register");
+	if (util_dl_check_error(Rpmem_register, "dlsym")) {
+		ERR("symbol 'rpmem_register' not found");
+		goto err;
+	}
+
+	Rpmem_unregister = util_dlsym(Rpmem_handle_remote,
+			"rpmem_unregister");
+	if (util_dl_check_error(Rpmem_unregister, "dlsym")) {
+		ERR("symbol 'rpmem_unregister' not found");
+		goto err;
+	}
+
 	Rpmem_remove = util_dlsym(Rpmem_handle_remote, "rpmem_remove");
 	if (util_dl_check_error(Rpmem_remove, "dlsym")) {
 		ERR("symbol 'rpmem_remove' not found");
@@ -279,8 +279,13 @@ int util_replica_close_remote(struct pool_replica *rep, unsigned repn,
 
 extern int (*Rpmem_persist)(RPMEMpool *rpp, size_t offset, size_t length,
 								unsigned lane);
+extern int (*Rpmem_flush)(RPMEMpool *rpp, size_t offset, size_t length,
+								unsigned lane);
+extern int (*Rpmem_drain)(RPMEMpool *rpp, unsigned lane);
 extern int (*Rpmem_read)(RPMEMpool *rpp, void *buff, size_t offset,
 				size_t length, unsigned lane);
+extern int (*Rpmem_register)(RPMEMpool *rpp, void *buff, size_t length);
+extern int (*Rpmem_unregister)(RPMEMpool *rpp, void *buff);
 extern int (*Rpmem_close)(RPMEMpool *rpp);
 
 extern int (*Rpmem_remove)(const char *target,
@@ -101,6 +101,36 @@ util_mutex_unlock(os_mutex_t *m)
 	}
 }
 
+/*
+ * util_rwlock_rdlock -- os_rwlock_rdlock variant that never fails from
+ * caller perspective. If os_rwlock_rdlock failed, this function aborts
+ * the program.
+ */
+static inline void
+util_rwlock_rdlock(os_rwlock_t *m)
+{
+	int tmp = os_rwlock_rdlock(m);
+	if (tmp) {
+		errno = tmp;
+		FATAL("!os_rwlock_rdlock");
+	}
+}
+
+/*
+ * util_rwlock_wrlock -- os_rwlock_wrlock variant that never fails from
+ * caller perspective. If os_rwlock_wrlock failed, this function aborts
+ * the program.
+ */
+static inline void
+util_rwlock_wrlock(os_rwlock_t *m)
+{
+	int tmp = os_rwlock_wrlock(m);
+	if (tmp) {
+		errno = tmp;
+		FATAL("!os_rwlock_wrlock");
+	}
+}
+
 /*
  * util_rwlock_unlock -- os_rwlock_unlock variant that never fails from
  * caller perspective. If os_rwlock_unlock failed, this function aborts
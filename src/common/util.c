@@ -90,6 +90,111 @@ util_is_zeroed(const void *addr, size_t len)
 	return 1;
 }
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define CHECKSUM_SSE2
+#include <emmintrin.h>
+#endif
+
+/* number of 32-bit words processed by a single iteration of the main loop */
+#define CHECKSUM_WORDS 8
+
+/*
+ * checksum_words -- (internal) add words to the Fletcher64 sums
+ *
+ * The words are processed in 8 independent lanes. Each lane keeps the sum
+ * of its words (a) and the running sum of the partial sums (b), which
+ * counts every word as many times as there are iterations left, including
+ * its own. For the words w[i] of a block of n words the Fletcher sums are:
+ *
+ *	lo += sum(w[i])
+ *	hi += n * lo + sum((n - i) * w[i])
+ *
+ * and for the word i = 8 * t + l the weight (n - i) equals
+ * 8 * (T - t) - l, so the second sum is 8 * sum(b) - sum(l * a[l]).
+ * All of the sums are modulo 2^32, just like in the scalar version.
+ */
+static void
+checksum_words(const uint32_t *p32, size_t nwords, uint32_t *lo32,
+	uint32_t *hi32)
+{
+	size_t nblock = nwords - nwords % CHECKSUM_WORDS;
+	uint32_t a[CHECKSUM_WORDS];
+	uint32_t b[CHECKSUM_WORDS];
+
+#ifdef CHECKSUM_SSE2
+	__m128i a0 = _mm_setzero_si128();
+	__m128i a1 = _mm_setzero_si128();
+	__m128i b0 = _mm_setzero_si128();
+	__m128i b1 = _mm_setzero_si128();
+
+	for (size_t i = 0; i < nblock; i += CHECKSUM_WORDS) {
+		__m128i w0 = _mm_loadu_si128((const __m128i *)&p32[i]);
+		__m128i w1 = _mm_loadu_si128((const __m128i *)&p32[i + 4]);
+
+		a0 = _mm_add_epi32(a0, w0);
+		a1 = _mm_add_epi32(a1, w1);
+		b0 = _mm_add_epi32(b0, a0);
+		b1 = _mm_add_epi32(b1, a1);
+	}
+
+	_mm_storeu_si128((__m128i *)&a[0], a0);
+	_mm_storeu_si128((__m128i *)&a[4], a1);
+	_mm_storeu_si128((__m128i *)&b[0], b0);
+	_mm_storeu_si128((__m128i *)&b[4], b1);
+#else
+	memset(a, 0, sizeof(a));
+	memset(b, 0, sizeof(b));
+
+	for (size_t i = 0; i < nblock; i += CHECKSUM_WORDS) {
+		for (unsigned l = 0; l < CHECKSUM_WORDS; ++l) {
+			a[l] += le32toh(p32[i + l]);
+			b[l] += a[l];
+		}
+	}
+#endif
+
+	uint32_t lo = *lo32;
+	uint32_t hi = *hi32 + (uint32_t)nblock * lo;
+	uint32_t bsum = 0;
+
+	for (unsigned l = 0; l < CHECKSUM_WORDS; ++l) {
+		lo += a[l];
+		bsum += b[l];
+		hi -= l * a[l];
+	}
+	hi += CHECKSUM_WORDS * bsum;
+
+	for (size_t i = nblock; i < nwords; ++i) {
+		lo += le32toh(p32[i]);
+		hi += lo;
+	}
+
+	*lo32 = lo;
+	*hi32 = hi;
+}
+
+/*
+ * util_checksum_seq -- continue Fletcher64 checksum computation
+ *
+ * Returns the checksum of the range appended to the data the csum was
+ * computed for, so a checksum of multiple buffers may be computed piece by
+ * piece starting with csum equal to 0. The returned value is in host byte
+ * order.
+ */
+uint64_t
+util_checksum_seq(const void *addr, size_t len, uint64_t csum)
+{
+	if (len % 4 != 0)
+		abort();
+
+	uint32_t lo32 = (uint32_t)csum;
+	uint32_t hi32 = (uint32_t)(csum >> 32);
+
+	checksum_words(addr, len / 4, &lo32, &hi32);
+
+	return (uint64_t)hi32 << 32 | lo32;
+}
+
 /*
  * util_checksum -- compute Fletcher64 checksum
  *
@@ -108,24 +213,29 @@ util_checksum(void *addr, size_t len, uint64_t *csump, int insert)
 		abort();
 
 	uint32_t *p32 = addr;
-	uint32_t *p32end = (uint32_t *)((char *)addr + len);
+	size_t nwords = len / 4;
+	size_t csum_off = (size_t)((uintptr_t)csump - (uintptr_t)addr);
 	uint32_t lo32 = 0;
 	uint32_t hi32 = 0;
 	uint64_t csum;
 
-	while (p32 < p32end)
-		if (p32 == (uint32_t *)csump) {
-			/* lo32 += 0; treat first 32-bits as zero */
-			p32++;
-			hi32 += lo32;
-			/* lo32 += 0; treat second 32-bits as zero */
-			p32++;
-			hi32 += lo32;
-		} else {
-			lo32 += le32toh(*p32);
-			++p32;
-			hi32 += lo32;
-		}
+	if ((uintptr_t)csump < (uintptr_t)addr || csum_off >= len ||
+			csum_off % 4 != 0) {
+		/* the checksum does not live within the range */
+		checksum_words(p32, nwords, &lo32, &hi32);
+	} else {
+		size_t csum_word = csum_off / 4;
+		size_t next_word = csum_word + 2 < nwords ?
+			csum_word + 2 : nwords;
+
+		checksum_words(p32, csum_word, &lo32, &hi32);
+
+		/* treat both 32-bit halves of the checksum as zeros */
+		hi32 += 2 * lo32;
+
+		checksum_words(p32 + next_word, nwords - next_word,
+			&lo32, &hi32);
+	}
 
 	csum = (uint64_t)hi32 << 32 | lo32;
 
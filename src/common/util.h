@@ -87,6 +87,7 @@ extern void *Zalloc(size_t sz);
 void util_init(void);
 int util_is_zeroed(const void *addr, size_t len);
 int util_checksum(void *addr, size_t len, uint64_t *csump, int insert);
+uint64_t util_checksum_seq(const void *addr, size_t len, uint64_t csum);
 int util_parse_size(const char *str, size_t *sizep);
 char *util_fgets(char *buffer, int max, FILE *stream);
 char *util_getexecname(char *path, size_t pathlen);
@@ -44,6 +44,7 @@
 #include "map.h"
 #include "map_ctree.h"
 #include "map_btree.h"
+#include "map_bplustree.h"
 #include "map_rbtree.h"
 #include "map_hashmap_atomic.h"
 #include "map_hashmap_tx.h"
@@ -118,6 +119,8 @@ parse_map_type(const char *type)
 		return MAP_HASHMAP_TX;
 	else if (strcmp(type, "skiplist") == 0)
 		return MAP_SKIPLIST;
+	else if (strcmp(type, "bplustree") == 0)
+		return MAP_BPLUSTREE;
 	return NULL;
 
 }
@@ -126,7 +129,8 @@ int main(int argc, const char *argv[]) {
 	if (argc < 3) {
 		printf("usage: %s "
 			"<ctree|btree|rbtree|hashmap_atomic|"
-			"hashmap_tx|skiplist> file-name [nops]\n", argv[0]);
+			"hashmap_tx|skiplist|bplustree> file-name [nops]\n",
+			argv[0]);
 		return 1;
 	}
 
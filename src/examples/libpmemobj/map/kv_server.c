@@ -46,6 +46,7 @@
 #include "map.h"
 #include "map_ctree.h"
 #include "map_btree.h"
+#include "map_bplustree.h"
 #include "map_rtree.h"
 #include "map_rbtree.h"
 #include "map_hashmap_atomic.h"
@@ -400,7 +401,8 @@ static const struct {
 	{MAP_BTREE, "btree"},
 	{MAP_RTREE, "rtree"},
 	{MAP_RBTREE, "rbtree"},
-	{MAP_SKIPLIST, "skiplist"}
+	{MAP_SKIPLIST, "skiplist"},
+	{MAP_BPLUSTREE, "bplustree"}
 };
 
 /*
@@ -425,7 +427,8 @@ main(int argc, char *argv[])
 {
 	if (argc < 4) {
 		printf("usage: %s hashmap_tx|hashmap_atomic|ctree|btree|rtree|"
-				"rbtree|skiplist file-name port\n", argv[0]);
+				"rbtree|skiplist|bplustree file-name port\n",
+				argv[0]);
 		return 1;
 	}
 
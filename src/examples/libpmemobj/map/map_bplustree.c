@@ -0,0 +1,238 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * map_bplustree.c -- common interface for maps
+ */
+
+#include <map.h>
+#include <bplustree_map.h>
+
+#include "map_bplustree.h"
+
+/*
+ * map_bplustree_check -- wrapper for bplustree_map_check
+ */
+static int
+map_bplustree_check(PMEMobjpool *pop, TOID(struct map) map)
+{
+	TOID(struct bplustree_map) bplustree_map;
+	TOID_ASSIGN(bplustree_map, map.oid);
+
+	return bplustree_map_check(pop, bplustree_map);
+}
+
+/*
+ * map_bplustree_create -- wrapper for bplustree_map_create
+ */
+static int
+map_bplustree_create(PMEMobjpool *pop, TOID(struct map) *map, void *arg)
+{
+	TOID(struct bplustree_map) *bplustree_map =
+		(TOID(struct bplustree_map) *)map;
+
+	return bplustree_map_create(pop, bplustree_map, arg);
+}
+
+/*
+ * map_bplustree_destroy -- wrapper for bplustree_map_destroy
+ */
+static int
+map_bplustree_destroy(PMEMobjpool *pop, TOID(struct map) *map)
+{
+	TOID(struct bplustree_map) *bplustree_map =
+		(TOID(struct bplustree_map) *)map;
+
+	return bplustree_map_destroy(pop, bplustree_map);
+}
+
+/*
+ * map_bplustree_insert -- wrapper for bplustree_map_insert
+ */
+static int
+map_bplustree_insert(PMEMobjpool *pop, TOID(struct map) map,
+		uint64_t key, PMEMoid value)
+{
+	TOID(struct bplustree_map) bplustree_map;
+	TOID_ASSIGN(bplustree_map, map.oid);
+
+	return bplustree_map_insert(pop, bplustree_map, key, value);
+}
+
+/*
+ * map_bplustree_insert_new -- wrapper for bplustree_map_insert_new
+ */
+static int
+map_bplustree_insert_new(PMEMobjpool *pop, TOID(struct map) map,
+		uint64_t key, size_t size,
+		unsigned type_num,
+		void (*constructor)(PMEMobjpool *pop, void *ptr, void *arg),
+		void *arg)
+{
+	TOID(struct bplustree_map) bplustree_map;
+	TOID_ASSIGN(bplustree_map, map.oid);
+
+	return bplustree_map_insert_new(pop, bplustree_map, key, size,
+			type_num, constructor, arg);
+}
+
+/*
+ * map_bplustree_remove -- wrapper for bplustree_map_remove
+ */
+static PMEMoid
+map_bplustree_remove(PMEMobjpool *pop, TOID(struct map) map, uint64_t key)
+{
+	TOID(struct bplustree_map) bplustree_map;
+	TOID_ASSIGN(bplustree_map, map.oid);
+
+	return bplustree_map_remove(pop, bplustree_map, key);
+}
+
+/*
+ * map_bplustree_remove_free -- wrapper for bplustree_map_remove_free
+ */
+static int
+map_bplustree_remove_free(PMEMobjpool *pop, TOID(struct map) map, uint64_t key)
+{
+	TOID(struct bplustree_map) bplustree_map;
+	TOID_ASSIGN(bplustree_map, map.oid);
+
+	return bplustree_map_remove_free(pop, bplustree_map, key);
+}
+
+/*
+ * map_bplustree_clear -- wrapper for bplustree_map_clear
+ */
+static int
+map_bplustree_clear(PMEMobjpool *pop, TOID(struct map) map)
+{
+	TOID(struct bplustree_map) bplustree_map;
+	TOID_ASSIGN(bplustree_map, map.oid);
+
+	return bplustree_map_clear(pop, bplustree_map);
+}
+
+/*
+ * map_bplustree_get -- wrapper for bplustree_map_get
+ */
+static PMEMoid
+map_bplustree_get(PMEMobjpool *pop, TOID(struct map) map, uint64_t key)
+{
+	TOID(struct bplustree_map) bplustree_map;
+	TOID_ASSIGN(bplustree_map, map.oid);
+
+	return bplustree_map_get(pop, bplustree_map, key);
+}
+
+/*
+ * map_bplustree_lookup -- wrapper for bplustree_map_lookup
+ */
+static int
+map_bplustree_lookup(PMEMobjpool *pop, TOID(struct map) map, uint64_t key)
+{
+	TOID(struct bplustree_map) bplustree_map;
+	TOID_ASSIGN(bplustree_map, map.oid);
+
+	return bplustree_map_lookup(pop, bplustree_map, key);
+}
+
+/*
+ * map_bplustree_foreach -- wrapper for bplustree_map_foreach
+ */
+static int
+map_bplustree_foreach(PMEMobjpool *pop, TOID(struct map) map,
+		int (*cb)(uint64_t key, PMEMoid value, void *arg),
+		void *arg)
+{
+	TOID(struct bplustree_map) bplustree_map;
+	TOID_ASSIGN(bplustree_map, map.oid);
+
+	return bplustree_map_foreach(pop, bplustree_map, cb, arg);
+}
+
+/*
+ * map_bplustree_range -- wrapper for bplustree_map_range
+ */
+static int
+map_bplustree_range(PMEMobjpool *pop, TOID(struct map) map,
+		uint64_t start, uint64_t end,
+		int (*cb)(uint64_t key, PMEMoid value, void *arg),
+		void *arg)
+{
+	TOID(struct bplustree_map) bplustree_map;
+	TOID_ASSIGN(bplustree_map, map.oid);
+
+	return bplustree_map_range(pop, bplustree_map, start, end, cb, arg);
+}
+
+/*
+ * map_bplustree_is_empty -- wrapper for bplustree_map_is_empty
+ */
+static int
+map_bplustree_is_empty(PMEMobjpool *pop, TOID(struct map) map)
+{
+	TOID(struct bplustree_map) bplustree_map;
+	TOID_ASSIGN(bplustree_map, map.oid);
+
+	return bplustree_map_is_empty(pop, bplustree_map);
+}
+
+/*
+ * map_bplustree_count -- wrapper for bplustree_map_count
+ */
+static size_t
+map_bplustree_count(PMEMobjpool *pop, TOID(struct map) map)
+{
+	TOID(struct bplustree_map) bplustree_map;
+	TOID_ASSIGN(bplustree_map, map.oid);
+
+	return bplustree_map_count(pop, bplustree_map);
+}
+
+struct map_ops bplustree_map_ops = {
+	/* .check	= */ map_bplustree_check,
+	/* .create	= */ map_bplustree_create,
+	/* .destroy	= */ map_bplustree_destroy,
+	/* .init	= */ NULL,
+	/* .insert	= */ map_bplustree_insert,
+	/* .insert_new	= */ map_bplustree_insert_new,
+	/* .remove	= */ map_bplustree_remove,
+	/* .remove_free	= */ map_bplustree_remove_free,
+	/* .clear	= */ map_bplustree_clear,
+	/* .get		= */ map_bplustree_get,
+	/* .lookup	= */ map_bplustree_lookup,
+	/* .foreach	= */ map_bplustree_foreach,
+	/* .range	= */ map_bplustree_range,
+	/* .is_empty	= */ map_bplustree_is_empty,
+	/* .count	= */ map_bplustree_count,
+	/* .cmd		= */ NULL,
+};
@@ -204,6 +204,7 @@ struct map_ops btree_map_ops = {
 	/* .get		= */ map_btree_get,
 	/* .lookup	= */ map_btree_lookup,
 	/* .foreach	= */ map_btree_foreach,
+	/* .range	= */ NULL,
 	/* .is_empty	= */ map_btree_is_empty,
 	/* .count	= */ NULL,
 	/* .cmd		= */ NULL,
@@ -204,6 +204,7 @@ struct map_ops ctree_map_ops = {
 	/* .get		= */ map_ctree_get,
 	/* .lookup	= */ map_ctree_lookup,
 	/* .foreach	= */ map_ctree_foreach,
+	/* .range	= */ NULL,
 	/* .is_empty	= */ map_ctree_is_empty,
 	/* .count	= */ NULL,
 	/* .cmd		= */ NULL,
@@ -176,6 +176,7 @@ struct map_ops hashmap_tx_ops = {
 	/* .get		= */ map_hm_tx_get,
 	/* .lookup	= */ map_hm_tx_lookup,
 	/* .foreach	= */ map_hm_tx_foreach,
+	/* .range	= */ NULL,
 	/* .is_empty	= */ NULL,
 	/* .count	= */ map_hm_tx_count,
 	/* .cmd		= */ map_hm_tx_cmd,
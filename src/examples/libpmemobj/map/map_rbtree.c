@@ -204,6 +204,7 @@ struct map_ops rbtree_map_ops = {
 	/* .get		= */ map_rbtree_get,
 	/* .lookup	= */ map_rbtree_lookup,
 	/* .foreach	= */ map_rbtree_foreach,
+	/* .range	= */ NULL,
 	/* .is_empty	= */ map_rbtree_is_empty,
 	/* .count	= */ NULL,
 	/* .cmd		= */ NULL,
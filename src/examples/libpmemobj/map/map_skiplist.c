@@ -204,6 +204,7 @@ struct map_ops skiplist_map_ops = {
 	/* .get		= */ map_skiplist_get,
 	/* .lookup	= */ map_skiplist_lookup,
 	/* .foreach	= */ map_skiplist_foreach,
+	/* .range	= */ NULL,
 	/* .is_empty	= */ map_skiplist_is_empty,
 	/* .count	= */ NULL,
 	/* .cmd		= */ NULL,
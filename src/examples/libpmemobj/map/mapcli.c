@@ -43,6 +43,7 @@
 #include "map.h"
 #include "map_ctree.h"
 #include "map_btree.h"
+#include "map_bplustree.h"
 #include "map_rtree.h"
 #include "map_rbtree.h"
 #include "map_hashmap_atomic.h"
@@ -172,6 +173,7 @@ help(void)
 	printf("c $value - check $value, returns 0/1\n");
 	printf("n $value - insert $value random values\n");
 	printf("p - print all values\n");
+	printf("s $start $end - print values from $start to $end\n");
 	printf("d - print debug info\n");
 	printf("b [$value] - rebuild $value (default: 1) times\n");
 	printf("q - quit\n");
@@ -198,6 +200,22 @@ print_all(void)
 	printf("\n");
 }
 
+/*
+ * str_range -- prints the keys from $start to $end inclusive in order
+ */
+static void
+str_range(const char *str)
+{
+	uint64_t start;
+	uint64_t end;
+	if (sscanf(str, "%" PRIu64 " %" PRIu64, &start, &end) == 2) {
+		map_range(mapc, map, start, end, hashmap_print, NULL);
+		printf("\n");
+	} else {
+		fprintf(stderr, "range: invalid syntax\n");
+	}
+}
+
 #define INPUT_BUF_LEN 1000
 int
 main(int argc, char *argv[])
@@ -205,7 +223,7 @@ main(int argc, char *argv[])
 	if (argc < 3 || argc > 4) {
 		printf("usage: %s "
 			"hashmap_tx|hashmap_atomic|"
-			"ctree|btree|rtree|rbtree|skiplist"
+			"ctree|btree|rtree|rbtree|skiplist|bplustree"
 				" file-name [<seed>]\n", argv[0]);
 		return 1;
 	}
@@ -227,6 +245,8 @@ main(int argc, char *argv[])
 		ops = MAP_RBTREE;
 	} else if (strcmp(type, "skiplist") == 0) {
 		ops = MAP_SKIPLIST;
+	} else if (strcmp(type, "bplustree") == 0) {
+		ops = MAP_BPLUSTREE;
 	} else {
 		fprintf(stderr, "invalid hasmap type -- '%s'\n", type);
 		return 1;
@@ -307,6 +327,9 @@ main(int argc, char *argv[])
 			case 'p':
 				print_all();
 				break;
+			case 's':
+				str_range(buf + 1);
+				break;
 			case 'd':
 				map_cmd(mapc, map, HASHMAP_CMD_DEBUG,
 						(uint64_t)stdout);
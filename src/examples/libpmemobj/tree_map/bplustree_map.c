@@ -0,0 +1,808 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * bplustree_map.c -- B+-tree with fingerprinted leaves
+ *
+ * All the key-value pairs are stored in the leaves, which are linked into
+ * a list in key order, so range scans walk the leaves without going back
+ * to the inner nodes. The entries of a leaf are not sorted: a new pair is
+ * appended to the first free slot and a removed one is replaced with the
+ * last pair of the leaf, which keeps the undo log of both operations
+ * small. Each leaf keeps a one byte fingerprint of every key next to its
+ * header, so a lookup reads only that cache line to rule out most slots,
+ * including all of them for a key that is not there.
+ *
+ * Leaves are never merged, only freed once they become empty.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "bplustree_map.h"
+
+TOID_DECLARE(struct bplustree_leaf, BPLUSTREE_MAP_TYPE_OFFSET + 1);
+TOID_DECLARE(struct bplustree_inner, BPLUSTREE_MAP_TYPE_OFFSET + 2);
+
+#define BPLUSTREE_LEAF_MAX 32 /* number of entries per leaf, can't be odd */
+#define BPLUSTREE_INNER_MAX 15 /* number of keys per inner node */
+
+/*
+ * Maximum number of inner node levels -- the root is split only when all
+ * its children are at least half full, so a tree this high would not fit
+ * in any pool.
+ */
+#define BPLUSTREE_MAX_HEIGHT 32
+
+struct bplustree_leaf {
+	/* the header and fingerprints share the first cache line */
+	uint32_t n; /* number of occupied slots */
+	uint8_t fp[BPLUSTREE_LEAF_MAX];
+	TOID(struct bplustree_leaf) next;
+
+	uint64_t keys[BPLUSTREE_LEAF_MAX];
+	PMEMoid values[BPLUSTREE_LEAF_MAX];
+};
+
+struct bplustree_inner {
+	/* keys[i] is the smallest key which can be found in children[i + 1] */
+	uint64_t n; /* number of keys, there is one child more */
+	uint64_t keys[BPLUSTREE_INNER_MAX];
+	PMEMoid children[BPLUSTREE_INNER_MAX + 1];
+};
+
+struct bplustree_map {
+	uint64_t height; /* number of inner node levels above the leaves */
+	PMEMoid root;
+};
+
+/* the nodes visited on the way from the root to a leaf */
+struct bplustree_path {
+	TOID(struct bplustree_inner) nodes[BPLUSTREE_MAX_HEIGHT];
+	uint64_t idx[BPLUSTREE_MAX_HEIGHT]; /* index of the child taken */
+	TOID(struct bplustree_leaf) leaf;
+};
+
+/*
+ * bplustree_map_fp -- (internal) calculates the fingerprint of a key
+ */
+static uint8_t
+bplustree_map_fp(uint64_t key)
+{
+	return (uint8_t)((key * 0x9e3779b97f4a7c15ULL) >> 56);
+}
+
+/*
+ * bplustree_map_create -- allocates a new B+-tree instance
+ */
+int
+bplustree_map_create(PMEMobjpool *pop, TOID(struct bplustree_map) *map,
+	void *arg)
+{
+	int ret = 0;
+
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range_direct(map, sizeof(*map));
+		*map = TX_ZNEW(struct bplustree_map);
+	} TX_ONABORT {
+		ret = 1;
+	} TX_END
+
+	return ret;
+}
+
+/*
+ * bplustree_map_clear_node -- (internal) frees the subtree of a node
+ */
+static void
+bplustree_map_clear_node(PMEMoid node, uint64_t height)
+{
+	if (height != 0) {
+		TOID(struct bplustree_inner) inner;
+		TOID_ASSIGN(inner, node);
+
+		for (uint64_t i = 0; i <= D_RO(inner)->n; ++i)
+			bplustree_map_clear_node(D_RO(inner)->children[i],
+				height - 1);
+	}
+
+	pmemobj_tx_free(node);
+}
+
+/*
+ * bplustree_map_clear -- removes all elements from the map
+ */
+int
+bplustree_map_clear(PMEMobjpool *pop, TOID(struct bplustree_map) map)
+{
+	int ret = 0;
+
+	TX_BEGIN(pop) {
+		if (!OID_IS_NULL(D_RO(map)->root))
+			bplustree_map_clear_node(D_RO(map)->root,
+				D_RO(map)->height);
+
+		TX_ADD(map);
+		D_RW(map)->root = OID_NULL;
+		D_RW(map)->height = 0;
+	} TX_ONABORT {
+		ret = 1;
+	} TX_END
+
+	return ret;
+}
+
+/*
+ * bplustree_map_destroy -- cleanups and frees B+-tree instance
+ */
+int
+bplustree_map_destroy(PMEMobjpool *pop, TOID(struct bplustree_map) *map)
+{
+	int ret = 0;
+
+	TX_BEGIN(pop) {
+		bplustree_map_clear(pop, *map);
+		pmemobj_tx_add_range_direct(map, sizeof(*map));
+		TX_FREE(*map);
+		*map = TOID_NULL(struct bplustree_map);
+	} TX_ONABORT {
+		ret = 1;
+	} TX_END
+
+	return ret;
+}
+
+/*
+ * bplustree_map_child_idx -- (internal) returns the index of the child of
+ *	an inner node which can contain the key
+ */
+static uint64_t
+bplustree_map_child_idx(const struct bplustree_inner *node, uint64_t key)
+{
+	uint64_t lo = 0;
+	uint64_t hi = node->n;
+
+	while (lo < hi) {
+		uint64_t mid = (lo + hi) / 2;
+		if (key < node->keys[mid])
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return lo;
+}
+
+/*
+ * bplustree_map_find_leaf -- (internal) descends from the root to the leaf
+ *	which can contain the key, optionally recording the path
+ */
+static TOID(struct bplustree_leaf)
+bplustree_map_find_leaf(TOID(struct bplustree_map) map, uint64_t key,
+	struct bplustree_path *path)
+{
+	PMEMoid node = D_RO(map)->root;
+	uint64_t height = D_RO(map)->height;
+
+	for (uint64_t level = 0; level < height; ++level) {
+		TOID(struct bplustree_inner) inner;
+		TOID_ASSIGN(inner, node);
+
+		uint64_t i = bplustree_map_child_idx(D_RO(inner), key);
+		if (path) {
+			path->nodes[level] = inner;
+			path->idx[level] = i;
+		}
+
+		node = D_RO(inner)->children[i];
+	}
+
+	TOID(struct bplustree_leaf) leaf;
+	TOID_ASSIGN(leaf, node);
+	if (path)
+		path->leaf = leaf;
+
+	return leaf;
+}
+
+/*
+ * bplustree_map_leaf_find -- (internal) returns the slot of the key in
+ *	the leaf or -1
+ */
+static int
+bplustree_map_leaf_find(const struct bplustree_leaf *leaf, uint64_t key)
+{
+	uint8_t fp = bplustree_map_fp(key);
+
+	for (uint32_t i = 0; i < leaf->n; ++i) {
+		if (leaf->fp[i] == fp && leaf->keys[i] == key)
+			return (int)i;
+	}
+
+	return -1;
+}
+
+/*
+ * bplustree_map_sort -- (internal) sorts the slot numbers by their keys
+ */
+static void
+bplustree_map_sort(const struct bplustree_leaf *leaf, uint8_t *slots,
+	uint32_t n)
+{
+	for (uint32_t i = 1; i < n; ++i) {
+		uint8_t s = slots[i];
+		uint32_t j = i;
+		for (; j > 0 && leaf->keys[slots[j - 1]] > leaf->keys[s]; --j)
+			slots[j] = slots[j - 1];
+		slots[j] = s;
+	}
+}
+
+/*
+ * bplustree_map_leaf_append -- (internal) inserts a pair into a leaf with
+ *	a free slot
+ *
+ * The slot is past the end of the leaf, so it is written and persisted
+ * directly and only the header is added to the transaction. A slot freed
+ * earlier in the same transaction has already been snapshotted by
+ * bplustree_map_leaf_remove.
+ */
+static void
+bplustree_map_leaf_append(PMEMobjpool *pop, TOID(struct bplustree_leaf) leaf,
+	uint64_t key, PMEMoid value)
+{
+	struct bplustree_leaf *l = D_RW(leaf);
+	uint32_t n = l->n;
+
+	assert(n < BPLUSTREE_LEAF_MAX);
+
+	l->keys[n] = key;
+	l->values[n] = value;
+	pmemobj_flush(pop, &l->keys[n], sizeof(l->keys[n]));
+	pmemobj_persist(pop, &l->values[n], sizeof(l->values[n]));
+
+	pmemobj_tx_add_range_direct(l, offsetof(struct bplustree_leaf, next));
+	l->fp[n] = bplustree_map_fp(key);
+	l->n = n + 1;
+}
+
+/*
+ * bplustree_map_leaf_remove -- (internal) removes the pair at the slot
+ *	from the leaf, moving the last pair in its place
+ */
+static void
+bplustree_map_leaf_remove(TOID(struct bplustree_leaf) leaf, int slot)
+{
+	struct bplustree_leaf *l = D_RW(leaf);
+	uint32_t last = l->n - 1;
+
+	pmemobj_tx_add_range_direct(l, offsetof(struct bplustree_leaf, next));
+
+	/* the last slot is about to become free, see leaf_append */
+	TX_ADD_FIELD(leaf, keys[last]);
+	TX_ADD_FIELD(leaf, values[last]);
+
+	if ((uint32_t)slot != last) {
+		TX_ADD_FIELD(leaf, keys[slot]);
+		TX_ADD_FIELD(leaf, values[slot]);
+
+		l->keys[slot] = l->keys[last];
+		l->values[slot] = l->values[last];
+		l->fp[slot] = l->fp[last];
+	}
+
+	l->n = last;
+}
+
+/*
+ * bplustree_map_inner_insert -- (internal) inserts a separator and the
+ *	child to its right into the inner node at the given level, splitting
+ *	the nodes up to the root if needed
+ */
+static void
+bplustree_map_inner_insert(TOID(struct bplustree_map) map,
+	struct bplustree_path *path, uint64_t level, uint64_t key,
+	PMEMoid child)
+{
+	if (level == 0) {
+		/* the root has been split, grow the tree */
+		TOID(struct bplustree_inner) root =
+			TX_ZNEW(struct bplustree_inner);
+		D_RW(root)->n = 1;
+		D_RW(root)->keys[0] = key;
+		D_RW(root)->children[0] = D_RO(map)->root;
+		D_RW(root)->children[1] = child;
+
+		TX_ADD(map);
+		D_RW(map)->root = root.oid;
+		D_RW(map)->height += 1;
+		return;
+	}
+
+	TOID(struct bplustree_inner) node = path->nodes[level - 1];
+	uint64_t p = path->idx[level - 1]; /* the child which was split */
+	uint64_t n = D_RO(node)->n;
+
+	TX_ADD(node);
+	struct bplustree_inner *in = D_RW(node);
+
+	if (n < BPLUSTREE_INNER_MAX) {
+		memmove(&in->keys[p + 1], &in->keys[p],
+			sizeof(in->keys[0]) * (n - p));
+		memmove(&in->children[p + 2], &in->children[p + 1],
+			sizeof(in->children[0]) * (n - p));
+		in->keys[p] = key;
+		in->children[p + 1] = child;
+		in->n = n + 1;
+		return;
+	}
+
+	/* merge the new separator into a copy of the full node and split it */
+	uint64_t keys[BPLUSTREE_INNER_MAX + 1];
+	PMEMoid children[BPLUSTREE_INNER_MAX + 2];
+
+	memcpy(keys, in->keys, sizeof(keys[0]) * p);
+	keys[p] = key;
+	memcpy(&keys[p + 1], &in->keys[p], sizeof(keys[0]) * (n - p));
+
+	memcpy(children, in->children, sizeof(children[0]) * (p + 1));
+	children[p + 1] = child;
+	memcpy(&children[p + 2], &in->children[p + 1],
+		sizeof(children[0]) * (n - p));
+
+	uint64_t mid = (BPLUSTREE_INNER_MAX + 1) / 2;
+	uint64_t rn = BPLUSTREE_INNER_MAX - mid;
+
+	TOID(struct bplustree_inner) right = TX_ZNEW(struct bplustree_inner);
+	struct bplustree_inner *r = D_RW(right);
+
+	r->n = rn;
+	memcpy(r->keys, &keys[mid + 1], sizeof(keys[0]) * rn);
+	memcpy(r->children, &children[mid + 1],
+		sizeof(children[0]) * (rn + 1));
+
+	in->n = mid;
+	memcpy(in->keys, keys, sizeof(keys[0]) * mid);
+	memcpy(in->children, children, sizeof(children[0]) * (mid + 1));
+	memset(&in->keys[mid], 0,
+		sizeof(keys[0]) * (BPLUSTREE_INNER_MAX - mid));
+	memset(&in->children[mid + 1], 0,
+		sizeof(children[0]) * (BPLUSTREE_INNER_MAX - mid));
+
+	bplustree_map_inner_insert(map, path, level - 1, keys[mid],
+		right.oid);
+}
+
+/*
+ * bplustree_map_split_leaf -- (internal) moves the upper half of the full
+ *	leaf into a new one and returns the leaf the key belongs to
+ */
+static TOID(struct bplustree_leaf)
+bplustree_map_split_leaf(TOID(struct bplustree_map) map,
+	struct bplustree_path *path, uint64_t key)
+{
+	TOID(struct bplustree_leaf) leaf = path->leaf;
+
+	TX_ADD(leaf);
+	struct bplustree_leaf *l = D_RW(leaf);
+	struct bplustree_leaf old = *l;
+
+	uint8_t slots[BPLUSTREE_LEAF_MAX];
+	for (uint32_t i = 0; i < BPLUSTREE_LEAF_MAX; ++i)
+		slots[i] = (uint8_t)i;
+	bplustree_map_sort(&old, slots, BPLUSTREE_LEAF_MAX);
+
+	uint32_t half = BPLUSTREE_LEAF_MAX / 2;
+
+	TOID(struct bplustree_leaf) right = TX_ZNEW(struct bplustree_leaf);
+	struct bplustree_leaf *r = D_RW(right);
+
+	for (uint32_t i = 0; i < BPLUSTREE_LEAF_MAX; ++i) {
+		struct bplustree_leaf *dst = i < half ? l : r;
+		uint32_t d = i < half ? i : i - half;
+
+		dst->keys[d] = old.keys[slots[i]];
+		dst->values[d] = old.values[slots[i]];
+		dst->fp[d] = old.fp[slots[i]];
+	}
+
+	r->n = BPLUSTREE_LEAF_MAX - half;
+	r->next = l->next;
+
+	l->n = half;
+	l->next = right;
+	memset(&l->keys[half], 0, sizeof(l->keys[0]) * r->n);
+	memset(&l->values[half], 0, sizeof(l->values[0]) * r->n);
+	memset(&l->fp[half], 0, sizeof(l->fp[0]) * r->n);
+
+	uint64_t sep = r->keys[0];
+	bplustree_map_inner_insert(map, path, D_RO(map)->height, sep,
+		right.oid);
+
+	return key < sep ? leaf : right;
+}
+
+/*
+ * bplustree_map_is_empty -- checks whether the tree map is empty
+ */
+int
+bplustree_map_is_empty(PMEMobjpool *pop, TOID(struct bplustree_map) map)
+{
+	return OID_IS_NULL(D_RO(map)->root);
+}
+
+/*
+ * bplustree_map_insert -- inserts a new key-value pair into the map,
+ *	replacing the value of an existing key
+ */
+int
+bplustree_map_insert(PMEMobjpool *pop, TOID(struct bplustree_map) map,
+	uint64_t key, PMEMoid value)
+{
+	int ret = 0;
+
+	TX_BEGIN(pop) {
+		if (bplustree_map_is_empty(pop, map)) {
+			TOID(struct bplustree_leaf) leaf =
+				TX_ZNEW(struct bplustree_leaf);
+
+			TX_ADD(map);
+			D_RW(map)->root = leaf.oid;
+			D_RW(map)->height = 0;
+		}
+
+		struct bplustree_path path;
+		TOID(struct bplustree_leaf) leaf =
+			bplustree_map_find_leaf(map, key, &path);
+
+		int slot = bplustree_map_leaf_find(D_RO(leaf), key);
+		if (slot >= 0) {
+			TX_ADD_FIELD(leaf, values[slot]);
+			D_RW(leaf)->values[slot] = value;
+		} else {
+			if (D_RO(leaf)->n == BPLUSTREE_LEAF_MAX) {
+				if (D_RO(map)->height == BPLUSTREE_MAX_HEIGHT)
+					pmemobj_tx_abort(ENOMEM);
+
+				leaf = bplustree_map_split_leaf(map, &path,
+					key);
+			}
+
+			bplustree_map_leaf_append(pop, leaf, key, value);
+		}
+	} TX_ONABORT {
+		ret = 1;
+	} TX_END
+
+	return ret;
+}
+
+/*
+ * bplustree_map_prev_leaf -- (internal) returns the left neighbour of the
+ *	leaf at the end of the path
+ */
+static TOID(struct bplustree_leaf)
+bplustree_map_prev_leaf(TOID(struct bplustree_map) map,
+	struct bplustree_path *path)
+{
+	uint64_t height = D_RO(map)->height;
+	uint64_t level = height;
+
+	/* find the lowest node where the path did not take the first child */
+	while (level > 0 && path->idx[level - 1] == 0)
+		--level;
+
+	if (level == 0)
+		return TOID_NULL(struct bplustree_leaf);
+
+	const struct bplustree_inner *in = D_RO(path->nodes[level - 1]);
+	PMEMoid node = in->children[path->idx[level - 1] - 1];
+
+	/* and the rightmost leaf of the subtree to the left of the path */
+	for (; level < height; ++level) {
+		TOID(struct bplustree_inner) inner;
+		TOID_ASSIGN(inner, node);
+		node = D_RO(inner)->children[D_RO(inner)->n];
+	}
+
+	TOID(struct bplustree_leaf) leaf;
+	TOID_ASSIGN(leaf, node);
+
+	return leaf;
+}
+
+/*
+ * bplustree_map_inner_remove -- (internal) removes the child taken by the
+ *	path from the inner node at the given level
+ */
+static void
+bplustree_map_inner_remove(TOID(struct bplustree_map) map,
+	struct bplustree_path *path, uint64_t level)
+{
+	if (level == 0) {
+		/* the last leaf is gone */
+		TX_ADD(map);
+		D_RW(map)->root = OID_NULL;
+		D_RW(map)->height = 0;
+		return;
+	}
+
+	TOID(struct bplustree_inner) node = path->nodes[level - 1];
+	uint64_t p = path->idx[level - 1];
+	uint64_t n = D_RO(node)->n;
+
+	if (n == 0) {
+		/* the only child is gone */
+		TX_FREE(node);
+		bplustree_map_inner_remove(map, path, level - 1);
+		return;
+	}
+
+	TX_ADD(node);
+	struct bplustree_inner *in = D_RW(node);
+
+	/* the separator to the left of the child, if any, goes with it */
+	uint64_t k = p == 0 ? 0 : p - 1;
+	memmove(&in->keys[k], &in->keys[k + 1],
+		sizeof(in->keys[0]) * (n - k - 1));
+	memmove(&in->children[p], &in->children[p + 1],
+		sizeof(in->children[0]) * (n - p));
+	in->keys[n - 1] = 0;
+	in->children[n] = OID_NULL;
+	in->n = n - 1;
+}
+
+/*
+ * bplustree_map_shrink -- (internal) replaces the root with its only child
+ *	while there is one
+ */
+static void
+bplustree_map_shrink(TOID(struct bplustree_map) map)
+{
+	while (D_RO(map)->height != 0) {
+		TOID(struct bplustree_inner) root;
+		TOID_ASSIGN(root, D_RO(map)->root);
+
+		if (D_RO(root)->n != 0)
+			break;
+
+		TX_ADD(map);
+		D_RW(map)->root = D_RO(root)->children[0];
+		D_RW(map)->height -= 1;
+		TX_FREE(root);
+	}
+}
+
+/*
+ * bplustree_map_remove -- removes key-value pair from the map
+ */
+PMEMoid
+bplustree_map_remove(PMEMobjpool *pop, TOID(struct bplustree_map) map,
+		uint64_t key)
+{
+	PMEMoid ret = OID_NULL;
+
+	if (bplustree_map_is_empty(pop, map))
+		return ret;
+
+	TX_BEGIN(pop) {
+		struct bplustree_path path;
+		TOID(struct bplustree_leaf) leaf =
+			bplustree_map_find_leaf(map, key, &path);
+
+		int slot = bplustree_map_leaf_find(D_RO(leaf), key);
+		if (slot >= 0) {
+			ret = D_RO(leaf)->values[slot];
+
+			if (D_RO(leaf)->n > 1) {
+				bplustree_map_leaf_remove(leaf, slot);
+			} else {
+				TOID(struct bplustree_leaf) prev =
+					bplustree_map_prev_leaf(map, &path);
+				if (!TOID_IS_NULL(prev)) {
+					TX_ADD_FIELD(prev, next);
+					D_RW(prev)->next = D_RO(leaf)->next;
+				}
+
+				TX_FREE(leaf);
+				bplustree_map_inner_remove(map, &path,
+					D_RO(map)->height);
+				bplustree_map_shrink(map);
+			}
+		}
+	} TX_END
+
+	return ret;
+}
+
+/*
+ * bplustree_map_get -- searches for a value of the key
+ */
+PMEMoid
+bplustree_map_get(PMEMobjpool *pop, TOID(struct bplustree_map) map,
+		uint64_t key)
+{
+	if (bplustree_map_is_empty(pop, map))
+		return OID_NULL;
+
+	TOID(struct bplustree_leaf) leaf =
+		bplustree_map_find_leaf(map, key, NULL);
+
+	int slot = bplustree_map_leaf_find(D_RO(leaf), key);
+
+	return slot < 0 ? OID_NULL : D_RO(leaf)->values[slot];
+}
+
+/*
+ * bplustree_map_lookup -- searches if key exists
+ */
+int
+bplustree_map_lookup(PMEMobjpool *pop, TOID(struct bplustree_map) map,
+		uint64_t key)
+{
+	if (bplustree_map_is_empty(pop, map))
+		return 0;
+
+	TOID(struct bplustree_leaf) leaf =
+		bplustree_map_find_leaf(map, key, NULL);
+
+	return bplustree_map_leaf_find(D_RO(leaf), key) >= 0;
+}
+
+/*
+ * bplustree_map_range -- calls the callback for every key in [start, end]
+ *	in ascending key order, until the callback returns a non-zero value
+ */
+int
+bplustree_map_range(PMEMobjpool *pop, TOID(struct bplustree_map) map,
+	uint64_t start, uint64_t end,
+	int (*cb)(uint64_t key, PMEMoid value, void *arg), void *arg)
+{
+	if (bplustree_map_is_empty(pop, map) || start > end)
+		return 0;
+
+	TOID(struct bplustree_leaf) leaf =
+		bplustree_map_find_leaf(map, start, NULL);
+
+	while (!TOID_IS_NULL(leaf)) {
+		const struct bplustree_leaf *l = D_RO(leaf);
+		uint8_t slots[BPLUSTREE_LEAF_MAX];
+		uint32_t n = 0;
+		int past_end = 0;
+
+		for (uint32_t i = 0; i < l->n; ++i) {
+			if (l->keys[i] > end)
+				past_end = 1;
+			else if (l->keys[i] >= start)
+				slots[n++] = (uint8_t)i;
+		}
+
+		bplustree_map_sort(l, slots, n);
+
+		for (uint32_t i = 0; i < n; ++i) {
+			if (cb(l->keys[slots[i]], l->values[slots[i]], arg))
+				return 1;
+		}
+
+		/* the keys in the following leaves are even greater */
+		if (past_end)
+			break;
+
+		leaf = l->next;
+	}
+
+	return 0;
+}
+
+/*
+ * bplustree_map_foreach -- calls the callback for every key in ascending
+ *	key order
+ */
+int
+bplustree_map_foreach(PMEMobjpool *pop, TOID(struct bplustree_map) map,
+	int (*cb)(uint64_t key, PMEMoid value, void *arg), void *arg)
+{
+	return bplustree_map_range(pop, map, 0, UINT64_MAX, cb, arg);
+}
+
+/*
+ * bplustree_map_count -- returns the number of key-value pairs in the map
+ */
+size_t
+bplustree_map_count(PMEMobjpool *pop, TOID(struct bplustree_map) map)
+{
+	if (bplustree_map_is_empty(pop, map))
+		return 0;
+
+	size_t count = 0;
+	TOID(struct bplustree_leaf) leaf =
+		bplustree_map_find_leaf(map, 0, NULL);
+
+	for (; !TOID_IS_NULL(leaf); leaf = D_RO(leaf)->next)
+		count += D_RO(leaf)->n;
+
+	return count;
+}
+
+/*
+ * bplustree_map_check -- check if given persistent object is a tree map
+ */
+int
+bplustree_map_check(PMEMobjpool *pop, TOID(struct bplustree_map) map)
+{
+	return TOID_IS_NULL(map) || !TOID_VALID(map);
+}
+
+/*
+ * bplustree_map_insert_new -- allocates a new object and inserts it into
+ *	the tree
+ */
+int
+bplustree_map_insert_new(PMEMobjpool *pop, TOID(struct bplustree_map) map,
+		uint64_t key, size_t size, unsigned type_num,
+		void (*constructor)(PMEMobjpool *pop, void *ptr, void *arg),
+		void *arg)
+{
+	int ret = 0;
+
+	TX_BEGIN(pop) {
+		PMEMoid n = pmemobj_tx_alloc(size, type_num);
+		constructor(pop, pmemobj_direct(n), arg);
+		bplustree_map_insert(pop, map, key, n);
+	} TX_ONABORT {
+		ret = 1;
+	} TX_END
+
+	return ret;
+}
+
+/*
+ * bplustree_map_remove_free -- removes and frees an object from the tree
+ */
+int
+bplustree_map_remove_free(PMEMobjpool *pop, TOID(struct bplustree_map) map,
+		uint64_t key)
+{
+	int ret = 0;
+
+	TX_BEGIN(pop) {
+		PMEMoid val = bplustree_map_remove(pop, map, key);
+		pmemobj_tx_free(val);
+	} TX_ONABORT {
+		ret = 1;
+	} TX_END
+
+	return ret;
+}
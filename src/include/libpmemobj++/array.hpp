@@ -0,0 +1,462 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Persistent memory resident fixed-size array.
+ */
+
+#ifndef PMEMOBJ_ARRAY_HPP
+#define PMEMOBJ_ARRAY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+
+#include "libpmemobj++/detail/common.hpp"
+
+namespace nvml
+{
+
+namespace obj
+{
+
+/**
+ * Persistent memory resident fixed-size array.
+ *
+ * The array is an aggregate with the same layout as a plain C array,
+ * so it can be used in place of `T[N]` members of persistent objects.
+ * Unlike a plain array of p<> properties, which adds each modified
+ * element to the transaction separately, the bulk operations (fill(),
+ * swap(), data(), begin(), range()) add all the affected elements to the
+ * active transaction as one contiguous range.
+ *
+ * Single element access (operator[], at(), front(), back()) adds only
+ * the accessed element to the transaction. The const variants and
+ * cdata() have no transactional side effects. Outside of a transaction
+ * the modifications are not made durable automatically.
+ */
+template <typename T, std::size_t N>
+struct array {
+	static_assert(N > 0, "zero-sized persistent array");
+
+	typedef T value_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef value_type &reference;
+	typedef const value_type &const_reference;
+	typedef value_type *pointer;
+	typedef const value_type *const_pointer;
+	typedef pointer iterator;
+	typedef const_pointer const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	/**
+	 * Access element at a specific index with bounds checking.
+	 *
+	 * The element is added to the active transaction.
+	 *
+	 * @throw std::out_of_range if `n` is out of bounds.
+	 * @throw transaction_error when adding the element to the
+	 *	transaction failed.
+	 */
+	reference
+	at(size_type n)
+	{
+		if (n >= N)
+			throw std::out_of_range("array::at");
+
+		detail::conditional_add_to_tx(_data + n);
+
+		return _data[n];
+	}
+
+	/**
+	 * Access element at a specific index with bounds checking.
+	 *
+	 * @throw std::out_of_range if `n` is out of bounds.
+	 */
+	const_reference
+	at(size_type n) const
+	{
+		if (n >= N)
+			throw std::out_of_range("array::at");
+
+		return _data[n];
+	}
+
+	/**
+	 * Access element at a specific index.
+	 *
+	 * The element is added to the active transaction.
+	 *
+	 * @throw transaction_error when adding the element to the
+	 *	transaction failed.
+	 */
+	reference operator[](size_type n)
+	{
+		detail::conditional_add_to_tx(_data + n);
+
+		return _data[n];
+	}
+
+	/**
+	 * Access element at a specific index.
+	 */
+	const_reference operator[](size_type n) const
+	{
+		return _data[n];
+	}
+
+	/**
+	 * Access the first element, which is added to the transaction.
+	 */
+	reference
+	front()
+	{
+		return (*this)[0];
+	}
+
+	/**
+	 * Access the first element.
+	 */
+	const_reference
+	front() const
+	{
+		return _data[0];
+	}
+
+	/**
+	 * Access the last element, which is added to the transaction.
+	 */
+	reference
+	back()
+	{
+		return (*this)[N - 1];
+	}
+
+	/**
+	 * Access the last element.
+	 */
+	const_reference
+	back() const
+	{
+		return _data[N - 1];
+	}
+
+	/**
+	 * Returns a pointer to the underlying storage.
+	 *
+	 * All elements are added to the active transaction as one range.
+	 *
+	 * @throw transaction_error when adding the elements to the
+	 *	transaction failed.
+	 */
+	pointer
+	data()
+	{
+		detail::conditional_add_range_to_tx(_data, sizeof(_data));
+
+		return _data;
+	}
+
+	/**
+	 * Returns a const pointer to the underlying storage.
+	 */
+	const_pointer
+	data() const noexcept
+	{
+		return _data;
+	}
+
+	/**
+	 * Returns a const pointer to the underlying storage, regardless of
+	 * the constness of the array.
+	 */
+	const_pointer
+	cdata() const noexcept
+	{
+		return _data;
+	}
+
+	/**
+	 * Returns a pointer to a modifiable range of elements.
+	 *
+	 * Only the `n` elements starting at `start` are added to the active
+	 * transaction, as one range.
+	 *
+	 * @throw std::out_of_range if the range is out of bounds.
+	 * @throw transaction_error when adding the elements to the
+	 *	transaction failed.
+	 */
+	pointer
+	range(size_type start, size_type n)
+	{
+		if (start > N || n > N - start)
+			throw std::out_of_range("array::range");
+
+		detail::conditional_add_range_to_tx(_data + start,
+						    sizeof(T) * n);
+
+		return _data + start;
+	}
+
+	/**
+	 * Returns an iterator to the beginning.
+	 *
+	 * All elements are added to the active transaction as one range.
+	 */
+	iterator
+	begin()
+	{
+		return data();
+	}
+
+	/**
+	 * Returns an iterator to the end.
+	 *
+	 * All elements are added to the active transaction as one range.
+	 */
+	iterator
+	end()
+	{
+		return data() + N;
+	}
+
+	/**
+	 * Returns a const iterator to the beginning.
+	 */
+	const_iterator
+	begin() const noexcept
+	{
+		return _data;
+	}
+
+	/**
+	 * Returns a const iterator to the end.
+	 */
+	const_iterator
+	end() const noexcept
+	{
+		return _data + N;
+	}
+
+	/**
+	 * Returns a const iterator to the beginning.
+	 */
+	const_iterator
+	cbegin() const noexcept
+	{
+		return _data;
+	}
+
+	/**
+	 * Returns a const iterator to the end.
+	 */
+	const_iterator
+	cend() const noexcept
+	{
+		return _data + N;
+	}
+
+	/**
+	 * Returns a reverse iterator to the beginning.
+	 */
+	reverse_iterator
+	rbegin()
+	{
+		return reverse_iterator(end());
+	}
+
+	/**
+	 * Returns a reverse iterator to the end.
+	 */
+	reverse_iterator
+	rend()
+	{
+		return reverse_iterator(begin());
+	}
+
+	/**
+	 * Returns a const reverse iterator to the beginning.
+	 */
+	const_reverse_iterator
+	crbegin() const noexcept
+	{
+		return const_reverse_iterator(cend());
+	}
+
+	/**
+	 * Returns a const reverse iterator to the end.
+	 */
+	const_reverse_iterator
+	crend() const noexcept
+	{
+		return const_reverse_iterator(cbegin());
+	}
+
+	/**
+	 * Checks whether the array is empty, which is never the case.
+	 */
+	constexpr bool
+	empty() const noexcept
+	{
+		return false;
+	}
+
+	/**
+	 * Returns the number of elements.
+	 */
+	constexpr size_type
+	size() const noexcept
+	{
+		return N;
+	}
+
+	/**
+	 * Returns the maximum number of elements.
+	 */
+	constexpr size_type
+	max_size() const noexcept
+	{
+		return N;
+	}
+
+	/**
+	 * Assigns `value` to all elements.
+	 *
+	 * The elements are added to the active transaction as one range.
+	 */
+	void
+	fill(const_reference value)
+	{
+		std::fill(begin(), end(), value);
+	}
+
+	/**
+	 * Exchanges the contents with `other`.
+	 *
+	 * Both arrays are added to the active transaction as one range
+	 * each.
+	 */
+	void
+	swap(array &other)
+	{
+		std::swap_ranges(begin(), end(), other.begin());
+	}
+
+	/*
+	 * The elements, public to keep the class an aggregate.
+	 */
+	T _data[N];
+};
+
+/**
+ * Equality operator.
+ */
+template <typename T, std::size_t N>
+inline bool
+operator==(const array<T, N> &lhs, const array<T, N> &rhs)
+{
+	return std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin());
+}
+
+/**
+ * Inequality operator.
+ */
+template <typename T, std::size_t N>
+inline bool
+operator!=(const array<T, N> &lhs, const array<T, N> &rhs)
+{
+	return !(lhs == rhs);
+}
+
+/**
+ * Less than operator, compares the arrays lexicographically.
+ */
+template <typename T, std::size_t N>
+inline bool
+operator<(const array<T, N> &lhs, const array<T, N> &rhs)
+{
+	return std::lexicographical_compare(lhs.cbegin(), lhs.cend(),
+					    rhs.cbegin(), rhs.cend());
+}
+
+/**
+ * Less or equal operator.
+ */
+template <typename T, std::size_t N>
+inline bool
+operator<=(const array<T, N> &lhs, const array<T, N> &rhs)
+{
+	return !(rhs < lhs);
+}
+
+/**
+ * Greater than operator.
+ */
+template <typename T, std::size_t N>
+inline bool
+operator>(const array<T, N> &lhs, const array<T, N> &rhs)
+{
+	return rhs < lhs;
+}
+
+/**
+ * Greater or equal operator.
+ */
+template <typename T, std::size_t N>
+inline bool
+operator>=(const array<T, N> &lhs, const array<T, N> &rhs)
+{
+	return !(lhs < rhs);
+}
+
+/**
+ * Swaps the contents of two arrays.
+ *
+ * Non-member swap function as required by Swappable concept.
+ */
+template <typename T, std::size_t N>
+inline void
+swap(array<T, N> &lhs, array<T, N> &rhs)
+{
+	lhs.swap(rhs);
+}
+
+} /* namespace obj */
+
+} /* namespace nvml */
+
+#endif /* PMEMOBJ_ARRAY_HPP */
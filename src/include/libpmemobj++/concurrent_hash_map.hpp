@@ -0,0 +1,903 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Persistent memory resident concurrent hash map.
+ */
+
+#ifndef PMEMOBJ_CONCURRENT_HASH_MAP_HPP
+#define PMEMOBJ_CONCURRENT_HASH_MAP_HPP
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+#include "libpmemobj++/detail/common.hpp"
+#include "libpmemobj++/detail/pexceptions.hpp"
+#include "libpmemobj++/make_persistent.hpp"
+#include "libpmemobj++/mutex.hpp"
+#include "libpmemobj++/persistent_ptr.hpp"
+#include "libpmemobj++/pool.hpp"
+#include "libpmemobj++/shared_mutex.hpp"
+#include "libpmemobj++/transaction.hpp"
+#include "libpmemobj/tx_base.h"
+
+namespace nvml
+{
+
+namespace obj
+{
+
+/**
+ * Persistent memory resident concurrent hash map.
+ *
+ * The map is a linear hashing table: it starts with a single segment
+ * of buckets and grows one bucket at a time. When an insert finds the
+ * table overloaded, it splits the next bucket in line, moving only the
+ * elements of that bucket, so the cost of rehashing is spread over
+ * the operations instead of rebuilding the whole table at once. The
+ * buckets live in segments of doubling size, which are never moved.
+ *
+ * Concurrency control uses lock striping. A key is always protected by
+ * the same persistent shared_mutex, chosen by the low bits of its hash,
+ * no matter how many buckets the table has -- a bucket and the bucket
+ * it is split into always share a stripe. Lookups take the stripe lock
+ * for reading and modifiers take it for writing, as a transaction lock,
+ * so inside an outer transaction the lock is held until it ends.
+ *
+ * All the locks are persistent locks, which are reinitialized lazily
+ * on their first use after the pool is opened, so reopening a pool
+ * does not require walking the map. A zeroed map is a valid empty map.
+ *
+ * The map does not shrink. `Hash` and `KeyEqual` have to be stateless,
+ * and a thread must not hold an accessor while calling other methods
+ * of the map.
+ */
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+	  typename KeyEqual = std::equal_to<Key>>
+class concurrent_hash_map {
+	struct node;
+
+public:
+	typedef Key key_type;
+	typedef T mapped_type;
+	typedef std::pair<const Key, T> value_type;
+	typedef std::size_t size_type;
+	typedef Hash hasher;
+	typedef KeyEqual key_equal;
+
+	/**
+	 * Number of lock stripes.
+	 */
+	static const size_type NSTRIPES = 64;
+
+	/**
+	 * Number of buckets of the first segment.
+	 */
+	static const size_type INITIAL_BUCKETS = NSTRIPES;
+
+	/**
+	 * Average number of elements per bucket above which the table
+	 * grows.
+	 */
+	static const size_type MAX_LOAD_FACTOR = 2;
+
+	/**
+	 * Read-only access to an element of the map.
+	 *
+	 * Holds the lock of the element for reading until released or
+	 * destroyed. Inside a transaction the lock is held until the
+	 * transaction ends instead.
+	 */
+	class const_accessor {
+	public:
+		const_accessor()
+			: _mtx(nullptr), _node(nullptr), _exclusive(false)
+		{
+		}
+
+		~const_accessor()
+		{
+			release();
+		}
+
+		const_accessor(const const_accessor &) = delete;
+		const_accessor &operator=(const const_accessor &) = delete;
+
+		/**
+		 * Checks whether the accessor points to an element.
+		 */
+		bool
+		empty() const noexcept
+		{
+			return _node == nullptr;
+		}
+
+		/**
+		 * Releases the element and its lock.
+		 */
+		void
+		release()
+		{
+			if (_mtx != nullptr) {
+				if (_exclusive)
+					_mtx->unlock();
+				else
+					_mtx->unlock_shared();
+				_mtx = nullptr;
+			}
+
+			_node = nullptr;
+		}
+
+		const value_type &operator*() const
+		{
+			return _node->item;
+		}
+
+		const value_type *operator->() const
+		{
+			return &_node->item;
+		}
+
+	protected:
+		friend class concurrent_hash_map;
+
+		shared_mutex *_mtx;
+		node *_node;
+		bool _exclusive;
+	};
+
+	/**
+	 * Read-write access to an element of the map.
+	 *
+	 * Holds the lock of the element for writing. The element has to be
+	 * modified in a transaction, like any other persistent object.
+	 */
+	class accessor : public const_accessor {
+	public:
+		value_type &operator*() const
+		{
+			return this->_node->item;
+		}
+
+		value_type *operator->() const
+		{
+			return &this->_node->item;
+		}
+	};
+
+	/**
+	 * Default constructor, does not allocate.
+	 */
+	concurrent_hash_map() : _nbuckets(0)
+	{
+	}
+
+	concurrent_hash_map(const concurrent_hash_map &) = delete;
+	concurrent_hash_map &operator=(const concurrent_hash_map &) = delete;
+
+	/**
+	 * Destructor, frees all the elements and buckets.
+	 *
+	 * Must not be called concurrently with other methods.
+	 */
+	~concurrent_hash_map()
+	{
+		if (_nbuckets.load(std::memory_order_acquire) == 0)
+			return;
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			free_nodes();
+
+			for (size_type i = 0; i < NSEGMENTS; ++i) {
+				if (_segments[i] == nullptr)
+					continue;
+
+				if (pmemobj_tx_free(*_segments[i].raw_ptr()))
+					throw transaction_free_error(
+						"failed to delete persistent "
+						"hash map segment");
+				_segments[i] = nullptr;
+			}
+
+			store_tx(_nbuckets, 0);
+		});
+	}
+
+	/**
+	 * Inserts `key` mapped to a copy of `value` if not present.
+	 *
+	 * @return true if the element was inserted, false if the key was
+	 *	already present.
+	 *
+	 * @throw pool_error if the map is not in persistent memory.
+	 * @throw transaction_alloc_error when the allocation failed.
+	 */
+	bool
+	insert(const Key &key, const T &value)
+	{
+		return internal_insert(key, value, false);
+	}
+
+	/**
+	 * Inserts `value` if its key is not present.
+	 *
+	 * @return true if the element was inserted.
+	 */
+	bool
+	insert(const value_type &value)
+	{
+		return insert(value.first, value.second);
+	}
+
+	/**
+	 * Inserts `key` mapped to a copy of `value`, or assigns `value` to
+	 * the element already mapped to `key`.
+	 *
+	 * @return true if the element was inserted, false if it was
+	 *	assigned.
+	 */
+	bool
+	insert_or_assign(const Key &key, const T &value)
+	{
+		return internal_insert(key, value, true);
+	}
+
+	/**
+	 * Looks up `key`, inserting it with a value-initialized mapped value
+	 * if not present, and grants write access to the element.
+	 *
+	 * @return true if the element was inserted.
+	 */
+	bool
+	insert(accessor &acc, const Key &key)
+	{
+		acc.release();
+
+		size_type h = hasher()(key);
+		maybe_grow(h);
+
+		stripe &s = stripe_of(h);
+		pool_base pb = get_pool();
+		bool inserted = false;
+
+		acquire(acc, s.mtx, true);
+		try {
+			transaction::exec_tx(pb, [&] {
+				acc._node = insert_locked(h, key, nullptr,
+							  false, inserted);
+			});
+		} catch (...) {
+			acc.release();
+			throw;
+		}
+
+		return inserted;
+	}
+
+	/**
+	 * Looks up `key` and grants read access to the element.
+	 *
+	 * @return true if the key was found.
+	 */
+	bool
+	find(const_accessor &acc, const Key &key) const
+	{
+		return internal_find(acc, key, false);
+	}
+
+	/**
+	 * Looks up `key` and grants write access to the element.
+	 *
+	 * @return true if the key was found.
+	 */
+	bool
+	find(accessor &acc, const Key &key)
+	{
+		return internal_find(acc, key, true);
+	}
+
+	/**
+	 * Returns the number of elements mapped to `key`, 0 or 1.
+	 */
+	size_type
+	count(const Key &key) const
+	{
+		const_accessor acc;
+
+		return find(acc, key) ? 1 : 0;
+	}
+
+	/**
+	 * Removes the element mapped to `key`.
+	 *
+	 * @return true if the element was removed.
+	 */
+	bool
+	erase(const Key &key)
+	{
+		if (_nbuckets.load(std::memory_order_acquire) == 0)
+			return false;
+
+		size_type h = hasher()(key);
+		stripe &s = stripe_of(h);
+		pool_base pb = get_pool();
+		bool erased = false;
+
+		transaction::exec_tx(pb,
+				     [&] {
+					     erased = erase_locked(h, key, s);
+				     },
+				     s.mtx);
+
+		return erased;
+	}
+
+	/**
+	 * Removes all the elements. The buckets are kept.
+	 *
+	 * Takes all the locks of the map, in a fixed order.
+	 */
+	void
+	clear()
+	{
+		if (_nbuckets.load(std::memory_order_acquire) == 0)
+			return;
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			lock_all();
+			free_nodes();
+		});
+	}
+
+	/**
+	 * Returns the number of elements.
+	 *
+	 * The value is exact only if the map is not modified concurrently.
+	 */
+	size_type
+	size() const noexcept
+	{
+		size_type sz = 0;
+		for (size_type i = 0; i < NSTRIPES; ++i)
+			sz += _stripes[i].count.load(std::memory_order_relaxed);
+
+		return sz;
+	}
+
+	/**
+	 * Checks whether the map is empty.
+	 */
+	bool
+	empty() const noexcept
+	{
+		return size() == 0;
+	}
+
+	/**
+	 * Returns the current number of buckets.
+	 */
+	size_type
+	bucket_count() const noexcept
+	{
+		return _nbuckets.load(std::memory_order_acquire);
+	}
+
+private:
+	/*
+	 * Number of bucket segments, the segment k > 0 holds
+	 * INITIAL_BUCKETS << (k - 1) buckets.
+	 */
+	static const size_type NSEGMENTS = 48;
+
+	struct node {
+		node(size_type h, const Key &key, const T &value)
+			: next(nullptr), hash(h), item(key, value)
+		{
+		}
+
+		node(size_type h, const Key &key)
+			: next(nullptr), hash(h), item(key, T())
+		{
+		}
+
+		persistent_ptr<node> next;
+		const size_type hash;
+		value_type item;
+	};
+
+	typedef persistent_ptr<node> bucket_type;
+
+	/*
+	 * A lock stripe. The element count is kept per stripe, so that
+	 * inserts do not contend on a single counter.
+	 */
+	struct stripe {
+		stripe() : count(0)
+		{
+		}
+
+		shared_mutex mtx;
+		std::atomic<size_type> count;
+	};
+
+	/*
+	 * Returns the pool the map resides in.
+	 */
+	pool_base
+	get_pool() const
+	{
+		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		if (pop == nullptr)
+			throw pool_error("hash map is not in persistent "
+					 "memory");
+
+		return pool_base(pop);
+	}
+
+	/*
+	 * Transactionally stores `v` in `a`. The atomic store lets the
+	 * readers of other stripes read the value without locking.
+	 */
+	static void
+	store_tx(std::atomic<size_type> &a, size_type v)
+	{
+		detail::conditional_add_to_tx(&a);
+		a.store(v, std::memory_order_release);
+	}
+
+	/*
+	 * Adds a lock to the active transaction, it is held until the
+	 * outermost transaction ends.
+	 */
+	template <typename L>
+	static void
+	tx_lock(L &l)
+	{
+		if (pmemobj_tx_lock(l.lock_type(), l.native_handle()))
+			throw transaction_error("failed to add a lock to the"
+						" transaction");
+	}
+
+	/*
+	 * Returns floor(log2(v)) for v > 0.
+	 */
+	static unsigned
+	log2_floor(size_type v) noexcept
+	{
+		unsigned r = 0;
+		for (unsigned sh = sizeof(size_type) * 4; sh > 0; sh >>= 1) {
+			if (v >> sh) {
+				v >>= sh;
+				r += sh;
+			}
+		}
+
+		return r;
+	}
+
+	/*
+	 * Returns the segment holding bucket `idx`.
+	 */
+	static size_type
+	segment_of(size_type idx) noexcept
+	{
+		if (idx < INITIAL_BUCKETS)
+			return 0;
+
+		return log2_floor(idx) - log2_floor(INITIAL_BUCKETS) + 1;
+	}
+
+	/*
+	 * Returns the index of the first bucket of segment `seg`.
+	 */
+	static size_type
+	segment_base(size_type seg) noexcept
+	{
+		return seg == 0 ? 0 : INITIAL_BUCKETS << (seg - 1);
+	}
+
+	/*
+	 * Returns the number of buckets of segment `seg`.
+	 */
+	static size_type
+	segment_size(size_type seg) noexcept
+	{
+		return seg == 0 ? INITIAL_BUCKETS
+				: INITIAL_BUCKETS << (seg - 1);
+	}
+
+	/*
+	 * Maps a hash to a bucket of a table of `n` buckets.
+	 *
+	 * The buckets below `n` - `m` have already been split, where `m` is
+	 * the largest power of two not greater than `n`, so they are
+	 * addressed with one more bit of the hash.
+	 */
+	static size_type
+	bucket_index(size_type h, size_type n) noexcept
+	{
+		size_type m = size_type(1) << log2_floor(n);
+		size_type idx = h & (2 * m - 1);
+
+		return idx < n ? idx : h & (m - 1);
+	}
+
+	bucket_type &
+	bucket_at(size_type idx)
+	{
+		size_type seg = segment_of(idx);
+
+		return _segments[seg].get()[idx - segment_base(seg)];
+	}
+
+	/*
+	 * The stripe of a hash does not depend on the number of buckets,
+	 * as all the segment sizes are multiples of NSTRIPES.
+	 */
+	stripe &
+	stripe_of(size_type h) const
+	{
+		return _stripes[h & (NSTRIPES - 1)];
+	}
+
+	/*
+	 * Locks `mtx` on behalf of the accessor. Inside a transaction the
+	 * lock is added to the transaction, always for writing.
+	 */
+	static void
+	acquire(const_accessor &acc, shared_mutex &mtx, bool exclusive)
+	{
+		if (pmemobj_tx_stage() == TX_STAGE_WORK) {
+			tx_lock(mtx);
+			return;
+		}
+
+		if (exclusive)
+			mtx.lock();
+		else
+			mtx.lock_shared();
+
+		acc._mtx = &mtx;
+		acc._exclusive = exclusive;
+	}
+
+	/*
+	 * Looks up the node of `key` with the stripe lock held.
+	 */
+	node *
+	search(size_type h, const Key &key)
+	{
+		size_type n = _nbuckets.load(std::memory_order_acquire);
+		if (n == 0)
+			return nullptr;
+
+		node *cur = bucket_at(bucket_index(h, n)).get();
+		for (; cur != nullptr; cur = cur->next.get()) {
+			if (cur->hash == h && key_equal()(cur->item.first, key))
+				return cur;
+		}
+
+		return nullptr;
+	}
+
+	bool
+	internal_find(const_accessor &acc, const Key &key, bool exclusive) const
+	{
+		acc.release();
+
+		if (_nbuckets.load(std::memory_order_acquire) == 0)
+			return false;
+
+		size_type h = hasher()(key);
+		acquire(acc, stripe_of(h).mtx, exclusive);
+
+		acc._node = const_cast<concurrent_hash_map *>(this)->search(
+			h, key);
+		if (acc._node == nullptr) {
+			acc.release();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool
+	internal_insert(const Key &key, const T &value, bool assign)
+	{
+		size_type h = hasher()(key);
+		maybe_grow(h);
+
+		stripe &s = stripe_of(h);
+		pool_base pb = get_pool();
+		bool inserted = false;
+
+		transaction::exec_tx(pb,
+				     [&] {
+					     insert_locked(h, key, &value,
+							   assign, inserted);
+				     },
+				     s.mtx);
+
+		return inserted;
+	}
+
+	/*
+	 * Inserts a new node at the head of the bucket of `key` with the
+	 * stripe lock held, or returns the existing one.
+	 */
+	node *
+	insert_locked(size_type h, const Key &key, const T *value,
+		      bool assign, bool &inserted)
+	{
+		node *cur = search(h, key);
+		if (cur != nullptr) {
+			if (assign)
+				cur->item.second = *value;
+			inserted = false;
+			return cur;
+		}
+
+		persistent_ptr<node> nn = value != nullptr
+			? make_persistent<node>(h, key, *value)
+			: make_persistent<node>(h, key);
+
+		size_type n = _nbuckets.load(std::memory_order_acquire);
+		bucket_type &b = bucket_at(bucket_index(h, n));
+		nn->next = b;
+		b = nn;
+
+		stripe &s = stripe_of(h);
+		store_tx(s.count, s.count.load(std::memory_order_relaxed) + 1);
+
+		inserted = true;
+		return nn.get();
+	}
+
+	bool
+	erase_locked(size_type h, const Key &key, stripe &s)
+	{
+		size_type n = _nbuckets.load(std::memory_order_acquire);
+		bucket_type *link = &bucket_at(bucket_index(h, n));
+
+		for (; *link != nullptr; link = &(*link)->next) {
+			node *cur = link->get();
+			if (cur->hash != h ||
+			    !key_equal()(cur->item.first, key))
+				continue;
+
+			persistent_ptr<node> victim = *link;
+			*link = cur->next;
+			delete_persistent<node>(victim);
+
+			store_tx(s.count,
+				 s.count.load(std::memory_order_relaxed) - 1);
+			return true;
+		}
+
+		return false;
+	}
+
+	/*
+	 * Allocates a segment of `count` empty buckets.
+	 */
+	static persistent_ptr<bucket_type[]>
+	alloc_segment(size_type count)
+	{
+		persistent_ptr<bucket_type[]> seg = pmemobj_tx_zalloc(
+			sizeof(bucket_type) * count,
+			detail::type_num<bucket_type>());
+
+		if (seg == nullptr)
+			throw transaction_alloc_error("failed to allocate "
+						      "persistent hash map "
+						      "segment");
+
+		return seg;
+	}
+
+	/*
+	 * Takes all the locks of the map for the active transaction.
+	 */
+	void
+	lock_all()
+	{
+		tx_lock(_resize_mutex);
+		for (size_type i = 0; i < NSTRIPES; ++i)
+			tx_lock(_stripes[i].mtx);
+	}
+
+	/*
+	 * Frees all the nodes, with all the locks held.
+	 */
+	void
+	free_nodes()
+	{
+		size_type n = _nbuckets.load(std::memory_order_acquire);
+
+		for (size_type i = 0; i < n; ++i) {
+			bucket_type &b = bucket_at(i);
+			if (b == nullptr)
+				continue;
+
+			persistent_ptr<node> cur = b;
+			while (cur != nullptr) {
+				persistent_ptr<node> next = cur->next;
+				delete_persistent<node>(cur);
+				cur = next;
+			}
+
+			b = nullptr;
+		}
+
+		for (size_type i = 0; i < NSTRIPES; ++i)
+			store_tx(_stripes[i].count, 0);
+	}
+
+	/*
+	 * Allocates the first segment of a zeroed map. All the locks are
+	 * held until the transaction ends, so that no reader can see the
+	 * table before it is committed.
+	 */
+	void
+	init_table()
+	{
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			lock_all();
+
+			if (_nbuckets.load(std::memory_order_acquire) != 0)
+				return;
+
+			if (_segments[0] == nullptr)
+				_segments[0] = alloc_segment(INITIAL_BUCKETS);
+			store_tx(_nbuckets, INITIAL_BUCKETS);
+		});
+	}
+
+	/*
+	 * Grows the table by one bucket if the stripe of `h` suggests it is
+	 * overloaded.
+	 *
+	 * Splitting never blocks: if another thread is already growing the
+	 * table or the stripe of the bucket being split is busy, the split
+	 * is left for one of the following inserts. The table does not grow
+	 * inside an outer transaction, which would keep the new bucket
+	 * count visible to other threads before it is committed.
+	 */
+	void
+	maybe_grow(size_type h)
+	{
+		size_type n = _nbuckets.load(std::memory_order_acquire);
+		if (n == 0) {
+			init_table();
+			return;
+		}
+
+		if (pmemobj_tx_stage() == TX_STAGE_WORK)
+			return;
+
+		size_type cnt =
+			stripe_of(h).count.load(std::memory_order_relaxed);
+		if (cnt * NSTRIPES <= MAX_LOAD_FACTOR * n)
+			return;
+
+		if (!_resize_mutex.try_lock())
+			return;
+
+		std::unique_lock<mutex> resize_lock(_resize_mutex,
+						    std::adopt_lock);
+
+		split_bucket();
+	}
+
+	/*
+	 * Splits the next bucket in line, with the resize mutex held.
+	 */
+	void
+	split_bucket()
+	{
+		size_type n = _nbuckets.load(std::memory_order_acquire);
+		if (segment_of(n) >= NSEGMENTS)
+			return;
+
+		size_type m = size_type(1) << log2_floor(n);
+		size_type src = n - m;
+
+		shared_mutex &mtx = _stripes[src & (NSTRIPES - 1)].mtx;
+		if (!mtx.try_lock())
+			return;
+
+		std::unique_lock<shared_mutex> stripe_lock(mtx,
+							   std::adopt_lock);
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			size_type seg = segment_of(n);
+			if (_segments[seg] == nullptr)
+				_segments[seg] =
+					alloc_segment(segment_size(seg));
+
+			/* move the nodes which now map to the new bucket */
+			bucket_type *link = &bucket_at(src);
+			bucket_type *tail = &bucket_at(n);
+			size_type mask = 2 * m - 1;
+
+			while (*link != nullptr) {
+				node *cur = link->get();
+				if ((cur->hash & mask) != n) {
+					link = &cur->next;
+					continue;
+				}
+
+				*tail = *link;
+				*link = cur->next;
+				cur->next = nullptr;
+				tail = &cur->next;
+			}
+
+			store_tx(_nbuckets, n + 1);
+		});
+	}
+
+	mutable stripe _stripes[NSTRIPES];
+	persistent_ptr<bucket_type[]> _segments[NSEGMENTS];
+	std::atomic<size_type> _nbuckets;
+	mutex _resize_mutex;
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+const typename concurrent_hash_map<Key, T, Hash, KeyEqual>::size_type
+	concurrent_hash_map<Key, T, Hash, KeyEqual>::NSTRIPES;
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+const typename concurrent_hash_map<Key, T, Hash, KeyEqual>::size_type
+	concurrent_hash_map<Key, T, Hash, KeyEqual>::INITIAL_BUCKETS;
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+const typename concurrent_hash_map<Key, T, Hash, KeyEqual>::size_type
+	concurrent_hash_map<Key, T, Hash, KeyEqual>::MAX_LOAD_FACTOR;
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+const typename concurrent_hash_map<Key, T, Hash, KeyEqual>::size_type
+	concurrent_hash_map<Key, T, Hash, KeyEqual>::NSEGMENTS;
+
+} /* namespace obj */
+
+} /* namespace nvml */
+
+#endif /* PMEMOBJ_CONCURRENT_HASH_MAP_HPP */
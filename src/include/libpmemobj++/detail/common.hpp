@@ -40,6 +40,7 @@
 
 #include "libpmemobj++/detail/pexceptions.hpp"
 #include "libpmemobj/tx_base.h"
+#include <cstddef>
 #include <typeinfo>
 
 namespace nvml
@@ -54,6 +55,73 @@ class persistent_ptr;
 namespace detail
 {
 
+/*
+ * Range of memory already added to the current transaction.
+ *
+ * Set by transaction::snapshot_scope for its lifetime, so that the
+ * fields within the range are not added to the transaction one by one.
+ */
+struct tx_snapshot_range {
+	const char *begin;
+	const char *end;
+};
+
+/*
+ * Return the calling thread's snapshotted range.
+ */
+inline tx_snapshot_range &
+tx_snapshot() noexcept
+{
+	static thread_local tx_snapshot_range range;
+
+	return range;
+}
+
+/*
+ * Check whether `size` bytes starting at `ptr` are within the range
+ * already added to the current transaction.
+ */
+inline bool
+tx_snapshot_covers(const void *ptr, std::size_t size) noexcept
+{
+	const tx_snapshot_range &range = tx_snapshot();
+	const char *begin = static_cast<const char *>(ptr);
+
+	return begin >= range.begin && begin + size <= range.end;
+}
+
+/*
+ * Check whether `size` bytes starting at `ptr` have to be added to the
+ * current transaction before they are modified.
+ *
+ * Memory within a pool cannot be modified once the transaction has been
+ * aborted, e.g. by a nested transaction: the undo log has already been
+ * applied, so the modification would outlive the failed transaction.
+ *
+ * @throw transaction_error if the transaction has been aborted.
+ */
+inline bool
+tx_snapshot_needed(const void *ptr, std::size_t size)
+{
+	auto stage = pmemobj_tx_stage();
+
+	if (stage == TX_STAGE_WORK) {
+		if (tx_snapshot_covers(ptr, size))
+			return false;
+	} else if (stage != TX_STAGE_ONABORT) {
+		return false;
+	}
+
+	/* 'ptr' is not in any open pool */
+	if (!pmemobj_pool_by_ptr(ptr))
+		return false;
+
+	if (stage == TX_STAGE_ONABORT)
+		throw transaction_error("The transaction has been aborted.");
+
+	return true;
+}
+
 /*
  * Conditionally add an object to a transaction.
  *
@@ -66,11 +134,7 @@ template <typename T>
 inline void
 conditional_add_to_tx(const T *that)
 {
-	if (pmemobj_tx_stage() != TX_STAGE_WORK)
-		return;
-
-	/* 'that' is not in any open pool */
-	if (!pmemobj_pool_by_ptr(that))
+	if (!tx_snapshot_needed(that, sizeof(*that)))
 		return;
 
 	if (pmemobj_tx_add_range_direct(that, sizeof(*that)))
@@ -92,7 +156,12 @@ template <typename T>
 inline void
 conditional_add_to_tx(const obj::persistent_ptr<T> &that)
 {
-	if (pmemobj_tx_stage() != TX_STAGE_WORK)
+	auto stage = pmemobj_tx_stage();
+
+	if (stage == TX_STAGE_ONABORT)
+		throw transaction_error("The transaction has been aborted.");
+
+	if (stage != TX_STAGE_WORK)
 		return;
 
 	if (pmemobj_tx_add_range(that.raw(), 0, sizeof(T)))
@@ -100,6 +169,30 @@ conditional_add_to_tx(const obj::persistent_ptr<T> &that)
 					" transaction.");
 }
 
+/*
+ * Conditionally add a range of memory to a transaction.
+ *
+ * Adds `size` bytes starting at `ptr` to the transaction as a single
+ * undo log entry if the range is within a pmemobj pool and there is
+ * an active transaction. Does nothing otherwise.
+ *
+ * @param[in] ptr pointer to the beginning of the range.
+ * @param[in] size size of the range in bytes.
+ */
+inline void
+conditional_add_range_to_tx(const void *ptr, std::size_t size)
+{
+	if (size == 0)
+		return;
+
+	if (!tx_snapshot_needed(ptr, size))
+		return;
+
+	if (pmemobj_tx_add_range_direct(ptr, size))
+		throw transaction_error("Could not add a range to the"
+					" transaction.");
+}
+
 /*
  * Return type number for given type.
  */
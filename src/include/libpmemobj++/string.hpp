@@ -0,0 +1,1044 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Persistent memory resident string.
+ */
+
+#ifndef PMEMOBJ_STRING_HPP
+#define PMEMOBJ_STRING_HPP
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "libpmemobj++/detail/pexceptions.hpp"
+#include "libpmemobj++/pool.hpp"
+#include "libpmemobj++/transaction.hpp"
+#include "libpmemobj++/vector.hpp"
+
+namespace nvml
+{
+
+namespace obj
+{
+
+/**
+ * Persistent memory resident string.
+ *
+ * The characters, along with the terminating null character, are kept
+ * in a persistent vector, so the string has the same transactional
+ * properties: every modifier runs in its own (possibly nested)
+ * transaction, adds the modified characters to it as one contiguous
+ * range and grows the storage geometrically. A zeroed string is a valid
+ * empty string.
+ *
+ * Non-const character access (operator[], at(), data(), begin(), ...)
+ * adds the accessed characters to the active transaction, if there is
+ * one. c_str(), cdata() and the const variants have no transactional
+ * side effects.
+ */
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+class basic_string {
+public:
+	typedef Traits traits_type;
+	typedef CharT value_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef value_type &reference;
+	typedef const value_type &const_reference;
+	typedef value_type *pointer;
+	typedef const value_type *const_pointer;
+	typedef pointer iterator;
+	typedef const_pointer const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+	typedef std::basic_string<CharT, Traits> std_string_type;
+
+	/**
+	 * Special value meaning "until the end of the string".
+	 */
+	static const size_type npos = static_cast<size_type>(-1);
+
+	/**
+	 * Default constructor.
+	 *
+	 * Creates an empty string, does not allocate.
+	 */
+	basic_string() = default;
+
+	/**
+	 * Creates a string with `count` copies of `ch`.
+	 */
+	basic_string(size_type count, CharT ch)
+	{
+		assign(count, ch);
+	}
+
+	/**
+	 * Creates a string with the first `count` characters of `s`.
+	 */
+	basic_string(const CharT *s, size_type count)
+	{
+		assign(s, count);
+	}
+
+	/**
+	 * Creates a string from the null-terminated string `s`.
+	 */
+	basic_string(const CharT *s)
+	{
+		assign(s);
+	}
+
+	/**
+	 * Creates a string from a volatile std::basic_string.
+	 */
+	basic_string(const std_string_type &str)
+	{
+		assign(str);
+	}
+
+	/**
+	 * Copy constructor.
+	 */
+	basic_string(const basic_string &other)
+	{
+		assign(other);
+	}
+
+	/**
+	 * Move constructor, `other` is left empty.
+	 */
+	basic_string(basic_string &&other) : _data(std::move(other._data))
+	{
+	}
+
+	/**
+	 * Copy assignment operator.
+	 */
+	basic_string &
+	operator=(const basic_string &other)
+	{
+		return assign(other);
+	}
+
+	/**
+	 * Move assignment operator, `other` is left empty.
+	 */
+	basic_string &
+	operator=(basic_string &&other)
+	{
+		_data = std::move(other._data);
+
+		return *this;
+	}
+
+	/**
+	 * Assigns the null-terminated string `s`.
+	 */
+	basic_string &
+	operator=(const CharT *s)
+	{
+		return assign(s);
+	}
+
+	/**
+	 * Assigns a volatile std::basic_string.
+	 */
+	basic_string &
+	operator=(const std_string_type &str)
+	{
+		return assign(str);
+	}
+
+	/**
+	 * Replaces the contents with `count` copies of `ch`.
+	 */
+	basic_string &
+	assign(size_type count, CharT ch)
+	{
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			if (count == 0) {
+				_data.clear();
+				return;
+			}
+
+			_data.assign(count + 1, ch);
+			_data[count] = CharT();
+		});
+
+		return *this;
+	}
+
+	/**
+	 * Replaces the contents with the first `count` characters of `s`.
+	 *
+	 * The characters being overwritten are added to the transaction as
+	 * one range. `s` may point into this string.
+	 */
+	basic_string &
+	assign(const CharT *s, size_type count)
+	{
+		if (points_into(s)) {
+			std_string_type tmp(s, count);
+			return assign(tmp.data(), count);
+		}
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			if (count == 0)
+				_data.clear();
+			else
+				_data.assign(terminated_iterator(s, count, 0),
+					     terminated_iterator(s, count,
+								 count + 1));
+		});
+
+		return *this;
+	}
+
+	/**
+	 * Replaces the contents with the null-terminated string `s`.
+	 */
+	basic_string &
+	assign(const CharT *s)
+	{
+		return assign(s, Traits::length(s));
+	}
+
+	/**
+	 * Replaces the contents with a volatile std::basic_string.
+	 */
+	basic_string &
+	assign(const std_string_type &str)
+	{
+		return assign(str.data(), str.size());
+	}
+
+	/**
+	 * Replaces the contents with a copy of `other`.
+	 */
+	basic_string &
+	assign(const basic_string &other)
+	{
+		if (this != &other)
+			assign(other.cdata(), other.size());
+
+		return *this;
+	}
+
+	/**
+	 * Access character at a specific index with bounds checking.
+	 *
+	 * The character is added to the active transaction.
+	 *
+	 * @throw std::out_of_range if `n` is out of bounds.
+	 */
+	reference
+	at(size_type n)
+	{
+		if (n >= size())
+			throw std::out_of_range("string::at");
+
+		return _data[n];
+	}
+
+	/**
+	 * Access character at a specific index with bounds checking.
+	 *
+	 * @throw std::out_of_range if `n` is out of bounds.
+	 */
+	const_reference
+	at(size_type n) const
+	{
+		if (n >= size())
+			throw std::out_of_range("string::at");
+
+		return _data[n];
+	}
+
+	/**
+	 * Access character at a specific index.
+	 *
+	 * The character is added to the active transaction.
+	 */
+	reference operator[](size_type n)
+	{
+		return _data[n];
+	}
+
+	/**
+	 * Access character at a specific index.
+	 */
+	const_reference operator[](size_type n) const
+	{
+		return c_str()[n];
+	}
+
+	/**
+	 * Access the first character, which is added to the transaction.
+	 */
+	reference
+	front()
+	{
+		return _data[0];
+	}
+
+	/**
+	 * Access the first character.
+	 */
+	const_reference
+	front() const
+	{
+		return c_str()[0];
+	}
+
+	/**
+	 * Access the last character, which is added to the transaction.
+	 */
+	reference
+	back()
+	{
+		return _data[size() - 1];
+	}
+
+	/**
+	 * Access the last character.
+	 */
+	const_reference
+	back() const
+	{
+		return c_str()[size() - 1];
+	}
+
+	/**
+	 * Returns a pointer to the null-terminated contents.
+	 */
+	const CharT *
+	c_str() const noexcept
+	{
+		return _data.empty() ? empty_str() : _data.cdata();
+	}
+
+	/**
+	 * Returns a pointer to the modifiable contents.
+	 *
+	 * All characters are added to the active transaction as one range.
+	 */
+	pointer
+	data()
+	{
+		if (_data.empty())
+			return const_cast<pointer>(empty_str());
+
+		return _data.range(0, size());
+	}
+
+	/**
+	 * Returns a pointer to the null-terminated contents.
+	 */
+	const_pointer
+	data() const noexcept
+	{
+		return c_str();
+	}
+
+	/**
+	 * Returns a pointer to the null-terminated contents, regardless of
+	 * the constness of the string.
+	 */
+	const_pointer
+	cdata() const noexcept
+	{
+		return c_str();
+	}
+
+	/**
+	 * Returns a pointer to a modifiable range of characters.
+	 *
+	 * Only the `n` characters starting at `start` are added to the
+	 * active transaction, as one range.
+	 *
+	 * @throw std::out_of_range if the range is out of bounds.
+	 */
+	pointer
+	range(size_type start, size_type n)
+	{
+		if (start > size() || n > size() - start)
+			throw std::out_of_range("string::range");
+
+		return _data.range(start, n);
+	}
+
+	/**
+	 * Returns an iterator to the beginning.
+	 *
+	 * All characters are added to the active transaction as one range.
+	 */
+	iterator
+	begin()
+	{
+		return data();
+	}
+
+	/**
+	 * Returns an iterator to the end.
+	 *
+	 * All characters are added to the active transaction as one range.
+	 */
+	iterator
+	end()
+	{
+		return data() + size();
+	}
+
+	/**
+	 * Returns a const iterator to the beginning.
+	 */
+	const_iterator
+	begin() const noexcept
+	{
+		return cdata();
+	}
+
+	/**
+	 * Returns a const iterator to the end.
+	 */
+	const_iterator
+	end() const noexcept
+	{
+		return cdata() + size();
+	}
+
+	/**
+	 * Returns a const iterator to the beginning.
+	 */
+	const_iterator
+	cbegin() const noexcept
+	{
+		return cdata();
+	}
+
+	/**
+	 * Returns a const iterator to the end.
+	 */
+	const_iterator
+	cend() const noexcept
+	{
+		return cdata() + size();
+	}
+
+	/**
+	 * Returns a const reverse iterator to the beginning.
+	 */
+	const_reverse_iterator
+	crbegin() const noexcept
+	{
+		return const_reverse_iterator(cend());
+	}
+
+	/**
+	 * Returns a const reverse iterator to the end.
+	 */
+	const_reverse_iterator
+	crend() const noexcept
+	{
+		return const_reverse_iterator(cbegin());
+	}
+
+	/**
+	 * Checks whether the string is empty.
+	 */
+	bool
+	empty() const noexcept
+	{
+		return size() == 0;
+	}
+
+	/**
+	 * Returns the number of characters.
+	 */
+	size_type
+	size() const noexcept
+	{
+		return _data.empty() ? 0 : _data.size() - 1;
+	}
+
+	/**
+	 * Returns the number of characters.
+	 */
+	size_type
+	length() const noexcept
+	{
+		return size();
+	}
+
+	/**
+	 * Returns the number of characters that fit in the current storage.
+	 */
+	size_type
+	capacity() const noexcept
+	{
+		return _data.capacity() == 0 ? 0 : _data.capacity() - 1;
+	}
+
+	/**
+	 * Returns the maximum number of characters.
+	 */
+	size_type
+	max_size() const noexcept
+	{
+		return _data.max_size() - 1;
+	}
+
+	/**
+	 * Increases the capacity to at least `new_cap` characters.
+	 */
+	void
+	reserve(size_type new_cap)
+	{
+		_data.reserve(new_cap + 1);
+	}
+
+	/**
+	 * Removes all characters. The capacity is left unchanged.
+	 */
+	void
+	clear()
+	{
+		_data.clear();
+	}
+
+	/**
+	 * Inserts the first `count` characters of `s` at `index`.
+	 *
+	 * The characters following `index` are added to the transaction as
+	 * one range, or none at all if the storage is reallocated. `s` may
+	 * point into this string.
+	 *
+	 * @throw std::out_of_range if `index` is greater than size().
+	 */
+	basic_string &
+	insert(size_type index, const CharT *s, size_type count)
+	{
+		if (index > size())
+			throw std::out_of_range("string::insert");
+
+		if (count == 0)
+			return *this;
+
+		if (empty())
+			return assign(s, count);
+
+		if (points_into(s)) {
+			std_string_type tmp(s, count);
+			return insert(index, tmp.data(), count);
+		}
+
+		_data.insert(_data.cbegin() + index, s, s + count);
+
+		return *this;
+	}
+
+	/**
+	 * Inserts the null-terminated string `s` at `index`.
+	 */
+	basic_string &
+	insert(size_type index, const CharT *s)
+	{
+		return insert(index, s, Traits::length(s));
+	}
+
+	/**
+	 * Inserts `str` at `index`.
+	 */
+	basic_string &
+	insert(size_type index, const basic_string &str)
+	{
+		return insert(index, str.cdata(), str.size());
+	}
+
+	/**
+	 * Inserts `count` copies of `ch` at `index`.
+	 */
+	basic_string &
+	insert(size_type index, size_type count, CharT ch)
+	{
+		if (index > size())
+			throw std::out_of_range("string::insert");
+
+		if (count == 0)
+			return *this;
+
+		if (empty())
+			return assign(count, ch);
+
+		_data.insert(_data.cbegin() + index, count, ch);
+
+		return *this;
+	}
+
+	/**
+	 * Removes up to `count` characters starting at `index`.
+	 *
+	 * The characters from `index` to the end are added to the
+	 * transaction as one range.
+	 *
+	 * @throw std::out_of_range if `index` is greater than size().
+	 */
+	basic_string &
+	erase(size_type index = 0, size_type count = npos)
+	{
+		size_type sz = size();
+		if (index > sz)
+			throw std::out_of_range("string::erase");
+
+		count = std::min(count, sz - index);
+		_data.erase(_data.cbegin() + index,
+			    _data.cbegin() + index + count);
+
+		return *this;
+	}
+
+	/**
+	 * Appends `ch`.
+	 */
+	void
+	push_back(CharT ch)
+	{
+		append(1, ch);
+	}
+
+	/**
+	 * Removes the last character.
+	 */
+	void
+	pop_back()
+	{
+		erase(size() - 1, 1);
+	}
+
+	/**
+	 * Appends the first `count` characters of `s`.
+	 *
+	 * Only the terminating null character is added to the transaction,
+	 * unless the storage has to be reallocated.
+	 */
+	basic_string &
+	append(const CharT *s, size_type count)
+	{
+		return insert(size(), s, count);
+	}
+
+	/**
+	 * Appends the null-terminated string `s`.
+	 */
+	basic_string &
+	append(const CharT *s)
+	{
+		return append(s, Traits::length(s));
+	}
+
+	/**
+	 * Appends `str`.
+	 */
+	basic_string &
+	append(const basic_string &str)
+	{
+		return append(str.cdata(), str.size());
+	}
+
+	/**
+	 * Appends a volatile std::basic_string.
+	 */
+	basic_string &
+	append(const std_string_type &str)
+	{
+		return append(str.data(), str.size());
+	}
+
+	/**
+	 * Appends `count` copies of `ch`.
+	 */
+	basic_string &
+	append(size_type count, CharT ch)
+	{
+		return insert(size(), count, ch);
+	}
+
+	/**
+	 * Appends `str`.
+	 */
+	basic_string &
+	operator+=(const basic_string &str)
+	{
+		return append(str);
+	}
+
+	/**
+	 * Appends the null-terminated string `s`.
+	 */
+	basic_string &
+	operator+=(const CharT *s)
+	{
+		return append(s);
+	}
+
+	/**
+	 * Appends `ch`.
+	 */
+	basic_string &
+	operator+=(CharT ch)
+	{
+		return append(1, ch);
+	}
+
+	/**
+	 * Appends a volatile std::basic_string.
+	 */
+	basic_string &
+	operator+=(const std_string_type &str)
+	{
+		return append(str);
+	}
+
+	/**
+	 * Resizes the string to `count` characters, new characters are
+	 * copies of `ch`.
+	 */
+	void
+	resize(size_type count, CharT ch = CharT())
+	{
+		size_type sz = size();
+
+		if (count < sz)
+			erase(count);
+		else
+			append(count - sz, ch);
+	}
+
+	/**
+	 * Compares the string with the first `count` characters of `s`.
+	 *
+	 * @return negative value, zero or positive value if the string is
+	 *	respectively less than, equal to or greater than `s`.
+	 */
+	int
+	compare(const CharT *s, size_type count) const
+	{
+		size_type sz = size();
+		int ret = Traits::compare(cdata(), s, std::min(sz, count));
+
+		if (ret != 0)
+			return ret;
+
+		return sz < count ? -1 : (sz > count ? 1 : 0);
+	}
+
+	/**
+	 * Compares the string with the null-terminated string `s`.
+	 */
+	int
+	compare(const CharT *s) const
+	{
+		return compare(s, Traits::length(s));
+	}
+
+	/**
+	 * Compares the string with `str`.
+	 */
+	int
+	compare(const basic_string &str) const
+	{
+		return compare(str.cdata(), str.size());
+	}
+
+	/**
+	 * Compares the string with a volatile std::basic_string.
+	 */
+	int
+	compare(const std_string_type &str) const
+	{
+		return compare(str.data(), str.size());
+	}
+
+	/**
+	 * Exchanges the contents with `other`.
+	 */
+	void
+	swap(basic_string &other)
+	{
+		_data.swap(other._data);
+	}
+
+private:
+	/*
+	 * Forward iterator over `count` characters of a buffer followed by
+	 * a null character, lets the vector copy a terminated string in
+	 * a single pass.
+	 */
+	class terminated_iterator {
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef CharT value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const CharT *pointer;
+		typedef CharT reference;
+
+		terminated_iterator(const CharT *s, size_type count,
+				    size_type pos)
+			: s(s), count(count), pos(pos)
+		{
+		}
+
+		CharT operator*() const
+		{
+			return pos < count ? s[pos] : CharT();
+		}
+
+		terminated_iterator &operator++()
+		{
+			++pos;
+			return *this;
+		}
+
+		terminated_iterator operator++(int)
+		{
+			terminated_iterator tmp(*this);
+			++pos;
+			return tmp;
+		}
+
+		bool
+		operator==(const terminated_iterator &other) const
+		{
+			return pos == other.pos;
+		}
+
+		bool
+		operator!=(const terminated_iterator &other) const
+		{
+			return pos != other.pos;
+		}
+
+	private:
+		const CharT *s;
+		size_type count;
+		size_type pos;
+	};
+
+	/*
+	 * Returns the pool the string resides in.
+	 */
+	pool_base
+	get_pool() const
+	{
+		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		if (pop == nullptr)
+			throw pool_error("string is not in persistent memory");
+
+		return pool_base(pop);
+	}
+
+	/*
+	 * Checks whether `s` points into the storage of this string.
+	 */
+	bool
+	points_into(const CharT *s) const
+	{
+		std::less_equal<const CharT *> le;
+		std::less<const CharT *> lt;
+
+		return !_data.empty() && le(_data.cdata(), s) &&
+			lt(s, _data.cdata() + _data.size());
+	}
+
+	/*
+	 * Returns the contents of an empty string.
+	 */
+	static const CharT *
+	empty_str() noexcept
+	{
+		static const CharT nul = CharT();
+
+		return &nul;
+	}
+
+	vector<CharT> _data;
+};
+
+template <typename CharT, typename Traits>
+const typename basic_string<CharT, Traits>::size_type
+	basic_string<CharT, Traits>::npos;
+
+/**
+ * Equality operator.
+ */
+template <typename CharT, typename Traits>
+inline bool
+operator==(const basic_string<CharT, Traits> &lhs,
+	   const basic_string<CharT, Traits> &rhs)
+{
+	return lhs.compare(rhs) == 0;
+}
+
+/**
+ * Equality operator.
+ */
+template <typename CharT, typename Traits>
+inline bool
+operator==(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
+{
+	return lhs.compare(rhs) == 0;
+}
+
+/**
+ * Equality operator.
+ */
+template <typename CharT, typename Traits>
+inline bool
+operator==(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
+{
+	return rhs.compare(lhs) == 0;
+}
+
+/**
+ * Equality operator.
+ */
+template <typename CharT, typename Traits>
+inline bool
+operator==(const basic_string<CharT, Traits> &lhs,
+	   const std::basic_string<CharT, Traits> &rhs)
+{
+	return lhs.compare(rhs) == 0;
+}
+
+/**
+ * Equality operator.
+ */
+template <typename CharT, typename Traits>
+inline bool
+operator==(const std::basic_string<CharT, Traits> &lhs,
+	   const basic_string<CharT, Traits> &rhs)
+{
+	return rhs.compare(lhs) == 0;
+}
+
+/**
+ * Inequality operator.
+ */
+template <typename CharT, typename Traits>
+inline bool
+operator!=(const basic_string<CharT, Traits> &lhs,
+	   const basic_string<CharT, Traits> &rhs)
+{
+	return !(lhs == rhs);
+}
+
+/**
+ * Inequality operator.
+ */
+template <typename CharT, typename Traits>
+inline bool
+operator!=(const basic_string<CharT, Traits> &lhs, const CharT *rhs)
+{
+	return !(lhs == rhs);
+}
+
+/**
+ * Inequality operator.
+ */
+template <typename CharT, typename Traits>
+inline bool
+operator!=(const CharT *lhs, const basic_string<CharT, Traits> &rhs)
+{
+	return !(lhs == rhs);
+}
+
+/**
+ * Inequality operator.
+ */
+template <typename CharT, typename Traits>
+inline bool
+operator!=(const basic_string<CharT, Traits> &lhs,
+	   const std::basic_string<CharT, Traits> &rhs)
+{
+	return !(lhs == rhs);
+}
+
+/**
+ * Inequality operator.
+ */
+template <typename CharT, typename Traits>
+inline bool
+operator!=(const std::basic_string<CharT, Traits> &lhs,
+	   const basic_string<CharT, Traits> &rhs)
+{
+	return !(lhs == rhs);
+}
+
+/**
+ * Less than operator, compares the strings lexicographically.
+ */
+template <typename CharT, typename Traits>
+inline bool
+operator<(const basic_string<CharT, Traits> &lhs,
+	  const basic_string<CharT, Traits> &rhs)
+{
+	return lhs.compare(rhs) < 0;
+}
+
+/**
+ * Swaps the contents of two strings.
+ *
+ * Non-member swap function as required by Swappable concept.
+ */
+template <typename CharT, typename Traits>
+inline void
+swap(basic_string<CharT, Traits> &lhs, basic_string<CharT, Traits> &rhs)
+{
+	lhs.swap(rhs);
+}
+
+typedef basic_string<char> string;
+typedef basic_string<wchar_t> wstring;
+
+} /* namespace obj */
+
+} /* namespace nvml */
+
+#endif /* PMEMOBJ_STRING_HPP */
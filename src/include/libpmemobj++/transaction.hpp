@@ -38,9 +38,11 @@
 #ifndef LIBPMEMOBJ_TRANSACTION_HPP
 #define LIBPMEMOBJ_TRANSACTION_HPP
 
+#include <cstddef>
 #include <functional>
 #include <string>
 
+#include "libpmemobj++/detail/common.hpp"
 #include "libpmemobj++/detail/pexceptions.hpp"
 #include "libpmemobj++/pool.hpp"
 #include "libpmemobj/tx_base.h"
@@ -293,6 +295,116 @@ public:
 	};
 #endif /* __cpp_lib_uncaught_exceptions */
 
+	/**
+	 * C++ scoped snapshot class.
+	 *
+	 * Adds a range of an object to the active transaction as a single
+	 * undo log entry, see transaction::snapshot. For the lifetime of
+	 * the snapshot_scope object, modifications of `p<>` properties and
+	 * persistent pointers within the range do not add themselves to
+	 * the transaction again, which spares a lookup of the transaction's
+	 * ranges for each of them.
+	 *
+	 * The object has to be destroyed before the transaction in which
+	 * it was created ends. Scopes may be nested, only the innermost
+	 * one is used to filter the modifications.
+	 *
+	 * The typical usage example would be:
+	 * @code
+	 * transaction::exec_tx(pop, [&] {
+	 *	transaction::snapshot_scope<foo> s(ptr.get(), &foo::a,
+	 *		&foo::b, &foo::c);
+	 *	ptr->a = 1;
+	 *	ptr->b = 2;
+	 *	ptr->c = 3;
+	 * });
+	 * @endcode
+	 */
+	template <typename T>
+	class snapshot_scope {
+	public:
+		/**
+		 * Snapshot `num` consecutive objects starting at `addr`.
+		 *
+		 * @param[in] addr pointer to the first object.
+		 * @param[in] num number of objects.
+		 *
+		 * @throw transaction_error if called outside of
+		 *	a transaction or adding the range failed.
+		 */
+		snapshot_scope(const T *addr, std::size_t num = 1)
+		    : prev(detail::tx_snapshot())
+		{
+			transaction::snapshot(addr, num);
+			set_range(addr, addr + num);
+		}
+
+		/**
+		 * Snapshot the given fields of `obj`.
+		 *
+		 * The fields are coalesced into the smallest range which
+		 * covers them all.
+		 *
+		 * @param[in] obj pointer to the object.
+		 * @param[in] fields pointers to members of `T`.
+		 *
+		 * @throw transaction_error if called outside of
+		 *	a transaction or adding the range failed.
+		 */
+		template <typename... Fields>
+		snapshot_scope(const T *obj, Fields T::*... fields)
+		    : prev(detail::tx_snapshot())
+		{
+			const char *begin = nullptr;
+			const char *end = nullptr;
+			transaction::field_range(obj, begin, end, fields...);
+
+			transaction::snapshot(begin,
+					      static_cast<std::size_t>(
+						      end - begin));
+			set_range(begin, end);
+		}
+
+		/**
+		 * Destructor.
+		 *
+		 * Restores the previously snapshotted range. The range
+		 * stays in the transaction until it ends.
+		 */
+		~snapshot_scope() noexcept
+		{
+			detail::tx_snapshot() = prev;
+		}
+
+		/**
+		 * Deleted copy constructor.
+		 */
+		snapshot_scope(const snapshot_scope &) = delete;
+
+		/**
+		 * Deleted assignment operator.
+		 */
+		snapshot_scope &operator=(const snapshot_scope &) = delete;
+
+	private:
+		/**
+		 * Make [begin, end) the calling thread's snapshotted range.
+		 */
+		static void
+		set_range(const void *begin, const void *end) noexcept
+		{
+			detail::tx_snapshot().begin =
+				static_cast<const char *>(begin);
+			detail::tx_snapshot().end =
+				static_cast<const char *>(end);
+		}
+
+		/**
+		 * The range of the enclosing scope.
+		 */
+		detail::tx_snapshot_range prev;
+	};
+
 	/*
 	 * Deleted default constructor.
 	 */
@@ -357,6 +469,57 @@ public:
 		return pmemobj_tx_errno();
 	}
 
+	/**
+	 * Add `num` consecutive objects starting at `addr` to the active
+	 * transaction as a single undo log entry.
+	 *
+	 * Snapshotting a whole object once is cheaper than letting each of
+	 * its modified fields add itself to the transaction separately.
+	 *
+	 * @param[in] addr pointer to the first object.
+	 * @param[in] num number of objects.
+	 *
+	 * @throw transaction_error if called outside of a transaction or
+	 *	adding the range failed.
+	 */
+	template <typename T>
+	static void
+	snapshot(const T *addr, std::size_t num = 1)
+	{
+		if (pmemobj_tx_stage() != TX_STAGE_WORK)
+			throw transaction_error("wrong stage for"
+						" snapshot");
+
+		if (pmemobj_tx_add_range_direct(addr, sizeof(T) * num))
+			throw transaction_error("Could not add a range to the"
+						" transaction.");
+	}
+
+	/**
+	 * Add the given fields of `obj` to the active transaction as
+	 * a single undo log entry.
+	 *
+	 * The fields are coalesced into the smallest range which covers
+	 * them all, including whatever lies between them.
+	 *
+	 * @param[in] obj pointer to the object.
+	 * @param[in] field pointer to a member of `T`.
+	 * @param[in] fields pointers to further members of `T`.
+	 *
+	 * @throw transaction_error if called outside of a transaction or
+	 *	adding the range failed.
+	 */
+	template <typename T, typename F, typename... Fields>
+	static void
+	snapshot(const T *obj, F T::*field, Fields T::*... fields)
+	{
+		const char *begin = nullptr;
+		const char *end = nullptr;
+		field_range(obj, begin, end, field, fields...);
+
+		snapshot(begin, static_cast<std::size_t>(end - begin));
+	}
+
 	/**
 	 * Execute a closure-like transaction and lock `locks`.
 	 *
@@ -379,8 +542,10 @@ public:
 	 *
 	 * @param[in,out] pool the pool in which the transaction will take
 	 *	place.
-	 * @param[in] tx an std::function<void ()> which will perform
-	 *	operations within this transaction.
+	 * @param[in] tx a callable object taking no arguments, which will
+	 *	perform operations within this transaction. It is invoked
+	 *	directly, without being wrapped in an std::function, so
+	 *	lambdas do not allocate regardless of their captures.
 	 * @param[in,out] locks locks to be taken for the duration of
 	 *	the transaction.
 	 *
@@ -388,9 +553,9 @@ public:
 	 *	of the transaction.
 	 * @throw manual_tx_abort on manual transaction abort.
 	 */
-	template <typename... Locks>
+	template <typename F, typename... Locks>
 	static void
-	exec_tx(pool_base &pool, std::function<void()> tx, Locks &... locks)
+	exec_tx(pool_base &pool, F &&tx, Locks &... locks)
 	{
 		if (pmemobj_tx_begin(pool.get_handle(), NULL, TX_PARAM_NONE) !=
 		    0)
@@ -435,7 +600,102 @@ public:
 		(void)pmemobj_tx_end();
 	}
 
+	/**
+	 * Execute a closure-like transaction and lock `locks`, reporting
+	 * errors by return value.
+	 *
+	 * This is the fast path for short transactions which cannot throw.
+	 * The callable has to be `noexcept`, which lets the transaction skip
+	 * the exception handling entirely. The transaction may still be
+	 * aborted with pmemobj_tx_abort, in which case its error number is
+	 * returned.
+	 *
+	 * Assigning to `p<>` properties, as well as using any other part of
+	 * the C++ bindings that reports errors by exceptions, is not safe in
+	 * the callable: a failure to snapshot the property would terminate
+	 * the program. Persistent memory has to be added to the transaction
+	 * with pmemobj_tx_add_range or pmemobj_tx_add_range_direct, checking
+	 * their return value, before it is modified. If any of them fails or
+	 * a nested transaction aborts, pmemobj_tx_stage() is no longer
+	 * TX_STAGE_WORK and the callable must return without modifying
+	 * persistent memory any further, as the changes made so far have
+	 * already been rolled back.
+	 *
+	 * The locks have to be persistent memory resident locks and are
+	 * held until the end of the outermost transaction.
+	 *
+	 * @param[in,out] pool the pool in which the transaction will take
+	 *	place.
+	 * @param[in] tx a `noexcept` callable object taking no arguments,
+	 *	which will perform operations within this transaction.
+	 * @param[in,out] locks locks to be taken for the duration of
+	 *	the transaction.
+	 *
+	 * @return 0 if the transaction was committed, error number
+	 *	otherwise.
+	 */
+	template <typename F, typename... Locks>
+	static int
+	exec_tx_noexcept(pool_base &pool, F &&tx, Locks &... locks) noexcept
+	{
+		static_assert(noexcept(tx()),
+			      "the transaction callable has to be noexcept");
+
+		auto err = pmemobj_tx_begin(pool.get_handle(), NULL,
+					    TX_PARAM_NONE);
+		if (err)
+			return err;
+
+		err = add_lock(locks...);
+
+		if (err) {
+			pmemobj_tx_abort(err);
+			return pmemobj_tx_end();
+		}
+
+		tx();
+
+		auto stage = pmemobj_tx_stage();
+
+		if (stage == TX_STAGE_WORK)
+			pmemobj_tx_commit();
+		else if (stage == TX_STAGE_NONE)
+			return ECANCELED;
+
+		return pmemobj_tx_end();
+	}
+
 private:
+	/**
+	 * Recursively extend [begin, end) to cover the given fields of
+	 * `obj`. An empty range is denoted by null pointers.
+	 */
+	template <typename T, typename F, typename... Fields>
+	static void
+	field_range(const T *obj, const char *&begin, const char *&end,
+		    F T::*field, Fields T::*... fields) noexcept
+	{
+		const char *fbegin =
+			reinterpret_cast<const char *>(&(obj->*field));
+		const char *fend = fbegin + sizeof(F);
+
+		if (begin == nullptr || fbegin < begin)
+			begin = fbegin;
+		if (end == nullptr || fend > end)
+			end = fend;
+
+		field_range(obj, begin, end, fields...);
+	}
+
+	/**
+	 * Method ending the recursive algorithm.
+	 */
+	template <typename T>
+	static void
+	field_range(const T *, const char *&, const char *&) noexcept
+	{
+	}
+
 	/**
 	 * Recursively add locks to the active transaction.
 	 *
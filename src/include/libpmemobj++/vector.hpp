@@ -0,0 +1,1217 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Persistent memory resident vector.
+ */
+
+#ifndef PMEMOBJ_VECTOR_HPP
+#define PMEMOBJ_VECTOR_HPP
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "libpmemobj++/detail/common.hpp"
+#include "libpmemobj++/detail/life.hpp"
+#include "libpmemobj++/detail/pexceptions.hpp"
+#include "libpmemobj++/p.hpp"
+#include "libpmemobj++/persistent_ptr.hpp"
+#include "libpmemobj++/pool.hpp"
+#include "libpmemobj++/transaction.hpp"
+#include "libpmemobj/base.h"
+#include "libpmemobj/tx_base.h"
+
+namespace nvml
+{
+
+namespace obj
+{
+
+/**
+ * Persistent memory resident vector.
+ *
+ * The vector has to reside in persistent memory, either as a member of
+ * a persistent object or as an object allocated with make_persistent.
+ * A zeroed vector is a valid empty vector, so it can be embedded in a
+ * root object directly. The elements are stored in a single contiguous
+ * transactional allocation.
+ *
+ * Every modifier is executed in its own (possibly nested) transaction.
+ * Instead of adding each element separately, the affected elements are
+ * added to the transaction as one contiguous range, so bulk operations
+ * like assign(), insert() or resize() cost a single undo log entry.
+ * When the capacity is exceeded, the storage grows geometrically in one
+ * transactional reallocation, which does not need an undo log entry for
+ * the elements at all.
+ *
+ * Non-const element access (operator[], at(), data(), begin(), ...)
+ * adds the accessed elements to the active transaction, if there is
+ * one. The const variants and cdata() have no transactional side
+ * effects.
+ */
+template <typename T>
+class vector {
+public:
+	typedef T value_type;
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef value_type &reference;
+	typedef const value_type &const_reference;
+	typedef value_type *pointer;
+	typedef const value_type *const_pointer;
+	typedef pointer iterator;
+	typedef const_pointer const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	/**
+	 * Default constructor.
+	 *
+	 * Creates an empty vector, does not allocate.
+	 */
+	vector() : _data(nullptr), _size(0), _capacity(0)
+	{
+	}
+
+	/**
+	 * Fill constructor.
+	 *
+	 * @param[in] count number of elements.
+	 * @param[in] value value the elements are initialized with.
+	 *
+	 * @throw pool_error if the vector is not in persistent memory.
+	 * @throw transaction_alloc_error when the allocation failed.
+	 */
+	vector(size_type count, const value_type &value = value_type())
+		: _data(nullptr), _size(0), _capacity(0)
+	{
+		assign(count, value);
+	}
+
+	/**
+	 * Range constructor.
+	 *
+	 * @throw pool_error if the vector is not in persistent memory.
+	 * @throw transaction_alloc_error when the allocation failed.
+	 */
+	template <typename InputIt,
+		  typename = typename std::enable_if<!std::is_integral<
+			  InputIt>::value>::type>
+	vector(InputIt first, InputIt last)
+		: _data(nullptr), _size(0), _capacity(0)
+	{
+		assign(first, last);
+	}
+
+	/**
+	 * Initializer list constructor.
+	 *
+	 * @throw pool_error if the vector is not in persistent memory.
+	 * @throw transaction_alloc_error when the allocation failed.
+	 */
+	vector(std::initializer_list<value_type> ilist)
+		: _data(nullptr), _size(0), _capacity(0)
+	{
+		assign(ilist.begin(), ilist.end());
+	}
+
+	/**
+	 * Copy constructor.
+	 *
+	 * @throw pool_error if the vector is not in persistent memory.
+	 * @throw transaction_alloc_error when the allocation failed.
+	 */
+	vector(const vector &other) : _data(nullptr), _size(0), _capacity(0)
+	{
+		assign(other.cbegin(), other.cend());
+	}
+
+	/**
+	 * Move constructor.
+	 *
+	 * Takes over the storage of `other`, which is left empty.
+	 *
+	 * @throw transaction_error when adding `other` to the transaction
+	 *	failed.
+	 */
+	vector(vector &&other) : _data(nullptr), _size(0), _capacity(0)
+	{
+		swap(other);
+	}
+
+	/**
+	 * Destructor.
+	 *
+	 * Destroys the elements and transactionally frees the storage.
+	 */
+	~vector()
+	{
+		if (_data == nullptr)
+			return;
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] { release(); });
+	}
+
+	/**
+	 * Copy assignment operator.
+	 */
+	vector &
+	operator=(const vector &other)
+	{
+		if (this != &other)
+			assign(other.cbegin(), other.cend());
+
+		return *this;
+	}
+
+	/**
+	 * Move assignment operator.
+	 *
+	 * The previous contents are freed, `other` is left empty.
+	 */
+	vector &
+	operator=(vector &&other)
+	{
+		if (this == &other)
+			return *this;
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			release();
+			swap(other);
+		});
+
+		return *this;
+	}
+
+	/**
+	 * Initializer list assignment operator.
+	 */
+	vector &
+	operator=(std::initializer_list<value_type> ilist)
+	{
+		assign(ilist.begin(), ilist.end());
+
+		return *this;
+	}
+
+	/**
+	 * Replaces the contents with `count` copies of `value`.
+	 *
+	 * The reused storage is added to the transaction as one range.
+	 *
+	 * @throw pool_error if the vector is not in persistent memory.
+	 * @throw transaction_alloc_error when the allocation failed.
+	 */
+	void
+	assign(size_type count, const value_type &value)
+	{
+		value_type tmp(value);
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			prepare_assign(count);
+
+			T *d = _data.get();
+			for (size_type i = 0; i < count; ++i)
+				detail::create<T>(d + i, tmp);
+
+			_size = count;
+		});
+	}
+
+	/**
+	 * Replaces the contents with the elements from [first, last).
+	 *
+	 * The range must not refer to the elements of this vector.
+	 *
+	 * @throw pool_error if the vector is not in persistent memory.
+	 * @throw transaction_alloc_error when the allocation failed.
+	 */
+	template <typename InputIt,
+		  typename = typename std::enable_if<!std::is_integral<
+			  InputIt>::value>::type>
+	void
+	assign(InputIt first, InputIt last)
+	{
+		size_type count =
+			static_cast<size_type>(std::distance(first, last));
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			prepare_assign(count);
+
+			T *d = _data.get();
+			for (size_type i = 0; i < count; ++i, ++first)
+				detail::create<T>(d + i, *first);
+
+			_size = count;
+		});
+	}
+
+	/**
+	 * Replaces the contents with the elements of `ilist`.
+	 */
+	void
+	assign(std::initializer_list<value_type> ilist)
+	{
+		assign(ilist.begin(), ilist.end());
+	}
+
+	/**
+	 * Access element at a specific index with bounds checking.
+	 *
+	 * The element is added to the active transaction.
+	 *
+	 * @throw std::out_of_range if `n` is out of bounds.
+	 * @throw transaction_error when adding the element to the
+	 *	transaction failed.
+	 */
+	reference
+	at(size_type n)
+	{
+		if (n >= _size)
+			throw std::out_of_range("vector::at");
+
+		detail::conditional_add_to_tx(_data.get() + n);
+
+		return _data.get()[n];
+	}
+
+	/**
+	 * Access element at a specific index with bounds checking.
+	 *
+	 * @throw std::out_of_range if `n` is out of bounds.
+	 */
+	const_reference
+	at(size_type n) const
+	{
+		if (n >= _size)
+			throw std::out_of_range("vector::at");
+
+		return _data.get()[n];
+	}
+
+	/**
+	 * Access element at a specific index.
+	 *
+	 * The element is added to the active transaction.
+	 *
+	 * @throw transaction_error when adding the element to the
+	 *	transaction failed.
+	 */
+	reference operator[](size_type n)
+	{
+		detail::conditional_add_to_tx(_data.get() + n);
+
+		return _data.get()[n];
+	}
+
+	/**
+	 * Access element at a specific index.
+	 */
+	const_reference operator[](size_type n) const
+	{
+		return _data.get()[n];
+	}
+
+	/**
+	 * Access the first element, which is added to the transaction.
+	 */
+	reference
+	front()
+	{
+		return (*this)[0];
+	}
+
+	/**
+	 * Access the first element.
+	 */
+	const_reference
+	front() const
+	{
+		return _data.get()[0];
+	}
+
+	/**
+	 * Access the last element, which is added to the transaction.
+	 */
+	reference
+	back()
+	{
+		return (*this)[size() - 1];
+	}
+
+	/**
+	 * Access the last element.
+	 */
+	const_reference
+	back() const
+	{
+		return _data.get()[size() - 1];
+	}
+
+	/**
+	 * Returns a pointer to the underlying contiguous storage.
+	 *
+	 * All elements are added to the active transaction as one range.
+	 *
+	 * @throw transaction_error when adding the elements to the
+	 *	transaction failed.
+	 */
+	pointer
+	data()
+	{
+		snapshot_data(0, _size);
+
+		return _data.get();
+	}
+
+	/**
+	 * Returns a const pointer to the underlying contiguous storage.
+	 */
+	const_pointer
+	data() const noexcept
+	{
+		return _data.get();
+	}
+
+	/**
+	 * Returns a const pointer to the underlying contiguous storage,
+	 * regardless of the constness of the vector.
+	 */
+	const_pointer
+	cdata() const noexcept
+	{
+		return _data.get();
+	}
+
+	/**
+	 * Returns a pointer to a modifiable range of elements.
+	 *
+	 * Only the `n` elements starting at `start` are added to the active
+	 * transaction, as one range.
+	 *
+	 * @throw std::out_of_range if the range is out of bounds.
+	 * @throw transaction_error when adding the elements to the
+	 *	transaction failed.
+	 */
+	pointer
+	range(size_type start, size_type n)
+	{
+		if (start > _size || n > _size - start)
+			throw std::out_of_range("vector::range");
+
+		snapshot_data(start, start + n);
+
+		return _data.get() + start;
+	}
+
+	/**
+	 * Returns an iterator to the beginning.
+	 *
+	 * All elements are added to the active transaction as one range.
+	 */
+	iterator
+	begin()
+	{
+		return data();
+	}
+
+	/**
+	 * Returns an iterator to the end.
+	 *
+	 * All elements are added to the active transaction as one range.
+	 */
+	iterator
+	end()
+	{
+		return data() + size();
+	}
+
+	/**
+	 * Returns a const iterator to the beginning.
+	 */
+	const_iterator
+	begin() const noexcept
+	{
+		return cdata();
+	}
+
+	/**
+	 * Returns a const iterator to the end.
+	 */
+	const_iterator
+	end() const noexcept
+	{
+		return cdata() + size();
+	}
+
+	/**
+	 * Returns a const iterator to the beginning.
+	 */
+	const_iterator
+	cbegin() const noexcept
+	{
+		return cdata();
+	}
+
+	/**
+	 * Returns a const iterator to the end.
+	 */
+	const_iterator
+	cend() const noexcept
+	{
+		return cdata() + size();
+	}
+
+	/**
+	 * Returns a reverse iterator to the beginning.
+	 */
+	reverse_iterator
+	rbegin()
+	{
+		return reverse_iterator(end());
+	}
+
+	/**
+	 * Returns a reverse iterator to the end.
+	 */
+	reverse_iterator
+	rend()
+	{
+		return reverse_iterator(begin());
+	}
+
+	/**
+	 * Returns a const reverse iterator to the beginning.
+	 */
+	const_reverse_iterator
+	crbegin() const noexcept
+	{
+		return const_reverse_iterator(cend());
+	}
+
+	/**
+	 * Returns a const reverse iterator to the end.
+	 */
+	const_reverse_iterator
+	crend() const noexcept
+	{
+		return const_reverse_iterator(cbegin());
+	}
+
+	/**
+	 * Checks whether the vector is empty.
+	 */
+	bool
+	empty() const noexcept
+	{
+		return size() == 0;
+	}
+
+	/**
+	 * Returns the number of elements.
+	 */
+	size_type
+	size() const noexcept
+	{
+		return _size;
+	}
+
+	/**
+	 * Returns the number of elements that fit in the current storage.
+	 */
+	size_type
+	capacity() const noexcept
+	{
+		return _capacity;
+	}
+
+	/**
+	 * Returns the maximum number of elements of a single allocation.
+	 */
+	size_type
+	max_size() const noexcept
+	{
+		return PMEMOBJ_MAX_ALLOC_SIZE / sizeof(value_type);
+	}
+
+	/**
+	 * Increases the capacity to at least `new_cap` elements.
+	 *
+	 * @throw std::length_error if `new_cap` exceeds max_size().
+	 * @throw transaction_alloc_error when the allocation failed.
+	 */
+	void
+	reserve(size_type new_cap)
+	{
+		if (new_cap <= _capacity)
+			return;
+
+		check_length(new_cap);
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] { realloc(new_cap); });
+	}
+
+	/**
+	 * Reduces the capacity to the number of elements.
+	 *
+	 * @throw transaction_alloc_error when the allocation failed.
+	 */
+	void
+	shrink_to_fit()
+	{
+		if (_capacity == _size)
+			return;
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			if (_size == 0)
+				release();
+			else
+				realloc(_size);
+		});
+	}
+
+	/**
+	 * Destroys all elements. The capacity is left unchanged.
+	 */
+	void
+	clear()
+	{
+		if (_size == 0)
+			return;
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] { shrink(0); });
+	}
+
+	/**
+	 * Inserts `value` before `pos`.
+	 *
+	 * @return iterator to the inserted element.
+	 */
+	iterator
+	insert(const_iterator pos, const value_type &value)
+	{
+		return emplace(pos, value);
+	}
+
+	/**
+	 * Moves `value` into the vector before `pos`.
+	 *
+	 * @return iterator to the inserted element.
+	 */
+	iterator
+	insert(const_iterator pos, value_type &&value)
+	{
+		return emplace(pos, std::move(value));
+	}
+
+	/**
+	 * Inserts `count` copies of `value` before `pos`.
+	 *
+	 * The elements after `pos` are added to the transaction as one
+	 * range, or none at all if the storage is reallocated.
+	 *
+	 * @return iterator to the first inserted element.
+	 */
+	iterator
+	insert(const_iterator pos, size_type count, const value_type &value)
+	{
+		size_type idx = index_of(pos);
+		value_type tmp(value);
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			internal_insert(idx, count, [&](T *dest) {
+				for (size_type i = 0; i < count; ++i)
+					detail::create<T>(dest + i, tmp);
+			});
+		});
+
+		return _data.get() + idx;
+	}
+
+	/**
+	 * Inserts the elements from [first, last) before `pos`.
+	 *
+	 * The range must not refer to the elements of this vector.
+	 * The elements after `pos` are added to the transaction as one
+	 * range, or none at all if the storage is reallocated.
+	 *
+	 * @return iterator to the first inserted element.
+	 */
+	template <typename InputIt,
+		  typename = typename std::enable_if<!std::is_integral<
+			  InputIt>::value>::type>
+	iterator
+	insert(const_iterator pos, InputIt first, InputIt last)
+	{
+		size_type idx = index_of(pos);
+		size_type count =
+			static_cast<size_type>(std::distance(first, last));
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			internal_insert(idx, count, [&](T *dest) {
+				for (size_type i = 0; i < count; ++i, ++first)
+					detail::create<T>(dest + i, *first);
+			});
+		});
+
+		return _data.get() + idx;
+	}
+
+	/**
+	 * Inserts the elements of `ilist` before `pos`.
+	 *
+	 * @return iterator to the first inserted element.
+	 */
+	iterator
+	insert(const_iterator pos, std::initializer_list<value_type> ilist)
+	{
+		return insert(pos, ilist.begin(), ilist.end());
+	}
+
+	/**
+	 * Constructs an element in place before `pos`.
+	 *
+	 * @return iterator to the inserted element.
+	 */
+	template <typename... Args>
+	iterator
+	emplace(const_iterator pos, Args &&... args)
+	{
+		size_type idx = index_of(pos);
+
+		/* the arguments may refer to the elements being shifted */
+		if (idx != _size && _size < _capacity) {
+			value_type tmp(std::forward<Args>(args)...);
+			return insert(pos, 1, tmp);
+		}
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			internal_insert(idx, 1, [&](T *dest) {
+				detail::create<T>(dest,
+						  std::forward<Args>(args)...);
+			});
+		});
+
+		return _data.get() + idx;
+	}
+
+	/**
+	 * Constructs an element in place at the end.
+	 *
+	 * @return reference to the inserted element.
+	 */
+	template <typename... Args>
+	reference
+	emplace_back(Args &&... args)
+	{
+		return *emplace(cend(), std::forward<Args>(args)...);
+	}
+
+	/**
+	 * Appends a copy of `value`.
+	 */
+	void
+	push_back(const value_type &value)
+	{
+		emplace(cend(), value);
+	}
+
+	/**
+	 * Appends `value` by moving it.
+	 */
+	void
+	push_back(value_type &&value)
+	{
+		emplace(cend(), std::move(value));
+	}
+
+	/**
+	 * Removes the last element.
+	 */
+	void
+	pop_back()
+	{
+		if (_size == 0)
+			return;
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] { shrink(_size - 1); });
+	}
+
+	/**
+	 * Removes the element at `pos`.
+	 *
+	 * @return iterator following the removed element.
+	 */
+	iterator
+	erase(const_iterator pos)
+	{
+		return erase(pos, pos + 1);
+	}
+
+	/**
+	 * Removes the elements in [first, last).
+	 *
+	 * The elements from `first` to the end are added to the
+	 * transaction as one range.
+	 *
+	 * @return iterator following the last removed element.
+	 */
+	iterator
+	erase(const_iterator first, const_iterator last)
+	{
+		size_type idx = index_of(first);
+		size_type count = static_cast<size_type>(last - first);
+
+		if (count == 0)
+			return _data.get() + idx;
+
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			size_type sz = _size;
+			T *d = _data.get();
+
+			snapshot_data(idx, sz);
+
+			std::move(d + idx + count, d + sz, d + idx);
+			for (size_type i = sz - count; i < sz; ++i)
+				detail::destroy<T>(d[i]);
+
+			_size = sz - count;
+		});
+
+		return _data.get() + idx;
+	}
+
+	/**
+	 * Resizes the vector to `count` elements.
+	 *
+	 * New elements are value-initialized.
+	 */
+	void
+	resize(size_type count)
+	{
+		pool_base pb = get_pool();
+		transaction::exec_tx(pb, [&] {
+			if (count <= _size) {
+				shrink(count);
+				return;
+			}
+
+			size_type n = count - _size;
+			internal_insert(_size, n, [&](T *dest) {
+				for (size_type i = 0; i < n; ++i)
+					detail::create<T>(dest + i);
+			});
+		});
+	}
+
+	/**
+	 * Resizes the vector to `count` elements.
+	 *
+	 * New elements are copies of `value`.
+	 */
+	void
+	resize(size_type count, const value_type &value)
+	{
+		if (count <= _size)
+			resize(count);
+		else
+			insert(cend(), count - _size, value);
+	}
+
+	/**
+	 * Exchanges the contents with `other`.
+	 *
+	 * Only the control data of both vectors is modified, the elements
+	 * are not touched.
+	 *
+	 * @throw transaction_error when adding the vectors to the
+	 *	transaction failed.
+	 */
+	void
+	swap(vector &other)
+	{
+		_data.swap(other._data);
+		_size.swap(other._size);
+		_capacity.swap(other._capacity);
+	}
+
+private:
+	/*
+	 * Returns the pool the vector resides in.
+	 */
+	pool_base
+	get_pool() const
+	{
+		PMEMobjpool *pop = pmemobj_pool_by_ptr(this);
+		if (pop == nullptr)
+			throw pool_error("vector is not in persistent memory");
+
+		return pool_base(pop);
+	}
+
+	/*
+	 * Adds the elements [first, last) to the transaction as one range.
+	 */
+	void
+	snapshot_data(size_type first, size_type last)
+	{
+		detail::conditional_add_range_to_tx(
+			_data.get() + first, sizeof(T) * (last - first));
+	}
+
+	/*
+	 * Converts an iterator to an index.
+	 */
+	size_type
+	index_of(const_iterator pos) const
+	{
+		return static_cast<size_type>(pos - cdata());
+	}
+
+	/*
+	 * Throws if `n` elements do not fit in a single allocation.
+	 */
+	void
+	check_length(size_type n) const
+	{
+		if (n > max_size())
+			throw std::length_error("vector length exceeded");
+	}
+
+	/*
+	 * Returns the capacity to be used for `required` elements --
+	 * the storage grows geometrically.
+	 */
+	size_type
+	grow_capacity(size_type required) const
+	{
+		check_length(required);
+
+		size_type cap = _capacity;
+		size_type grown = cap > max_size() / 2 ? max_size() : cap * 2;
+
+		return std::max(required, grown);
+	}
+
+	/*
+	 * Allocates storage for `n` elements. The previous storage, if any,
+	 * has to be released by the caller.
+	 */
+	void
+	alloc(size_type n)
+	{
+		if (pmemobj_tx_stage() != TX_STAGE_WORK)
+			throw transaction_scope_error(
+				"refusing to allocate "
+				"memory outside of transaction scope");
+
+		persistent_ptr<T[]> res = pmemobj_tx_alloc(
+			sizeof(T) * n, detail::type_num<T>());
+
+		if (res == nullptr)
+			throw transaction_alloc_error("failed to allocate "
+						      "persistent memory "
+						      "vector");
+
+		/* one undo log entry for the whole header */
+		transaction::snapshot_scope<vector> s(this);
+
+		_data = res;
+		_capacity = n;
+	}
+
+	/*
+	 * Destroys the elements from `count` to the end.
+	 */
+	void
+	shrink(size_type count)
+	{
+		size_type sz = _size;
+		T *d = _data.get();
+
+		snapshot_data(count, sz);
+
+		for (size_type i = sz; i > count; --i)
+			detail::destroy<T>(d[i - 1]);
+
+		_size = count;
+	}
+
+	/*
+	 * Destroys all elements and frees the storage.
+	 */
+	void
+	release()
+	{
+		if (_data == nullptr)
+			return;
+
+		shrink(0);
+
+		if (pmemobj_tx_free(*_data.raw_ptr()) != 0)
+			throw transaction_free_error("failed to delete "
+						     "persistent memory "
+						     "vector");
+
+		transaction::snapshot_scope<vector> s(this);
+
+		_data = nullptr;
+		_capacity = 0;
+	}
+
+	/*
+	 * Moves the elements to a new storage of `n` elements.
+	 *
+	 * Neither the old nor the new storage needs an undo log entry --
+	 * the former is freed and the latter is allocated in the
+	 * same transaction.
+	 */
+	void
+	realloc(size_type n)
+	{
+		persistent_ptr<T[]> old = _data;
+		size_type sz = _size;
+
+		alloc(n);
+		relocate(_data.get(), old, 0, sz);
+		free_storage(old, sz);
+	}
+
+	/*
+	 * Move-constructs `count` elements at `dest` from `old[first]`.
+	 */
+	static void
+	relocate(T *dest, const persistent_ptr<T[]> &old, size_type first,
+		 size_type count)
+	{
+		T *src = old.get() + first;
+		for (size_type i = 0; i < count; ++i)
+			detail::create<T>(dest + i, std::move(src[i]));
+	}
+
+	/*
+	 * Destroys `count` elements of the old storage and frees it.
+	 */
+	static void
+	free_storage(persistent_ptr<T[]> &old, size_type count)
+	{
+		if (old == nullptr)
+			return;
+
+		T *src = old.get();
+		for (size_type i = count; i > 0; --i)
+			detail::destroy<T>(src[i - 1]);
+
+		if (pmemobj_tx_free(*old.raw_ptr()) != 0)
+			throw transaction_free_error("failed to delete "
+						     "persistent memory "
+						     "vector");
+	}
+
+	/*
+	 * Destroys the current elements and makes room for `count` new
+	 * ones at the beginning of the storage. If the storage is reused,
+	 * everything that is going to be overwritten is added to the
+	 * transaction as one range -- the commit flushes only the ranges
+	 * known to the transaction.
+	 */
+	void
+	prepare_assign(size_type count)
+	{
+		check_length(count);
+
+		if (count > _capacity) {
+			persistent_ptr<T[]> old = _data;
+			size_type sz = _size;
+
+			alloc(count);
+			free_storage(old, sz);
+		} else {
+			size_type sz = _size;
+			T *d = _data.get();
+
+			snapshot_data(0, std::max(sz, count));
+
+			for (size_type i = sz; i > 0; --i)
+				detail::destroy<T>(d[i - 1]);
+		}
+
+		_size = 0;
+	}
+
+	/*
+	 * Opens a gap of `count` elements at `idx` and fills it with
+	 * `construct`, which has to create exactly `count` elements at
+	 * the given address.
+	 *
+	 * If the storage has to grow, the new elements are created first,
+	 * so they may safely refer to the old storage. Otherwise the
+	 * elements following `idx` are shifted in place, which costs a
+	 * single undo log entry covering everything from `idx` to the new
+	 * end.
+	 */
+	template <typename Construct>
+	void
+	internal_insert(size_type idx, size_type count, Construct construct)
+	{
+		if (count == 0)
+			return;
+
+		size_type sz = _size;
+
+		if (sz + count > _capacity) {
+			persistent_ptr<T[]> old = _data;
+
+			alloc(grow_capacity(sz + count));
+
+			T *d = _data.get();
+			construct(d + idx);
+			relocate(d, old, 0, idx);
+			relocate(d + idx + count, old, idx, sz - idx);
+			free_storage(old, sz);
+		} else {
+			T *d = _data.get();
+
+			snapshot_data(idx, sz + count);
+
+			for (size_type i = sz; i > idx; --i) {
+				detail::create<T>(d + i - 1 + count,
+						  std::move(d[i - 1]));
+				detail::destroy<T>(d[i - 1]);
+			}
+
+			construct(d + idx);
+		}
+
+		_size = sz + count;
+	}
+
+	persistent_ptr<T[]> _data;
+	p<size_type> _size;
+	p<size_type> _capacity;
+};
+
+/**
+ * Equality operator.
+ */
+template <typename T>
+inline bool
+operator==(const vector<T> &lhs, const vector<T> &rhs)
+{
+	return lhs.size() == rhs.size() &&
+		std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin());
+}
+
+/**
+ * Inequality operator.
+ */
+template <typename T>
+inline bool
+operator!=(const vector<T> &lhs, const vector<T> &rhs)
+{
+	return !(lhs == rhs);
+}
+
+/**
+ * Less than operator, compares the vectors lexicographically.
+ */
+template <typename T>
+inline bool
+operator<(const vector<T> &lhs, const vector<T> &rhs)
+{
+	return std::lexicographical_compare(lhs.cbegin(), lhs.cend(),
+					    rhs.cbegin(), rhs.cend());
+}
+
+/**
+ * Less or equal operator.
+ */
+template <typename T>
+inline bool
+operator<=(const vector<T> &lhs, const vector<T> &rhs)
+{
+	return !(rhs < lhs);
+}
+
+/**
+ * Greater than operator.
+ */
+template <typename T>
+inline bool
+operator>(const vector<T> &lhs, const vector<T> &rhs)
+{
+	return rhs < lhs;
+}
+
+/**
+ * Greater or equal operator.
+ */
+template <typename T>
+inline bool
+operator>=(const vector<T> &lhs, const vector<T> &rhs)
+{
+	return !(lhs < rhs);
+}
+
+/**
+ * Swaps the contents of two vectors.
+ *
+ * Non-member swap function as required by Swappable concept.
+ */
+template <typename T>
+inline void
+swap(vector<T> &lhs, vector<T> &rhs)
+{
+	lhs.swap(rhs);
+}
+
+} /* namespace obj */
+
+} /* namespace nvml */
+
+#endif /* PMEMOBJ_VECTOR_HPP */
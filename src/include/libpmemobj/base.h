@@ -101,9 +101,35 @@ static const PMEMoid OID_NULL = { 0, 0 };
 PMEMobjpool *pmemobj_pool_by_ptr(const void *addr);
 PMEMobjpool *pmemobj_pool_by_oid(PMEMoid oid);
 
+/*
+ * Per-thread cache of the pools the object handles were recently translated
+ * for. It is a two-way set associative cache indexed by the pool uuid, so that
+ * a thread using objects from a few pools at a time does not have to look up
+ * the pool on every translation.
+ */
+#define _POBJ_PCACHE_NSETS 8
+#define _POBJ_PCACHE_NWAYS 2
+
+struct _pobj_pcache_entry {
+	uint64_t uuid_lo;
+	PMEMobjpool *pop;
+};
+
+struct _pobj_pcache_tab {
+	int invalidate;
+	struct _pobj_pcache_entry
+		entries[_POBJ_PCACHE_NSETS * _POBJ_PCACHE_NWAYS];
+};
+
 #ifndef _WIN32
 
 extern int _pobj_cache_invalidate;
+extern __thread struct _pobj_pcache_tab _pobj_cached_pools;
+
+/*
+ * single-entry cache used by the binaries built against older versions of
+ * this header
+ */
 extern __thread struct _pobj_pcache {
 	PMEMobjpool *pop;
 	uint64_t uuid_lo;
@@ -119,20 +145,33 @@ pmemobj_direct_inline(PMEMoid oid)
 	if (oid.off == 0 || oid.pool_uuid_lo == 0)
 		return NULL;
 
-	struct _pobj_pcache *cache = &_pobj_cached_pool;
-	if (_pobj_cache_invalidate != cache->invalidate ||
-			cache->uuid_lo != oid.pool_uuid_lo) {
+	struct _pobj_pcache_tab *cache = &_pobj_cached_pools;
+	struct _pobj_pcache_entry *e = &cache->entries[
+		(oid.pool_uuid_lo % _POBJ_PCACHE_NSETS) * _POBJ_PCACHE_NWAYS];
+
+	if (_pobj_cache_invalidate == cache->invalidate) {
+		if (e[0].uuid_lo == oid.pool_uuid_lo)
+			return (void *)((uintptr_t)e[0].pop + oid.off);
+		if (e[1].uuid_lo == oid.pool_uuid_lo)
+			return (void *)((uintptr_t)e[1].pop + oid.off);
+	} else {
+		/* some pool has been closed, forget all of them */
+		for (int i = 0; i < _POBJ_PCACHE_NSETS * _POBJ_PCACHE_NWAYS;
+				++i)
+			cache->entries[i].uuid_lo = 0;
 		cache->invalidate = _pobj_cache_invalidate;
+	}
 
-		if (!(cache->pop = pmemobj_pool_by_oid(oid))) {
-			cache->uuid_lo = 0;
-			return NULL;
-		}
+	PMEMobjpool *pop = pmemobj_pool_by_oid(oid);
+	if (pop == NULL)
+		return NULL;
 
-		cache->uuid_lo = oid.pool_uuid_lo;
-	}
+	/* the older entry of the set is evicted */
+	e[1] = e[0];
+	e[0].uuid_lo = oid.pool_uuid_lo;
+	e[0].pop = pop;
 
-	return (void *)((uintptr_t)cache->pop + oid.off);
+	return (void *)((uintptr_t)pop + oid.off);
 }
 
 #endif /* _WIN32 */
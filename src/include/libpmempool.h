@@ -50,6 +50,7 @@
 #define pmempool_check pmempool_checkW
 #define pmempool_sync pmempool_syncW
 #define pmempool_transform pmempool_transformW
+#define pmempool_scrub pmempool_scrubW
 #define pmempool_rm pmempool_rmW
 #define pmempool_check_version pmempool_check_versionW
 #define pmempool_errormsg pmempool_errormsgW
@@ -61,6 +62,7 @@
 #define pmempool_check pmempool_checkU
 #define pmempool_sync pmempool_syncU
 #define pmempool_transform pmempool_transformU
+#define pmempool_scrub pmempool_scrubU
 #define pmempool_rm pmempool_rmU
 #define pmempool_check_version pmempool_check_versionU
 #define pmempool_errormsg pmempool_errormsgU
@@ -85,6 +87,28 @@ extern "C" {
 #define PMEMPOOL_DRY_RUN (1 << 1)
 
 
+/* PMEMPOOL SYNC */
+
+/*
+ * compare the data with the healthy replica before writing it and write only
+ * the regions which differ
+ */
+#define PMEMPOOL_SYNC_COMPARE (1 << 2)
+
+
+/* PMEMPOOL SCRUB */
+
+/*
+ * repair the damaged data from the replicas holding the valid data
+ */
+#define PMEMPOOL_SCRUB_REPAIR (1 << 3)
+
+/*
+ * record the checksums of the data of the master replica
+ */
+#define PMEMPOOL_SCRUB_UPDATE (1 << 4)
+
+
 /* PMEMPOOL CHECK */
 
 /*
@@ -266,6 +290,36 @@ int pmempool_transformW(const wchar_t *poolset_file_src,
 	const wchar_t *poolset_file_dst, unsigned flags);
 #endif
 
+/*
+ * LIBPMEMPOOL SCRUB
+ */
+
+/*
+ * Statistics of a scrub
+ */
+struct pmempool_scrub_stats {
+	uint64_t nregions;	/* number of checked regions */
+	uint64_t nbad;		/* number of damaged regions */
+	uint64_t nrepaired;	/* number of repaired regions */
+	uint64_t nupdated;	/* number of regions with updated checksums */
+};
+
+/*
+ * Verify the pool data against the recorded checksums, reading at most rate
+ * bytes per second (unlimited if 0).
+ *
+ * EXPERIMENTAL
+ */
+#ifndef _WIN32
+int pmempool_scrub(const char *path, size_t rate, unsigned flags,
+	struct pmempool_scrub_stats *stats);
+#else
+int pmempool_scrubU(const char *path, size_t rate, unsigned flags,
+	struct pmempool_scrub_stats *stats);
+int pmempool_scrubW(const wchar_t *path, size_t rate, unsigned flags,
+	struct pmempool_scrub_stats *stats);
+#endif
+
 /* PMEMPOOL RM */
 #ifndef _WIN32
 int pmempool_rm(const char *path, int flags);
@@ -82,8 +82,13 @@ int rpmem_close(RPMEMpool *rpp);
 
 int rpmem_persist(RPMEMpool *rpp, size_t offset, size_t length,
 		unsigned lane);
+int rpmem_flush(RPMEMpool *rpp, size_t offset, size_t length,
+		unsigned lane);
+int rpmem_drain(RPMEMpool *rpp, unsigned lane);
 int rpmem_read(RPMEMpool *rpp, void *buff, size_t offset, size_t length,
 		unsigned lane);
+int rpmem_register(RPMEMpool *rpp, void *buff, size_t length);
+int rpmem_unregister(RPMEMpool *rpp, void *buff);
 
 #define RPMEM_REMOVE_FORCE 0x1
 #define RPMEM_REMOVE_POOL_SET 0x2
@@ -97,7 +102,7 @@ int rpmem_remove(const char *target, const char *pool_set, int flags);
  * at compile-time by passing these defines to rpmem_check_version().
  */
 #define RPMEM_MAJOR_VERSION 1
-#define RPMEM_MINOR_VERSION 1
+#define RPMEM_MINOR_VERSION 2
 const char *rpmem_check_version(unsigned major_required,
 		unsigned minor_required);
 
@@ -44,10 +44,14 @@
 #ifdef _WIN32
 #ifndef NVML_UTF8_API
 #define vmem_create vmem_createW
+#define vmem_create_growable vmem_create_growableW
+#define vmem_create_ex vmem_create_exW
 #define vmem_check_version vmem_check_versionW
 #define vmem_errormsg vmem_errormsgW
 #else
 #define vmem_create vmem_createU
+#define vmem_create_growable vmem_create_growableU
+#define vmem_create_ex vmem_create_exU
 #define vmem_check_version vmem_check_versionU
 #define vmem_errormsg vmem_errormsgU
 #endif
@@ -68,23 +72,63 @@ typedef struct vmem VMEM;	/* opaque type internal to libvmem */
 
 #define VMEM_MIN_POOL ((size_t)(1024 * 1024 * 14)) /* min pool size: 14MB */
 
+/* flags for struct vmem_attr */
+#define VMEM_ARENA_PER_CPU	(1U << 0) /* choose arenas by the CPU */
+#define VMEM_NO_TCACHE		(1U << 1) /* do not use thread caches */
+
+/*
+ * attributes of a memory pool, a zeroed structure stands for the defaults
+ */
+struct vmem_attr {
+	unsigned narenas;	/* number of arenas */
+	size_t tcache_max;	/* largest size of objects cached by threads */
+	unsigned flags;		/* VMEM_ARENA_PER_CPU, VMEM_NO_TCACHE */
+	size_t hugepage_size;	/* huge page size to align the pool to */
+};
+
+/*
+ * summary statistics of a memory pool
+ */
+struct vmem_stats {
+	size_t allocated;	/* bytes allocated by the application */
+	size_t active;		/* bytes in the pages used by the allocations */
+	size_t mapped;		/* bytes in the chunks used by the allocator */
+	unsigned narenas;	/* number of arenas */
+	size_t pagesize;	/* size of the pages backing the pool */
+};
+
 #ifndef _WIN32
 VMEM *vmem_create(const char *dir, size_t size);
+VMEM *vmem_create_growable(const char *dir, size_t size, size_t max_size,
+		size_t grow_size);
+VMEM *vmem_create_ex(const char *dir, size_t size,
+		const struct vmem_attr *attr);
 #else
 VMEM *vmem_createU(const char *dir, size_t size);
 VMEM *vmem_createW(const wchar_t *dir, size_t size);
+VMEM *vmem_create_growableU(const char *dir, size_t size, size_t max_size,
+		size_t grow_size);
+VMEM *vmem_create_growableW(const wchar_t *dir, size_t size, size_t max_size,
+		size_t grow_size);
+VMEM *vmem_create_exU(const char *dir, size_t size,
+		const struct vmem_attr *attr);
+VMEM *vmem_create_exW(const wchar_t *dir, size_t size,
+		const struct vmem_attr *attr);
 #endif
 
 VMEM *vmem_create_in_region(void *addr, size_t size);
 void vmem_delete(VMEM *vmp);
 int vmem_check(VMEM *vmp);
 void vmem_stats_print(VMEM *vmp, const char *opts);
+int vmem_stats_get(VMEM *vmp, struct vmem_stats *stats);
 
 /*
  * support for malloc and friends...
  */
 void *vmem_malloc(VMEM *vmp, size_t size);
 void vmem_free(VMEM *vmp, void *ptr);
+size_t vmem_malloc_batch(VMEM *vmp, size_t size, size_t n, void *ptrs[]);
+void vmem_free_batch(VMEM *vmp, void *ptrs[], size_t n);
 void *vmem_calloc(VMEM *vmp, size_t nmemb, size_t size);
 void *vmem_realloc(VMEM *vmp, void *ptr, size_t size);
 void *vmem_aligned_alloc(VMEM *vmp, size_t alignment, size_t size);
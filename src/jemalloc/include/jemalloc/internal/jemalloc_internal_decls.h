@@ -17,6 +17,9 @@
 #  endif
 #  include <pthread.h>
 #  include <errno.h>
+#  ifdef JEMALLOC_HAVE_SCHED_GETCPU
+#    include <sched.h>
+#  endif
 #endif
 #include <sys/types.h>
 
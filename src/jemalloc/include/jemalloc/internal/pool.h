@@ -58,6 +58,13 @@ struct pool_s {
 	unsigned narenas_total;
 	unsigned narenas_auto;
 
+	/* Choose arenas for threads by the CPU they run on. */
+	bool		arena_per_cpu;
+	/* Thread caches are not used for this pool. */
+	bool		tcache_disabled;
+	/* Largest size class cached in the thread caches of this pool. */
+	size_t		tcache_maxclass;
+
 	/* Tree of chunks that are stand-alone huge allocations. */
 	extent_tree_t	huge;
 	/* Protects chunk-related data structures. */
@@ -106,6 +113,14 @@ struct pool_s {
 
 	/* List of memory ranges inside pool, useful for pool_check(). */
 	pool_memory_range_node_t *memory_range_list;
+
+	/*
+	 * Optional callback used to add more memory to a custom pool (by
+	 * pool_extend()) when none of the existing chunks can satisfy
+	 * a chunk allocation.  Returns 0 if the pool has been extended.
+	 */
+	int (*grow)(pool_t *pool, size_t size, void *arg);
+	void *grow_arg;
 };
 
 struct tsd_pool_s {
@@ -126,7 +141,7 @@ struct tsd_pool_s {
 /******************************************************************************/
 #ifdef JEMALLOC_H_EXTERNS
 
-bool pool_new(pool_t *pool, unsigned pool_id);
+bool pool_new(pool_t *pool, unsigned pool_id, const pool_attr_t *attr);
 void pool_destroy(pool_t *pool);
 
 extern malloc_mutex_t	pools_lock;
@@ -241,6 +241,8 @@ tcache_get(pool_t *pool, bool create)
 		return (NULL);
 	if (config_lazy_lock && isthreaded == false)
 		return (NULL);
+	if (pool->tcache_disabled)
+		return (NULL);
 
 	tsd = tcache_tsd_get();
 
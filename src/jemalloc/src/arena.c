@@ -1747,6 +1747,60 @@ arena_malloc_small(arena_t *arena, size_t size, bool zero)
 	return (ret);
 }
 
+/*
+ * Allocate up to n regions of the same small size class, taking the bin lock
+ * only once.  Returns the number of regions allocated.
+ */
+size_t
+arena_malloc_small_batch(arena_t *arena, size_t size, size_t n, void **ptrs)
+{
+	void *ret;
+	arena_bin_t *bin;
+	arena_run_t *run;
+	size_t binind, i, j;
+
+	if (arena == NULL)
+		return (0);
+
+	binind = small_size2bin(size);
+	assert(binind < NBINS);
+	bin = &arena->bins[binind];
+	size = small_bin2size(binind);
+
+	malloc_mutex_lock(&bin->lock);
+	for (i = 0; i < n; i++) {
+		if ((run = bin->runcur) != NULL && run->nfree > 0)
+			ret = arena_run_reg_alloc(run, &arena_bin_info[binind]);
+		else
+			ret = arena_bin_malloc_hard(arena, bin);
+		if (ret == NULL)
+			break;
+		ptrs[i] = ret;
+	}
+	if (config_stats) {
+		bin->stats.allocated += i * size;
+		bin->stats.nmalloc += i;
+		bin->stats.nrequests += i;
+	}
+	malloc_mutex_unlock(&bin->lock);
+	if (config_prof && isthreaded == false && arena_prof_accum(arena,
+	    i * size))
+		prof_idump();
+
+	for (j = 0; j < i; j++) {
+		if (config_fill) {
+			if (opt_junk) {
+				arena_alloc_junk_small(ptrs[j],
+				    &arena_bin_info[binind], false);
+			} else if (opt_zero)
+				memset(ptrs[j], 0, size);
+		}
+		JEMALLOC_VALGRIND_MAKE_MEM_UNDEFINED(ptrs[j], size);
+	}
+
+	return (i);
+}
+
 void *
 arena_malloc_large(arena_t *arena, size_t size, bool zero)
 {
@@ -2029,6 +2083,50 @@ arena_dalloc_small(arena_t *arena, arena_chunk_t *chunk, void *ptr,
 	arena_dalloc_bin(arena, chunk, ptr, pageind, mapelm);
 }
 
+/*
+ * Deallocate the leading regions of ptrs[] which belong to the same arena bin
+ * as ptrs[0], taking the bin lock only once.  ptrs[0] must point to a small
+ * region.  Returns the number of regions deallocated.
+ */
+size_t
+arena_dalloc_small_batch(void **ptrs, size_t n)
+{
+	arena_chunk_t *chunk;
+	arena_t *arena;
+	arena_bin_t *bin;
+	size_t pageind, mapbits, binind, i;
+
+	assert(n > 0);
+	chunk = (arena_chunk_t *)CHUNK_ADDR2BASE(ptrs[0]);
+	assert(chunk != ptrs[0]);
+	arena = chunk->arena;
+	pageind = ((uintptr_t)ptrs[0] - (uintptr_t)chunk) >> LG_PAGE;
+	binind = arena_ptr_small_binind_get(ptrs[0], arena_mapbits_get(chunk,
+	    pageind));
+	bin = &arena->bins[binind];
+
+	malloc_mutex_lock(&bin->lock);
+	for (i = 0; i < n; i++) {
+		void *ptr = ptrs[i];
+
+		if (ptr == NULL)
+			break;
+		chunk = (arena_chunk_t *)CHUNK_ADDR2BASE(ptr);
+		if (chunk == ptr || chunk->arena != arena)
+			break;
+		pageind = ((uintptr_t)ptr - (uintptr_t)chunk) >> LG_PAGE;
+		mapbits = arena_mapbits_get(chunk, pageind);
+		if ((mapbits & CHUNK_MAP_LARGE) != 0 ||
+		    arena_ptr_small_binind_get(ptr, mapbits) != binind)
+			break;
+		arena_dalloc_bin_locked(arena, chunk, ptr,
+		    arena_mapp_get(chunk, pageind));
+	}
+	malloc_mutex_unlock(&bin->lock);
+
+	return (i);
+}
+
 #ifdef JEMALLOC_JET
 #undef arena_dalloc_junk_large
 #define	arena_dalloc_junk_large JEMALLOC_N(arena_dalloc_junk_large_impl)
@@ -249,10 +249,23 @@ chunk_alloc_default(void *new_addr, size_t size, size_t alignment, bool *zero,
     unsigned arena_ind, pool_t *pool)
 {
 	if (pool->pool_id != 0) {
+		void *ret;
+
 		/* Custom pools can only use existing chunks. */
-		return (chunk_recycle(pool, &pool->chunks_szad_mmap,
-				     &pool->chunks_ad_mmap, new_addr, size,
-				     alignment, false, zero));
+		while ((ret = chunk_recycle(pool, &pool->chunks_szad_mmap,
+		    &pool->chunks_ad_mmap, new_addr, size, alignment, false,
+		    zero)) == NULL) {
+			/*
+			 * Ask the owner of the pool for more memory. The size
+			 * requested covers the alignment of the chunk and the
+			 * base allocator space used by pool_extend().
+			 */
+			if (new_addr != NULL || pool->grow == NULL ||
+			    pool->grow(pool, size + alignment + chunksize,
+			    pool->grow_arg) != 0)
+				break;
+		}
+		return (ret);
 	} else {
 		malloc_rwlock_rdlock(&pool->arenas_lock);
 		dss_prec_t dss_prec = pool->arenas[arena_ind]->dss_prec;
@@ -170,8 +170,29 @@ choose_arena_hard(pool_t *pool)
 {
 	arena_t *ret;
 	tsd_pool_t *tsd;
+#ifdef JEMALLOC_HAVE_SCHED_GETCPU
+	int cpu;
+#endif
+
+	if (pool->narenas_auto > 1 && pool->arena_per_cpu) {
+		unsigned choose = 0;
 
-	if (pool->narenas_auto > 1) {
+#ifdef JEMALLOC_HAVE_SCHED_GETCPU
+		/*
+		 * Threads running on the same CPU share an arena, so that
+		 * the arena locks are contended only by threads which compete
+		 * for the same CPU anyway.
+		 */
+		if ((cpu = sched_getcpu()) >= 0)
+			choose = (unsigned)cpu % pool->narenas_auto;
+#endif
+		malloc_rwlock_wrlock(&pool->arenas_lock);
+		ret = pool->arenas[choose];
+		if (ret == NULL)
+			ret = arenas_extend(pool, choose);
+		ret->nthreads++;
+		malloc_rwlock_unlock(&pool->arenas_lock);
+	} else if (pool->narenas_auto > 1) {
 		unsigned i, choose, first_null;
 
 		choose = 0;
@@ -229,6 +250,45 @@ choose_arena_hard(pool_t *pool)
 	return (ret);
 }
 
+/*
+ * Retry an allocation which failed in the arena of the calling thread in the
+ * other arenas of the pool.  A pool backed by a fixed memory range runs out of
+ * free chunks long before it is full when it has many arenas, e.g. one per
+ * CPU, and an arena which does not own a chunk with free runs yet cannot
+ * allocate anything even if the other arenas still have plenty of space.
+ */
+void *
+pool_ialloc_fallback(pool_t *pool, size_t size, size_t alignment, bool zero)
+{
+	arena_t *arena;
+	unsigned i;
+	void *ret;
+
+	/* huge objects are allocated directly from the pool chunks */
+	if (size > arena_maxclass)
+		return (NULL);
+
+	for (i = 0; ; i++) {
+		malloc_rwlock_rdlock(&pool->arenas_lock);
+		if (i >= pool->narenas_total || pool->narenas_total == 1) {
+			malloc_rwlock_unlock(&pool->arenas_lock);
+			return (NULL);
+		}
+		arena = pool->arenas[i];
+		malloc_rwlock_unlock(&pool->arenas_lock);
+
+		if (arena == NULL)
+			continue;
+
+		if (alignment == 0)
+			ret = arena_malloc(arena, size, zero, false);
+		else
+			ret = ipalloct(size, alignment, zero, false, arena);
+		if (ret != NULL)
+			return (ret);
+	}
+}
+
 static void
 stats_print_atexit(void)
 {
@@ -401,7 +461,7 @@ malloc_init_base_pool(void)
 		return (true);
 	}
 
-	if (pool_new(&base_pool, 0)) {
+	if (pool_new(&base_pool, 0, NULL)) {
 		malloc_mutex_unlock(&pool_base_lock);
 		return (true);
 	}
@@ -1504,6 +1564,18 @@ void pools_shared_data_destroy(void)
 
 pool_t *
 je_pool_create(void *addr, size_t size, int zeroed)
+{
+
+	return (je_pool_create_ex(addr, size, zeroed, NULL));
+}
+
+/*
+ * create a pool with the given attributes, NULL attributes stand for
+ * the defaults
+ */
+pool_t *
+je_pool_create_ex(void *addr, size_t size, int zeroed,
+	const pool_attr_t *attr)
 {
 	if (malloc_init())
 		return (NULL);
@@ -1567,7 +1639,7 @@ je_pool_create(void *addr, size_t size, int zeroed)
 	pool->base_past_addr = (void *)((uintptr_t)addr + size);
 
 	/* prepare pool and internal structures */
-	if (pool_new(pool, pool_id)) {
+	if (pool_new(pool, pool_id, attr)) {
 		assert(pools[pool_id] == NULL);
 		malloc_mutex_unlock(&pools_lock);
 		pools_shared_data_destroy();
@@ -1894,6 +1966,102 @@ je_pool_check(pool_t *pool)
 	return 1;
 }
 
+/* data structure for callback used in je_pool_free_chunks_iter() */
+typedef struct {
+	void (*cb)(void *addr, size_t size, void *arg);
+	void *arg;
+} free_chunks_cb_t;
+
+static extent_node_t *
+free_chunks_tree_iter_cb(extent_tree_t *tree, extent_node_t *node, void *arg)
+{
+	free_chunks_cb_t *arg_cb = arg;
+
+	arg_cb->cb(node->addr, node->size, arg_cb->arg);
+
+	/* return NULL to continue iterations of tree */
+	return (NULL);
+}
+
+/*
+ * walk the free chunks of a pool in the order of their addresses
+ *
+ * No locks are acquired, so the caller has to make sure the pool is not
+ * modified concurrently, e.g. by calling it from a fork handler, after
+ * all the jemalloc locks were acquired by the prefork handler.
+ */
+void
+je_pool_free_chunks_iter(pool_t *pool,
+	void (*cb)(void *addr, size_t size, void *arg), void *arg)
+{
+	free_chunks_cb_t arg_cb;
+	arg_cb.cb = cb;
+	arg_cb.arg = arg;
+
+	extent_tree_ad_iter(&pool->chunks_ad_mmap, NULL,
+		free_chunks_tree_iter_cb, &arg_cb);
+}
+
+/*
+ * get the summary statistics of the pool
+ *
+ * Returns 0 on success, or an error number as mallctl() does.
+ */
+int
+je_pool_stats_get(pool_t *pool, pool_stats_t *stats)
+{
+	char name[64];
+	uint64_t epoch = 1;
+	size_t sz = sizeof (epoch);
+	int err;
+
+	if (config_stats == false)
+		return (ENOENT);
+
+	/* refresh the statistics */
+	if ((err = je_mallctl("epoch", &epoch, &sz, &epoch, sz)) != 0)
+		return (err);
+
+	sz = sizeof (size_t);
+	malloc_snprintf(name, sizeof (name), "pool.%u.stats.allocated",
+		pool->pool_id);
+	if ((err = je_mallctl(name, &stats->allocated, &sz, NULL, 0)) != 0)
+		return (err);
+
+	malloc_snprintf(name, sizeof (name), "pool.%u.stats.active",
+		pool->pool_id);
+	if ((err = je_mallctl(name, &stats->active, &sz, NULL, 0)) != 0)
+		return (err);
+
+	malloc_snprintf(name, sizeof (name), "pool.%u.stats.mapped",
+		pool->pool_id);
+	if ((err = je_mallctl(name, &stats->mapped, &sz, NULL, 0)) != 0)
+		return (err);
+
+	malloc_rwlock_rdlock(&pool->arenas_lock);
+	stats->narenas = pool->narenas_total;
+	malloc_rwlock_unlock(&pool->arenas_lock);
+
+	return (0);
+}
+
+/*
+ * set the callback used to grow the pool when it runs out of chunks
+ *
+ * The callback is called without any of the pool locks held and is expected
+ * to add at least 'size' bytes of memory to the pool using pool_extend().
+ * Base allocations (pool metadata) never trigger the callback.
+ */
+void
+je_pool_set_grow_func(pool_t *pool,
+	int (*grow)(pool_t *pool, size_t size, void *arg), void *arg)
+{
+	malloc_mutex_lock(&pool->chunks_mtx);
+	pool->grow = grow;
+	pool->grow_arg = arg;
+	malloc_mutex_unlock(&pool->chunks_mtx);
+}
+
 /*
  * add more memory to a pool
  */
@@ -2355,6 +2523,96 @@ je_pool_free(pool_t *pool, void *ptr)
 		pool_ifree(pool, ptr);
 }
 
+/*
+ * The batch variants of pool_malloc() and pool_free() bypass the per-object
+ * hooks, so they fall back to the regular functions when any of them is
+ * enabled.
+ */
+JEMALLOC_ALWAYS_INLINE_C bool
+pool_batch_slow(void)
+{
+
+	return ((config_prof && opt_prof) || (config_fill && opt_quarantine) ||
+	    (config_valgrind && in_valgrind) || (config_utrace && opt_utrace));
+}
+
+/*
+ * allocate up to n objects of the same size, returns the number of objects
+ * allocated
+ */
+size_t
+je_pool_malloc_batch(pool_t *pool, size_t size, size_t n, void **ptrs)
+{
+	size_t i = 0;
+
+	if (malloc_init())
+		return (0);
+
+	if (size == 0)
+		size = 1;
+
+	if (size <= SMALL_MAXCLASS && pool_batch_slow() == false) {
+		arena_t dummy;
+		DUMMY_ARENA_INITIALIZE(dummy, pool);
+
+		i = arena_malloc_small_batch(choose_arena(&dummy), size, n,
+			ptrs);
+		if (config_stats)
+			thread_allocated_tsd_get()->allocated += i * s2u(size);
+	}
+
+	/* large objects, or whatever the arena bin could not provide */
+	for (; i < n; i++) {
+		if ((ptrs[i] = je_pool_malloc(pool, size)) == NULL)
+			break;
+	}
+
+	return (i);
+}
+
+/*
+ * free n objects, taking each arena bin lock once for all the consecutive
+ * objects which belong to the bin
+ */
+void
+je_pool_free_batch(pool_t *pool, void **ptrs, size_t n)
+{
+	size_t i = 0;
+
+	if (pool_batch_slow()) {
+		for (; i < n; i++)
+			je_pool_free(pool, ptrs[i]);
+		return;
+	}
+
+	while (i < n) {
+		void *ptr = ptrs[i];
+		arena_chunk_t *chunk;
+		size_t usize JEMALLOC_CC_SILENCE_INIT(0);
+		size_t nfreed;
+
+		if (ptr == NULL) {
+			i++;
+			continue;
+		}
+
+		chunk = (arena_chunk_t *)CHUNK_ADDR2BASE(ptr);
+		if (chunk == ptr || (arena_mapbits_get(chunk, ((uintptr_t)ptr -
+		    (uintptr_t)chunk) >> LG_PAGE) & CHUNK_MAP_LARGE) != 0) {
+			pool_ifree(pool, ptr);
+			i++;
+			continue;
+		}
+
+		if (config_stats)
+			usize = isalloc(ptr, config_prof);
+		nfreed = arena_dalloc_small_batch(&ptrs[i], n - i);
+		if (config_stats)
+			thread_allocated_tsd_get()->deallocated += nfreed * usize;
+		i += nfreed;
+	}
+}
+
 void
 je_pool_malloc_stats_print(pool_t *pool,
 				void (*write_cb)(void *, const char *),
@@ -5,7 +5,7 @@ malloc_mutex_t	pool_base_lock;
 malloc_mutex_t	pools_lock;
 
 /* Initialize pool and create its base arena. */
-bool pool_new(pool_t *pool, unsigned pool_id)
+bool pool_new(pool_t *pool, unsigned pool_id, const pool_attr_t *attr)
 {
 	pool->pool_id = pool_id;
 
@@ -40,6 +40,18 @@ bool pool_new(pool_t *pool, unsigned pool_id)
 	pool->ctl_stats_mapped = 0;
 
 	pool->narenas_auto = opt_narenas;
+	pool->arena_per_cpu = false;
+	pool->tcache_disabled = false;
+	pool->tcache_maxclass = tcache_maxclass;
+
+	if (attr != NULL) {
+		if (attr->narenas != 0)
+			pool->narenas_auto = attr->narenas;
+		pool->arena_per_cpu = attr->arena_per_cpu != 0;
+		pool->tcache_disabled = attr->tcache_disable != 0;
+		if (attr->tcache_max != 0 && attr->tcache_max < tcache_maxclass)
+			pool->tcache_maxclass = attr->tcache_max;
+	}
 	/*
 	 * Make sure that the arenas array can be allocated.  In practice, this
 	 * limit is enough to allow the allocator to function, but the ctl
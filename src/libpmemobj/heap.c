@@ -1335,73 +1335,16 @@ heap_verify_header(struct heap_header *hdr)
 	return 0;
 }
 
-/*
- * heap_verify_zone_header --
- *	(internal) verifies if the zone header is consistent
- */
-static int
-heap_verify_zone_header(struct zone_header *hdr)
-{
-	if (hdr->size_idx == 0) {
-		ERR("heap: invalid zone size");
-		return -1;
-	}
-
-	return 0;
-}
-
-/*
- * heap_verify_chunk_header --
- *	(internal) verifies if the chunk header is consistent
- */
-static int
-heap_verify_chunk_header(struct chunk_header *hdr)
-{
-	if (hdr->type == CHUNK_TYPE_UNKNOWN) {
-		ERR("heap: invalid chunk type");
-		return -1;
-	}
-
-	if (hdr->type >= MAX_CHUNK_TYPE) {
-		ERR("heap: unknown chunk type");
-		return -1;
-	}
-
-	if (hdr->flags & ~CHUNK_FLAGS_ALL_VALID) {
-		ERR("heap: invalid chunk flags");
-		return -1;
-	}
-
-	return 0;
-}
-
 /*
  * heap_verify_zone -- (internal) verifies if the zone is consistent
  */
 static int
-heap_verify_zone(struct zone *zone)
+heap_verify_zone(struct zone *zone, uint32_t max_chunks)
 {
-	if (zone->header.magic == 0)
-		return 0; /* not initialized, and that is OK */
-
-	if (zone->header.magic != ZONE_HEADER_MAGIC) {
-		ERR("heap: invalid zone magic");
-		return -1;
-	}
-
-	if (heap_verify_zone_header(&zone->header))
-		return -1;
-
-	uint32_t i;
-	for (i = 0; i < zone->header.size_idx; ) {
-		if (heap_verify_chunk_header(&zone->chunk_headers[i]))
-			return -1;
-
-		i += zone->chunk_headers[i].size_idx;
-	}
-
-	if (i != zone->header.size_idx) {
-		ERR("heap: chunk sizes mismatch");
+	uint32_t chunk;
+	const char *error = heap_zone_check(zone, max_chunks, &chunk);
+	if (error) {
+		ERR("heap: %s", error);
 		return -1;
 	}
 
@@ -1431,8 +1374,10 @@ heap_check(void *heap_start, uint64_t heap_size)
 	if (heap_verify_header(&layout->header))
 		return -1;
 
-	for (unsigned i = 0; i < heap_max_zone(layout->header.size); ++i) {
-		if (heap_verify_zone(ZID_TO_ZONE(layout, i)))
+	unsigned max_zone = heap_max_zone(layout->header.size);
+	for (unsigned i = 0; i < max_zone; ++i) {
+		if (heap_verify_zone(ZID_TO_ZONE(layout, i),
+				get_zone_size_idx(i, max_zone, heap_size)))
 			return -1;
 	}
 
@@ -1475,14 +1420,16 @@ heap_check_remote(void *heap_start, uint64_t heap_size, struct remote_ops *ops)
 		ERR("heap: zone_buff malloc error");
 		return -1;
 	}
-	for (unsigned i = 0; i < heap_max_zone(header.size); ++i) {
+	unsigned max_zone = heap_max_zone(header.size);
+	for (unsigned i = 0; i < max_zone; ++i) {
 		if (ops->read(ops->ctx, ops->base, zone_buff,
 				ZID_TO_ZONE(layout, i), sizeof(struct zone))) {
 			ERR("heap: obj_read_remote error");
 			goto out;
 		}
 
-		if (heap_verify_zone(zone_buff)) {
+		if (heap_verify_zone(zone_buff,
+				get_zone_size_idx(i, max_zone, heap_size))) {
 			goto out;
 		}
 	}
@@ -148,4 +148,55 @@ struct allocation_header_compact {
 	uint64_t extra;
 };
 
+#define ZONE_CHECK_NO_CHUNK UINT32_MAX
+
+/*
+ * heap_zone_check -- checks the zone header and the chunk headers of the zone,
+ *	returns NULL if they are consistent or the description of the first
+ *	inconsistency found
+ *
+ * The index of the chunk the inconsistency was found in is stored in *chunk,
+ * ZONE_CHECK_NO_CHUNK means the zone header itself is invalid. The zone may
+ * not span more than max_chunks chunks.
+ */
+static inline const char *
+heap_zone_check(const struct zone *zone, uint32_t max_chunks, uint32_t *chunk)
+{
+	*chunk = ZONE_CHECK_NO_CHUNK;
+
+	if (zone->header.magic == 0)
+		return NULL; /* not initialized, and that is OK */
+
+	if (zone->header.magic != ZONE_HEADER_MAGIC)
+		return "invalid zone magic";
+
+	if (zone->header.size_idx == 0 || zone->header.size_idx > max_chunks)
+		return "invalid zone size";
+
+	uint32_t i = 0;
+	while (i < zone->header.size_idx) {
+		const struct chunk_header *hdr = &zone->chunk_headers[i];
+		*chunk = i;
+
+		if (hdr->type == CHUNK_TYPE_UNKNOWN)
+			return "invalid chunk type";
+		if (hdr->type >= MAX_CHUNK_TYPE)
+			return "unknown chunk type";
+		if (hdr->flags & ~CHUNK_FLAGS_ALL_VALID)
+			return "invalid chunk flags";
+		if (hdr->size_idx == 0)
+			return "invalid chunk size";
+		if (hdr->size_idx > zone->header.size_idx - i)
+			break;
+
+		i += hdr->size_idx;
+	}
+
+	if (i != zone->header.size_idx)
+		return "chunk sizes mismatch";
+
+	*chunk = ZONE_CHECK_NO_CHUNK;
+	return NULL;
+}
+
 #endif
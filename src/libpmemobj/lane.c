@@ -189,6 +189,15 @@ lane_init(PMEMobjpool *pop, struct lane *lane, struct lane_layout *layout)
 	int i;
 	int oerrno;
 
+	lane->rep_queue = NULL;
+	if (pop->has_remote_replicas) {
+		lane->rep_queue = Zalloc(sizeof(*lane->rep_queue));
+		if (lane->rep_queue == NULL) {
+			ERR("!Zalloc of remote replica queue");
+			return -1;
+		}
+	}
+
 	for (i = 0; i < MAX_LANE_SECTION; ++i) {
 		lane->sections[i].layout = &layout->sections[i];
 		errno = 0;
@@ -204,6 +213,7 @@ error_section_construct:
 	oerrno = errno;
 	for (i = i - 1; i >= 0; --i)
 		Section_ops[i]->destroy_rt(pop, &lane->sections[i].runtime);
+	Free(lane->rep_queue);
 	errno = oerrno;
 	return -1;
 }
@@ -216,6 +226,47 @@ lane_destroy(PMEMobjpool *pop, struct lane *lane)
 {
 	for (int i = 0; i < MAX_LANE_SECTION; ++i)
 		Section_ops[i]->destroy_rt(pop, lane->sections[i].runtime);
+
+	Free(lane->rep_queue);
+}
+
+/*
+ * lane_rep_queue_coalesce -- extend the deferred ranges to whole cache lines,
+ *	sort and merge them
+ */
+void
+lane_rep_queue_coalesce(struct lane_rep_queue *q)
+{
+	struct lane_rep_range *r = q->ranges;
+
+	for (size_t i = 0; i < q->nranges; ++i) {
+		uintptr_t start = r[i].addr & ~(LANE_REP_ALIGN - 1);
+		uintptr_t end = (r[i].addr + r[i].len + LANE_REP_ALIGN - 1) &
+			~(LANE_REP_ALIGN - 1);
+
+		/* insertion sort, the queue is short and mostly ordered */
+		size_t j = i;
+		for (; j > 0 && r[j - 1].addr > start; --j)
+			r[j] = r[j - 1];
+
+		r[j].addr = start;
+		r[j].len = end - start;
+	}
+
+	size_t n = 0;
+	for (size_t i = 1; i < q->nranges; ++i) {
+		uintptr_t end = r[n].addr + r[n].len;
+		if (r[i].addr <= end) {
+			uintptr_t iend = r[i].addr + r[i].len;
+			if (iend > end)
+				r[n].len = iend - r[n].addr;
+		} else {
+			r[++n] = r[i];
+		}
+	}
+
+	if (q->nranges != 0)
+		q->nranges = n + 1;
 }
 
 /*
@@ -520,6 +571,12 @@ lane_release(PMEMobjpool *pop)
 	if (unlikely(lane->nest_count == 0)) {
 		FATAL("lane_release");
 	} else if (--(lane->nest_count) == 0) {
+		struct lane_rep_queue *q =
+			pop->lanes_desc.lane[lane->lane_idx].rep_queue;
+		/* send what was deferred for the remote replicas */
+		if (q != NULL && q->nranges != 0)
+			obj_rep_sync_lane(pop, (unsigned)lane->lane_idx);
+
 		if (unlikely(!util_bool_compare_and_swap64(
 				&pop->lanes_desc.lane_locks[lane->lane_idx],
 				1, 0))) {
@@ -88,9 +88,37 @@ struct lane_layout {
 	struct lane_section_layout sections[MAX_LANE_SECTION];
 };
 
+/*
+ * Maximum number of ranges deferred for the remote replicas in a lane.
+ */
+#define LANE_REP_RANGES_MAX 64
+
+/*
+ * Deferred ranges are extended to this alignment before they are merged.
+ */
+#define LANE_REP_ALIGN ((uintptr_t)64)
+
+struct lane_rep_range {
+	uintptr_t addr;
+	size_t len;
+};
+
+/*
+ * Ranges flushed while the lane is held are not sent to the remote replicas
+ * right away. They are collected here, coalesced and sent on the next drain
+ * or when the lane is released.
+ */
+struct lane_rep_queue {
+	size_t nranges;
+	struct lane_rep_range ranges[LANE_REP_RANGES_MAX];
+};
+
 struct lane {
 	/* volatile state */
 	struct lane_section sections[MAX_LANE_SECTION];
+
+	/* NULL if the pool has no remote replicas */
+	struct lane_rep_queue *rep_queue;
 };
 
 struct lane_descriptor {
@@ -151,6 +179,8 @@ void lane_release(PMEMobjpool *pop);
 void lane_attach(PMEMobjpool *pop, unsigned lane);
 unsigned lane_detach(PMEMobjpool *pop);
 
+void lane_rep_queue_coalesce(struct lane_rep_queue *q);
+
 #ifndef _MSC_VER
 
 #define SECTION_PARM(n, ops)\
@@ -76,8 +76,23 @@ static struct ctree *pools_tree; /* tree used for searching by address */
 
 int _pobj_cache_invalidate;
 
+/*
+ * obj_pcache_forget -- (internal) remove the pool from the pool cache
+ */
+static void
+obj_pcache_forget(struct _pobj_pcache_tab *pcache, PMEMobjpool *pop)
+{
+	for (int i = 0; i < _POBJ_PCACHE_NSETS * _POBJ_PCACHE_NWAYS; ++i) {
+		if (pcache->entries[i].pop == pop) {
+			pcache->entries[i].pop = NULL;
+			pcache->entries[i].uuid_lo = 0;
+		}
+	}
+}
+
 #ifndef _WIN32
 
+__thread struct _pobj_pcache_tab _pobj_cached_pools;
 __thread struct _pobj_pcache _pobj_cached_pool;
 
 /*
@@ -100,12 +115,6 @@ pmemobj_direct(PMEMoid oid)
  * Need to verify that once we have the multi-threaded tests ported.
  */
 
-struct _pobj_pcache {
-	PMEMobjpool *pop;
-	uint64_t uuid_lo;
-	int invalidate;
-};
-
 static os_once_t Cached_pool_key_once = OS_ONCE_INIT;
 static os_tls_key_t Cached_pool_key;
 
@@ -129,29 +138,39 @@ pmemobj_direct(PMEMoid oid)
 	if (oid.off == 0 || oid.pool_uuid_lo == 0)
 		return NULL;
 
-	struct _pobj_pcache *pcache = os_tls_get(Cached_pool_key);
+	struct _pobj_pcache_tab *pcache = os_tls_get(Cached_pool_key);
 	if (pcache == NULL) {
-		pcache = Zalloc(sizeof(struct _pobj_pcache));
+		pcache = Zalloc(sizeof(struct _pobj_pcache_tab));
 		if (pcache == NULL)
 			FATAL("!pcache malloc");
+		pcache->invalidate = _pobj_cache_invalidate;
 		int ret = os_tls_set(Cached_pool_key, pcache);
 		if (ret)
 			FATAL("!os_tls_set");
 	}
 
-	if (_pobj_cache_invalidate != pcache->invalidate ||
-	    pcache->uuid_lo != oid.pool_uuid_lo) {
+	struct _pobj_pcache_entry *e = &pcache->entries[
+		(oid.pool_uuid_lo % _POBJ_PCACHE_NSETS) * _POBJ_PCACHE_NWAYS];
+
+	if (_pobj_cache_invalidate == pcache->invalidate) {
+		if (e[0].uuid_lo == oid.pool_uuid_lo)
+			return (void *)((uintptr_t)e[0].pop + oid.off);
+		if (e[1].uuid_lo == oid.pool_uuid_lo)
+			return (void *)((uintptr_t)e[1].pop + oid.off);
+	} else {
+		memset(pcache->entries, 0, sizeof(pcache->entries));
 		pcache->invalidate = _pobj_cache_invalidate;
+	}
 
-		if ((pcache->pop = pmemobj_pool_by_oid(oid)) == NULL) {
-			pcache->uuid_lo = 0;
-			return NULL;
-		}
+	PMEMobjpool *pop = pmemobj_pool_by_oid(oid);
+	if (pop == NULL)
+		return NULL;
 
-		pcache->uuid_lo = oid.pool_uuid_lo;
-	}
+	e[1] = e[0];
+	e[0].uuid_lo = oid.pool_uuid_lo;
+	e[0].pop = pop;
 
-	return (void *)((uintptr_t)pcache->pop + oid.off);
+	return (void *)((uintptr_t)pop + oid.off);
 }
 
 #endif /* _WIN32 */
@@ -366,6 +385,51 @@ obj_remote_persist(PMEMobjpool *pop, const void *addr, size_t len,
 	return (void *)addr;
 }
 
+/*
+ * obj_remote_flush -- (internal) post remote persist w/o waiting for it
+ */
+static int
+obj_remote_flush(PMEMobjpool *pop, const void *addr, size_t len,
+			unsigned lane)
+{
+	LOG(15, "pop %p addr %p len %zu lane %u", pop, addr, len, lane);
+
+	ASSERTne(pop->rpp, NULL);
+
+	uintptr_t offset = (uintptr_t)addr - pop->remote_base;
+
+	int rv = Rpmem_flush(pop->rpp, offset, len, lane);
+	if (rv) {
+		ERR("!rpmem_flush(rpp %p offset %zu length %zu lane %u)"
+			" FATAL ERROR (returned value %i)",
+			pop->rpp, offset, len, lane, rv);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * obj_remote_drain -- (internal) wait for the posted remote persist
+ */
+static int
+obj_remote_drain(PMEMobjpool *pop, unsigned lane)
+{
+	LOG(15, "pop %p lane %u", pop, lane);
+
+	ASSERTne(pop->rpp, NULL);
+
+	int rv = Rpmem_drain(pop->rpp, lane);
+	if (rv) {
+		ERR("!rpmem_drain(rpp %p lane %u)"
+			" FATAL ERROR (returned value %i)",
+			pop->rpp, lane, rv);
+		return -1;
+	}
+
+	return 0;
+}
+
 /*
  * XXX - Consider removing obj_norep_*() wrappers to call *_local()
  * functions directly.  Alternatively, always use obj_rep_*(), even
@@ -450,6 +514,138 @@ obj_handle_remote_persist_error(PMEMobjpool *pop)
 	FATAL("Fatal error of remote persist. Aborting...");
 }
 
+/*
+ * obj_rep_post_remote -- (internal) post persist of the range to all
+ *                        remote replicas
+ */
+static void
+obj_rep_post_remote(PMEMobjpool *pop, uintptr_t addr, size_t len,
+	unsigned lane)
+{
+	PMEMobjpool *rep = pop->replica;
+	while (rep) {
+		if (rep->rpp != NULL) {
+			void *raddr = (char *)rep + addr - (uintptr_t)pop;
+			if (rep->flush_remote(rep, raddr, len, lane))
+				obj_handle_remote_persist_error(pop);
+		}
+		rep = rep->replica;
+	}
+}
+
+/*
+ * obj_rep_queue -- (internal) returns the remote replica queue of the lane
+ *
+ * There is no queue before the runtime lanes are initialized, the remote
+ * operations share RLANE_DEFAULT then and cannot be deferred.
+ */
+static inline struct lane_rep_queue *
+obj_rep_queue(PMEMobjpool *pop, unsigned lane)
+{
+	if (pop->lanes_desc.runtime_nlanes == 0)
+		return NULL;
+
+	return pop->lanes_desc.lane[lane].rep_queue;
+}
+
+/*
+ * obj_rep_queue_post -- (internal) post all deferred ranges of the lane
+ *                       to the remote replicas
+ */
+static void
+obj_rep_queue_post(PMEMobjpool *pop, struct lane_rep_queue *q, unsigned lane)
+{
+	lane_rep_queue_coalesce(q);
+
+	for (size_t i = 0; i < q->nranges; ++i)
+		obj_rep_post_remote(pop, q->ranges[i].addr, q->ranges[i].len,
+				lane);
+
+	q->nranges = 0;
+}
+
+static void obj_rep_drain_remote(PMEMobjpool *pop, unsigned lane);
+
+/*
+ * obj_rep_queue_add -- (internal) defer the range for the remote replicas
+ */
+static void
+obj_rep_queue_add(PMEMobjpool *pop, struct lane_rep_queue *q,
+	const void *addr, size_t len, unsigned lane)
+{
+	if (q->nranges == LANE_REP_RANGES_MAX) {
+		lane_rep_queue_coalesce(q);
+		if (q->nranges == LANE_REP_RANGES_MAX) {
+			obj_rep_queue_post(pop, q, lane);
+			obj_rep_drain_remote(pop, lane);
+		}
+	}
+
+	q->ranges[q->nranges].addr = (uintptr_t)addr;
+	q->ranges[q->nranges].len = len;
+	q->nranges++;
+}
+
+/*
+ * obj_rep_flush_remote -- (internal) post persist of the range, together
+ *                         with the ranges deferred in the lane, to all
+ *                         remote replicas
+ *
+ * The RMA operations stay in flight until obj_rep_drain_replicas, so that
+ * the local replicas can be written in the meantime.
+ */
+static void
+obj_rep_flush_remote(PMEMobjpool *pop, const void *addr, size_t len,
+	unsigned lane)
+{
+	struct lane_rep_queue *q = obj_rep_queue(pop, lane);
+	if (q == NULL) {
+		obj_rep_post_remote(pop, (uintptr_t)addr, len, lane);
+		return;
+	}
+
+	obj_rep_queue_add(pop, q, addr, len, lane);
+	obj_rep_queue_post(pop, q, lane);
+}
+
+/*
+ * obj_rep_drain_remote -- (internal) wait for the persists posted to
+ *                         the remote replicas
+ */
+static void
+obj_rep_drain_remote(PMEMobjpool *pop, unsigned lane)
+{
+	PMEMobjpool *rep = pop->replica;
+	while (rep) {
+		if (rep->rpp != NULL && rep->drain_remote(rep, lane))
+			obj_handle_remote_persist_error(pop);
+		rep = rep->replica;
+	}
+}
+
+/*
+ * obj_rep_drain_replicas -- (internal) drain the local replicas and wait
+ *                           for the remote ones
+ */
+static void
+obj_rep_drain_replicas(PMEMobjpool *pop, unsigned lane)
+{
+	drain_local_fn drained = NULL;
+
+	PMEMobjpool *rep = pop->replica;
+	while (rep) {
+		/* a single fence covers all pmem replicas */
+		if (rep->rpp == NULL && rep->drain_local != drained) {
+			rep->drain_local();
+			drained = rep->drain_local;
+		}
+		rep = rep->replica;
+	}
+
+	if (pop->has_remote_replicas)
+		obj_rep_drain_remote(pop, lane);
+}
+
 /*
  * obj_rep_memcpy_persist -- (internal) memcpy with replication
  */
@@ -465,20 +661,22 @@ obj_rep_memcpy_persist(void *ctx, void *dest, const void *src,
 	if (pop->has_remote_replicas)
 		lane = lane_hold(pop, NULL, LANE_ID);
 
+	/* remote replicas are written from the master replica's memory */
 	void *ret = pop->memcpy_persist_local(dest, src, len);
 
+	if (pop->has_remote_replicas)
+		obj_rep_flush_remote(pop, dest, len, lane);
+
 	PMEMobjpool *rep = pop->replica;
 	while (rep) {
 		void *rdest = (char *)rep + (uintptr_t)dest - (uintptr_t)pop;
-		if (rep->rpp == NULL) {
-			rep->memcpy_persist_local(rdest, src, len);
-		} else {
-			if (rep->persist_remote(rep, rdest, len, lane) == NULL)
-				obj_handle_remote_persist_error(pop);
-		}
+		if (rep->rpp == NULL)
+			rep->memcpy_nodrain_local(rdest, src, len);
 		rep = rep->replica;
 	}
 
+	obj_rep_drain_replicas(pop, lane);
+
 	if (pop->has_remote_replicas)
 		lane_release(pop);
 
@@ -501,18 +699,19 @@ obj_rep_memset_persist(void *ctx, void *dest, int c, size_t len)
 
 	void *ret = pop->memset_persist_local(dest, c, len);
 
+	if (pop->has_remote_replicas)
+		obj_rep_flush_remote(pop, dest, len, lane);
+
 	PMEMobjpool *rep = pop->replica;
 	while (rep) {
 		void *rdest = (char *)rep + (uintptr_t)dest - (uintptr_t)pop;
-		if (rep->rpp == NULL) {
-			rep->memset_persist_local(rdest, c, len);
-		} else {
-			if (rep->persist_remote(rep, rdest, len, lane) == NULL)
-				obj_handle_remote_persist_error(pop);
-		}
+		if (rep->rpp == NULL)
+			rep->memset_nodrain_local(rdest, c, len);
 		rep = rep->replica;
 	}
 
+	obj_rep_drain_replicas(pop, lane);
+
 	if (pop->has_remote_replicas)
 		lane_release(pop);
 
@@ -535,24 +734,29 @@ obj_rep_persist(void *ctx, const void *addr, size_t len)
 
 	pop->persist_local(addr, len);
 
+	if (pop->has_remote_replicas)
+		obj_rep_flush_remote(pop, addr, len, lane);
+
 	PMEMobjpool *rep = pop->replica;
 	while (rep) {
 		void *raddr = (char *)rep + (uintptr_t)addr - (uintptr_t)pop;
-		if (rep->rpp == NULL) {
-			rep->memcpy_persist_local(raddr, addr, len);
-		} else {
-			if (rep->persist_remote(rep, raddr, len, lane) == NULL)
-				obj_handle_remote_persist_error(pop);
-		}
+		if (rep->rpp == NULL)
+			rep->memcpy_nodrain_local(raddr, addr, len);
 		rep = rep->replica;
 	}
 
+	obj_rep_drain_replicas(pop, lane);
+
 	if (pop->has_remote_replicas)
 		lane_release(pop);
 }
 
 /*
  * obj_rep_flush -- (internal) flush with replication
+ *
+ * The range is only queued for the remote replicas, it is sent together
+ * with the other ranges flushed in the lane on the next drain or when
+ * the lane is released.
  */
 static void
 obj_rep_flush(void *ctx, const void *addr, size_t len)
@@ -573,15 +777,20 @@ obj_rep_flush(void *ctx, const void *addr, size_t len)
 		if (rep->rpp == NULL) {
 			memcpy(raddr, addr, len);
 			rep->flush_local(raddr, len);
-		} else {
-			if (rep->persist_remote(rep, raddr, len, lane) == NULL)
-				obj_handle_remote_persist_error(pop);
 		}
 		rep = rep->replica;
 	}
 
-	if (pop->has_remote_replicas)
+	if (pop->has_remote_replicas) {
+		struct lane_rep_queue *q = obj_rep_queue(pop, lane);
+		if (q != NULL) {
+			obj_rep_queue_add(pop, q, addr, len, lane);
+		} else {
+			obj_rep_post_remote(pop, (uintptr_t)addr, len, lane);
+			obj_rep_drain_remote(pop, lane);
+		}
 		lane_release(pop);
+	}
 }
 
 /*
@@ -601,6 +810,30 @@ obj_rep_drain(void *ctx)
 			rep->drain_local();
 		rep = rep->replica;
 	}
+
+	if (pop->has_remote_replicas) {
+		unsigned lane = lane_hold(pop, NULL, LANE_ID);
+		struct lane_rep_queue *q = obj_rep_queue(pop, lane);
+		if (q != NULL && q->nranges != 0)
+			obj_rep_sync_lane(pop, lane);
+		lane_release(pop);
+	}
+}
+
+/*
+ * obj_rep_sync_lane -- send the ranges deferred in the lane to the remote
+ *                      replicas and wait until they are persistent
+ */
+void
+obj_rep_sync_lane(PMEMobjpool *pop, unsigned lane)
+{
+	LOG(15, "pop %p lane %u", pop, lane);
+
+	struct lane_rep_queue *q = obj_rep_queue(pop, lane);
+	ASSERTne(q, NULL);
+
+	obj_rep_queue_post(pop, q, lane);
+	obj_rep_drain_remote(pop, lane);
 }
 
 #ifdef USE_VG_MEMCHECK
@@ -891,6 +1124,8 @@ obj_replica_init_local(PMEMobjpool *rep, int is_pmem)
 
 	/* init hooks */
 	rep->persist_remote = NULL;
+	rep->flush_remote = NULL;
+	rep->drain_remote = NULL;
 
 	/*
 	 * All replicas, except for master, are ignored as far as valgrind is
@@ -906,12 +1141,16 @@ obj_replica_init_local(PMEMobjpool *rep, int is_pmem)
 		rep->drain_local = pmem_drain;
 		rep->memcpy_persist_local = pmem_memcpy_persist;
 		rep->memset_persist_local = pmem_memset_persist;
+		rep->memcpy_nodrain_local = pmem_memcpy_nodrain;
+		rep->memset_nodrain_local = pmem_memset_nodrain;
 	} else {
 		rep->persist_local = (persist_local_fn)pmem_msync;
 		rep->flush_local = (flush_local_fn)pmem_msync;
 		rep->drain_local = obj_drain_empty;
 		rep->memcpy_persist_local = obj_nopmem_memcpy_persist;
 		rep->memset_persist_local = obj_nopmem_memset_persist;
+		rep->memcpy_nodrain_local = obj_nopmem_memcpy_persist;
+		rep->memset_nodrain_local = obj_nopmem_memset_persist;
 	}
 
 	return 0;
@@ -949,11 +1188,15 @@ obj_replica_init_remote(PMEMobjpool *rep, struct pool_set *set,
 
 	/* init hooks */
 	rep->persist_remote = obj_remote_persist;
+	rep->flush_remote = obj_remote_flush;
+	rep->drain_remote = obj_remote_drain;
 	rep->persist_local = NULL;
 	rep->flush_local = NULL;
 	rep->drain_local = NULL;
 	rep->memcpy_persist_local = NULL;
 	rep->memset_persist_local = NULL;
+	rep->memcpy_nodrain_local = NULL;
+	rep->memset_nodrain_local = NULL;
 
 	rep->p_ops.remote.read = obj_read_remote;
 	rep->p_ops.remote.ctx = rep->rpp;
@@ -1835,6 +2078,8 @@ pmemobj_close(PMEMobjpool *pop)
 
 #ifndef _WIN32
 
+	obj_pcache_forget(&_pobj_cached_pools, pop);
+
 	if (_pobj_cached_pool.pop == pop) {
 		_pobj_cached_pool.pop = NULL;
 		_pobj_cached_pool.uuid_lo = 0;
@@ -1842,13 +2087,9 @@ pmemobj_close(PMEMobjpool *pop)
 
 #else /* _WIN32 */
 
-	struct _pobj_pcache *pcache = os_tls_get(Cached_pool_key);
-	if (pcache != NULL) {
-		if (pcache->pop == pop) {
-			pcache->pop = NULL;
-			pcache->uuid_lo = 0;
-		}
-	}
+	struct _pobj_pcache_tab *pcache = os_tls_get(Cached_pool_key);
+	if (pcache != NULL)
+		obj_pcache_forget(pcache, pop);
 
 #endif /* _WIN32 */
 
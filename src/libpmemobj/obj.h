@@ -105,6 +105,9 @@ typedef void *(*memset_local_fn)(void *dest, int c, size_t len);
 
 typedef void *(*persist_remote_fn)(PMEMobjpool *pop, const void *addr,
 					size_t len, unsigned lane);
+typedef int (*flush_remote_fn)(PMEMobjpool *pop, const void *addr,
+					size_t len, unsigned lane);
+typedef int (*drain_remote_fn)(PMEMobjpool *pop, unsigned lane);
 
 typedef uint64_t type_num_t;
 
@@ -160,6 +163,8 @@ struct pmemobjpool {
 	drain_local_fn drain_local;	/* drain function */
 	memcpy_local_fn memcpy_persist_local; /* persistent memcpy function */
 	memset_local_fn memset_persist_local; /* persistent memset function */
+	memcpy_local_fn memcpy_nodrain_local; /* memcpy w/o drain function */
+	memset_local_fn memset_nodrain_local; /* memset w/o drain function */
 
 	/* for 'master' replica: with or without data replication */
 	struct pmem_ops p_ops;
@@ -175,6 +180,8 @@ struct pmemobjpool {
 	char *pool_desc;	/* descriptor of a poolset */
 
 	persist_remote_fn persist_remote; /* remote persist function */
+	flush_remote_fn flush_remote; /* post remote persist function */
+	drain_remote_fn drain_remote; /* wait for remote persist function */
 
 	int vg_boot;
 	int tx_debug_skip_expensive_checks;
@@ -191,7 +198,7 @@ struct pmemobjpool {
 
 	/* padding to align size of this structure to page boundary */
 	/* sizeof(unused2) == 8192 - offsetof(struct pmemobjpool, unused2) */
-	char unused2[1004];
+	char unused2[972];
 };
 
 /*
@@ -238,6 +245,7 @@ void obj_init(void);
 void obj_fini(void);
 int obj_read_remote(void *ctx, uintptr_t base, void *dest, void *addr,
 		size_t length);
+void obj_rep_sync_lane(PMEMobjpool *pop, unsigned lane);
 
 /*
  * (debug helper macro) logs notice message if used inside a transaction
@@ -88,6 +88,11 @@ static const struct step steps[] = {
 		.func		= check_btt_map_flog,
 		.part		= false,
 	},
+	{
+		.type		= POOL_TYPE_OBJ,
+		.func		= check_obj,
+		.part		= false,
+	},
 	{
 		.type		= POOL_TYPE_BLK | POOL_TYPE_LOG | POOL_TYPE_BTT,
 		.func		= check_write,
@@ -203,8 +208,12 @@ check_step(PMEMpoolcheck *ppc)
 	/* perform step */
 	step->func(ppc);
 
-	/* move on to next step if no questions were generated */
-	if (ppc->result != CHECK_RESULT_ASK_QUESTIONS)
+	/*
+	 * move on to next step if no questions were generated and the step
+	 * does not have to be continued
+	 */
+	if (ppc->result != CHECK_RESULT_ASK_QUESTIONS &&
+			!check_get_step_data(ppc->data)->incomplete)
 		check_step_inc(ppc->data);
 
 	/* get current status and return */
@@ -41,6 +41,7 @@
 #include "out.h"
 #include "file.h"
 #include "os.h"
+#include "mmap.h"
 #include "libpmempool.h"
 #include "pmempool.h"
 #include "pool.h"
@@ -244,23 +245,52 @@ err:
 static int
 backup_poolset(PMEMpoolcheck *ppc, location *loc, int overwrite)
 {
-	struct pool_replica *srep = ppc->pool->set_file->poolset->replica[0];
+	struct pool_set_file *file = ppc->pool->set_file;
+	struct pool_replica *srep = file->poolset->replica[0];
 	struct pool_replica *drep = loc->set->replica[0];
+
+	/* copy only the live data if the layout of the pool allows that */
+	struct pool_extents exts = VEC_INITIALIZER;
+	int sparse = pool_live_extents(ppc->pool->params.type, file->addr,
+		file->size, &exts) == 0;
+
+	/* parts other than the first one are mapped without the header */
+	size_t hdrsize = (file->poolset->options & OPTION_NO_HDRS) ?
+		0 : Mmap_align;
+
+	int ret = 0;
 	for (unsigned p = 0; p < srep->nparts; p++) {
 		if (overwrite == 0) {
 			CHECK_INFO(ppc, "creating backup file: %s",
 				drep->part[p].path);
 		}
+
+		uint64_t data_off = (uint64_t)((uintptr_t)srep->part[p].addr -
+			(uintptr_t)srep->part[0].addr);
+		uint64_t data_end = p + 1 < srep->nparts ?
+			(uint64_t)((uintptr_t)srep->part[p + 1].addr -
+			(uintptr_t)srep->part[0].addr) : file->size;
+		size_t skip = p == 0 ? 0 : hdrsize;
+
+		struct pool_copy_map map = {
+			.exts = &exts,
+			.base = data_off - skip,
+			.begin = skip,
+			.end = skip + (size_t)(data_end - data_off),
+		};
+
 		if (pool_set_part_copy(&drep->part[p], &srep->part[p],
-				overwrite)) {
+				overwrite, sparse ? &map : NULL)) {
 			location_release(loc);
 			ppc->result = CHECK_RESULT_ERROR;
 			CHECK_INFO(ppc, "unable to create backup file");
-			return CHECK_ERR(ppc, "unable to backup poolset");
+			ret = CHECK_ERR(ppc, "unable to backup poolset");
+			break;
 		}
 	}
 
-	return 0;
+	VEC_DELETE(&exts);
+	return ret;
 }
 
 /*
@@ -0,0 +1,521 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * check_obj.c -- check pmemobj descriptor, lanes and heap
+ */
+
+#include <inttypes.h>
+#include <unistd.h>
+
+#include "out.h"
+#include "os_thread.h"
+#include "libpmempool.h"
+#include "pmempool.h"
+#include "pool.h"
+#include "check_util.h"
+#include "obj.h"
+#include "heap_layout.h"
+#include "list.h"
+#include "pmalloc.h"
+#include "redo.h"
+#include "tx.h"
+
+/* maximum number of zones verified by a single step invocation */
+#define CHECK_OBJ_ZONES_BATCH 64
+/* maximum number of threads verifying zones */
+#define CHECK_OBJ_MAX_THREADS 16
+/* maximum number of reported invalid lanes */
+#define CHECK_OBJ_MAX_LANE_ERRORS 16
+
+/*
+ * zone_result -- result of verification of a single zone
+ */
+struct zone_result {
+	const char *error;	/* NULL if the zone is consistent */
+	uint32_t chunk;
+};
+
+/*
+ * zones_args -- arguments shared by all threads verifying a batch of zones
+ */
+struct zones_args {
+	struct heap_layout *layout;
+	uint64_t heap_size;
+	unsigned first;		/* first zone of the batch */
+	unsigned nzones;	/* number of zones in the batch */
+
+	uint64_t next;		/* next zone to verify */
+	struct zone_result results[CHECK_OBJ_ZONES_BATCH];
+};
+
+/*
+ * obj_pop -- (internal) return pointer to the mapped pmemobj pool
+ */
+static inline PMEMobjpool *
+obj_pop(PMEMpoolcheck *ppc)
+{
+	return pool_set_file_map(ppc->pool->set_file, 0);
+}
+
+/*
+ * obj_inconsistent -- (internal) mark the pool as inconsistent
+ *
+ * None of the pmemobj structures checked here can be repaired.
+ */
+static void
+obj_inconsistent(PMEMpoolcheck *ppc)
+{
+	ppc->result = CHECK_IS_NOT(ppc, REPAIR) ?
+		CHECK_RESULT_NOT_CONSISTENT : CHECK_RESULT_CANNOT_REPAIR;
+}
+
+/*
+ * obj_heap_nzones -- (internal) return number of zones in the heap
+ */
+static unsigned
+obj_heap_nzones(uint64_t heap_size)
+{
+	unsigned nzones = 0;
+	uint64_t size = heap_size - sizeof(struct heap_header);
+
+	while (size >= ZONE_MIN_SIZE) {
+		nzones++;
+		size -= size <= ZONE_MAX_SIZE ? size : ZONE_MAX_SIZE;
+	}
+
+	return nzones;
+}
+
+/*
+ * obj_descr_check -- (internal) check pmemobj descriptor
+ */
+static int
+obj_descr_check(PMEMpoolcheck *ppc, location *loc)
+{
+	LOG(3, NULL);
+
+	CHECK_INFO(ppc, "checking pmemobj descriptor");
+
+	PMEMobjpool *pop = obj_pop(ppc);
+	uint64_t size = ppc->pool->set_file->size;
+	void *dscp = (void *)((uintptr_t)pop + sizeof(struct pool_hdr));
+
+	const char *error = NULL;
+	if (!util_checksum(dscp, OBJ_DSC_P_SIZE, &pop->checksum, 0))
+		error = "invalid pmemobj descriptor checksum";
+	else if (strnlen(pop->layout, PMEMOBJ_MAX_LAYOUT) ==
+			PMEMOBJ_MAX_LAYOUT)
+		error = "invalid pmemobj.layout";
+	else if (pop->run_id % 2)
+		error = "invalid pmemobj.run_id";
+	else if (pop->nlanes == 0 || pop->lanes_offset < OBJ_LANES_OFFSET ||
+			pop->heap_offset <= pop->lanes_offset ||
+			pop->nlanes > (pop->heap_offset - pop->lanes_offset) /
+				sizeof(struct lane_layout))
+		error = "invalid pmemobj lanes";
+	else if (pop->heap_offset + pop->heap_size != size ||
+			pop->heap_offset % Pagesize ||
+			pop->heap_size % Pagesize ||
+			pop->heap_size < HEAP_MIN_SIZE)
+		error = "invalid pmemobj heap";
+
+	if (error) {
+		obj_inconsistent(ppc);
+		check_end(ppc->data);
+		return CHECK_ERR(ppc, "%s", error);
+	}
+
+	CHECK_INFO(ppc, "pmemobj descriptor correct");
+	return 0;
+}
+
+/*
+ * obj_off_is_valid -- (internal) check if the offset may be modified by
+ *	the redo log, see OBJ_OFF_IS_VALID
+ */
+static int
+obj_off_is_valid(void *ctx, uint64_t off)
+{
+	PMEMobjpool *pop = ctx;
+	return OBJ_OFF_IS_VALID(pop, off);
+}
+
+/*
+ * obj_lane_check -- (internal) check sections of a single lane, returns
+ *	the name of the first invalid section
+ */
+static const char *
+obj_lane_check(PMEMobjpool *pop, struct redo_ctx *redo,
+	struct lane_layout *lane)
+{
+	struct lane_alloc_layout *alloc = (struct lane_alloc_layout *)
+		&lane->sections[LANE_SECTION_ALLOCATOR];
+	if (redo_log_check(redo, alloc->redo, ALLOC_REDO_LOG_SIZE))
+		return "allocator redo log";
+
+	struct lane_list_layout *list = (struct lane_list_layout *)
+		&lane->sections[LANE_SECTION_LIST];
+	if (redo_log_check(redo, list->redo, REDO_NUM_ENTRIES))
+		return "list redo log";
+	if (list->obj_offset && !OBJ_OFF_FROM_HEAP(pop, list->obj_offset))
+		return "list object offset";
+
+	struct lane_tx_layout *tx = (struct lane_tx_layout *)
+		&lane->sections[LANE_SECTION_TRANSACTION];
+	if (tx->state != TX_STATE_NONE && tx->state != TX_STATE_COMMITTED)
+		return "transaction state";
+
+	for (unsigned i = 0; i < MAX_UNDO_TYPES; ++i) {
+		struct pvector *vec = &tx->undo_log[i];
+
+		/* the first array is embedded in the lane */
+		if (vec->arrays[0] && vec->arrays[0] !=
+				OBJ_PTR_TO_OFF(pop, &vec->embedded))
+			return "transaction undo log";
+
+		for (unsigned j = 1; j < PVECTOR_MAX_ARRAYS; ++j) {
+			uint64_t off = vec->arrays[j];
+			if (off && !OBJ_OFF_FROM_HEAP(pop, off))
+				return "transaction undo log";
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * obj_lanes_check -- (internal) check lanes
+ */
+static int
+obj_lanes_check(PMEMpoolcheck *ppc, location *loc)
+{
+	LOG(3, NULL);
+
+	CHECK_INFO(ppc, "checking lanes");
+
+	PMEMobjpool *pop = obj_pop(ppc);
+	struct lane_layout *lanes = (struct lane_layout *)
+		((uintptr_t)pop + pop->lanes_offset);
+
+	/* the redo logs are only verified, the pmem operations are not used */
+	struct pmem_ops p_ops;
+	memset(&p_ops, 0, sizeof(p_ops));
+
+	struct redo_ctx *redo = redo_log_config_new(pop, &p_ops,
+		obj_off_is_valid, pop, REDO_NUM_ENTRIES);
+	if (redo == NULL) {
+		ppc->result = CHECK_RESULT_ERROR;
+		return CHECK_ERR(ppc, "cannot allocate memory for lanes check");
+	}
+
+	uint64_t ninvalid = 0;
+	for (uint64_t i = 0; i < pop->nlanes; ++i) {
+		const char *section = obj_lane_check(pop, redo, &lanes[i]);
+		if (section == NULL)
+			continue;
+
+		if (ninvalid++ < CHECK_OBJ_MAX_LANE_ERRORS)
+			CHECK_INFO(ppc, "lane %" PRIu64 ": invalid %s", i,
+				section);
+	}
+
+	redo_log_config_delete(redo);
+
+	if (ninvalid) {
+		obj_inconsistent(ppc);
+		return CHECK_ERR(ppc, "number of invalid lanes: %" PRIu64,
+			ninvalid);
+	}
+
+	CHECK_INFO(ppc, "lanes correct");
+	return 0;
+}
+
+/*
+ * obj_heap_hdr_check -- (internal) check heap header
+ */
+static int
+obj_heap_hdr_check(PMEMpoolcheck *ppc, location *loc)
+{
+	LOG(3, NULL);
+
+	CHECK_INFO(ppc, "checking heap header");
+
+	PMEMobjpool *pop = obj_pop(ppc);
+	struct heap_header *hdr = (struct heap_header *)
+		((uintptr_t)pop + pop->heap_offset);
+
+	const char *error = NULL;
+	if (memcmp(hdr->signature, HEAP_SIGNATURE, HEAP_SIGNATURE_LEN) != 0)
+		error = "invalid heap signature";
+	else if (!util_checksum(hdr, sizeof(*hdr), &hdr->checksum, 0))
+		error = "invalid heap header checksum";
+	else if (hdr->size != pop->heap_size)
+		error = "heap size mismatch";
+	else if (hdr->chunksize != CHUNKSIZE ||
+			hdr->chunks_per_zone != MAX_CHUNK)
+		error = "invalid heap geometry";
+
+	if (error) {
+		obj_inconsistent(ppc);
+		check_end(ppc->data);
+		return CHECK_ERR(ppc, "%s", error);
+	}
+
+	CHECK_INFO(ppc, "heap header correct");
+	return 0;
+}
+
+/*
+ * zone_run_check -- (internal) check the header of a run
+ */
+static const char *
+zone_run_check(struct chunk_run *run, uint32_t size_idx)
+{
+	uint64_t run_size = RUNSIZE + (size_idx - 1) * CHUNKSIZE;
+	if (run->block_size == 0 || run->block_size > run_size)
+		return "invalid run block size";
+
+	/* the bits past the last block have to be set, see alloc_class.c */
+	uint64_t nallocs = min(run_size / run->block_size, RUN_BITMAP_SIZE);
+	uint64_t nvals = (nallocs + BITS_PER_VALUE - 1) / BITS_PER_VALUE;
+	unsigned unused = (unsigned)(nvals * BITS_PER_VALUE - nallocs);
+	uint64_t last_val = unused ? ((1ULL << unused) - 1ULL) <<
+		(BITS_PER_VALUE - unused) : 0;
+
+	if ((run->bitmap[nvals - 1] & last_val) != last_val)
+		return "invalid run bitmap";
+
+	return NULL;
+}
+
+/*
+ * zone_check -- (internal) check a single zone, the zone and chunk headers
+ *	are verified the same way libpmemobj does it on open, the runs are
+ *	verified in addition
+ */
+static void
+zone_check(struct zone *zone, uint32_t max_chunks, struct zone_result *res)
+{
+	res->error = heap_zone_check(zone, max_chunks, &res->chunk);
+	if (res->error || zone->header.magic == 0)
+		return;
+
+	for (uint32_t i = 0; i < zone->header.size_idx;
+			i += zone->chunk_headers[i].size_idx) {
+		struct chunk_header *hdr = &zone->chunk_headers[i];
+		if (hdr->type != CHUNK_TYPE_RUN)
+			continue;
+
+		res->error = zone_run_check(
+			(struct chunk_run *)&zone->chunks[i], hdr->size_idx);
+		if (res->error) {
+			res->chunk = i;
+			return;
+		}
+	}
+}
+
+/*
+ * zones_worker -- (internal) check zones of the batch until none is left
+ */
+static void *
+zones_worker(void *arg)
+{
+	struct zones_args *args = arg;
+	uint64_t heap_end = args->heap_size;
+
+	for (;;) {
+		uint64_t n = util_fetch_and_add64(&args->next, 1);
+		if (n >= args->nzones)
+			break;
+
+		unsigned zid = args->first + (unsigned)n;
+		struct zone *zone = ZID_TO_ZONE(args->layout, zid);
+
+		/* the last zone may be smaller than the others */
+		uint64_t zone_off = (uint64_t)((uintptr_t)zone -
+			(uintptr_t)args->layout);
+		uint64_t zone_size = min(heap_end - zone_off, ZONE_MAX_SIZE);
+		uint32_t max_chunks = (uint32_t)
+			((zone_size - sizeof(struct zone)) / CHUNKSIZE);
+
+		zone_check(zone, max_chunks, &args->results[n]);
+	}
+
+	return NULL;
+}
+
+/*
+ * zones_nthreads -- (internal) return the number of threads for the batch
+ */
+static unsigned
+zones_nthreads(unsigned nzones)
+{
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned nthreads = cpus < 1 ? 1 : (unsigned)cpus;
+
+	nthreads = min(nthreads, CHECK_OBJ_MAX_THREADS);
+	nthreads = min(nthreads, nzones);
+
+	return nthreads ? nthreads : 1;
+}
+
+/*
+ * obj_zones_check -- (internal) check a batch of heap zones
+ *
+ * Zones of the batch are verified in parallel. The step is performed again
+ * until all of the zones are verified, so the progress is reported to the
+ * caller after each batch.
+ */
+static int
+obj_zones_check(PMEMpoolcheck *ppc, location *loc)
+{
+	LOG(3, NULL);
+
+	PMEMobjpool *pop = obj_pop(ppc);
+	unsigned nzones = obj_heap_nzones(pop->heap_size);
+
+	if (loc->zone == 0)
+		CHECK_INFO(ppc, "checking heap zones");
+
+	struct zones_args *args = Zalloc(sizeof(*args));
+	if (args == NULL) {
+		ppc->result = CHECK_RESULT_ERROR;
+		return CHECK_ERR(ppc, "cannot allocate memory for heap check");
+	}
+
+	args->layout = (struct heap_layout *)((uintptr_t)pop +
+		pop->heap_offset);
+	args->heap_size = pop->heap_size;
+	args->first = loc->zone;
+	args->nzones = min(nzones - loc->zone, CHECK_OBJ_ZONES_BATCH);
+
+	unsigned nthreads = zones_nthreads(args->nzones);
+	os_thread_t threads[CHECK_OBJ_MAX_THREADS];
+	unsigned started = 0;
+
+	/* the calling thread is one of the workers */
+	for (; started + 1 < nthreads; ++started) {
+		if (os_thread_create(&threads[started], NULL, zones_worker,
+				args))
+			break;
+	}
+
+	zones_worker(args);
+
+	for (unsigned i = 0; i < started; ++i)
+		os_thread_join(&threads[i], NULL);
+
+	for (unsigned i = 0; i < args->nzones; ++i) {
+		struct zone_result *res = &args->results[i];
+		if (res->error == NULL)
+			continue;
+
+		loc->nzones_invalid++;
+		if (res->chunk != ZONE_CHECK_NO_CHUNK)
+			CHECK_INFO(ppc, "zone %u: chunk %u: %s",
+				args->first + i, res->chunk, res->error);
+		else
+			CHECK_INFO(ppc, "zone %u: %s", args->first + i,
+				res->error);
+	}
+
+	loc->zone += args->nzones;
+	Free(args);
+
+	if (loc->zone < nzones) {
+		CHECK_INFO(ppc, "checked %u of %u heap zones", loc->zone,
+			nzones);
+		loc->incomplete = 1;
+		return 0;
+	}
+
+	loc->incomplete = 0;
+
+	if (loc->nzones_invalid) {
+		obj_inconsistent(ppc);
+		return CHECK_ERR(ppc, "number of invalid heap zones: %u",
+			loc->nzones_invalid);
+	}
+
+	CHECK_INFO(ppc, "heap zones correct");
+	return 0;
+}
+
+struct step {
+	int (*check)(PMEMpoolcheck *, location *);
+};
+
+static const struct step steps[] = {
+	{
+		.check	= obj_descr_check,
+	},
+	{
+		.check	= obj_lanes_check,
+	},
+	{
+		.check	= obj_heap_hdr_check,
+	},
+	{
+		.check	= obj_zones_check,
+	},
+	{
+		.check	= NULL,
+	},
+};
+
+/*
+ * check_obj -- entry point for pmemobj checks
+ *
+ * The heap zones are checked in batches, the step returns after each of them
+ * with the location marked as incomplete.
+ */
+void
+check_obj(PMEMpoolcheck *ppc)
+{
+	LOG(3, NULL);
+
+	location *loc = check_get_step_data(ppc->data);
+
+	while (loc->step != CHECK_STEP_COMPLETE &&
+			steps[loc->step].check != NULL) {
+		if (steps[loc->step].check(ppc, loc))
+			break;
+
+		if (loc->incomplete)
+			return;
+
+		loc->step++;
+	}
+}
@@ -121,6 +121,11 @@ typedef struct {
 		struct btt_info btti;
 		uint64_t btti_offset;
 	} pool_valid;
+
+	/* the step has to be performed again to complete */
+	int incomplete;
+	unsigned zone;
+	unsigned nzones_invalid;
 } location;
 
 /* check steps */
@@ -130,6 +135,7 @@ void check_pool_hdr_uuids(PMEMpoolcheck *ppc);
 void check_log_blk(PMEMpoolcheck *ppc);
 void check_btt_info(PMEMpoolcheck *ppc);
 void check_btt_map_flog(PMEMpoolcheck *ppc);
+void check_obj(PMEMpoolcheck *ppc);
 void check_write(PMEMpoolcheck *ppc);
 
 struct check_data *check_data_alloc(void);
@@ -36,6 +36,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -61,6 +62,7 @@
 #include "pool.h"
 #include "lane.h"
 #include "obj.h"
+#include "heap_layout.h"
 #include "btt.h"
 #include "file.h"
 #include "os.h"
@@ -68,6 +70,7 @@
 #include "check_util.h"
 #include "util_pmem.h"
 #include "mmap.h"
+#include "os_thread.h"
 
 /* arbitrary size of a maximum file part being read / write at once */
 #define RW_BUFFERING_SIZE (128 * 1024 * 1024)
@@ -651,6 +654,7 @@ pool_copy(struct pool_data *pool, const char *dst_path, int overwrite)
 {
 	struct pool_set_file *file = pool->set_file;
 	int dfd;
+	unsigned flags = POOL_COPY_ZERO_HOLES;
 	if (!os_access(dst_path, F_OK)) {
 		if (!overwrite) {
 			errno = EEXIST;
@@ -660,6 +664,8 @@ pool_copy(struct pool_data *pool, const char *dst_path, int overwrite)
 	} else {
 		if (errno == ENOENT) {
 			errno = 0;
+			/* a new file is zeroed, holes can be skipped */
+			flags = 0;
 			dfd = util_file_create(dst_path, file->size, 0);
 		} else {
 			return -1;
@@ -689,7 +695,17 @@ pool_copy(struct pool_data *pool, const char *dst_path, int overwrite)
 
 	if (pool->params.type != POOL_TYPE_BTT) {
 		void *saddr = pool_set_file_map(file, 0);
-		memcpy(daddr, saddr, file->size);
+
+		struct pool_extents exts = VEC_INITIALIZER;
+		struct pool_copy_map map = {&exts, 0, 0, file->size};
+		int sparse = pool_live_extents(pool->params.type, saddr,
+			file->size, &exts) == 0;
+
+		if (pool_copy_data(daddr, saddr, file->size, 0, flags,
+				sparse ? &map : NULL))
+			result = -1;
+
+		VEC_DELETE(&exts);
 		goto out_unmap;
 	}
 
@@ -723,14 +739,549 @@ out_close:
 	return result;
 }
 
+/*
+ * pool_copy_args -- arguments shared by all threads copying data
+ */
+struct pool_copy_args {
+	void *dst;
+	const void *src;
+	size_t len;
+	int is_pmem;
+	unsigned flags;
+	const struct pool_copy_map *map;
+
+	uint64_t next_chunk;	/* next chunk to copy */
+	uint64_t copied;	/* number of bytes written */
+	uint64_t skipped;	/* number of bytes which are not live */
+	int error;		/* accessed atomically */
+};
+
+/*
+ * pool_copy_range -- (internal) copy range of data
+ */
+static int
+pool_copy_range(struct pool_copy_args *args, size_t off, size_t len)
+{
+	void *dst = ADDR_SUM(args->dst, off);
+	const void *src = (const char *)args->src + off;
+
+	if ((args->flags & POOL_COPY_COMPARE) &&
+			memcmp(dst, src, len) == 0)
+		return 0;
+
+	if (args->is_pmem)
+		pmem_memcpy_nodrain(dst, src, len);
+	else
+		memcpy(dst, src, len);
+
+	util_fetch_and_add64(&args->copied, len);
+
+	return 0;
+}
+
+/*
+ * pool_zero_range -- (internal) zero range of data which is not live
+ */
+static int
+pool_zero_range(struct pool_copy_args *args, size_t off, size_t len)
+{
+	util_fetch_and_add64(&args->skipped, len);
+
+	if (!(args->flags & POOL_COPY_ZERO_HOLES))
+		return 0;
+
+	void *dst = ADDR_SUM(args->dst, off);
+	if (util_is_zeroed(dst, len))
+		return 0;
+
+	if (args->is_pmem)
+		pmem_memset_nodrain(dst, 0, len);
+	else
+		memset(dst, 0, len);
+
+	util_fetch_and_add64(&args->copied, len);
+
+	return 0;
+}
+
+/*
+ * pool_copy_map_next -- (internal) return length of the range starting at
+ *                       given offset which is either entirely live or not
+ */
+static size_t
+pool_copy_map_next(const struct pool_copy_map *map, size_t off, size_t len,
+	int *live)
+{
+	*live = 1;
+	if (off < map->begin)
+		return min(len, map->begin - off);
+	if (off >= map->end)
+		return len;
+
+	len = min(len, map->end - off);
+
+	/* find the first extent which ends after the offset */
+	const struct pool_extents *exts = map->exts;
+	uint64_t pos = map->base + off;
+	size_t l = 0;
+	size_t r = VEC_SIZE(exts);
+	while (l < r) {
+		size_t m = l + (r - l) / 2;
+		struct pool_extent *e = VEC_GET(exts, m);
+		if (e->offset + e->length <= pos)
+			l = m + 1;
+		else
+			r = m;
+	}
+
+	if (l == VEC_SIZE(exts)) {
+		*live = 0;
+		return len;
+	}
+
+	struct pool_extent *e = VEC_GET(exts, l);
+	if (e->offset <= pos)
+		return (size_t)min(len, e->offset + e->length - pos);
+
+	*live = 0;
+	return (size_t)min(len, e->offset - pos);
+}
+
+/*
+ * pool_copy_region -- (internal) copy live data of a single region
+ */
+static int
+pool_copy_region(struct pool_copy_args *args, size_t off, size_t len)
+{
+	if (args->map == NULL)
+		return pool_copy_range(args, off, len);
+
+	while (len) {
+		int live;
+		size_t n = pool_copy_map_next(args->map, off, len, &live);
+		int ret = live ? pool_copy_range(args, off, n) :
+			pool_zero_range(args, off, n);
+		if (ret)
+			return -1;
+
+		off += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+/*
+ * pool_copy_worker -- (internal) copy chunks of data until there is none left
+ */
+static void *
+pool_copy_worker(void *arg)
+{
+	struct pool_copy_args *args = arg;
+
+	for (;;) {
+		uint64_t chunk = util_fetch_and_add64(&args->next_chunk, 1);
+		size_t off = chunk * POOL_COPY_CHUNK;
+		if (off >= args->len || util_fetch_and_or32(&args->error, 0))
+			break;
+
+		size_t end = off + POOL_COPY_CHUNK < args->len ?
+			off + POOL_COPY_CHUNK : args->len;
+
+		for (; off < end; off += POOL_COPY_REGION) {
+			size_t len = end - off < POOL_COPY_REGION ?
+				end - off : POOL_COPY_REGION;
+			if (pool_copy_region(args, off, len)) {
+				/* the first error is reported */
+				util_bool_compare_and_swap32(&args->error, 0,
+						errno);
+				break;
+			}
+		}
+	}
+
+	if (args->is_pmem)
+		pmem_drain();
+
+	return NULL;
+}
+
+/*
+ * pool_copy_nthreads -- (internal) returns the number of threads to copy
+ *                       data of given length
+ */
+static unsigned
+pool_copy_nthreads(size_t len)
+{
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cpus < 1)
+		cpus = 1;
+
+	size_t nchunks = (len + POOL_COPY_CHUNK - 1) / POOL_COPY_CHUNK;
+	size_t nthreads = (size_t)cpus;
+	if (nthreads > POOL_COPY_MAX_THREADS)
+		nthreads = POOL_COPY_MAX_THREADS;
+	if (nthreads > nchunks)
+		nthreads = nchunks;
+
+	return nthreads ? (unsigned)nthreads : 1;
+}
+
+/*
+ * pool_copy_data -- copy data and make it persistent using multiple threads
+ *
+ * With the POOL_COPY_COMPARE flag each region is compared with the
+ * destination first and only the regions which differ are written, so the
+ * already synchronized regions and the free space of newly created (zeroed)
+ * files are not rewritten. Both the source and the destination are still
+ * read in full, there is no record of the modified ranges.
+ *
+ * If the map is provided only the live data is copied, the remaining ranges
+ * are left intact or, with the POOL_COPY_ZERO_HOLES flag, zeroed.
+ */
+int
+pool_copy_data(void *dst, const void *src, size_t len, int is_pmem,
+	unsigned flags, const struct pool_copy_map *map)
+{
+	LOG(3, "dst %p src %p len %zu is_pmem %d flags %u map %p", dst, src,
+			len, is_pmem, flags, map);
+
+	struct pool_copy_args args = {
+		.dst = dst,
+		.src = src,
+		.len = len,
+		.is_pmem = is_pmem,
+		.flags = flags,
+		.map = map,
+		.next_chunk = 0,
+		.copied = 0,
+		.skipped = 0,
+		.error = 0,
+	};
+
+	unsigned nthreads = pool_copy_nthreads(len);
+	os_thread_t *threads = NULL;
+	unsigned started = 0;
+
+	if (nthreads > 1) {
+		threads = Malloc(nthreads * sizeof(*threads));
+		if (threads == NULL)
+			nthreads = 1;
+	}
+
+	/* the calling thread is one of the workers */
+	for (; started + 1 < nthreads; ++started) {
+		if (os_thread_create(&threads[started], NULL,
+				pool_copy_worker, &args))
+			break;
+	}
+
+	pool_copy_worker(&args);
+
+	for (unsigned i = 0; i < started; ++i)
+		os_thread_join(&threads[i], NULL);
+
+	Free(threads);
+
+	/*
+	 * The data written to a regular file is flushed with a single msync
+	 * once all the workers are done, instead of syncing every region.
+	 */
+	if (!is_pmem && args.error == 0 && pmem_msync(dst, len))
+		args.error = errno;
+
+	LOG(4, "written %" PRIu64 " of %zu bytes (%" PRIu64 " not live) "
+			"using %u threads", args.copied, len, args.skipped,
+			started + 1);
+
+	if (args.error) {
+		errno = args.error;
+		ERR("!copying data failed");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * pool_extents_add -- (internal) append live range, merging it with the
+ *                     previous one if they are adjacent
+ */
+static void
+pool_extents_add(struct pool_extents *exts, uint64_t offset, uint64_t length)
+{
+	if (length == 0)
+		return;
+
+	if (VEC_SIZE(exts) != 0) {
+		struct pool_extent *last = VEC_GET(exts, VEC_SIZE(exts) - 1);
+		ASSERT(last->offset + last->length <= offset);
+		if (last->offset + last->length == offset) {
+			last->length += length;
+			return;
+		}
+	}
+
+	struct pool_extent e = {offset, length};
+	VEC_PUSH_BACK(exts, e);
+}
+
+/*
+ * pool_live_extents_log -- (internal) live data of the log pool ends at the
+ *                          current write point
+ */
+static int
+pool_live_extents_log(const void *addr, size_t size, struct pool_extents *exts)
+{
+	const struct pmemlog *plp = addr;
+	uint64_t start_offset = le64toh(plp->start_offset);
+	uint64_t end_offset = le64toh(plp->end_offset);
+	uint64_t write_offset = le64toh(plp->write_offset);
+
+	if (start_offset < sizeof(*plp) || start_offset > write_offset ||
+			write_offset > end_offset || end_offset > size)
+		return -1;
+
+	pool_extents_add(exts, 0, write_offset);
+	pool_extents_add(exts, end_offset, size - end_offset);
+
+	return 0;
+}
+
+/*
+ * pool_live_extents_arena -- (internal) add live ranges of a single BTT arena
+ *
+ * Only the data blocks referenced by normal map entries and by the flog
+ * entries are live, the blocks of zero, error and initial map entries are
+ * never read.
+ */
+static int
+pool_live_extents_arena(const void *addr, uint64_t arena_off,
+	uint64_t arena_end, struct btt_info *infop, struct pool_extents *exts)
+{
+	uint64_t data_off = arena_off + infop->dataoff;
+	uint64_t map_off = arena_off + infop->mapoff;
+	uint64_t flog_off = arena_off + infop->flogoff;
+	uint64_t bsize = infop->internal_lbasize;
+	uint64_t data_end = data_off + infop->internal_nlba * bsize;
+
+	if (bsize == 0 || data_end > map_off ||
+			map_off + infop->external_nlba * BTT_MAP_ENTRY_SIZE >
+				flog_off ||
+			flog_off + infop->nfree * BTT_FLOG_PAIR_ALIGN >
+				arena_end)
+		return -1;
+
+	uint64_t *live = Zalloc(sizeof(uint64_t) *
+		((infop->internal_nlba + 63) / 64));
+	if (live == NULL)
+		return -1;
+
+	int ret = -1;
+	const uint32_t *map = (const uint32_t *)((uintptr_t)addr + map_off);
+	for (uint32_t i = 0; i < infop->external_nlba; ++i) {
+		uint32_t entry = le32toh(map[i]);
+		if ((entry & ~BTT_MAP_ENTRY_LBA_MASK) != BTT_MAP_ENTRY_NORMAL)
+			continue;
+
+		uint32_t lba = entry & BTT_MAP_ENTRY_LBA_MASK;
+		if (lba >= infop->internal_nlba)
+			goto out;
+		live[lba / 64] |= 1ULL << (lba % 64);
+	}
+
+	/* blocks of interrupted writes may be mapped by the recovery */
+	for (uint32_t i = 0; i < infop->nfree; ++i) {
+		const struct btt_flog *flog = (const struct btt_flog *)
+			((uintptr_t)addr + flog_off + i * BTT_FLOG_PAIR_ALIGN);
+		for (int j = 0; j < 2; ++j) {
+			uint32_t maps[2] = {
+				le32toh(flog[j].old_map) &
+					BTT_MAP_ENTRY_LBA_MASK,
+				le32toh(flog[j].new_map) &
+					BTT_MAP_ENTRY_LBA_MASK,
+			};
+			for (int k = 0; k < 2; ++k) {
+				if (maps[k] < infop->internal_nlba)
+					live[maps[k] / 64] |=
+						1ULL << (maps[k] % 64);
+			}
+		}
+	}
+
+	pool_extents_add(exts, arena_off, data_off - arena_off);
+	for (uint32_t b = 0; b < infop->internal_nlba; ++b) {
+		if (live[b / 64] & (1ULL << (b % 64)))
+			pool_extents_add(exts, data_off + b * bsize, bsize);
+	}
+	pool_extents_add(exts, data_end, arena_end - data_end);
+
+	ret = 0;
+out:
+	Free(live);
+	return ret;
+}
+
+/*
+ * pool_live_extents_blk -- (internal) walk BTT arenas of the blk pool
+ */
+static int
+pool_live_extents_blk(const void *addr, size_t size, struct pool_extents *exts)
+{
+	uint64_t arena_off = 2 * BTT_ALIGNMENT;
+	pool_extents_add(exts, 0, arena_off);
+
+	while (arena_off != 0) {
+		struct btt_info info;
+		if (arena_off + sizeof(info) > size)
+			return -1;
+
+		memcpy(&info, (const char *)addr + arena_off, sizeof(info));
+		if (!pool_btt_info_valid(&info))
+			return -1;
+		btt_info_convert2h(&info);
+
+		uint64_t next_off = info.nextoff ? arena_off + info.nextoff : 0;
+		uint64_t arena_end = next_off ? next_off : size;
+		if (arena_end > size || arena_end <= arena_off)
+			return -1;
+
+		if (pool_live_extents_arena(addr, arena_off, arena_end, &info,
+				exts))
+			return -1;
+
+		arena_off = next_off;
+	}
+
+	return 0;
+}
+
+/*
+ * pool_live_extents_zone -- (internal) add live ranges of a single heap zone
+ *
+ * Only the used chunks and runs are live, the data of free chunks and of the
+ * chunks beyond the zone size is not.
+ */
+static void
+pool_live_extents_zone(const void *addr, uint64_t zone_off, uint64_t zone_size,
+	struct pool_extents *exts)
+{
+	const struct zone *z =
+		(const struct zone *)((uintptr_t)addr + zone_off);
+	uint64_t chunks_off = zone_off + sizeof(struct zone);
+	uint32_t nchunks = (uint32_t)((zone_size - sizeof(struct zone)) /
+		CHUNKSIZE);
+
+	pool_extents_add(exts, zone_off, sizeof(struct zone));
+
+	if (z->header.magic == 0)
+		return; /* zone was never used */
+
+	if (z->header.magic != ZONE_HEADER_MAGIC ||
+			z->header.size_idx > nchunks) {
+		pool_extents_add(exts, chunks_off, zone_size -
+			sizeof(struct zone));
+		return;
+	}
+
+	uint32_t i = 0;
+	while (i < z->header.size_idx) {
+		const struct chunk_header *hdr = &z->chunk_headers[i];
+		if (hdr->size_idx == 0 || hdr->size_idx > nchunks - i) {
+			/* corrupted chunk header, copy the rest of the zone */
+			pool_extents_add(exts, chunks_off + i * CHUNKSIZE,
+				(nchunks - i) * CHUNKSIZE);
+			return;
+		}
+
+		if (hdr->type != CHUNK_TYPE_FREE)
+			pool_extents_add(exts, chunks_off + i * CHUNKSIZE,
+				hdr->size_idx * CHUNKSIZE);
+
+		i += hdr->size_idx;
+	}
+}
+
+/*
+ * pool_live_extents_obj -- (internal) walk zones of the obj pool heap
+ */
+static int
+pool_live_extents_obj(const void *addr, size_t size, struct pool_extents *exts)
+{
+	const struct pmemobjpool *pop = addr;
+	uint64_t heap_off = pop->heap_offset;
+	uint64_t heap_size = pop->heap_size;
+
+	if (heap_size < HEAP_MIN_SIZE || heap_off > size ||
+			heap_size > size - heap_off)
+		return -1;
+
+	const struct heap_header *hhdr =
+		(const struct heap_header *)((uintptr_t)addr + heap_off);
+	if (memcmp(hhdr->signature, HEAP_SIGNATURE, HEAP_SIGNATURE_LEN) != 0)
+		return -1;
+
+	pool_extents_add(exts, 0, heap_off + sizeof(struct heap_header));
+
+	uint64_t zone_off = heap_off + sizeof(struct heap_header);
+	uint64_t heap_end = heap_off + heap_size;
+	while (heap_end - zone_off >= ZONE_MIN_SIZE) {
+		uint64_t zone_size = min(heap_end - zone_off, ZONE_MAX_SIZE);
+		pool_live_extents_zone(addr, zone_off, zone_size, exts);
+		zone_off += zone_size;
+	}
+
+	pool_extents_add(exts, zone_off, size - zone_off);
+
+	return 0;
+}
+
+/*
+ * pool_live_extents -- find the ranges of the pool which hold live data
+ *
+ * The extents are sorted and do not overlap. If the layout of the pool is
+ * unknown or does not look consistent an error is returned and the whole
+ * pool has to be treated as live.
+ */
+int
+pool_live_extents(enum pool_type type, const void *addr, size_t size,
+	struct pool_extents *exts)
+{
+	LOG(3, "type %d addr %p size %zu", type, addr, size);
+
+	int ret;
+	switch (type) {
+	case POOL_TYPE_LOG:
+		ret = pool_live_extents_log(addr, size, exts);
+		break;
+	case POOL_TYPE_BLK:
+		ret = pool_live_extents_blk(addr, size, exts);
+		break;
+	case POOL_TYPE_OBJ:
+		ret = pool_live_extents_obj(addr, size, exts);
+		break;
+	default:
+		ret = -1;
+		break;
+	}
+
+	if (ret) {
+		LOG(2, "cannot determine live data of the pool");
+		VEC_CLEAR(exts);
+		return -1;
+	}
+
+	return 0;
+}
+
 /*
  * pool_set_part_copy -- make a copy of the poolset part
  */
 int
 pool_set_part_copy(struct pool_set_part *dpart, struct pool_set_part *spart,
-	int overwrite)
+	int overwrite, const struct pool_copy_map *map)
 {
-	LOG(3, "dpart %p spart %p", dpart, spart);
+	LOG(3, "dpart %p spart %p map %p", dpart, spart, map);
 
 	int result = 0;
 
@@ -748,6 +1299,7 @@ pool_set_part_copy(struct pool_set_part *dpart, struct pool_set_part *spart,
 	size_t dmapped = 0;
 	int is_pmem;
 	void *daddr;
+	unsigned flags = POOL_COPY_ZERO_HOLES;
 
 	if (!os_access(dpart->path, F_OK)) {
 		if (!overwrite) {
@@ -761,6 +1313,8 @@ pool_set_part_copy(struct pool_set_part *dpart, struct pool_set_part *spart,
 	} else {
 		if (errno == ENOENT) {
 			errno = 0;
+			/* a new part is zeroed, holes can be skipped */
+			flags = 0;
 			daddr = pmem_map_file(dpart->path, dpart->filesize,
 				PMEM_FILE_CREATE | PMEM_FILE_EXCL,
 				stat_buf.st_mode, &dmapped, &is_pmem);
@@ -776,12 +1330,8 @@ pool_set_part_copy(struct pool_set_part *dpart, struct pool_set_part *spart,
 
 	ASSERT(dmapped >= smapped);
 
-	if (is_pmem) {
-		pmem_memcpy_persist(daddr, saddr, smapped);
-	} else {
-		memcpy(daddr, saddr, smapped);
-		pmem_msync(daddr, smapped);
-	}
+	if (pool_copy_data(daddr, saddr, smapped, is_pmem, flags, map))
+		result = -1;
 
 	pmem_unmap(daddr, dmapped);
 out_sunmap:
@@ -40,11 +40,24 @@
 #include "libpmemobj.h"
 
 #include "queue.h"
+#include "vec.h"
 #include "set.h"
 #include "log.h"
 #include "blk.h"
 #include "btt_layout.h"
 
+/* size of data copied by a thread at once */
+#define POOL_COPY_CHUNK ((size_t)(1 << 26)) /* 64 MiB */
+/* size of data compared and persisted at once */
+#define POOL_COPY_REGION ((size_t)(1 << 16)) /* 64 KiB */
+/* maximum number of threads copying data */
+#define POOL_COPY_MAX_THREADS 16
+
+/* compare each region before writing it and skip the ones which match */
+#define POOL_COPY_COMPARE (1 << 0)
+/* zero the regions which do not hold live data instead of skipping them */
+#define POOL_COPY_ZERO_HOLES (1 << 1)
+
 enum pool_type {
 	POOL_TYPE_UNKNOWN	= (1 << 0),
 	POOL_TYPE_LOG		= (1 << 1),
@@ -116,6 +129,30 @@ struct pool_data {
 	uint32_t narenas;
 };
 
+/*
+ * pool_extent -- range of the pool which holds live data
+ */
+struct pool_extent {
+	uint64_t offset;
+	uint64_t length;
+};
+
+VEC(pool_extents, struct pool_extent);
+
+/*
+ * pool_copy_map -- describes which bytes of the copied range are live
+ *
+ * The extents are expressed in pool offsets, base is the pool offset of the
+ * first byte of the copied range. The extents apply only to the [begin, end)
+ * subrange, everything outside of it (e.g. part headers) is always copied.
+ */
+struct pool_copy_map {
+	const struct pool_extents *exts;
+	uint64_t base;
+	size_t begin;
+	size_t end;
+};
+
 struct pool_data *pool_data_alloc(PMEMpoolcheck *ppc);
 void pool_data_free(struct pool_data *pool);
 void pool_params_from_header(struct pool_params *params,
@@ -128,8 +165,13 @@ int pool_read(struct pool_data *pool, void *buff, size_t nbytes,
 int pool_write(struct pool_data *pool, const void *buff, size_t nbytes,
 	uint64_t off);
 int pool_copy(struct pool_data *pool, const char *dst_path, int overwrite);
+int pool_copy_data(void *dst, const void *src, size_t len, int is_pmem,
+	unsigned flags, const struct pool_copy_map *map);
+int pool_live_extents(enum pool_type type, const void *addr, size_t size,
+	struct pool_extents *exts);
 int pool_set_part_copy(struct pool_set_part *dpart,
-	struct pool_set_part *spart, int overwrite);
+	struct pool_set_part *spart, int overwrite,
+	const struct pool_copy_map *map);
 int pool_memset(struct pool_data *pool, uint64_t off, int c, size_t count);
 
 unsigned pool_set_files_count(struct pool_set_file *file);
@@ -61,7 +61,7 @@
 static int
 check_flags_sync(unsigned flags)
 {
-	flags &= ~(unsigned)PMEMPOOL_DRY_RUN;
+	flags &= ~(unsigned)(PMEMPOOL_DRY_RUN | PMEMPOOL_SYNC_COMPARE);
 	return flags > 0;
 }
 
@@ -76,6 +76,21 @@ check_flags_transform(unsigned flags)
 	return flags > 0;
 }
 
+/*
+ * check_flags_scrub -- (internal) check if flags are supported for scrub
+ */
+static int
+check_flags_scrub(unsigned flags)
+{
+	/* recording the checksums cannot be emulated */
+	if ((flags & PMEMPOOL_SCRUB_UPDATE) && (flags & PMEMPOOL_DRY_RUN))
+		return 1;
+
+	flags &= ~(unsigned)(PMEMPOOL_DRY_RUN | PMEMPOOL_SCRUB_UPDATE |
+		PMEMPOOL_SCRUB_REPAIR);
+	return flags > 0;
+}
+
 /*
  * replica_get_part_data_len -- get data length for given part
  */
@@ -1319,3 +1334,87 @@ pmempool_transformW(const wchar_t *poolset_src,
 	return ret;
 }
 #endif
+
+/*
+ * pmempool_scrubU -- verify the pool data against the recorded checksums
+ */
+#ifndef _WIN32
+static inline
+#endif
+int
+pmempool_scrubU(const char *path, size_t rate, unsigned flags,
+		struct pmempool_scrub_stats *stats)
+{
+	LOG(3, "path %s, rate %zu, flags %u, stats %p", path, rate, flags,
+			stats);
+	ASSERTne(path, NULL);
+
+	if (stats == NULL) {
+		ERR("invalid stats argument");
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* check if flags are supported */
+	if (check_flags_scrub(flags)) {
+		ERR("unsupported flags");
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* the path may point to a poolset file or to a single pool file */
+	struct pool_set *set = NULL;
+	if (util_poolset_create_set(&set, path, 0, 0) < 0) {
+		ERR("cannot open pool %s", path);
+		goto err;
+	}
+
+	if (replica_scrub(set, path, rate, flags, stats)) {
+		LOG(1, "scrubbing failed");
+		goto err_close;
+	}
+
+	util_poolset_close(set, DO_NOT_DELETE_PARTS);
+	return 0;
+
+err_close:
+	util_poolset_close(set, DO_NOT_DELETE_PARTS);
+
+err:
+	if (errno == 0)
+		errno = EINVAL;
+
+	return -1;
+}
+
+#ifndef _WIN32
+/*
+ * pmempool_scrub -- verify the pool data against the recorded checksums
+ */
+int
+pmempool_scrub(const char *path, size_t rate, unsigned flags,
+		struct pmempool_scrub_stats *stats)
+{
+	return pmempool_scrubU(path, rate, flags, stats);
+}
+#else
+/*
+ * pmempool_scrubW -- verify the pool data against the recorded checksums
+ *                    in widechar
+ */
+int
+pmempool_scrubW(const wchar_t *path, size_t rate, unsigned flags,
+		struct pmempool_scrub_stats *stats)
+{
+	char *upath = util_toUTF8(path);
+	if (upath == NULL) {
+		ERR("Invalid pool file path.");
+		return -1;
+	}
+
+	int ret = pmempool_scrubU(upath, rate, flags, stats);
+
+	util_free_UTF8(upath);
+	return ret;
+}
+#endif
@@ -100,6 +100,16 @@ is_dry_run(unsigned flags)
 	return PMEMPOOL_DRY_RUN & flags;
 }
 
+/*
+ * is_compare -- (internal) check whether the data should be compared before
+ *               it is written
+ */
+static inline bool
+is_compare(unsigned flags)
+{
+	return PMEMPOOL_SYNC_COMPARE & flags;
+}
+
 int replica_remove_part(struct pool_set *set, unsigned repn, unsigned partn);
 int replica_create_poolset_health_status(struct pool_set *set,
 		struct poolset_health_status **set_hsp);
@@ -134,3 +144,5 @@ int replica_sync(struct pool_set *set_in, struct poolset_health_status *set_hs,
 		unsigned flags);
 int replica_transform(struct pool_set *set_in, struct pool_set *set_out,
 		unsigned flags);
+int replica_scrub(struct pool_set *set, const char *path, size_t rate,
+		unsigned flags, struct pmempool_scrub_stats *stats);
@@ -0,0 +1,567 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * scrub.c -- a module for verifying the pool data against recorded checksums
+ *
+ * The persistent part of the pool descriptor is the first region. The heap
+ * is divided into regions of SCRUB_REGION_SIZE bytes. The run-time part of
+ * the descriptor and the lanes are not checksummed, they are modified by
+ * every run of the pool. A Fletcher64 checksum of each region is kept in
+ * a file next to the pool (or the poolset) file, with the SCRUB_FILE_EXT
+ * extension appended.
+ *
+ * A region which does not match the recorded checksum in some replicas, but
+ * matches it in another one, is damaged and it can be repaired by copying
+ * the data from the valid replica. A region which differs from the recorded
+ * checksum in all replicas was modified after the checksums were recorded, so
+ * its checksum is updated to the one of the master replica.
+ *
+ * The checksums are refreshed lazily: the file records the run id of the pool
+ * at the time of the last scrub. If the pool was opened since then, a region
+ * of a pool without replicas which differs from the recorded checksum was
+ * modified by the application and its checksum is updated. Otherwise nothing
+ * could have modified it and the region is reported as damaged.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+#include <endian.h>
+
+#include "libpmem.h"
+#include "libpmempool.h"
+#include "replica.h"
+#include "out.h"
+#include "os.h"
+#include "file.h"
+#include "mmap.h"
+#include "util.h"
+#include "obj.h"
+
+/* size of the checksummed region */
+#define SCRUB_REGION_SIZE ((size_t)1 << 20) /* 1 MiB */
+
+#define SCRUB_FILE_EXT ".scrub"
+#define SCRUB_SIGNATURE "PMEMSCRB"
+#define SCRUB_SIGNATURE_LEN 8
+
+#define NSEC_IN_SEC 1000000000ULL
+
+/*
+ * scrub_hdr -- header of the file with the checksums of the regions
+ *
+ * All fields are stored in little-endian byte order. The checksum covers
+ * the whole file.
+ */
+struct scrub_hdr {
+	char signature[SCRUB_SIGNATURE_LEN];
+	uint64_t region_size;	/* size of the checksummed region */
+	uint64_t pool_size;	/* size of the checksummed pool */
+	uint64_t nregions;	/* number of regions */
+	uuid_t poolset_uuid;	/* uuid of the checksummed pool */
+	uint64_t run_id;	/* run id of the pool at the last scrub */
+	uint64_t checksum;	/* checksum of the file */
+	uint64_t csum[];	/* checksums of the regions */
+};
+
+/*
+ * scrub_file -- the mapped file with the checksums of the regions
+ */
+struct scrub_file {
+	char *path;
+	int fd;
+	size_t size;
+	struct scrub_hdr *hdr;
+	int modified;
+	int stale;	/* the pool was opened since the last scrub */
+};
+
+/*
+ * is_scrub_update -- (internal) check whether the checksums are only recorded
+ */
+static inline int
+is_scrub_update(unsigned flags)
+{
+	return (flags & PMEMPOOL_SCRUB_UPDATE) != 0;
+}
+
+/*
+ * is_scrub_repair -- (internal) check whether damaged regions are repaired
+ */
+static inline int
+is_scrub_repair(unsigned flags)
+{
+	return (flags & PMEMPOOL_SCRUB_REPAIR) != 0;
+}
+
+/*
+ * scrub_file_size -- (internal) return size of the file for given number of
+ *	regions
+ */
+static inline size_t
+scrub_file_size(uint64_t nregions)
+{
+	return sizeof(struct scrub_hdr) + nregions * sizeof(uint64_t);
+}
+
+/*
+ * scrub_file_matches -- (internal) check if the file holds valid checksums
+ *	of the pool
+ */
+static int
+scrub_file_matches(struct scrub_file *sf, size_t pool_size,
+	uint64_t nregions, const uuid_t poolset_uuid)
+{
+	struct scrub_hdr *hdr = sf->hdr;
+
+	if (memcmp(hdr->signature, SCRUB_SIGNATURE, SCRUB_SIGNATURE_LEN)) {
+		ERR("%s: invalid signature", sf->path);
+		return 0;
+	}
+
+	if (!util_checksum(hdr, sf->size, &hdr->checksum, 0)) {
+		ERR("%s: invalid checksum", sf->path);
+		return 0;
+	}
+
+	if (le64toh(hdr->region_size) != SCRUB_REGION_SIZE ||
+			le64toh(hdr->pool_size) != pool_size ||
+			le64toh(hdr->nregions) != nregions ||
+			memcmp(hdr->poolset_uuid, poolset_uuid,
+				POOL_HDR_UUID_LEN)) {
+		ERR("%s: the checksums were recorded for a different pool",
+			sf->path);
+		return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * scrub_file_close -- (internal) store changes and unmap the file with the
+ *	checksums
+ */
+static int
+scrub_file_close(struct scrub_file *sf, int store)
+{
+	int ret = 0;
+
+	if (sf->hdr != NULL) {
+		if (store && sf->modified) {
+			util_checksum(sf->hdr, sf->size, &sf->hdr->checksum, 1);
+			if (pmem_msync(sf->hdr, sf->size)) {
+				ERR("!msync %s", sf->path);
+				ret = -1;
+			}
+		}
+		util_unmap(sf->hdr, sf->size);
+	}
+
+	if (sf->fd != -1)
+		os_close(sf->fd);
+
+	Free(sf->path);
+	return ret;
+}
+
+/*
+ * scrub_file_init -- (internal) initialize the header of a new file
+ */
+static void
+scrub_file_init(struct scrub_file *sf, size_t pool_size, uint64_t nregions,
+	const uuid_t poolset_uuid)
+{
+	struct scrub_hdr *hdr = sf->hdr;
+
+	memset(hdr, 0, sf->size);
+	memcpy(hdr->signature, SCRUB_SIGNATURE, SCRUB_SIGNATURE_LEN);
+	hdr->region_size = htole64(SCRUB_REGION_SIZE);
+	hdr->pool_size = htole64(pool_size);
+	hdr->nregions = htole64(nregions);
+	memcpy(hdr->poolset_uuid, poolset_uuid, POOL_HDR_UUID_LEN);
+	sf->modified = 1;
+}
+
+/*
+ * scrub_file_open -- (internal) open and map the file with the checksums
+ *
+ * In the update mode a missing or mismatched file is (re)created.
+ */
+static int
+scrub_file_open(struct scrub_file *sf, const char *path, size_t pool_size,
+	uint64_t nregions, const uuid_t poolset_uuid, unsigned flags)
+{
+	memset(sf, 0, sizeof(*sf));
+	sf->fd = -1;
+
+	size_t len = strlen(path) + sizeof(SCRUB_FILE_EXT);
+	sf->path = Malloc(len);
+	if (sf->path == NULL) {
+		ERR("!Malloc");
+		return -1;
+	}
+	snprintf(sf->path, len, "%s%s", path, SCRUB_FILE_EXT);
+
+	size_t size = scrub_file_size(nregions);
+	int create = 0;
+
+	if (os_access(sf->path, F_OK) != 0) {
+		if (!is_scrub_update(flags)) {
+			ERR("no checksums recorded for the pool, %s is missing",
+				sf->path);
+			errno = ENOENT;
+			goto err;
+		}
+		create = 1;
+	} else {
+		sf->fd = util_file_open(sf->path, &sf->size, 0, O_RDWR);
+		if (sf->fd < 0)
+			goto err;
+
+		if (sf->size == size) {
+			sf->hdr = util_map(sf->fd, sf->size, MAP_SHARED, 0, 0);
+			if (sf->hdr == NULL)
+				goto err;
+		}
+
+		if (sf->hdr == NULL || !scrub_file_matches(sf, pool_size,
+				nregions, poolset_uuid)) {
+			if (!is_scrub_update(flags)) {
+				if (sf->hdr == NULL)
+					ERR("%s: invalid size", sf->path);
+				errno = EINVAL;
+				goto err;
+			}
+
+			/* the checksums are recorded from scratch */
+			if (sf->hdr != NULL)
+				util_unmap(sf->hdr, sf->size);
+			sf->hdr = NULL;
+			os_close(sf->fd);
+			sf->fd = -1;
+			if (os_unlink(sf->path)) {
+				ERR("!unlink %s", sf->path);
+				goto err;
+			}
+			create = 1;
+		}
+	}
+
+	if (create) {
+		sf->size = size;
+		sf->fd = util_file_create(sf->path, sf->size, 0);
+		if (sf->fd < 0)
+			goto err;
+
+		/* the file is accessible to the same users as the pool */
+		os_stat_t stbuf;
+		if (os_stat(path, &stbuf) == 0 &&
+				os_chmod(sf->path, stbuf.st_mode & 0777)) {
+			ERR("!chmod %s", sf->path);
+			goto err;
+		}
+
+		sf->hdr = util_map(sf->fd, sf->size, MAP_SHARED, 0, 0);
+		if (sf->hdr == NULL)
+			goto err;
+
+		scrub_file_init(sf, pool_size, nregions, poolset_uuid);
+	}
+
+	return 0;
+
+err:
+	scrub_file_close(sf, 0);
+	return -1;
+}
+
+/*
+ * scrub_throttle -- (internal) suspend the execution to keep the rate of
+ *	reading the data below the limit
+ */
+static void
+scrub_throttle(const struct timespec *start, uint64_t nbytes, size_t rate)
+{
+	if (rate == 0)
+		return;
+
+	struct timespec now;
+	os_clock_gettime(CLOCK_MONOTONIC, &now);
+
+	uint64_t elapsed = (uint64_t)(now.tv_sec - start->tv_sec) *
+		NSEC_IN_SEC + (uint64_t)now.tv_nsec - (uint64_t)start->tv_nsec;
+	uint64_t expected = (uint64_t)((double)nbytes / (double)rate *
+		(double)NSEC_IN_SEC);
+
+	if (expected <= elapsed)
+		return;
+
+	uint64_t delay = expected - elapsed;
+	struct timespec req = {
+		.tv_sec = (time_t)(delay / NSEC_IN_SEC),
+		.tv_nsec = (long)(delay % NSEC_IN_SEC),
+	};
+	os_nanosleep(&req);
+}
+
+/*
+ * scrub_region -- (internal) verify a single region in all replicas and
+ *	repair it or update its checksum if needed
+ */
+static int
+scrub_region(struct pool_set *set, struct scrub_file *sf, uint64_t i,
+	size_t off, size_t len, uint64_t *csum, unsigned flags,
+	struct pmempool_scrub_stats *stats)
+{
+	for (unsigned r = 0; r < set->nreplicas; ++r) {
+		char *addr = (char *)REP(set, r)->part[0].addr + off;
+		csum[r] = util_checksum_seq(addr, len, 0);
+	}
+
+	uint64_t recorded = le64toh(sf->hdr->csum[i]);
+
+	/* the data of the master replica is recorded as the valid one */
+	if (is_scrub_update(flags) && recorded != csum[0]) {
+		recorded = csum[0];
+		sf->hdr->csum[i] = htole64(recorded);
+		sf->modified = 1;
+		stats->nupdated++;
+	}
+
+	/* find a replica with the valid data of the region */
+	unsigned valid = UNDEF_REPLICA;
+	unsigned nvalid = 0;
+	for (unsigned r = 0; r < set->nreplicas; ++r) {
+		if (csum[r] == recorded) {
+			nvalid++;
+			if (valid == UNDEF_REPLICA)
+				valid = r;
+		}
+	}
+
+	if (nvalid == set->nreplicas)
+		return 0;
+
+	if (valid == UNDEF_REPLICA) {
+		/* pool not opened since the last scrub, so nothing wrote it */
+		if (set->nreplicas == 1 && !sf->stale) {
+			ERR("region %" PRIu64 " at offset %zu is damaged",
+				i, off);
+			stats->nbad++;
+			return 0;
+		}
+
+		/*
+		 * The region was modified after the checksums were recorded.
+		 * The data of the master replica is the reference, the other
+		 * replicas may lack the data which was stored in the master
+		 * replica but was never persisted.
+		 */
+		LOG(4, "region %" PRIu64 ": modified", i);
+		recorded = csum[0];
+		if (!is_dry_run(flags)) {
+			sf->hdr->csum[i] = htole64(recorded);
+			sf->modified = 1;
+		}
+		stats->nupdated++;
+
+		valid = 0;
+		nvalid = 0;
+		for (unsigned r = 0; r < set->nreplicas; ++r) {
+			if (csum[r] == recorded)
+				nvalid++;
+		}
+
+		if (nvalid == set->nreplicas)
+			return 0;
+	}
+
+	stats->nbad++;
+	LOG(2, "region %" PRIu64 " at offset %zu is damaged in %u replica(s)",
+		i, off, set->nreplicas - nvalid);
+
+	if (!is_scrub_repair(flags) || is_dry_run(flags))
+		return 0;
+
+	char *src = (char *)REP(set, valid)->part[0].addr + off;
+	for (unsigned r = 0; r < set->nreplicas; ++r) {
+		if (csum[r] == recorded)
+			continue;
+
+		struct pool_replica *rep = REP(set, r);
+		char *dst = (char *)rep->part[0].addr + off;
+		if (pool_copy_data(dst, src, len, rep->is_pmem, 0, NULL)) {
+			ERR("!repairing region %" PRIu64 " of replica %u",
+				i, r);
+			return -1;
+		}
+	}
+
+	stats->nrepaired++;
+	return 0;
+}
+
+/*
+ * replica_scrub -- verify the data of the pool against recorded checksums
+ */
+int
+replica_scrub(struct pool_set *set, const char *path, size_t rate,
+	unsigned flags, struct pmempool_scrub_stats *stats)
+{
+	LOG(3, "set %p, path %s, rate %zu, flags %u", set, path, rate, flags);
+
+	int ret = -1;
+	struct poolset_health_status *set_hs = NULL;
+	size_t pool_size = set->poolsize;
+
+	if (set->remote) {
+		ERR("scrubbing remote replicas is not supported");
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	/* the replicas have to hold the same data, i.e. have to be in sync */
+	if (set->nreplicas > 1) {
+		if (replica_check_poolset_health(set, &set_hs, flags)) {
+			ERR("poolset health check failed");
+			return -1;
+		}
+
+		if (!replica_is_poolset_healthy(set_hs)) {
+			ERR("poolset is not healthy, synchronize the replicas "
+				"first");
+			errno = EINVAL;
+			goto out;
+		}
+
+		/* replica_check_poolset_health closes the part files */
+
+		for (unsigned r = 0; r < set->nreplicas; ++r) {
+			if (set_hs->replica[r]->pool_size < pool_size)
+				pool_size = set_hs->replica[r]->pool_size;
+		}
+	}
+
+	if (replica_open_poolset_part_files(set)) {
+		ERR("opening poolset part files failed");
+		goto out;
+	}
+
+	if (util_poolset_open(set)) {
+		ERR("opening poolset failed");
+		goto out;
+	}
+
+	struct pool_hdr *hdr = REP(set, 0)->part[0].addr;
+	if (memcmp(hdr->signature, OBJ_HDR_SIG, POOL_HDR_SIG_LEN)) {
+		ERR("scrubbing is supported only for obj pools");
+		errno = ENOTSUP;
+		goto out;
+	}
+
+	/* the run-time part of the descriptor and the lanes are skipped */
+	PMEMobjpool *pop = REP(set, 0)->part[0].addr;
+	size_t data_off = pop->heap_offset;
+	if (data_off < OBJ_LANES_OFFSET || data_off >= pool_size ||
+			data_off % sizeof(uint32_t)) {
+		ERR("invalid pool descriptor");
+		errno = EINVAL;
+		goto out;
+	}
+
+	size_t data_size = (pool_size - data_off) & ~(sizeof(uint32_t) - 1);
+	uint64_t nregions = 1 + (data_size + SCRUB_REGION_SIZE - 1) /
+		SCRUB_REGION_SIZE;
+
+	struct scrub_file sf;
+	if (scrub_file_open(&sf, path, pool_size, nregions,
+			hdr->poolset_uuid, flags))
+		goto out;
+
+	uint64_t *csum = Malloc(set->nreplicas * sizeof(uint64_t));
+	if (csum == NULL) {
+		ERR("!Malloc");
+		scrub_file_close(&sf, 0);
+		goto out;
+	}
+
+	uint64_t run_id = pop->run_id;
+	sf.stale = le64toh(sf.hdr->run_id) != run_id;
+
+	memset(stats, 0, sizeof(*stats));
+	stats->nregions = nregions;
+
+	struct timespec start;
+	os_clock_gettime(CLOCK_MONOTONIC, &start);
+
+	ret = 0;
+	uint64_t nbytes = 0;
+	for (uint64_t i = 0; i < nregions; ++i) {
+		size_t off;
+		size_t len;
+		if (i == 0) {
+			off = POOL_HDR_SIZE;
+			len = OBJ_DSC_P_SIZE;
+		} else {
+			off = data_off + (i - 1) * SCRUB_REGION_SIZE;
+			len = data_off + data_size - off;
+			if (len > SCRUB_REGION_SIZE)
+				len = SCRUB_REGION_SIZE;
+		}
+
+		if ((ret = scrub_region(set, &sf, i, off, len, csum, flags,
+				stats)))
+			break;
+
+		nbytes += len * set->nreplicas;
+		scrub_throttle(&start, nbytes, rate);
+	}
+
+	Free(csum);
+
+	if (ret == 0 && sf.stale && !is_dry_run(flags)) {
+		sf.hdr->run_id = htole64(run_id);
+		sf.modified = 1;
+	}
+
+	if (scrub_file_close(&sf, !is_dry_run(flags)))
+		ret = -1;
+
+out:
+	if (set_hs != NULL)
+		replica_free_poolset_health_status(set_hs);
+	return ret;
+}
@@ -317,6 +317,8 @@ copy_data_to_broken_parts(struct pool_set *set, unsigned healthy_replica,
 	/* get pool size from healthy replica */
 	size_t poolsize = set->poolsize;
 
+	unsigned copy_flags = is_compare(flags) ? POOL_COPY_COMPARE : 0;
+
 	for (unsigned r = 0; r < set_hs->nreplicas; ++r) {
 		/* skip unbroken and consistent replicas */
 		if (replica_is_replica_healthy(r, set_hs))
@@ -361,9 +363,27 @@ copy_data_to_broken_parts(struct pool_set *set, unsigned healthy_replica,
 					return -1;
 				}
 			} else if (rep_h->remote) {
-				int ret = Rpmem_read(rep_h->remote->rpp,
-						dst_addr,
+				RPMEMpool *rpp = rep_h->remote->rpp;
+
+				/*
+				 * Let the data land directly in the part,
+				 * if the part cannot be registered it is read
+				 * through the library's buffer.
+				 */
+				int reg = Rpmem_register(rpp, dst_addr, len);
+				if (reg)
+					LOG(2, "registering part failed -- "
+						"'%s' on '%s'",
+						rep_h->remote->pool_desc,
+						rep_h->remote->node_addr);
+
+				int ret = Rpmem_read(rpp, dst_addr,
 						off - POOL_HDR_SIZE, len, 0);
+
+				if (reg == 0 &&
+				    Rpmem_unregister(rpp, dst_addr))
+					LOG(2, "unregistering part failed");
+
 				if (ret) {
 					LOG(1, "Reading data from remote node "
 						"failed -- '%s' on '%s'",
@@ -378,9 +398,18 @@ copy_data_to_broken_parts(struct pool_set *set, unsigned healthy_replica,
 				void *src_addr =
 					ADDR_SUM(rep_h->part[0].addr, off);
 
-				/* copy all data */
-				memcpy(dst_addr, src_addr, len);
-				util_persist(part->is_dev_dax, dst_addr, len);
+				/*
+				 * copy all (or only differing) data, also the
+				 * free space, so that the replicas stay
+				 * identical for pmempool_scrub
+				 */
+				if (pool_copy_data(dst_addr, src_addr, len,
+						part->is_dev_dax, copy_flags,
+						NULL)) {
+					LOG(1, "Copying data to part '%s' "
+						"failed", part->path);
+					return -1;
+				}
 			}
 		}
 	}
@@ -631,6 +631,65 @@ rpmem_persist(RPMEMpool *rpp, size_t offset, size_t length, unsigned lane)
 	return 0;
 }
 
+/*
+ * rpmem_flush -- post persist operation on target node, the operation
+ * is completed by rpmem_drain
+ *
+ * rpp           -- remote pool handle
+ * offset        -- offset in pool
+ * length        -- length of persist operation
+ * lane          -- lane number
+ */
+int
+rpmem_flush(RPMEMpool *rpp, size_t offset, size_t length, unsigned lane)
+{
+	LOG(3, "rpp %p, offset %zu, length %zu, lane %d", rpp, offset, length,
+			lane);
+
+	if (unlikely(rpp->error)) {
+		errno = rpp->error;
+		return -1;
+	}
+
+	int ret = rpmem_fip_flush(rpp->fip, offset, length, lane);
+	if (unlikely(ret)) {
+		ERR("flush operation failed");
+		rpp->error = ret;
+		errno = rpp->error;
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * rpmem_drain -- wait for completion of persist operation posted
+ * on the lane by rpmem_flush
+ *
+ * rpp           -- remote pool handle
+ * lane          -- lane number
+ */
+int
+rpmem_drain(RPMEMpool *rpp, unsigned lane)
+{
+	LOG(3, "rpp %p, lane %d", rpp, lane);
+
+	if (unlikely(rpp->error)) {
+		errno = rpp->error;
+		return -1;
+	}
+
+	int ret = rpmem_fip_drain(rpp->fip, lane);
+	if (unlikely(ret)) {
+		ERR("drain operation failed");
+		rpp->error = ret;
+		errno = rpp->error;
+		return -1;
+	}
+
+	return 0;
+}
+
 /*
  * rpmem_read -- read data from remote pool:
  *
@@ -662,6 +721,60 @@ rpmem_read(RPMEMpool *rpp, void *buff, size_t offset,
 	return 0;
 }
 
+/*
+ * rpmem_register -- register buffer as destination of read operations
+ *
+ * rpp           -- remote pool handle
+ * buff          -- buffer
+ * length        -- length of the buffer
+ */
+int
+rpmem_register(RPMEMpool *rpp, void *buff, size_t length)
+{
+	LOG(3, "rpp %p, buff %p, length %zu", rpp, buff, length);
+
+	if (unlikely(rpp->error)) {
+		errno = rpp->error;
+		return -1;
+	}
+
+	if (!buff || !length) {
+		errno = EINVAL;
+		ERR("invalid buffer");
+		return -1;
+	}
+
+	int ret = rpmem_fip_register(rpp->fip, buff, length);
+	if (ret) {
+		errno = ret;
+		ERR("!registering buffer failed");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * rpmem_unregister -- unregister buffer registered by rpmem_register
+ *
+ * rpp           -- remote pool handle
+ * buff          -- buffer
+ */
+int
+rpmem_unregister(RPMEMpool *rpp, void *buff)
+{
+	LOG(3, "rpp %p, buff %p", rpp, buff);
+
+	int ret = rpmem_fip_unregister(rpp->fip, buff);
+	if (ret) {
+		errno = ret;
+		ERR("!unregistering buffer failed");
+		return -1;
+	}
+
+	return 0;
+}
+
 /*
  * rpmem_set_attr -- overwrite pool attributes on the remote node
  *
@@ -54,6 +54,7 @@
 #include "util.h"
 #include "os_thread.h"
 #include "os.h"
+#include "sys_util.h"
 #include "rpmem_common.h"
 #include "rpmem_fip_common.h"
 #include "rpmem_proto.h"
@@ -81,9 +82,20 @@
 #define RPMEM_RAW_BUFF_SIZE 4096
 #define RPMEM_RAW_SIZE 8
 
-typedef int (*rpmem_fip_persist_fn)(struct rpmem_fip *fip, size_t offset,
+/* maximum size of per-lane buffer for READ operations */
+#define RPMEM_RD_BUFF_SIZE ((size_t)(1 << 20)) /* 1 MiB */
+
+/*
+ * Access flags of all local buffers used as destination of READ operations,
+ * both the per-lane read buffers and the buffers registered by the user.
+ */
+#define RPMEM_RD_BUFF_ACCESS FI_READ
+
+typedef int (*rpmem_fip_flush_fn)(struct rpmem_fip *fip, size_t offset,
 		size_t len, unsigned lane);
 
+typedef int (*rpmem_fip_drain_fn)(struct rpmem_fip *fip, unsigned lane);
+
 typedef int (*rpmem_fip_process_fn)(struct rpmem_fip *fip,
 		void *context, uint64_t flags);
 
@@ -102,7 +114,8 @@ cq_read_infinite(struct fid_cq *cq, void *buf, size_t count)
  * rpmem_fip_ops -- operations specific for persistency method
  */
 struct rpmem_fip_ops {
-	rpmem_fip_persist_fn persist;
+	rpmem_fip_flush_fn flush;
+	rpmem_fip_drain_fn drain;
 	rpmem_fip_process_fn process;
 	rpmem_fip_init_fn lanes_init;
 	rpmem_fip_init_fn lanes_init_mem;
@@ -117,6 +130,7 @@ struct rpmem_fip_lane {
 	struct fid_ep *ep;		/* endpoint */
 	struct fid_cq *cq;		/* completion queue */
 	uint64_t event;
+	int pending;			/* flush posted but not drained */
 };
 
 /*
@@ -147,6 +161,29 @@ struct rpmem_fip_rlane {
 	struct rpmem_fip_rma read;	/* READ message */
 };
 
+/*
+ * rpmem_fip_rd_buff -- per-lane registered buffer for READ operations
+ *
+ * Used when the user's buffer is not registered.
+ */
+struct rpmem_fip_rd_buff {
+	void *buff;			/* read buffer */
+	size_t len;			/* read buffer length */
+	struct fid_mr *mr;		/* read buffer memory region */
+	void *mr_desc;			/* read buffer memory descriptor */
+};
+
+/*
+ * rpmem_fip_user_mr -- user's buffer registered for READ operations
+ */
+struct rpmem_fip_user_mr {
+	struct rpmem_fip_user_mr *next;
+	void *buff;			/* user's buffer */
+	size_t len;			/* user's buffer length */
+	struct fid_mr *mr;		/* memory region */
+	void *mr_desc;			/* memory descriptor */
+};
+
 struct rpmem_fip {
 	struct fi_info *fi; /* fabric interface information */
 	struct fid_fabric *fabric; /* fabric domain */
@@ -188,6 +225,10 @@ struct rpmem_fip {
 	struct fid_mr *raw_mr;		/* RAW memory region */
 	void *raw_mr_desc;		/* RAW memory descriptor */
 
+	struct rpmem_fip_rd_buff *rd_buffs; /* per-lane READ buffers */
+	struct rpmem_fip_user_mr *user_mrs; /* user's READ buffers */
+	os_rwlock_t user_mrs_lock;	/* lock for user's READ buffers */
+
 	cq_read_fn cq_read;		/* CQ read function */
 };
 
@@ -460,10 +501,12 @@ rpmem_fip_init_memory(struct rpmem_fip *fip)
 	/*
 	 * Register local memory space. The local memory will be used
 	 * with WRITE operation in rpmem_fip_persist function thus
-	 * the FI_WRITE access flag.
+	 * the FI_WRITE access flag. It is also the destination of READ
+	 * operations in rpmem_fip_read when the data is read directly
+	 * into the pool thus the FI_READ access flag.
 	 */
 	ret = fi_mr_reg(fip->domain, fip->laddr, fip->size,
-			FI_WRITE, 0, 0, 0, &fip->mr, NULL);
+			FI_WRITE | FI_READ, 0, 0, 0, &fip->mr, NULL);
 	if (ret) {
 		RPMEM_FI_ERR(ret, "registrating memory");
 		return ret;
@@ -770,10 +813,10 @@ rpmem_fip_post_lanes_apm(struct rpmem_fip *fip)
 }
 
 /*
- * rpmem_fip_persist_apm -- (internal) perform persist operation for APM
+ * rpmem_fip_flush_apm -- (internal) post persist operation for APM
  */
 static int
-rpmem_fip_persist_apm(struct rpmem_fip *fip, size_t offset,
+rpmem_fip_flush_apm(struct rpmem_fip *fip, size_t offset,
 	size_t len, unsigned lane)
 {
 	struct rpmem_fip_plane_apm *lanep = &fip->lanes[lane].apm;
@@ -800,14 +843,25 @@ rpmem_fip_persist_apm(struct rpmem_fip *fip, size_t offset,
 		return ret;
 	}
 
+	return 0;
+}
+
+/*
+ * rpmem_fip_drain_apm -- (internal) wait for persist operation for APM
+ */
+static int
+rpmem_fip_drain_apm(struct rpmem_fip *fip, unsigned lane)
+{
+	struct rpmem_fip_plane_apm *lanep = &fip->lanes[lane].apm;
+
 	/* wait for READ completion */
-	ret = rpmem_fip_lane_wait(fip, &lanep->base, FI_READ);
+	int ret = rpmem_fip_lane_wait(fip, &lanep->base, FI_READ);
 	if (unlikely(ret)) {
 		ERR("waiting for READ completion failed");
 		return ret;
 	}
 
-	return ret;
+	return 0;
 }
 
 /*
@@ -980,10 +1034,10 @@ rpmem_fip_fini_lanes_gpspm(struct rpmem_fip *fip)
 }
 
 /*
- * rpmem_fip_persist_gpspm -- (internal) perform persist operation for GPSPM
+ * rpmem_fip_flush_gpspm -- (internal) post persist operation for GPSPM
  */
 static int
-rpmem_fip_persist_gpspm(struct rpmem_fip *fip, size_t offset,
+rpmem_fip_flush_gpspm(struct rpmem_fip *fip, size_t offset,
 	size_t len, unsigned lane)
 {
 	struct rpmem_fip_plane_gpspm *lanep = &fip->lanes[lane].gpspm;
@@ -1021,6 +1075,18 @@ rpmem_fip_persist_gpspm(struct rpmem_fip *fip, size_t offset,
 		return ret;
 	}
 
+	return 0;
+}
+
+/*
+ * rpmem_fip_drain_gpspm -- (internal) wait for persist operation for GPSPM
+ */
+static int
+rpmem_fip_drain_gpspm(struct rpmem_fip *fip, unsigned lane)
+{
+	struct rpmem_fip_plane_gpspm *lanep = &fip->lanes[lane].gpspm;
+	int ret;
+
 	/* wait for persist operation completion */
 	ret = rpmem_fip_lane_wait(fip, &lanep->base, FI_RECV);
 	if (unlikely(ret)) {
@@ -1042,14 +1108,16 @@ rpmem_fip_persist_gpspm(struct rpmem_fip *fip, size_t offset,
  */
 static struct rpmem_fip_ops rpmem_fip_ops[MAX_RPMEM_PM] = {
 	[RPMEM_PM_GPSPM] = {
-		.persist = rpmem_fip_persist_gpspm,
+		.flush = rpmem_fip_flush_gpspm,
+		.drain = rpmem_fip_drain_gpspm,
 		.lanes_init = rpmem_fip_init_lanes_gpspm,
 		.lanes_init_mem = rpmem_fip_init_mem_lanes_gpspm,
 		.lanes_fini = rpmem_fip_fini_lanes_gpspm,
 		.lanes_post = rpmem_fip_post_lanes_gpspm,
 	},
 	[RPMEM_PM_APM] = {
-		.persist = rpmem_fip_persist_apm,
+		.flush = rpmem_fip_flush_apm,
+		.drain = rpmem_fip_drain_apm,
 		.lanes_init = rpmem_fip_init_lanes_apm,
 		.lanes_init_mem = rpmem_fip_init_mem_lanes_apm,
 		.lanes_fini = rpmem_fip_fini_lanes_apm,
@@ -1078,6 +1146,61 @@ rpmem_fip_set_attr(struct rpmem_fip *fip, struct rpmem_fip_attr *attr)
 	fip->ops = &rpmem_fip_ops[fip->persist_method];
 }
 
+/*
+ * rpmem_fip_rd_init -- (internal) initialize READ operations resources
+ *
+ * The per-lane READ buffers are allocated and registered on the first
+ * read performed on a lane.
+ */
+static int
+rpmem_fip_rd_init(struct rpmem_fip *fip)
+{
+	fip->rd_buffs = calloc(fip->nlanes, sizeof(*fip->rd_buffs));
+	if (!fip->rd_buffs) {
+		RPMEM_LOG(ERR, "!allocating read buffers");
+		return -1;
+	}
+
+	fip->user_mrs = NULL;
+
+	errno = os_rwlock_init(&fip->user_mrs_lock);
+	if (errno) {
+		RPMEM_LOG(ERR, "!initializing read buffers lock");
+		free(fip->rd_buffs);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * rpmem_fip_rd_fini -- (internal) deinitialize READ operations resources
+ */
+static void
+rpmem_fip_rd_fini(struct rpmem_fip *fip)
+{
+	for (unsigned i = 0; i < fip->nlanes; i++) {
+		struct rpmem_fip_rd_buff *rbuff = &fip->rd_buffs[i];
+		if (!rbuff->buff)
+			continue;
+
+		RPMEM_FI_CLOSE(rbuff->mr, "unregistering read buffer");
+		free(rbuff->buff);
+	}
+
+	free(fip->rd_buffs);
+
+	while (fip->user_mrs) {
+		struct rpmem_fip_user_mr *umr = fip->user_mrs;
+		fip->user_mrs = umr->next;
+
+		RPMEM_FI_CLOSE(umr->mr, "unregistering user's buffer");
+		free(umr);
+	}
+
+	os_rwlock_destroy(&fip->user_mrs_lock);
+}
+
 /*
  * rpmem_fip_init -- initialize fabric provider
  */
@@ -1113,7 +1236,14 @@ rpmem_fip_init(const char *node, const char *service,
 	if (ret)
 		goto err_init_lanes;
 
+	ret = rpmem_fip_rd_init(fip);
+	if (ret)
+		goto err_rd_init;
+
 	return fip;
+err_rd_init:
+	fip->ops->lanes_fini(fip);
+	rpmem_fip_lanes_fini_common(fip);
 err_init_lanes:
 	rpmem_fip_fini_fabric_res(fip);
 err_init_fabric_res:
@@ -1129,6 +1259,7 @@ err_getinfo:
 void
 rpmem_fip_fini(struct rpmem_fip *fip)
 {
+	rpmem_fip_rd_fini(fip);
 	fip->ops->lanes_fini(fip);
 	rpmem_fip_lanes_fini_common(fip);
 	rpmem_fip_fini_fabric_res(fip);
@@ -1204,10 +1335,29 @@ close_monitor:
 }
 
 /*
- * rpmem_fip_persist -- perform remote persist operation
+ * rpmem_fip_lane_drain -- (internal) wait for the lane's pending flush
+ */
+static inline int
+rpmem_fip_lane_drain(struct rpmem_fip *fip, unsigned lane)
+{
+	struct rpmem_fip_lane *lanep = &fip->lanes[lane].base;
+	if (!lanep->pending)
+		return 0;
+
+	lanep->pending = 0;
+	return fip->ops->drain(fip, lane);
+}
+
+/*
+ * rpmem_fip_flush -- post remote persist operation without waiting for
+ * its completion
+ *
+ * Only the last chunk of the range is left in flight, the earlier ones
+ * are drained before the next one is posted because each lane has
+ * a single persist response buffer.
  */
 int
-rpmem_fip_persist(struct rpmem_fip *fip, size_t offset, size_t len,
+rpmem_fip_flush(struct rpmem_fip *fip, size_t offset, size_t len,
 	unsigned lane)
 {
 	if (unlikely(fip->closing))
@@ -1224,18 +1374,27 @@ rpmem_fip_persist(struct rpmem_fip *fip, size_t offset, size_t len,
 		return 0;
 	}
 
+	struct rpmem_fip_lane *lanep = &fip->lanes[lane].base;
 
 	int ret = 0;
 	while (len > 0) {
 		size_t tmp_len = len < fip->fi->ep_attr->max_msg_size ?
 			len : fip->fi->ep_attr->max_msg_size;
 
-		ret = fip->ops->persist(fip, offset, tmp_len, lane);
+		ret = rpmem_fip_lane_drain(fip, lane);
+		if (ret) {
+			RPMEM_LOG(ERR, "persist operation failed");
+			goto err;
+		}
+
+		ret = fip->ops->flush(fip, offset, tmp_len, lane);
 		if (ret) {
 			RPMEM_LOG(ERR, "persist operation failed");
 			goto err;
 		}
 
+		lanep->pending = 1;
+
 		offset += tmp_len;
 		len -= tmp_len;
 	}
@@ -1247,14 +1406,11 @@ err:
 }
 
 /*
- * rpmem_fip_read -- perform read operation
+ * rpmem_fip_drain -- wait for completion of the lane's posted persist
  */
 int
-rpmem_fip_read(struct rpmem_fip *fip, void *buff, size_t len,
-	size_t off, unsigned lane)
+rpmem_fip_drain(struct rpmem_fip *fip, unsigned lane)
 {
-	int ret;
-
 	if (unlikely(fip->closing))
 		return ECONNRESET; /* it will be passed to errno */
 
@@ -1262,91 +1418,273 @@ rpmem_fip_read(struct rpmem_fip *fip, void *buff, size_t len,
 	if (unlikely(lane >= fip->nlanes))
 		return EINVAL; /* it will be passed to errno */
 
-	size_t rd_buff_len = len < fip->fi->ep_attr->max_msg_size ?
-		len : fip->fi->ep_attr->max_msg_size;
+	int ret = rpmem_fip_lane_drain(fip, lane);
+	if (ret)
+		RPMEM_LOG(ERR, "persist operation failed");
 
-	void *rd_buff;		/* buffer for read operation */
-	struct fid_mr *rd_mr;	/* read buffer memory region */
-	void *rd_mr_desc;	/* read buffer memory descriptor */
-	struct rpmem_fip_rlane rd_lane;
+	if (unlikely(fip->closing))
+		return ECONNRESET; /* it will be passed to errno */
+
+	return ret;
+}
+
+/*
+ * rpmem_fip_persist -- perform remote persist operation
+ */
+int
+rpmem_fip_persist(struct rpmem_fip *fip, size_t offset, size_t len,
+	unsigned lane)
+{
+	int ret = rpmem_fip_flush(fip, offset, len, lane);
+	if (ret)
+		return ret;
+
+	return rpmem_fip_drain(fip, lane);
+}
+
+/*
+ * rpmem_fip_rd_buff_get -- (internal) return registered READ buffer of the
+ * lane, allocate it on first use
+ */
+static struct rpmem_fip_rd_buff *
+rpmem_fip_rd_buff_get(struct rpmem_fip *fip, unsigned lane)
+{
+	struct rpmem_fip_rd_buff *rbuff = &fip->rd_buffs[lane];
+	if (rbuff->buff)
+		return rbuff;
+
+	size_t len = fip->fi->ep_attr->max_msg_size < RPMEM_RD_BUFF_SIZE ?
+		fip->fi->ep_attr->max_msg_size : RPMEM_RD_BUFF_SIZE;
+	void *buff;
 
 	/* allocate buffer for read operation */
-	errno = posix_memalign((void **)&rd_buff, Pagesize,
-			rd_buff_len);
+	errno = posix_memalign(&buff, Pagesize, len);
 	if (errno) {
 		RPMEM_LOG(ERR, "!allocating read buffer");
-		ret = errno;
-		goto err_malloc_rd_buff;
+		return NULL;
 	}
 
-	/*
-	 * Register buffer for read operation.
-	 * The read operation utilizes READ operation thus
-	 * the FI_REMOTE_WRITE flag.
-	 */
-	ret = fi_mr_reg(fip->domain, rd_buff,
-			rd_buff_len, FI_REMOTE_WRITE,
-			0, 0, 0, &rd_mr, NULL);
+	/* register buffer for read operation */
+	int ret = fi_mr_reg(fip->domain, buff, len, RPMEM_RD_BUFF_ACCESS,
+			0, 0, 0, &rbuff->mr, NULL);
 	if (ret) {
 		RPMEM_FI_ERR(ret, "registrating read buffer");
-		goto err_rd_mr;
+		free(buff);
+		errno = -ret;
+		return NULL;
 	}
 
 	/* get read buffer local memory descriptor */
-	rd_mr_desc = fi_mr_desc(rd_mr);
+	rbuff->mr_desc = fi_mr_desc(rbuff->mr);
+	rbuff->len = len;
+	rbuff->buff = buff;
+
+	return rbuff;
+}
+
+/*
+ * rpmem_fip_user_mr_find -- (internal) find registered memory which
+ * contains the whole buffer, must be called with user_mrs_lock held
+ */
+static int
+rpmem_fip_user_mr_find(struct rpmem_fip *fip, void *buff, size_t len,
+	void **mr_desc)
+{
+	uintptr_t start = (uintptr_t)buff;
+	uintptr_t end = start + len;
+
+	/* the pool memory is registered with READ access as well */
+	if (start >= (uintptr_t)fip->laddr &&
+	    end <= (uintptr_t)fip->laddr + fip->size) {
+		*mr_desc = fip->mr_desc;
+		return 1;
+	}
+
+	for (struct rpmem_fip_user_mr *umr = fip->user_mrs; umr;
+			umr = umr->next) {
+		if (start >= (uintptr_t)umr->buff &&
+		    end <= (uintptr_t)umr->buff + umr->len) {
+			*mr_desc = umr->mr_desc;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * rpmem_fip_read_rma -- (internal) perform READ operations of the whole
+ * range to the registered memory
+ */
+static int
+rpmem_fip_read_rma(struct rpmem_fip *fip, struct rpmem_fip_lane *lanep,
+	void *buff, void *mr_desc, size_t len, size_t off)
+{
+	struct rpmem_fip_rlane rd_lane;
+	int ret;
 
 	/*
 	 * Initialize READ message. The completion is required in order
 	 * to signal thread that READ operation has been completed.
 	 */
-	rpmem_fip_rma_init(&rd_lane.read, rd_mr_desc, 0,
+	rpmem_fip_rma_init(&rd_lane.read, mr_desc, 0,
 			fip->rkey, &rd_lane, FI_COMPLETION);
 
 	size_t rd = 0;
 	uint8_t *cbuff = buff;
-	struct rpmem_fip_lane *lanep = &fip->lanes[lane].base;
 
 	while (rd < len) {
-		size_t rd_len = len - rd < rd_buff_len ?
-				len - rd : rd_buff_len;
-		size_t rd_off = off + rd;
-		uint64_t raddr = fip->raddr + rd_off;
+		size_t rd_len = len - rd < fip->fi->ep_attr->max_msg_size ?
+				len - rd : fip->fi->ep_attr->max_msg_size;
+		uint64_t raddr = fip->raddr + off + rd;
 
 		rpmem_fip_lane_begin(lanep, FI_READ);
 
 		ret = rpmem_fip_readmsg(lanep->ep, &rd_lane.read,
-				rd_buff, rd_len, raddr);
+				&cbuff[rd], rd_len, raddr);
 		if (ret) {
 			RPMEM_FI_ERR(ret, "RMA read");
-			goto err_readmsg;
+			return ret;
 		}
 
-		VALGRIND_DO_MAKE_MEM_DEFINED(rd_buff, rd_len);
+		VALGRIND_DO_MAKE_MEM_DEFINED(&cbuff[rd], rd_len);
 
 		ret = rpmem_fip_lane_wait(fip, lanep, FI_READ);
 		if (ret) {
 			ERR("error when processing read request");
-			goto err_lane_wait;
+			return ret;
 		}
 
-		memcpy(&cbuff[rd], rd_buff, rd_len);
+		rd += rd_len;
+	}
+
+	return 0;
+}
+
+/*
+ * rpmem_fip_read -- perform read operation
+ *
+ * The data is read directly into the user's buffer if it is a part of
+ * the pool memory or it was registered by rpmem_fip_register, otherwise
+ * the lane's READ buffer is used and the data is copied.
+ */
+int
+rpmem_fip_read(struct rpmem_fip *fip, void *buff, size_t len,
+	size_t off, unsigned lane)
+{
+	int ret;
+
+	if (unlikely(fip->closing))
+		return ECONNRESET; /* it will be passed to errno */
+
+	RPMEM_ASSERT(lane < fip->nlanes);
+	if (unlikely(lane >= fip->nlanes))
+		return EINVAL; /* it will be passed to errno */
+
+	struct rpmem_fip_lane *lanep = &fip->lanes[lane].base;
+	void *mr_desc;
+
+	util_rwlock_rdlock(&fip->user_mrs_lock);
+
+	if (rpmem_fip_user_mr_find(fip, buff, len, &mr_desc)) {
+		ret = rpmem_fip_read_rma(fip, lanep, buff, mr_desc, len, off);
+		goto out_unlock;
+	}
+
+	struct rpmem_fip_rd_buff *rbuff = rpmem_fip_rd_buff_get(fip, lane);
+	if (!rbuff) {
+		ret = errno;
+		goto out_unlock;
+	}
+
+	size_t rd = 0;
+	uint8_t *cbuff = buff;
+
+	while (rd < len) {
+		size_t rd_len = len - rd < rbuff->len ? len - rd : rbuff->len;
+
+		ret = rpmem_fip_read_rma(fip, lanep, rbuff->buff,
+				rbuff->mr_desc, rd_len, off + rd);
+		if (ret)
+			goto out_unlock;
+
+		memcpy(&cbuff[rd], rbuff->buff, rd_len);
 
 		rd += rd_len;
 	}
 
 	ret = 0;
-err_lane_wait:
-err_readmsg:
-	RPMEM_FI_CLOSE(rd_mr, "unregistering memory");
-err_rd_mr:
-	free(rd_buff);
-err_malloc_rd_buff:
+out_unlock:
+	util_rwlock_unlock(&fip->user_mrs_lock);
+
 	if (unlikely(fip->closing))
 		return ECONNRESET; /* it will be passed to errno */
 
 	return ret;
 }
 
+/*
+ * rpmem_fip_register -- register user's buffer as destination of
+ * read operations
+ */
+int
+rpmem_fip_register(struct rpmem_fip *fip, void *buff, size_t len)
+{
+	struct rpmem_fip_user_mr *umr = calloc(1, sizeof(*umr));
+	if (!umr) {
+		RPMEM_LOG(ERR, "!allocating user's buffer descriptor");
+		return errno;
+	}
+
+	int ret = fi_mr_reg(fip->domain, buff, len, RPMEM_RD_BUFF_ACCESS,
+			0, 0, 0, &umr->mr, NULL);
+	if (ret) {
+		RPMEM_FI_ERR(ret, "registering user's buffer");
+		free(umr);
+		return -ret;
+	}
+
+	umr->mr_desc = fi_mr_desc(umr->mr);
+	umr->buff = buff;
+	umr->len = len;
+
+	util_rwlock_wrlock(&fip->user_mrs_lock);
+	umr->next = fip->user_mrs;
+	fip->user_mrs = umr;
+	util_rwlock_unlock(&fip->user_mrs_lock);
+
+	return 0;
+}
+
+/*
+ * rpmem_fip_unregister -- unregister user's buffer
+ */
+int
+rpmem_fip_unregister(struct rpmem_fip *fip, void *buff)
+{
+	util_rwlock_wrlock(&fip->user_mrs_lock);
+
+	struct rpmem_fip_user_mr **prev = &fip->user_mrs;
+	struct rpmem_fip_user_mr *umr = fip->user_mrs;
+	while (umr && umr->buff != buff) {
+		prev = &umr->next;
+		umr = umr->next;
+	}
+
+	if (umr)
+		*prev = umr->next;
+
+	util_rwlock_unlock(&fip->user_mrs_lock);
+
+	if (!umr)
+		return ENOENT;
+
+	int ret = RPMEM_FI_CLOSE(umr->mr, "unregistering user's buffer");
+	free(umr);
+
+	return ret ? -ret : 0;
+}
+
 /*
  * parse_bool -- convert string value to boolean
  */
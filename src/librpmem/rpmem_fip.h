@@ -62,7 +62,12 @@ int rpmem_fip_process_stop(struct rpmem_fip *fip);
 
 int rpmem_fip_persist(struct rpmem_fip *fip, size_t offset, size_t len,
 		unsigned lane);
+int rpmem_fip_flush(struct rpmem_fip *fip, size_t offset, size_t len,
+		unsigned lane);
+int rpmem_fip_drain(struct rpmem_fip *fip, unsigned lane);
 
 int rpmem_fip_read(struct rpmem_fip *fip, void *buff,
 		size_t len, size_t off, unsigned lane);
+int rpmem_fip_register(struct rpmem_fip *fip, void *buff, size_t len);
+int rpmem_fip_unregister(struct rpmem_fip *fip, void *buff);
 void rpmem_fip_probe_fork_safety(int *fork_unsafe);
@@ -145,17 +145,52 @@ vmem_fini(void)
 }
 
 /*
- * vmem_createU -- create a memory pool in a temp file
+ * vmem_map_tmpfile -- (internal) map a temp file for a pool
+ *
+ * On hugetlbfs the mapping is aligned to the page size of the file system,
+ * otherwise to the requested huge page size and the kernel is advised to use
+ * transparent huge pages for it. The size is silently rounded up to a multiple
+ * of the page size. The size of the pages known to back the mapping is
+ * returned in *pagesize.
  */
-#ifndef _WIN32
-static inline
-#endif
-VMEM *
-vmem_createU(const char *dir, size_t size)
+static void *
+vmem_map_tmpfile(const char *dir, size_t *size, size_t hugepage_size,
+		size_t *pagesize)
 {
-	vmem_construct();
+	size_t fs_pagesize = util_file_hugetlbfs_pagesize(dir);
+	size_t align = fs_pagesize ? fs_pagesize : hugepage_size;
 
-	LOG(3, "dir \"%s\" size %zu", dir, size);
+	if (align != 0)
+		*size = roundup(*size, align);
+
+	void *addr = util_map_tmpfile(dir, *size, MAX(align, 4 * MEGABYTE));
+	if (addr == NULL)
+		return NULL;
+
+	if (fs_pagesize != 0)
+		*pagesize = fs_pagesize;
+	else
+		*pagesize = Pagesize;
+
+	if (fs_pagesize == 0 && hugepage_size > Pagesize &&
+			util_map_advise_huge(addr, *size) == 0) {
+		size_t thp_pagesize = util_file_thp_pagesize(dir);
+		if (thp_pagesize != 0 && thp_pagesize <= hugepage_size)
+			*pagesize = thp_pagesize;
+	}
+
+	LOG(3, "mapped %zu bytes at %p, page size %zu", *size, addr,
+		*pagesize);
+	return addr;
+}
+
+/*
+ * vmem_create_pool -- (internal) create a memory pool in a temp file
+ */
+static VMEM *
+vmem_create_pool(const char *dir, size_t size, const pool_attr_t *pattr,
+		size_t hugepage_size)
+{
 	if (size < VMEM_MIN_POOL) {
 		ERR("size %zu smaller than %zu", size, VMEM_MIN_POOL);
 		errno = EINVAL;
@@ -167,11 +202,14 @@ vmem_createU(const char *dir, size_t size)
 	/* silently enforce multiple of mapping alignment */
 	size = roundup(size, Mmap_align);
 	void *addr;
+	size_t pagesize;
 	if (is_dev_dax) {
 		if ((addr = util_file_map_whole(dir)) == NULL)
 			return NULL;
+		pagesize = MAX(util_file_device_dax_alignment(dir), Pagesize);
 	} else {
-		if ((addr = util_map_tmpfile(dir, size, 4 * MEGABYTE)) == NULL)
+		addr = vmem_map_tmpfile(dir, &size, hugepage_size, &pagesize);
+		if (addr == NULL)
 			return NULL;
 	}
 
@@ -182,11 +220,15 @@ vmem_createU(const char *dir, size_t size)
 	vmp->addr = addr;
 	vmp->size = size;
 	vmp->caller_mapped = 0;
+	vmp->pagesize = pagesize;
+	vmp->hugepage_size = hugepage_size;
+	vmp->dir = NULL;
+	vmp->ext = NULL;
 
 	/* Prepare pool for jemalloc */
-	if (je_vmem_pool_create((void *)((uintptr_t)addr + Header_size),
+	if (je_vmem_pool_create_ex((void *)((uintptr_t)addr + Header_size),
 			size - Header_size,
-			/* zeroed if */ !is_dev_dax) == NULL) {
+			/* zeroed if */ !is_dev_dax, pattr) == NULL) {
 		ERR("pool creation failed");
 		util_unmap(vmp->addr, vmp->size);
 		return NULL;
@@ -196,14 +238,32 @@ vmem_createU(const char *dir, size_t size)
 	 * If possible, turn off all permissions on the pool header page.
 	 *
 	 * The prototype PMFS doesn't allow this when large pages are in
-	 * use. It is not considered an error if this fails.
+	 * use. It is not considered an error if this fails. It is not even
+	 * attempted for a pool backed by huge pages, as it would split the
+	 * first huge page of the pool.
 	 */
-	if (!is_dev_dax)
+	vmp->hdr_protected = !is_dev_dax && pagesize == Pagesize;
+	if (vmp->hdr_protected)
 		util_range_none(addr, sizeof(struct pool_hdr));
 
 	LOG(3, "vmp %p", vmp);
 	return vmp;
+}
 
+/*
+ * vmem_createU -- create a memory pool in a temp file
+ */
+#ifndef _WIN32
+static inline
+#endif
+VMEM *
+vmem_createU(const char *dir, size_t size)
+{
+	vmem_construct();
+
+	LOG(3, "dir \"%s\" size %zu", dir, size);
+
+	return vmem_create_pool(dir, size, NULL, 0);
 }
 
 #ifndef _WIN32
@@ -233,6 +293,235 @@ vmem_createW(const wchar_t *dir, size_t size)
 }
 #endif
 
+/*
+ * vmem_create_exU -- create a memory pool in a temp file with the given
+ *	attributes
+ */
+#ifndef _WIN32
+static inline
+#endif
+VMEM *
+vmem_create_exU(const char *dir, size_t size, const struct vmem_attr *attr)
+{
+	vmem_construct();
+
+	if (attr == NULL) {
+		LOG(3, "dir \"%s\" size %zu attr %p", dir, size, attr);
+		return vmem_create_pool(dir, size, NULL, 0);
+	}
+
+	LOG(3, "dir \"%s\" size %zu narenas %u tcache_max %zu flags 0x%x "
+		"hugepage_size %zu", dir, size, attr->narenas,
+		attr->tcache_max, attr->flags, attr->hugepage_size);
+
+	if (attr->flags & ~(VMEM_ARENA_PER_CPU | VMEM_NO_TCACHE)) {
+		ERR("invalid flags 0x%x", attr->flags);
+		errno = EINVAL;
+		return NULL;
+	}
+
+	if (attr->hugepage_size != 0 && (attr->hugepage_size < Pagesize ||
+			(attr->hugepage_size & (attr->hugepage_size - 1)))) {
+		ERR("invalid huge page size %zu", attr->hugepage_size);
+		errno = EINVAL;
+		return NULL;
+	}
+
+	pool_attr_t pattr;
+	pattr.narenas = attr->narenas;
+	pattr.arena_per_cpu = (attr->flags & VMEM_ARENA_PER_CPU) != 0;
+	pattr.tcache_disable = (attr->flags & VMEM_NO_TCACHE) != 0;
+	pattr.tcache_max = attr->tcache_max;
+
+	return vmem_create_pool(dir, size, &pattr, attr->hugepage_size);
+}
+
+#ifndef _WIN32
+/*
+ * vmem_create_ex -- create a memory pool in a temp file with the given
+ *	attributes
+ */
+VMEM *
+vmem_create_ex(const char *dir, size_t size, const struct vmem_attr *attr)
+{
+	return vmem_create_exU(dir, size, attr);
+}
+#else
+/*
+ * vmem_create_exW -- create a memory pool in a temp file with the given
+ *	attributes
+ */
+VMEM *
+vmem_create_exW(const wchar_t *dir, size_t size, const struct vmem_attr *attr)
+{
+	char *udir = util_toUTF8(dir);
+	if (udir == NULL)
+		return NULL;
+
+	VMEM *ret = vmem_create_exU(udir, size, attr);
+
+	util_free_UTF8(udir);
+	return ret;
+}
+#endif
+
+/*
+ * vmem_grow -- (internal) add a new mapping to a growable pool
+ *
+ * Called by jemalloc, without any of the pool locks held, when none of
+ * the free chunks of the pool can satisfy a chunk allocation.
+ */
+static int
+vmem_grow(pool_t *pool, size_t size, void *arg)
+{
+	struct vmem *vmp = arg;
+
+	LOG(3, "vmp %p size %zu", vmp, size);
+
+	util_mutex_lock(&vmp->grow_lock);
+
+	/* the mappings of a pool backed by huge pages are made of them */
+	size_t align = MAX(MAX(vmp->pagesize, vmp->hugepage_size), Mmap_align);
+
+	/* the descriptor of the mapping occupies its first page */
+	size_t ext_size = MAX(vmp->grow_size, size + Pagesize);
+	ext_size = roundup(MAX(ext_size, VMEM_MIN_POOL), align);
+
+	if (ext_size > vmp->max_size - vmp->total_size) {
+		/* use whatever is left, if it is enough */
+		ext_size = (vmp->max_size - vmp->total_size) & ~(align - 1);
+		if (ext_size < size + Pagesize || ext_size < VMEM_MIN_POOL) {
+			LOG(2, "pool %p reached its maximum size %zu", vmp,
+				vmp->max_size);
+			goto err;
+		}
+	}
+
+	size_t pagesize;
+	void *addr = vmem_map_tmpfile(vmp->dir, &ext_size, vmp->hugepage_size,
+			&pagesize);
+	if (addr == NULL)
+		goto err;
+
+	struct vmem_ext *ext = addr;
+	ext->addr = addr;
+	ext->size = ext_size;
+
+	if (je_vmem_pool_extend(pool, (void *)((uintptr_t)addr + Pagesize),
+			ext_size - Pagesize, /* zeroed */ 1) == 0) {
+		ERR("cannot extend pool %p", vmp);
+		util_unmap(addr, ext_size);
+		goto err;
+	}
+
+	ext->next = vmp->ext;
+	vmp->ext = ext;
+	vmp->total_size += ext_size;
+
+	LOG(3, "pool %p extended by %zu bytes, total size %zu", vmp, ext_size,
+		vmp->total_size);
+
+	util_mutex_unlock(&vmp->grow_lock);
+	return 0;
+
+err:
+	util_mutex_unlock(&vmp->grow_lock);
+	return -1;
+}
+
+/*
+ * vmem_create_growableU -- create a memory pool in a temp file, which grows
+ *	by adding more temp files when it runs out of memory
+ */
+#ifndef _WIN32
+static inline
+#endif
+VMEM *
+vmem_create_growableU(const char *dir, size_t size, size_t max_size,
+		size_t grow_size)
+{
+	vmem_construct();
+
+	LOG(3, "dir \"%s\" size %zu max_size %zu grow_size %zu", dir, size,
+		max_size, grow_size);
+
+	if (max_size == 0)
+		max_size = SIZE_MAX;
+
+	if (max_size < size) {
+		ERR("max_size %zu smaller than size %zu", max_size, size);
+		errno = EINVAL;
+		return NULL;
+	}
+
+	if (util_file_is_device_dax(dir)) {
+		ERR("device dax cannot be used for a growable pool");
+		errno = EINVAL;
+		return NULL;
+	}
+
+	char *pdir = Strdup(dir);
+	if (pdir == NULL) {
+		ERR("!Strdup");
+		return NULL;
+	}
+
+	VMEM *vmp = vmem_createU(dir, size);
+	if (vmp == NULL)
+		goto err_free;
+
+	vmp->dir = pdir;
+	vmp->max_size = max_size;
+	vmp->grow_size = grow_size ? grow_size : vmp->size;
+	vmp->total_size = vmp->size;
+	if (os_mutex_init(&vmp->grow_lock)) {
+		ERR("!os_mutex_init");
+		goto err_delete;
+	}
+
+	je_vmem_pool_set_grow_func((pool_t *)((uintptr_t)vmp + Header_size),
+			vmem_grow, vmp);
+
+	LOG(3, "vmp %p", vmp);
+	return vmp;
+
+err_delete:
+	vmp->dir = NULL;
+	vmem_delete(vmp);
+err_free:
+	Free(pdir);
+	return NULL;
+}
+
+#ifndef _WIN32
+/*
+ * vmem_create_growable -- create a growable memory pool in a temp file
+ */
+VMEM *
+vmem_create_growable(const char *dir, size_t size, size_t max_size,
+		size_t grow_size)
+{
+	return vmem_create_growableU(dir, size, max_size, grow_size);
+}
+#else
+/*
+ * vmem_create_growableW -- create a growable memory pool in a temp file
+ */
+VMEM *
+vmem_create_growableW(const wchar_t *dir, size_t size, size_t max_size,
+		size_t grow_size)
+{
+	char *udir = util_toUTF8(dir);
+	if (udir == NULL)
+		return NULL;
+
+	VMEM *ret = vmem_create_growableU(udir, size, max_size, grow_size);
+
+	util_free_UTF8(udir);
+	return ret;
+}
+#endif
+
 /*
  * vmem_create_in_region -- create a memory pool in a given range
  */
@@ -268,6 +557,10 @@ vmem_create_in_region(void *addr, size_t size)
 	vmp->addr = addr;
 	vmp->size = size;
 	vmp->caller_mapped = 1;
+	vmp->pagesize = Pagesize;
+	vmp->hugepage_size = 0;
+	vmp->dir = NULL;
+	vmp->ext = NULL;
 
 	/* Prepare pool for jemalloc */
 	if (je_vmem_pool_create((void *)((uintptr_t)addr + Header_size),
@@ -283,7 +576,10 @@ vmem_create_in_region(void *addr, size_t size)
 	 * The prototype PMFS doesn't allow this when large pages are in
 	 * use. It is not considered an error if this fails.
 	 */
+	vmp->hdr_protected = 1;
 	util_range_none(addr, sizeof(struct pool_hdr));
+#else
+	vmp->hdr_protected = 0;
 #endif
 
 	LOG(3, "vmp %p", vmp);
@@ -304,9 +600,18 @@ vmem_delete(VMEM *vmp)
 		errno = EINVAL;
 		return;
 	}
-#ifndef _WIN32
-	util_range_rw(vmp->addr, sizeof(struct pool_hdr));
-#endif
+	if (vmp->hdr_protected)
+		util_range_rw(vmp->addr, sizeof(struct pool_hdr));
+
+	if (vmp->dir != NULL) {
+		while (vmp->ext != NULL) {
+			struct vmem_ext *ext = vmp->ext;
+			vmp->ext = ext->next;
+			util_unmap(ext->addr, ext->size);
+		}
+		os_mutex_destroy(&vmp->grow_lock);
+		Free(vmp->dir);
+	}
 
 	if (vmp->caller_mapped == 0) {
 		util_unmap(vmp->addr, vmp->size);
@@ -344,6 +649,32 @@ vmem_stats_print(VMEM *vmp, const char *opts)
 			print_jemalloc_stats, NULL, opts);
 }
 
+/*
+ * vmem_stats_get -- get the summary statistics of a pool
+ */
+int
+vmem_stats_get(VMEM *vmp, struct vmem_stats *stats)
+{
+	LOG(3, "vmp %p stats %p", vmp, stats);
+
+	pool_stats_t pstats;
+	int ret = je_vmem_pool_stats_get(
+			(pool_t *)((uintptr_t)vmp + Header_size), &pstats);
+	if (ret != 0) {
+		ERR("cannot get pool statistics");
+		errno = ret;
+		return -1;
+	}
+
+	stats->allocated = pstats.allocated;
+	stats->active = pstats.active;
+	stats->mapped = pstats.mapped;
+	stats->narenas = pstats.narenas;
+	stats->pagesize = vmp->pagesize;
+
+	return 0;
+}
+
 /*
  * vmem_malloc -- allocate memory
  */
@@ -367,6 +698,30 @@ vmem_free(VMEM *vmp, void *ptr)
 	je_vmem_pool_free((pool_t *)((uintptr_t)vmp + Header_size), ptr);
 }
 
+/*
+ * vmem_malloc_batch -- allocate a number of objects of the same size
+ */
+size_t
+vmem_malloc_batch(VMEM *vmp, size_t size, size_t n, void *ptrs[])
+{
+	LOG(3, "vmp %p size %zu n %zu ptrs %p", vmp, size, n, ptrs);
+
+	return je_vmem_pool_malloc_batch(
+		(pool_t *)((uintptr_t)vmp + Header_size), size, n, ptrs);
+}
+
+/*
+ * vmem_free_batch -- free a number of objects
+ */
+void
+vmem_free_batch(VMEM *vmp, void *ptrs[], size_t n)
+{
+	LOG(3, "vmp %p ptrs %p n %zu", vmp, ptrs, n);
+
+	je_vmem_pool_free_batch((pool_t *)((uintptr_t)vmp + Header_size),
+			ptrs, n);
+}
+
 /*
  * vmem_calloc -- allocate zeroed memory
  */
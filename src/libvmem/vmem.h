@@ -36,6 +36,7 @@
 
 #include <stddef.h>
 
+#include "os_thread.h"
 #include "pool_hdr.h"
 
 #define VMEM_LOG_PREFIX "libvmem"
@@ -46,12 +47,33 @@
 #define VMEM_HDR_SIG "VMEM   "	/* must be 8 bytes including '\0' */
 #define VMEM_FORMAT_MAJOR 1
 
+/*
+ * descriptor of a mapping added to a growable pool, stored at the beginning
+ * of the mapping itself
+ */
+struct vmem_ext {
+	void *addr;	/* mapped region */
+	size_t size;	/* size of mapped region */
+	struct vmem_ext *next;
+};
+
 struct vmem {
 	struct pool_hdr hdr;	/* memory pool header */
 
 	void *addr;	/* mapped region */
 	size_t size;	/* size of mapped region */
 	int caller_mapped;
+	size_t pagesize;	/* size of the pages backing the pool */
+	size_t hugepage_size;	/* huge page size requested for the pool */
+	int hdr_protected;	/* header page made inaccessible */
+
+	/* growable pools only */
+	char *dir;		/* directory for the additional mappings */
+	size_t max_size;	/* limit of the total size of the pool */
+	size_t grow_size;	/* minimal size of an additional mapping */
+	size_t total_size;	/* total size of all the mappings */
+	struct vmem_ext *ext;	/* list of the additional mappings */
+	os_mutex_t grow_lock;	/* serializes growing of the pool */
 };
 
 void vmem_construct(void);
@@ -74,8 +74,10 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <sys/ioctl.h>
 #ifndef __FreeBSD__
 #include <malloc.h>
+#include <linux/fs.h>
 #endif
 
 #include "libvmem.h"
@@ -102,6 +104,7 @@ static int Fd;
 static int Fd_clone;
 static int Private;
 static int Forkopt = 1; /* default behavior - remap as private */
+static size_t Hugepage_size; /* requested huge page size, 0 for none */
 
 
 /*
@@ -368,8 +371,12 @@ libvmmalloc_create(const char *dir, size_t size)
 		return NULL;
 	}
 
+	/* huge pages are enforced by the file system on hugetlbfs */
+	size_t fs_pagesize = util_file_hugetlbfs_pagesize(dir);
+	size_t align = fs_pagesize ? fs_pagesize : Hugepage_size;
+
 	/* silently enforce multiple of page size */
-	size = roundup(size, Pagesize);
+	size = roundup(size, MAX(align, Pagesize));
 
 	Fd = util_tmpfile(dir, "/vmem.XXXXXX");
 	if (Fd == -1)
@@ -382,11 +389,21 @@ libvmmalloc_create(const char *dir, size_t size)
 	}
 
 	void *addr;
-	if ((addr = util_map(Fd, size, MAP_SHARED, 0, 4 << 20)) == NULL) {
+	if ((addr = util_map(Fd, size, MAP_SHARED, 0,
+			MAX(align, 4 << 20))) == NULL) {
 		(void) os_close(Fd);
 		return NULL;
 	}
 
+	size_t pagesize = fs_pagesize ? fs_pagesize : Pagesize;
+
+	if (fs_pagesize == 0 && Hugepage_size > Pagesize &&
+			util_map_advise_huge(addr, size) == 0) {
+		size_t thp_pagesize = util_file_thp_pagesize(dir);
+		if (thp_pagesize != 0 && thp_pagesize <= Hugepage_size)
+			pagesize = thp_pagesize;
+	}
+
 	/* store opaque info at beginning of mapped area */
 	struct vmem *vmp = addr;
 	memset(&vmp->hdr, '\0', sizeof(vmp->hdr));
@@ -394,6 +411,8 @@ libvmmalloc_create(const char *dir, size_t size)
 	vmp->addr = addr;
 	vmp->size = size;
 	vmp->caller_mapped = 0;
+	vmp->pagesize = pagesize;
+	vmp->hugepage_size = Hugepage_size;
 
 	/* Prepare pool for jemalloc */
 	if (je_vmem_pool_create((void *)((uintptr_t)addr + Header_size),
@@ -407,16 +426,80 @@ libvmmalloc_create(const char *dir, size_t size)
 	 * If possible, turn off all permissions on the pool header page.
 	 *
 	 * The prototype PMFS doesn't allow this when large pages are in
-	 * use. It is not considered an error if this fails.
+	 * use. It is not considered an error if this fails. It is not even
+	 * attempted for a pool backed by huge pages, as it would split the
+	 * first huge page of the pool.
 	 */
-	util_range_none(addr, sizeof(struct pool_hdr));
+	if (pagesize == Pagesize)
+		util_range_none(addr, sizeof(struct pool_hdr));
 
+	LOG(2, "pool page size %zu", pagesize);
 	LOG(3, "vmp %p", vmp);
 	return vmp;
 }
 
+/*
+ * clone_ctx -- (internal) state of copying the used part of the pool
+ */
+struct clone_ctx {
+	char *dst;	/* mapping of the cloned pool file */
+	char *next;	/* first byte of the pool not copied yet */
+	size_t copied;	/* number of bytes copied */
+};
+
+/*
+ * clone_copy -- (internal) copy the range of the pool up to the given address
+ */
+static void
+clone_copy(struct clone_ctx *ctx, char *end)
+{
+	if (end <= ctx->next)
+		return;
+
+	size_t len = (size_t)(end - ctx->next);
+	memcpy(ctx->dst + (ctx->next - (char *)Vmp->addr), ctx->next, len);
+	ctx->copied += len;
+}
+
+/*
+ * clone_free_chunk_cb -- (internal) copy the part of the pool preceding
+ *	the free chunk and skip the chunk
+ *
+ * The free chunks do not hold any data, so they are left zeroed in the clone.
+ */
+static void
+clone_free_chunk_cb(void *addr, size_t size, void *arg)
+{
+	struct clone_ctx *ctx = arg;
+
+	clone_copy(ctx, addr);
+	ctx->next = (char *)addr + size;
+}
+
+/*
+ * libvmmalloc_reflink -- (internal) clone the pool file sharing its blocks
+ *
+ * The blocks of the file are copied on write by the file system, so the cost
+ * does not depend on the size of the pool.
+ */
+static int
+libvmmalloc_reflink(void)
+{
+#ifdef FICLONE
+	if (ioctl(Fd_clone, FICLONE, Fd) == 0) {
+		LOG(3, "pool file reflinked");
+		return 0;
+	}
+	LOG(4, "!FICLONE");
+#endif
+	return -1;
+}
+
 /*
  * libvmmalloc_clone - (internal) clone the entire pool
+ *
+ * If the file system does not support reflinks, only the allocated chunks of
+ * the pool are copied to a new file.
  */
 static int
 libvmmalloc_clone(void)
@@ -427,6 +510,9 @@ libvmmalloc_clone(void)
 	if (Fd_clone == -1)
 		return -1;
 
+	if (libvmmalloc_reflink() == 0)
+		return 0;
+
 	err = os_posix_fallocate(Fd_clone, 0, (os_off_t)Vmp->size);
 	if (err != 0) {
 		errno = err;
@@ -441,25 +527,40 @@ libvmmalloc_clone(void)
 		goto err_close;
 	}
 
-	LOG(3, "copy the entire pool file: dst %p src %p size %zu",
+	LOG(3, "copy the used part of the pool file: dst %p src %p size %zu",
 			addr, Vmp->addr, Vmp->size);
 
-	util_range_rw(Vmp->addr, sizeof(struct pool_hdr));
+	if (Vmp->pagesize == Pagesize)
+		util_range_rw(Vmp->addr, sizeof(struct pool_hdr));
+
+	struct clone_ctx ctx = {
+		.dst = addr,
+		.next = Vmp->addr,
+		.copied = 0,
+	};
 
 	/*
 	 * Part of vmem pool was probably freed at some point, so Valgrind
 	 * marked it as undefined/inaccessible. We need to duplicate the whole
 	 * pool, so as a workaround temporarily disable error reporting.
+	 *
+	 * The jemalloc prefork handler holds all the pool locks at this point,
+	 * so the free chunks can be walked safely.
 	 */
 	VALGRIND_DO_DISABLE_ERROR_REPORTING;
-	memcpy(addr, Vmp->addr, Vmp->size);
+	je_vmem_pool_free_chunks_iter((pool_t *)((uintptr_t)Vmp + Header_size),
+			clone_free_chunk_cb, &ctx);
+	clone_copy(&ctx, (char *)Vmp->addr + Vmp->size);
 	VALGRIND_DO_ENABLE_ERROR_REPORTING;
 
+	LOG(3, "copied %zu bytes", ctx.copied);
+
 	if (munmap(addr, Vmp->size)) {
 		ERR("!munmap");
 		goto err_close;
 	}
-	util_range_none(Vmp->addr, sizeof(struct pool_hdr));
+	if (Vmp->pagesize == Pagesize)
+		util_range_none(Vmp->addr, sizeof(struct pool_hdr));
 	return 0;
 
 err_close:
@@ -490,6 +591,10 @@ remap_as_private(void)
 		abort();
 	}
 
+	/* the advice does not survive replacing the mapping */
+	if (Vmp->hugepage_size > Pagesize)
+		util_map_advise_huge(Vmp->addr, Vmp->size);
+
 	Private = 1;
 }
 
@@ -700,6 +805,20 @@ libvmmalloc_init(void)
 		LOG(4, "Fork action %d", Forkopt);
 	}
 
+	if ((env_str = os_getenv(VMMALLOC_HUGEPAGE_SIZE_VAR)) != NULL) {
+		long long v = atoll(env_str);
+		if (v < 0 || (v != 0 && ((unsigned long long)v < Pagesize ||
+				(v & (v - 1)) != 0))) {
+			out_log(NULL, 0, NULL, 0, "Error (libvmmalloc): "
+					"incorrect %s value (%s)",
+					VMMALLOC_HUGEPAGE_SIZE_VAR, env_str);
+			abort();
+		}
+
+		Hugepage_size = (size_t)v;
+		LOG(4, "Huge page size %zu", Hugepage_size);
+	}
+
 	/*
 	 * XXX - vmem_create() could be used here, but then we need to
 	 * link vmem.o, including all the vmem API.
@@ -737,6 +856,7 @@ libvmmalloc_fini(void)
 		print_jemalloc_stats, NULL, "gba");
 
 	LOG_NONL(0, "\n=========    vmem pool   ========\n");
+	LOG_NONL(0, "Page size: %zu\n", Vmp->pagesize);
 	je_vmem_pool_malloc_stats_print(
 		(pool_t *)((uintptr_t)Vmp + Header_size),
 		print_jemalloc_stats, NULL, "gba");
@@ -119,6 +119,24 @@ main(int argc, char *argv[])
 			/* calculate a checksum */
 			uint64_t gold_csum = fletcher64(addr, stbuf.st_size);
 
+			/*
+			 * verify the checksum calculated in two pieces split
+			 * at the checksum location matches the gold version
+			 */
+			size_t off = (size_t)((char *)ptr - (char *)addr);
+			uint64_t seq_csum = util_checksum_seq(addr, off, 0);
+			seq_csum = util_checksum_seq((char *)addr + off,
+				stbuf.st_size - off, seq_csum);
+			UT_ASSERTeq(htole64(seq_csum), gold_csum);
+
+			/*
+			 * verify checksums of ranges, which are not multiple
+			 * of the vectorized block size
+			 */
+			size_t len = off + sizeof(uint32_t);
+			UT_ASSERTeq(htole64(util_checksum_seq(addr, len, 0)),
+				fletcher64(addr, len));
+
 			/* put the old value back */
 			*ptr = oldval;
 
@@ -0,0 +1,315 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * obj_cpp_concurrent_hash_map.cpp -- cpp bindings test for the persistent
+ * concurrent hash map
+ *
+ */
+
+#include "unittest.h"
+
+#include <libpmemobj++/concurrent_hash_map.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/transaction.hpp>
+
+#define LAYOUT "cpp"
+
+namespace nvobj = nvml::obj;
+
+namespace
+{
+
+typedef nvobj::concurrent_hash_map<int, nvobj::p<int>> map_type;
+
+const int NKEYS = 2000;
+const int NTHREADS = 8;
+const int NKEYS_MT = 500;
+
+const size_t POOL_SIZE = 16 * PMEMOBJ_MIN_POOL;
+
+struct root {
+	map_type map;
+	nvobj::persistent_ptr<map_type> pmap;
+};
+
+/*
+ * check_value -- (internal) check the value mapped to `key`
+ */
+void
+check_value(map_type &map, int key, int expected)
+{
+	map_type::const_accessor acc;
+	UT_ASSERT(map.find(acc, key));
+	UT_ASSERTeq(acc->first, key);
+	UT_ASSERTeq(acc->second, expected);
+}
+
+/*
+ * test_basic -- (internal) test inserting, looking up and erasing keys
+ */
+void
+test_basic(nvobj::pool<root> &pop)
+{
+	map_type &map = pop.get_root()->map;
+
+	UT_ASSERT(map.empty());
+	UT_ASSERTeq(map.bucket_count(), 0);
+	UT_ASSERTeq(map.count(1), 0);
+	UT_ASSERT(!map.erase(1));
+
+	for (int i = 0; i < NKEYS; ++i)
+		UT_ASSERT(map.insert(i, i * 2));
+
+	UT_ASSERTeq(map.size(), (size_t)NKEYS);
+
+	/* the table has grown incrementally with the number of elements */
+	UT_ASSERT(map.bucket_count() > map_type::INITIAL_BUCKETS);
+	UT_ASSERT(map.bucket_count() * map_type::MAX_LOAD_FACTOR * 2 >=
+		  (size_t)NKEYS);
+
+	for (int i = 0; i < NKEYS; ++i)
+		check_value(map, i, i * 2);
+	UT_ASSERTeq(map.count(NKEYS), 0);
+
+	/* no overwrite */
+	UT_ASSERT(!map.insert(std::make_pair(0, nvobj::p<int>(-1))));
+	check_value(map, 0, 0);
+
+	UT_ASSERT(!map.insert_or_assign(0, -1));
+	check_value(map, 0, -1);
+
+	for (int i = 0; i < NKEYS; i += 2)
+		UT_ASSERT(map.erase(i));
+	UT_ASSERT(!map.erase(0));
+	UT_ASSERTeq(map.size(), (size_t)NKEYS / 2);
+
+	for (int i = 0; i < NKEYS; ++i)
+		UT_ASSERTeq(map.count(i), (size_t)(i % 2));
+}
+
+/*
+ * test_accessor -- (internal) test modifying elements through accessors
+ */
+void
+test_accessor(nvobj::pool<root> &pop)
+{
+	map_type &map = pop.get_root()->map;
+
+	{
+		map_type::accessor acc;
+		UT_ASSERT(map.find(acc, 1));
+		nvobj::transaction::exec_tx(pop, [&] { acc->second = 100; });
+	}
+	check_value(map, 1, 100);
+
+	{
+		map_type::accessor acc;
+		UT_ASSERT(map.insert(acc, 0));
+		UT_ASSERTeq(acc->second, 0);
+		nvobj::transaction::exec_tx(pop, [&] { acc->second = 200; });
+
+		UT_ASSERT(!map.insert(acc, 0));
+		UT_ASSERTeq(acc->second, 200);
+	}
+	check_value(map, 0, 200);
+
+	map_type::const_accessor cacc;
+	UT_ASSERT(!map.find(cacc, -1));
+	UT_ASSERT(cacc.empty());
+}
+
+/*
+ * test_abort -- (internal) test that aborted modifications are rolled back
+ */
+void
+test_abort(nvobj::pool<root> &pop)
+{
+	map_type &map = pop.get_root()->map;
+	size_t size = map.size();
+	size_t buckets = map.bucket_count();
+
+	bool exception_thrown = false;
+	try {
+		nvobj::transaction::exec_tx(pop, [&] {
+			UT_ASSERT(map.insert(-1, -1));
+			UT_ASSERT(map.erase(1));
+			UT_ASSERT(!map.insert_or_assign(3, -3));
+
+			map_type::accessor acc;
+			UT_ASSERT(map.find(acc, 5));
+			acc->second = -5;
+
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (nvml::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+	UT_ASSERT(exception_thrown);
+
+	UT_ASSERTeq(map.size(), size);
+	UT_ASSERTeq(map.bucket_count(), buckets);
+	UT_ASSERTeq(map.count(-1), 0);
+	check_value(map, 1, 100);
+	check_value(map, 3, 6);
+	check_value(map, 5, 10);
+}
+
+/*
+ * worker -- (internal) insert and look up a disjoint range of keys
+ */
+void *
+worker(void *arg)
+{
+	auto args = static_cast<std::pair<map_type *, int> *>(arg);
+	map_type &map = *args->first;
+	int first = args->second * NKEYS_MT;
+
+	for (int i = first; i < first + NKEYS_MT; ++i) {
+		UT_ASSERT(map.insert(i, i));
+		check_value(map, i, i);
+
+		/* keys of the other threads */
+		map.count(i - first);
+	}
+
+	for (int i = first; i < first + NKEYS_MT; i += 2)
+		UT_ASSERT(map.erase(i));
+
+	return nullptr;
+}
+
+/*
+ * test_mt -- (internal) test concurrent modifications of a map allocated
+ * with make_persistent
+ */
+void
+test_mt(nvobj::pool<root> &pop)
+{
+	auto r = pop.get_root();
+
+	nvobj::transaction::exec_tx(
+		pop, [&] { r->pmap = nvobj::make_persistent<map_type>(); });
+
+	os_thread_t threads[NTHREADS];
+	std::pair<map_type *, int> args[NTHREADS];
+
+	for (int i = 0; i < NTHREADS; ++i) {
+		args[i] = std::make_pair(r->pmap.get(), i);
+		PTHREAD_CREATE(&threads[i], nullptr, worker, &args[i]);
+	}
+
+	for (int i = 0; i < NTHREADS; ++i)
+		PTHREAD_JOIN(&threads[i], nullptr);
+
+	map_type &map = *r->pmap;
+	UT_ASSERTeq(map.size(), (size_t)NTHREADS * NKEYS_MT / 2);
+	UT_ASSERT(map.bucket_count() > map_type::INITIAL_BUCKETS);
+
+	for (int i = 0; i < NTHREADS * NKEYS_MT; ++i)
+		UT_ASSERTeq(map.count(i), (size_t)(i % 2));
+}
+
+/*
+ * test_reopen -- (internal) check the maps after reopening the pool
+ */
+void
+test_reopen(nvobj::pool<root> &pop)
+{
+	auto r = pop.get_root();
+	map_type &map = r->map;
+
+	UT_ASSERTeq(map.size(), (size_t)NKEYS / 2 + 1);
+	check_value(map, 0, 200);
+	check_value(map, 1, 100);
+	check_value(map, NKEYS - 1, (NKEYS - 1) * 2);
+
+	/* the locks are usable right away */
+	UT_ASSERT(map.insert(NKEYS, 0));
+	map.clear();
+	UT_ASSERT(map.empty());
+	UT_ASSERTeq(map.count(1), 0);
+	UT_ASSERT(map.insert(1, 1));
+	check_value(map, 1, 1);
+
+	UT_ASSERTeq(r->pmap->size(), (size_t)NTHREADS * NKEYS_MT / 2);
+
+	nvobj::transaction::exec_tx(pop, [&] {
+		nvobj::delete_persistent<map_type>(r->pmap);
+		r->pmap = nullptr;
+	});
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_cpp_concurrent_hash_map");
+
+	if (argc != 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	const char *path = argv[1];
+
+	nvobj::pool<root> pop;
+
+	try {
+		pop = nvobj::pool<root>::create(path, LAYOUT, POOL_SIZE,
+						S_IWUSR | S_IRUSR);
+	} catch (nvml::pool_error &pe) {
+		UT_FATAL("!pool::create: %s %s", pe.what(), path);
+	}
+
+	test_basic(pop);
+	test_accessor(pop);
+	test_abort(pop);
+	test_mt(pop);
+
+	pop.close();
+
+	try {
+		pop = nvobj::pool<root>::open(path, LAYOUT);
+	} catch (nvml::pool_error &pe) {
+		UT_FATAL("!pool::open: %s %s", pe.what(), path);
+	}
+
+	test_reopen(pop);
+
+	pop.close();
+
+	DONE(nullptr);
+}
@@ -0,0 +1,428 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * obj_cpp_pcontainers.cpp -- cpp bindings test for the persistent vector,
+ * string and array
+ *
+ */
+
+#include "unittest.h"
+
+#include <libpmemobj++/array.hpp>
+#include <libpmemobj++/make_persistent.hpp>
+#include <libpmemobj++/p.hpp>
+#include <libpmemobj++/persistent_ptr.hpp>
+#include <libpmemobj++/pool.hpp>
+#include <libpmemobj++/string.hpp>
+#include <libpmemobj++/transaction.hpp>
+#include <libpmemobj++/vector.hpp>
+
+#include <string>
+
+#define LAYOUT "cpp"
+
+namespace nvobj = nvml::obj;
+
+namespace
+{
+
+const int TEST_SIZE = 100;
+const int ARR_SIZE = 16;
+
+/* the vector walks through many allocation classes when growing */
+const size_t POOL_SIZE = 4 * PMEMOBJ_MIN_POOL;
+
+struct foo {
+	foo() : val(0)
+	{
+	}
+
+	explicit foo(int v) : val(v)
+	{
+	}
+
+	nvobj::p<int> val;
+};
+
+struct root {
+	nvobj::vector<int> vec;
+	nvobj::string str;
+	nvobj::array<int, ARR_SIZE> arr;
+	nvobj::persistent_ptr<nvobj::vector<foo>> foovec;
+};
+
+/*
+ * abort_tx -- (internal) run `f` in a transaction and abort it
+ */
+template <typename F>
+void
+abort_tx(nvobj::pool_base &pop, F f)
+{
+	bool exception_thrown = false;
+	try {
+		nvobj::transaction::exec_tx(pop, [&] {
+			f();
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (nvml::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERT(exception_thrown);
+}
+
+/*
+ * check_sequence -- (internal) check that `vec` holds first..first+n-1
+ */
+void
+check_sequence(const nvobj::vector<int> &vec, int first, int n)
+{
+	UT_ASSERTeq(vec.size(), (size_t)n);
+	for (int i = 0; i < n; ++i)
+		UT_ASSERTeq(vec[i], first + i);
+}
+
+/*
+ * test_vector -- (internal) test modifiers of the persistent vector
+ */
+void
+test_vector(nvobj::pool<root> &pop)
+{
+	auto r = pop.get_root();
+	nvobj::vector<int> &vec = r->vec;
+
+	UT_ASSERT(vec.empty());
+	UT_ASSERTeq(vec.capacity(), 0);
+
+	/* the storage grows geometrically */
+	size_t reallocs = 0;
+	for (int i = 0; i < TEST_SIZE; ++i) {
+		size_t cap = vec.capacity();
+		vec.push_back(i);
+		if (vec.capacity() != cap)
+			reallocs++;
+	}
+	check_sequence(vec, 0, TEST_SIZE);
+	UT_ASSERT(vec.capacity() >= vec.size());
+	UT_ASSERT(reallocs <= 8);
+
+	/* data() is one contiguous range */
+	const int *d = vec.cdata();
+	for (int i = 0; i < TEST_SIZE; ++i)
+		UT_ASSERTeq(d[i], i);
+
+	int vals[] = {-1, -2, -3};
+	vec.insert(vec.cbegin() + 10, vals, vals + 3);
+	UT_ASSERTeq(vec.size(), (size_t)TEST_SIZE + 3);
+	UT_ASSERTeq(vec[9], 9);
+	UT_ASSERTeq(vec[10], -1);
+	UT_ASSERTeq(vec[12], -3);
+	UT_ASSERTeq(vec[13], 10);
+
+	vec.erase(vec.cbegin() + 10, vec.cbegin() + 13);
+	check_sequence(vec, 0, TEST_SIZE);
+
+	/* inserting an element of the vector itself */
+	vec.reserve(vec.size() + 1);
+	vec.insert(vec.cbegin(), vec[TEST_SIZE - 1]);
+	UT_ASSERTeq(vec[0], TEST_SIZE - 1);
+	UT_ASSERTeq(vec[1], 0);
+	vec.erase(vec.cbegin());
+
+	vec.emplace_back(vec.back());
+	UT_ASSERTeq(vec.back(), TEST_SIZE - 1);
+	vec.pop_back();
+
+	size_t cap = vec.capacity();
+	vec.resize(TEST_SIZE / 2);
+	check_sequence(vec, 0, TEST_SIZE / 2);
+	UT_ASSERTeq(vec.capacity(), cap);
+
+	vec.resize(TEST_SIZE, 7);
+	UT_ASSERTeq(vec[TEST_SIZE / 2 - 1], TEST_SIZE / 2 - 1);
+	UT_ASSERTeq(vec[TEST_SIZE / 2], 7);
+	UT_ASSERTeq(vec[TEST_SIZE - 1], 7);
+
+	vec.assign(TEST_SIZE * 3, 5);
+	UT_ASSERTeq(vec.size(), (size_t)TEST_SIZE * 3);
+	UT_ASSERTeq(vec[TEST_SIZE * 3 - 1], 5);
+
+	vec = {1, 2, 3};
+	check_sequence(vec, 1, 3);
+
+	vec.shrink_to_fit();
+	UT_ASSERTeq(vec.capacity(), 3);
+
+	try {
+		vec.at(3);
+		UT_ASSERT(0);
+	} catch (std::out_of_range &) {
+	}
+
+	vec.clear();
+	UT_ASSERT(vec.empty());
+	UT_ASSERTeq(vec.capacity(), 3);
+}
+
+/*
+ * test_vector_abort -- (internal) test that aborted modifications of the
+ * persistent vector are rolled back
+ */
+void
+test_vector_abort(nvobj::pool<root> &pop)
+{
+	auto r = pop.get_root();
+	nvobj::vector<int> &vec = r->vec;
+
+	vec.assign(TEST_SIZE, 0);
+	int *d = vec.data();
+	for (int i = 0; i < TEST_SIZE; ++i)
+		d[i] = i;
+	size_t cap = vec.capacity();
+
+	/* in place */
+	abort_tx(pop, [&] {
+		vec.assign(TEST_SIZE / 2, -1);
+		vec.insert(vec.cbegin(), 3, -2);
+		vec.erase(vec.cbegin() + 1);
+		vec.resize(TEST_SIZE / 4);
+		vec.range(0, 2)[1] = -3;
+		vec[0] = -4;
+	});
+	check_sequence(vec, 0, TEST_SIZE);
+	UT_ASSERTeq(vec.capacity(), cap);
+
+	/* with a reallocation */
+	abort_tx(pop, [&] {
+		vec.resize(cap * 4, -1);
+		vec.insert(vec.cbegin(), (size_t)TEST_SIZE, -2);
+		vec.shrink_to_fit();
+	});
+	check_sequence(vec, 0, TEST_SIZE);
+	UT_ASSERTeq(vec.capacity(), cap);
+
+	/* bulk modification through an iterator range */
+	abort_tx(pop, [&] {
+		for (auto &v : vec)
+			v = -1;
+	});
+	check_sequence(vec, 0, TEST_SIZE);
+}
+
+/*
+ * test_vector_obj -- (internal) test the persistent vector of objects
+ * allocated with make_persistent
+ */
+void
+test_vector_obj(nvobj::pool<root> &pop)
+{
+	auto r = pop.get_root();
+
+	nvobj::transaction::exec_tx(pop, [&] {
+		r->foovec = nvobj::make_persistent<nvobj::vector<foo>>(
+			(size_t)TEST_SIZE, foo(1));
+	});
+
+	nvobj::vector<foo> &fv = *r->foovec;
+	UT_ASSERTeq(fv.size(), (size_t)TEST_SIZE);
+	UT_ASSERTeq(fv[TEST_SIZE - 1].val, 1);
+
+	fv.emplace(fv.cbegin(), 2);
+	fv.emplace_back(3);
+	UT_ASSERTeq(fv.front().val, 2);
+	UT_ASSERTeq(fv[1].val, 1);
+	UT_ASSERTeq(fv.back().val, 3);
+
+	abort_tx(pop, [&] {
+		fv.erase(fv.cbegin(), fv.cbegin() + 2);
+		fv.front().val = 4;
+	});
+	UT_ASSERTeq(fv.size(), (size_t)TEST_SIZE + 2);
+	UT_ASSERTeq(fv.front().val, 2);
+	UT_ASSERTeq(fv[1].val, 1);
+
+	nvobj::transaction::exec_tx(pop, [&] {
+		nvobj::delete_persistent<nvobj::vector<foo>>(r->foovec);
+		r->foovec = nullptr;
+	});
+}
+
+/*
+ * test_string -- (internal) test the persistent string
+ */
+void
+test_string(nvobj::pool<root> &pop)
+{
+	auto r = pop.get_root();
+	nvobj::string &str = r->str;
+
+	UT_ASSERT(str.empty());
+	UT_ASSERTeq(str.c_str()[0], '\0');
+	UT_ASSERT(str == "");
+
+	str = "persistent";
+	UT_ASSERTeq(str.size(), 10);
+	UT_ASSERTeq(strcmp(str.c_str(), "persistent"), 0);
+
+	str += ' ';
+	str.append("memory");
+	UT_ASSERT(str == "persistent memory");
+
+	str.insert(0, "a ");
+	UT_ASSERT(str == std::string("a persistent memory"));
+
+	str.erase(0, 2);
+	UT_ASSERT(str == "persistent memory");
+
+	/* appending the string to itself */
+	str.append(str);
+	UT_ASSERT(str == "persistent memorypersistent memory");
+	str.resize(10);
+	UT_ASSERT(str == "persistent");
+	UT_ASSERTeq(str.c_str()[10], '\0');
+
+	str.push_back('!');
+	UT_ASSERTeq(str.back(), '!');
+	str.pop_back();
+
+	UT_ASSERT(str.compare("persistenT") > 0);
+	UT_ASSERT(str.compare("persistent memory") < 0);
+
+	abort_tx(pop, [&] {
+		str.assign(100, 'x');
+		str[0] = 'y';
+		str.clear();
+		str.append("aborted");
+	});
+	UT_ASSERT(str == "persistent");
+	UT_ASSERTeq(str.c_str()[10], '\0');
+
+	str.clear();
+	UT_ASSERT(str.empty());
+	UT_ASSERTeq(str.c_str()[0], '\0');
+
+	str = "persistent";
+}
+
+/*
+ * test_array -- (internal) test the persistent array
+ */
+void
+test_array(nvobj::pool<root> &pop)
+{
+	auto r = pop.get_root();
+	nvobj::array<int, ARR_SIZE> &arr = r->arr;
+
+	UT_ASSERTeq(arr.size(), (size_t)ARR_SIZE);
+
+	nvobj::transaction::exec_tx(pop, [&] {
+		arr.fill(1);
+		arr.range(2, 2)[0] = 2;
+		arr[ARR_SIZE - 1] = 3;
+	});
+	UT_ASSERTeq(arr[0], 1);
+	UT_ASSERTeq(arr[2], 2);
+	UT_ASSERTeq(arr[3], 1);
+	UT_ASSERTeq(arr.back(), 3);
+
+	abort_tx(pop, [&] {
+		arr.fill(4);
+		arr.at(0) = 5;
+	});
+	UT_ASSERTeq(arr.front(), 1);
+	UT_ASSERTeq(arr[2], 2);
+	UT_ASSERTeq(arr.back(), 3);
+
+	try {
+		arr.at(ARR_SIZE);
+		UT_ASSERT(0);
+	} catch (std::out_of_range &) {
+	}
+}
+
+/*
+ * test_reopen -- (internal) check the contents after reopening the pool
+ */
+void
+test_reopen(nvobj::pool<root> &pop)
+{
+	auto r = pop.get_root();
+
+	check_sequence(r->vec, 0, TEST_SIZE);
+	UT_ASSERT(r->str == "persistent");
+	UT_ASSERTeq(r->arr[2], 2);
+	UT_ASSERT(r->foovec == nullptr);
+}
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_cpp_pcontainers");
+
+	if (argc != 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	const char *path = argv[1];
+
+	nvobj::pool<root> pop;
+
+	try {
+		pop = nvobj::pool<root>::create(path, LAYOUT, POOL_SIZE,
+						S_IWUSR | S_IRUSR);
+	} catch (nvml::pool_error &pe) {
+		UT_FATAL("!pool::create: %s %s", pe.what(), path);
+	}
+
+	test_vector(pop);
+	test_vector_abort(pop);
+	test_vector_obj(pop);
+	test_string(pop);
+	test_array(pop);
+
+	pop.close();
+
+	try {
+		pop = nvobj::pool<root>::open(path, LAYOUT);
+	} catch (nvml::pool_error &pe) {
+		UT_FATAL("!pool::open: %s %s", pe.what(), path);
+	}
+
+	test_reopen(pop);
+
+	pop.close();
+
+	DONE(nullptr);
+}
@@ -82,6 +82,13 @@ struct foo {
 	nvobj::shared_mutex smtx;
 };
 
+struct fields {
+	nvobj::p<int> a;
+	nvobj::p<char> b;
+	nvobj::p<long long> c;
+	nvobj::persistent_ptr<foo> d;
+};
+
 struct root {
 	nvobj::persistent_ptr<foo> pfoo;
 	nvobj::persistent_ptr<nvobj::p<int>> parr;
@@ -348,6 +355,301 @@ test_tx_no_throw_abort(nvobj::pool<root> &pop)
 	UT_ASSERT(rootp->parr == nullptr);
 }
 
+/*
+ * tx_set_noexcept -- snapshot and set a property without exceptions
+ */
+int
+tx_set_noexcept(nvobj::p<int> &prop, int val) noexcept
+{
+	if (pmemobj_tx_stage() != TX_STAGE_WORK)
+		return ECANCELED;
+
+	int *raw = const_cast<int *>(&prop.get_ro());
+	int err = pmemobj_tx_add_range_direct(raw, sizeof(*raw));
+	if (err == 0)
+		*raw = val;
+
+	return err;
+}
+
+/*
+ * test_tx_noexcept -- test the non-throwing transaction variant
+ */
+void
+test_tx_noexcept(nvobj::pool<root> &pop)
+{
+	auto rootp = pop.get_root();
+
+	UT_ASSERT(rootp->pfoo == nullptr);
+
+	/* captures which do not fit in the std::function small buffer */
+	int a = 1, b = 2, c = 3, d = 4;
+	try {
+		nvobj::transaction::exec_tx(pop, [&, a, b, c, d]() {
+			rootp->pfoo = nvobj::make_persistent<foo>();
+			rootp->pfoo->bar = a + b + c + d;
+		});
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERTeq(rootp->pfoo->bar, 10);
+
+	/* explicitly type-erased callables are still accepted */
+	std::function<void()> fn = [&]() { rootp->pfoo->bar = 11; };
+	try {
+		nvobj::transaction::exec_tx(pop, fn);
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERTeq(rootp->pfoo->bar, 11);
+
+	int ret = nvobj::transaction::exec_tx_noexcept(
+		pop,
+		[&]() noexcept {
+			UT_ASSERTeq(tx_set_noexcept(rootp->pfoo->bar, 42), 0);
+		},
+		rootp->mtx, rootp->pfoo->smtx);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(rootp->pfoo->bar, 42);
+
+	ret = nvobj::transaction::exec_tx_noexcept(pop, [&]() noexcept {
+		UT_ASSERTeq(tx_set_noexcept(rootp->pfoo->bar, 43), 0);
+		pmemobj_tx_abort(EINVAL);
+	});
+	UT_ASSERTeq(ret, EINVAL);
+	UT_ASSERTeq(rootp->pfoo->bar, 42);
+
+	/* inner abort is propagated to the outer transaction */
+	ret = nvobj::transaction::exec_tx_noexcept(pop, [&]() noexcept {
+		UT_ASSERTeq(tx_set_noexcept(rootp->pfoo->bar, 44), 0);
+		int err = nvobj::transaction::exec_tx_noexcept(
+			pop, [&]() noexcept { pmemobj_tx_abort(ENOMEM); });
+		UT_ASSERTeq(err, ENOMEM);
+		UT_ASSERTeq(pmemobj_tx_stage(), TX_STAGE_ONABORT);
+
+		/* the changes have been rolled back already */
+		UT_ASSERTeq(rootp->pfoo->bar, 42);
+		UT_ASSERTeq(tx_set_noexcept(rootp->pfoo->bar, 46), ECANCELED);
+	});
+	UT_ASSERTeq(ret, ENOMEM);
+	UT_ASSERTeq(rootp->pfoo->bar, 42);
+
+	/* nested in a regular transaction */
+	try {
+		nvobj::transaction::exec_tx(pop, [&]() {
+			auto &bar = rootp->pfoo->bar;
+			ret = nvobj::transaction::exec_tx_noexcept(
+				pop, [&]() noexcept {
+					int err = tx_set_noexcept(bar, 45);
+					UT_ASSERTeq(err, 0);
+				});
+		});
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(rootp->pfoo->bar, 45);
+
+	/* p<> write following a nested abort */
+	bool exception_thrown = false;
+	try {
+		nvobj::transaction::exec_tx(pop, [&]() {
+			rootp->pfoo->bar = 47;
+			try {
+				nvobj::transaction::exec_tx(pop, [&]() {
+					nvobj::transaction::abort(EINVAL);
+				});
+			} catch (nvml::manual_tx_abort &) {
+			}
+			UT_ASSERTeq(pmemobj_tx_stage(), TX_STAGE_ONABORT);
+			UT_ASSERTeq(rootp->pfoo->bar, 45);
+
+			/* volatile properties are not affected */
+			nvobj::p<int> local = 0;
+			local = 1;
+			UT_ASSERTeq(local, 1);
+
+			rootp->pfoo->bar = 48;
+			UT_ASSERT(0);
+		});
+	} catch (nvml::transaction_error &) {
+		exception_thrown = true;
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERT(exception_thrown);
+	UT_ASSERTeq(rootp->pfoo->bar, 45);
+
+	try {
+		nvobj::transaction::exec_tx(pop, [&]() {
+			nvobj::delete_persistent<foo>(rootp->pfoo);
+			rootp->pfoo = nullptr;
+		});
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERT(rootp->pfoo == nullptr);
+}
+
+/*
+ * set_fields -- (internal) modify all the fields of `f`
+ */
+void
+set_fields(nvobj::persistent_ptr<fields> &f, int v)
+{
+	f->a = v;
+	f->b = static_cast<char>(v);
+	f->c = v;
+	f->d = nullptr;
+}
+
+/*
+ * check_fields -- (internal) check the fields set by set_fields
+ */
+void
+check_fields(nvobj::persistent_ptr<fields> &f, int v)
+{
+	UT_ASSERTeq(f->a, v);
+	UT_ASSERTeq(f->b, static_cast<char>(v));
+	UT_ASSERTeq(f->c, v);
+}
+
+/*
+ * test_tx_snapshot -- test coalesced snapshots of object ranges
+ */
+void
+test_tx_snapshot(nvobj::pool<root> &pop)
+{
+	nvobj::persistent_ptr<fields> f;
+
+	bool exception_thrown = false;
+	try {
+		nvobj::transaction::snapshot(&exception_thrown);
+	} catch (nvml::transaction_error &) {
+		exception_thrown = true;
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERT(exception_thrown);
+	exception_thrown = false;
+
+	try {
+		nvobj::transaction::exec_tx(pop, [&]() {
+			f = nvobj::make_persistent<fields>();
+			set_fields(f, 1);
+			f->d = nvobj::make_persistent<foo>();
+		});
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	check_fields(f, 1);
+
+	try {
+		nvobj::transaction::exec_tx(pop, [&]() {
+			nvobj::transaction::snapshot(f.get());
+			set_fields(f, 2);
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (nvml::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERT(exception_thrown);
+	exception_thrown = false;
+	check_fields(f, 1);
+	UT_ASSERT(f->d != nullptr);
+
+	/* the range spans the fields in between */
+	try {
+		nvobj::transaction::exec_tx(pop, [&]() {
+			nvobj::transaction::snapshot(f.get(), &fields::d,
+						     &fields::a);
+			set_fields(f, 3);
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (nvml::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERT(exception_thrown);
+	exception_thrown = false;
+	check_fields(f, 1);
+	UT_ASSERT(f->d != nullptr);
+
+	try {
+		nvobj::transaction::exec_tx(pop, [&]() {
+			nvobj::transaction::snapshot_scope<fields> s(
+				f.get(), &fields::b, &fields::c);
+			f->b = 4;
+			f->c = 4;
+
+			{
+				nvobj::transaction::snapshot_scope<fields> in(
+					f.get());
+				set_fields(f, 5);
+			}
+
+			/* the outer scope does not cover 'a' */
+			f->a = 6;
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (nvml::manual_tx_abort &) {
+		exception_thrown = true;
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	UT_ASSERT(exception_thrown);
+	check_fields(f, 1);
+	UT_ASSERT(f->d != nullptr);
+
+	try {
+		nvobj::transaction::exec_tx(pop, [&]() {
+			nvobj::transaction::snapshot_scope<fields> s(
+				f.get(), &fields::a, &fields::c);
+			nvobj::delete_persistent<foo>(f->d);
+			set_fields(f, 7);
+		});
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	check_fields(f, 7);
+	UT_ASSERT(f->d == nullptr);
+
+	/* the scope is gone, modifications add themselves again */
+	try {
+		nvobj::transaction::exec_tx(pop, [&]() {
+			set_fields(f, 8);
+			nvobj::transaction::abort(EINVAL);
+		});
+	} catch (nvml::manual_tx_abort &) {
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+
+	check_fields(f, 7);
+
+	try {
+		nvobj::transaction::exec_tx(pop, [&]() {
+			nvobj::delete_persistent<fields>(f);
+		});
+	} catch (...) {
+		UT_ASSERT(0);
+	}
+}
+
 /*
  * Scoped tests.
  */
@@ -744,6 +1046,8 @@ main(int argc, char *argv[])
 	test_tx_no_throw_no_abort(pop);
 	test_tx_throw_no_abort(pop);
 	test_tx_no_throw_abort(pop);
+	test_tx_noexcept(pop);
+	test_tx_snapshot(pop);
 
 	test_tx_no_throw_no_abort_scope<nvobj::transaction::manual>(
 		pop, real_commit);
@@ -136,6 +136,14 @@ main(int argc, char *argv[])
 	UT_ASSERTeq(r, 0);
 	UT_ASSERTne(obj_direct(thread_oid), NULL);
 
+	/* objects of all the pools used in turns */
+	for (int round = 0; round < 3; ++round) {
+		for (int i = 0; i < npools; ++i) {
+			UT_ASSERTeq((char *)obj_direct(tmpoids[i]) -
+				tmpoids[i].off, (char *)pops[i]);
+		}
+	}
+
 	os_thread_t t;
 	PTHREAD_CREATE(&t, NULL, test_worker, NULL);
 
@@ -153,6 +161,12 @@ main(int argc, char *argv[])
 		UT_ASSERTeq(obj_direct(tmpoids[i]), NULL);
 		pmemobj_close(pops[i]);
 		UT_ASSERTeq(obj_direct(oids[i]), NULL);
+
+		/* the pools still open are not affected */
+		for (int j = i + 1; j < npools; ++j) {
+			UT_ASSERTeq((char *)obj_direct(tmpoids[j]) -
+				tmpoids[j].off, (char *)pops[j]);
+		}
 	}
 
 	/* signal the worker that we're free and closed */
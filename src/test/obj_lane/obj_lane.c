@@ -125,6 +125,15 @@ static struct section_operations noop_ops = {
 	.boot = lane_noop_boot
 };
 
+/*
+ * obj_rep_sync_lane -- there are no remote replicas in this test
+ */
+void
+obj_rep_sync_lane(PMEMobjpool *pop, unsigned lane)
+{
+	UT_ASSERT(0);
+}
+
 SECTION_PARM(LANE_SECTION_ALLOCATOR, &noop_ops);
 SECTION_PARM(LANE_SECTION_LIST, &noop_ops);
 SECTION_PARM(LANE_SECTION_TRANSACTION, &noop_ops);
@@ -134,6 +143,7 @@ test_lane_boot_cleanup_ok(void)
 {
 	struct mock_pop *pop = MALLOC(sizeof(struct mock_pop));
 	pop->p.nlanes = MAX_MOCK_LANES;
+	pop->p.has_remote_replicas = 0;
 
 	base_ptr = &pop->p;
 
@@ -164,6 +174,7 @@ test_lane_boot_fail(void)
 {
 	struct mock_pop *pop = MALLOC(sizeof(struct mock_pop));
 	pop->p.nlanes = MAX_MOCK_LANES;
+	pop->p.has_remote_replicas = 0;
 
 	base_ptr = &pop->p;
 	pop->p.lanes_offset = (uint64_t)&pop->l - (uint64_t)&pop->p;
@@ -185,6 +196,7 @@ test_lane_recovery_check_ok(void)
 {
 	struct mock_pop *pop = MALLOC(sizeof(struct mock_pop));
 	pop->p.nlanes = MAX_MOCK_LANES;
+	pop->p.has_remote_replicas = 0;
 
 	base_ptr = &pop->p;
 	pop->p.lanes_offset = (uint64_t)&pop->l - (uint64_t)&pop->p;
@@ -200,6 +212,7 @@ test_lane_recovery_check_fail(void)
 {
 	struct mock_pop *pop = MALLOC(sizeof(struct mock_pop));
 	pop->p.nlanes = MAX_MOCK_LANES;
+	pop->p.has_remote_replicas = 0;
 
 	base_ptr = &pop->p;
 	pop->p.lanes_offset = (uint64_t)&pop->l - (uint64_t)&pop->p;
@@ -283,6 +296,131 @@ test_lane_sizes(void)
 				LANE_SECTION_LEN);
 }
 
+/*
+ * rep_queue_add -- add the range to the queue
+ */
+static void
+rep_queue_add(struct lane_rep_queue *q, uintptr_t addr, size_t len)
+{
+	UT_ASSERT(q->nranges < LANE_REP_RANGES_MAX);
+	q->ranges[q->nranges].addr = addr;
+	q->ranges[q->nranges].len = len;
+	q->nranges++;
+}
+
+/*
+ * rep_queue_check -- check the queue holds the given ranges
+ */
+static void
+rep_queue_check(struct lane_rep_queue *q, size_t nranges,
+	const struct lane_rep_range *exp)
+{
+	UT_ASSERTeq(q->nranges, nranges);
+	for (size_t i = 0; i < nranges; ++i) {
+		UT_ASSERTeq(q->ranges[i].addr, exp[i].addr);
+		UT_ASSERTeq(q->ranges[i].len, exp[i].len);
+	}
+}
+
+#define REP_BASE ((uintptr_t)0x100000)
+#define REP_SPAN_LINES 512
+
+/*
+ * test_lane_rep_queue_coalesce -- check the ranges deferred for the remote
+ *	replicas are merged into sorted, disjoint extents covering exactly
+ *	the cache lines of the original ranges
+ */
+static void
+test_lane_rep_queue_coalesce(void)
+{
+	struct lane_rep_queue *q = MALLOC(sizeof(*q));
+
+	/* empty queue */
+	q->nranges = 0;
+	lane_rep_queue_coalesce(q);
+	UT_ASSERTeq(q->nranges, 0);
+
+	/* adjacent ranges */
+	q->nranges = 0;
+	rep_queue_add(q, REP_BASE, 64);
+	rep_queue_add(q, REP_BASE + 64, 64);
+	lane_rep_queue_coalesce(q);
+	struct lane_rep_range adjacent[] = {{REP_BASE, 128}};
+	rep_queue_check(q, 1, adjacent);
+
+	/* overlapping, unaligned and out of order ranges */
+	q->nranges = 0;
+	rep_queue_add(q, REP_BASE + 0x130, 0x50);
+	rep_queue_add(q, REP_BASE + 0x110, 0x30);
+	rep_queue_add(q, REP_BASE + 0x108, 8);
+	lane_rep_queue_coalesce(q);
+	struct lane_rep_range overlapping[] = {{REP_BASE + 0x100, 0x80}};
+	rep_queue_check(q, 1, overlapping);
+
+	/* ranges in the same cache line, a range within another one */
+	q->nranges = 0;
+	rep_queue_add(q, REP_BASE + 0x1000, 0x100);
+	rep_queue_add(q, REP_BASE + 0x1008, 8);
+	rep_queue_add(q, REP_BASE + 0x1038, 8);
+	rep_queue_add(q, REP_BASE + 0x1080, 0x10);
+	lane_rep_queue_coalesce(q);
+	struct lane_rep_range nested[] = {{REP_BASE + 0x1000, 0x100}};
+	rep_queue_check(q, 1, nested);
+
+	/* ranges separated by a cache line are not merged */
+	q->nranges = 0;
+	rep_queue_add(q, REP_BASE + 0x2080, 8);
+	rep_queue_add(q, REP_BASE + 0x2000, 8);
+	lane_rep_queue_coalesce(q);
+	struct lane_rep_range separate[] = {
+		{REP_BASE + 0x2000, 64},
+		{REP_BASE + 0x2080, 64},
+	};
+	rep_queue_check(q, 2, separate);
+
+	/* random ranges, the merged extents cover their union */
+	srand(1234);
+	for (int n = 0; n < 1000; ++n) {
+		int exp_lines[REP_SPAN_LINES] = {0};
+		int lines[REP_SPAN_LINES] = {0};
+
+		q->nranges = 0;
+		size_t nranges = 1 + (size_t)rand() % LANE_REP_RANGES_MAX;
+		for (size_t i = 0; i < nranges; ++i) {
+			size_t off = (size_t)rand() % (REP_SPAN_LINES * 48);
+			size_t len = 1 + (size_t)rand() % 512;
+			rep_queue_add(q, REP_BASE + off, len);
+
+			for (size_t l = off / 64; l <= (off + len - 1) / 64;
+					++l)
+				exp_lines[l] = 1;
+		}
+
+		lane_rep_queue_coalesce(q);
+
+		UT_ASSERT(q->nranges > 0 && q->nranges <= nranges);
+		for (size_t i = 0; i < q->nranges; ++i) {
+			struct lane_rep_range *r = &q->ranges[i];
+			UT_ASSERTeq(r->addr % 64, 0);
+			UT_ASSERTeq(r->len % 64, 0);
+			UT_ASSERTne(r->len, 0);
+
+			/* sorted, neither overlapping nor adjacent */
+			if (i > 0)
+				UT_ASSERT(r->addr > r[-1].addr + r[-1].len);
+
+			for (size_t l = (r->addr - REP_BASE) / 64;
+					l < (r->addr + r->len - REP_BASE) / 64;
+					++l)
+				lines[l] = 1;
+		}
+
+		UT_ASSERTeq(memcmp(lines, exp_lines, sizeof(lines)), 0);
+	}
+
+	FREE(q);
+}
+
 enum thread_work_type {
 	LANE_INFO_DESTROY,
 	LANE_CLEANUP
@@ -346,6 +484,7 @@ test_lane_cleanup_in_separate_thread(void)
 {
 	struct mock_pop *pop = MALLOC(sizeof(struct mock_pop));
 	pop->p.nlanes = MAX_MOCK_LANES;
+	pop->p.has_remote_replicas = 0;
 
 	base_ptr = &pop->p;
 
@@ -402,6 +541,7 @@ main(int argc, char *argv[])
 		test_lane_recovery_check_fail();
 		test_lane_hold_release();
 		test_lane_sizes();
+		test_lane_rep_queue_coalesce();
 		break;
 	case 'm':
 		/* multithreaded scenarios */
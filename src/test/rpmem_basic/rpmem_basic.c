@@ -365,14 +365,43 @@ persist_thread(void *arg)
 }
 
 /*
- * test_persist -- test case for persist operation
+ * flush_thread -- flush worker thread function
+ *
+ * Posts all the flushes on the lane without draining them in between,
+ * then drains the lane twice, the second time with nothing pending.
  */
-static int
-test_persist(const struct test_case *tc, int argc, char *argv[])
+static void *
+flush_thread(void *arg)
 {
-	if (argc < 4)
-		UT_FATAL("usage: test_persist <id> <seed> <nthreads> <nops>");
+	struct thread_arg *args = arg;
+	size_t flush_size = args->size / args->nops;
+	UT_ASSERTeq(args->size % args->nops, 0);
+
+	int ret = 0;
+	for (int i = 0; i < args->nops && ret == 0; i++) {
+		size_t off = args->off + i * flush_size;
+		ret = rpmem_flush(args->rpp, off, flush_size, args->lane);
+	}
+
+	/* an error of a flush may be reported only by the drain */
+	if (ret == 0)
+		ret = rpmem_drain(args->rpp, args->lane);
+	check_return_and_errno(ret, args->exp_errno);
 
+	/* the error sticks to the pool, nothing is pending otherwise */
+	ret = rpmem_drain(args->rpp, args->lane);
+	check_return_and_errno(ret, args->exp_errno);
+
+	return NULL;
+}
+
+/*
+ * run_threads -- fill the pool with random data and run the worker threads
+ * on separate parts of it
+ */
+static void
+run_threads(int argc, char *argv[], void *(*func)(void *))
+{
 	int id = atoi(argv[0]);
 	UT_ASSERT(id >= 0 && id < MAX_IDS);
 	struct pool_entry *pool = &pools[id];
@@ -404,7 +433,7 @@ test_persist(const struct test_case *tc, int argc, char *argv[])
 		args[i].size = size_left < size_per_thread ?
 				size_left : size_per_thread;
 		args[i].exp_errno = pool->exp_errno;
-		PTHREAD_CREATE(&threads[i], NULL, persist_thread, &args[i]);
+		PTHREAD_CREATE(&threads[i], NULL, func, &args[i]);
 	}
 
 	for (int i = 0; i < nthreads; i++)
@@ -412,10 +441,56 @@ test_persist(const struct test_case *tc, int argc, char *argv[])
 
 	FREE(args);
 	FREE(threads);
+}
+
+/*
+ * test_persist -- test case for persist operation
+ */
+static int
+test_persist(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 4)
+		UT_FATAL("usage: test_persist <id> <seed> <nthreads> <nops>");
+
+	run_threads(argc, argv, persist_thread);
+
+	return 4;
+}
+
+/*
+ * test_flush -- test case for flush and drain operations
+ */
+static int
+test_flush(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 4)
+		UT_FATAL("usage: test_flush <id> <seed> <nthreads> <nops>");
+
+	run_threads(argc, argv, flush_thread);
 
 	return 4;
 }
 
+/*
+ * test_drain -- test case for drain with no flush posted on the lane
+ */
+static int
+test_drain(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 2)
+		UT_FATAL("usage: test_drain <id> <lane>");
+
+	int id = atoi(argv[0]);
+	UT_ASSERT(id >= 0 && id < MAX_IDS);
+	struct pool_entry *pool = &pools[id];
+	unsigned lane = (unsigned)atoi(argv[1]);
+
+	int ret = rpmem_drain(pool->rpp, lane);
+	check_return_and_errno(ret, pool->exp_errno);
+
+	return 2;
+}
+
 /*
  * test_read -- test case for read operation
  */
@@ -448,6 +523,55 @@ test_read(const struct test_case *tc, int argc, char *argv[])
 	return 2;
 }
 
+/*
+ * test_register -- test case for registering the pool buffer as destination
+ * of read operations
+ */
+static int
+test_register(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_register <id>");
+
+	int id = atoi(argv[0]);
+	UT_ASSERT(id >= 0 && id < MAX_IDS);
+	struct pool_entry *pool = &pools[id];
+
+	void *buff = (void *)((uintptr_t)pool->pool + POOL_HDR_SIZE);
+	size_t buff_size = pool->size - POOL_HDR_SIZE;
+
+	int ret = rpmem_register(pool->rpp, buff, buff_size);
+	check_return_and_errno(ret, pool->exp_errno);
+
+	return 1;
+}
+
+/*
+ * test_unregister -- test case for unregistering the pool buffer
+ */
+static int
+test_unregister(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_unregister <id>");
+
+	int id = atoi(argv[0]);
+	UT_ASSERT(id >= 0 && id < MAX_IDS);
+	struct pool_entry *pool = &pools[id];
+
+	void *buff = (void *)((uintptr_t)pool->pool + POOL_HDR_SIZE);
+
+	int ret = rpmem_unregister(pool->rpp, buff);
+	UT_ASSERTeq(ret, 0);
+
+	/* the buffer is not registered anymore */
+	ret = rpmem_unregister(pool->rpp, buff);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, ENOENT);
+
+	return 1;
+}
+
 /*
  * test_remove -- test case for remove operation
  */
@@ -700,7 +824,11 @@ static struct test_case test_cases[] = {
 	TEST_CASE(test_set_attr),
 	TEST_CASE(test_close),
 	TEST_CASE(test_persist),
+	TEST_CASE(test_flush),
+	TEST_CASE(test_drain),
 	TEST_CASE(test_read),
+	TEST_CASE(test_register),
+	TEST_CASE(test_unregister),
 	TEST_CASE(test_remove),
 	TEST_CASE(check_pool),
 	TEST_CASE(fill_pool),
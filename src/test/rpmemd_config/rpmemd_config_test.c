@@ -51,7 +51,9 @@ static const char *config_print_fmt =
 "persist_general:\t%s\n"
 "use_syslog:\t\t%s\n"
 "max_lanes:\t\t%" PRIu64 "\n"
-"log_level:\t\t%s";
+"log_level:\t\t%s\n"
+"nthreads:\t\t%" PRIu64 "\n"
+"busy_poll:\t\t%s";
 
 /*
  * bool_to_str -- convert bool value to a string ("yes" / "no")
@@ -78,7 +80,9 @@ config_print(struct rpmemd_config *config)
 		bool_to_str(config->persist_general),
 		bool_to_str(config->use_syslog),
 		config->max_lanes,
-		rpmemd_log_level_to_str(config->log_level));
+		rpmemd_log_level_to_str(config->log_level),
+		config->nthreads,
+		bool_to_str(config->busy_poll));
 }
 
 /*
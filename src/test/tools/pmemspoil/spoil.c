@@ -1253,8 +1253,9 @@ pmemspoil_process_pmemobj(struct pmemspoil *psp,
 	struct lane_layout *lanes = (void *)((char *)pop + pop->lanes_offset);
 
 	PROCESS_BEGIN(psp, pfp) {
+		/* the descriptor starts right after the pool header */
 		struct checksum_args checksum_args = {
-			.ptr = pop,
+			.ptr = (char *)pop + sizeof(struct pool_hdr),
 			.len = OBJ_DSC_P_SIZE,
 			.checksum = &pop->checksum,
 		};
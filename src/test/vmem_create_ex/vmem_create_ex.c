@@ -0,0 +1,235 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * vmem_create_ex.c -- unit test for vmem_create_ex and vmem_stats_get
+ *
+ * usage: vmem_create_ex directory
+ */
+
+#include "unittest.h"
+
+#define NTHREADS 8
+#define NALLOCS 1000
+#define ALLOC_SIZE 64
+#define UNCACHED_SIZE (16 * 1024)
+#define HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+/* a pool too small for each of the arenas to own a chunk */
+#define NARENAS_MANY 8
+
+static VMEM *Vmp;
+
+static os_mutex_t Lock;
+static os_cond_t Cond;
+static int Nallocated;
+
+/*
+ * thread_func -- (internal) allocate and free objects in the pool
+ *
+ * All the threads hold their objects until every thread has allocated, so
+ * that they are alive at the same time and do not share arenas.
+ */
+static void *
+thread_func(void *arg)
+{
+	void **ptrs = MALLOC(NALLOCS * sizeof(void *));
+
+	for (int i = 0; i < NALLOCS; ++i) {
+		ptrs[i] = vmem_malloc(Vmp, ALLOC_SIZE);
+		UT_ASSERTne(ptrs[i], NULL);
+	}
+
+	os_mutex_lock(&Lock);
+	if (++Nallocated == NTHREADS)
+		os_cond_broadcast(&Cond);
+	while (Nallocated < NTHREADS)
+		os_cond_wait(&Cond, &Lock);
+	os_mutex_unlock(&Lock);
+
+	for (int i = 0; i < NALLOCS; ++i)
+		vmem_free(Vmp, ptrs[i]);
+
+	FREE(ptrs);
+	return NULL;
+}
+
+/*
+ * run_threads -- (internal) run the threads allocating from the pool
+ */
+static void
+run_threads(void)
+{
+	os_thread_t threads[NTHREADS];
+
+	Nallocated = 0;
+	for (int t = 0; t < NTHREADS; ++t)
+		PTHREAD_CREATE(&threads[t], NULL, thread_func, NULL);
+
+	for (int t = 0; t < NTHREADS; ++t)
+		PTHREAD_JOIN(&threads[t], NULL);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "vmem_create_ex");
+
+	if (argc != 2)
+		UT_FATAL("usage: %s directory", argv[0]);
+
+	char *dir = argv[1];
+	os_mutex_init(&Lock);
+	os_cond_init(&Cond);
+
+	struct vmem_stats stats;
+	struct vmem_attr attr;
+	memset(&attr, 0, sizeof(attr));
+
+	/* unknown flags */
+	attr.flags = ~0U;
+	UT_ASSERTeq(vmem_create_ex(dir, VMEM_MIN_POOL, &attr), NULL);
+	UT_ASSERTeq(errno, EINVAL);
+	attr.flags = 0;
+
+	/* huge page size not being a power of two */
+	attr.hugepage_size = 3 * Ut_pagesize;
+	UT_ASSERTeq(vmem_create_ex(dir, VMEM_MIN_POOL, &attr), NULL);
+	UT_ASSERTeq(errno, EINVAL);
+	attr.hugepage_size = 0;
+
+	/* the default attributes */
+	Vmp = vmem_create_ex(dir, VMEM_MIN_POOL, NULL);
+	if (Vmp == NULL)
+		UT_FATAL("!vmem_create_ex");
+	UT_ASSERTeq(vmem_stats_get(Vmp, &stats), 0);
+	UT_ASSERTeq(stats.allocated, 0);
+	UT_ASSERTne(stats.narenas, 0);
+	UT_ASSERT(stats.pagesize >= Ut_pagesize);
+	vmem_delete(Vmp);
+
+	/*
+	 * The pool aligned to huge pages. Whether they are used depends on
+	 * the file system and the system configuration.
+	 */
+	attr.hugepage_size = HUGEPAGE_SIZE;
+	Vmp = vmem_create_ex(dir, VMEM_MIN_POOL, &attr);
+	if (Vmp == NULL)
+		UT_FATAL("!vmem_create_ex");
+	UT_ASSERTeq((uintptr_t)Vmp % HUGEPAGE_SIZE, 0);
+	UT_ASSERTeq(vmem_stats_get(Vmp, &stats), 0);
+	UT_ASSERT(stats.pagesize >= Ut_pagesize);
+	UT_ASSERTeq(stats.pagesize & (stats.pagesize - 1), 0);
+
+	void *ptr = vmem_malloc(Vmp, 2 * HUGEPAGE_SIZE);
+	UT_ASSERTne(ptr, NULL);
+	memset(ptr, 0xc5, 2 * HUGEPAGE_SIZE);
+	vmem_free(Vmp, ptr);
+	UT_ASSERTeq(vmem_check(Vmp), 1);
+	vmem_delete(Vmp);
+	attr.hugepage_size = 0;
+
+	/* threads bound to arenas by CPU, no thread caches */
+	attr.narenas = 4;
+	attr.flags = VMEM_ARENA_PER_CPU | VMEM_NO_TCACHE;
+	Vmp = vmem_create_ex(dir, VMEM_MIN_POOL, &attr);
+	if (Vmp == NULL)
+		UT_FATAL("!vmem_create_ex");
+	UT_ASSERTeq(vmem_stats_get(Vmp, &stats), 0);
+	UT_ASSERTeq(stats.narenas, 4);
+
+	ptr = vmem_malloc(Vmp, ALLOC_SIZE);
+	UT_ASSERTne(ptr, NULL);
+	UT_ASSERTeq(vmem_stats_get(Vmp, &stats), 0);
+	UT_ASSERTeq(stats.allocated, ALLOC_SIZE);
+	UT_ASSERT(stats.active >= stats.allocated);
+	UT_ASSERT(stats.mapped >= stats.active);
+
+	run_threads();
+
+	/* without thread caches all the freed objects go back to the arenas */
+	UT_ASSERTeq(vmem_stats_get(Vmp, &stats), 0);
+	UT_ASSERTeq(stats.allocated, ALLOC_SIZE);
+	vmem_free(Vmp, ptr);
+	UT_ASSERTeq(vmem_stats_get(Vmp, &stats), 0);
+	UT_ASSERTeq(stats.allocated, 0);
+	UT_ASSERTeq(vmem_check(Vmp), 1);
+	vmem_delete(Vmp);
+
+	/* thread caches limited to small objects */
+	attr.narenas = 2;
+	attr.tcache_max = ALLOC_SIZE;
+	attr.flags = 0;
+	Vmp = vmem_create_ex(dir, VMEM_MIN_POOL, &attr);
+	if (Vmp == NULL)
+		UT_FATAL("!vmem_create_ex");
+	UT_ASSERTeq(vmem_stats_get(Vmp, &stats), 0);
+	UT_ASSERTeq(stats.narenas, 2);
+
+	/*
+	 * Objects above tcache_max are not cached, so they are freed
+	 * immediately. The size is below the default limit of the thread
+	 * caches (32 KiB), so it is tcache_max which keeps it out of them.
+	 */
+	ptr = vmem_malloc(Vmp, UNCACHED_SIZE);
+	UT_ASSERTne(ptr, NULL);
+	UT_ASSERTeq(vmem_stats_get(Vmp, &stats), 0);
+	UT_ASSERT(stats.allocated >= UNCACHED_SIZE);
+	vmem_free(Vmp, ptr);
+	UT_ASSERTeq(vmem_stats_get(Vmp, &stats), 0);
+	UT_ASSERTeq(stats.allocated, 0);
+
+	run_threads();
+	UT_ASSERTeq(vmem_check(Vmp), 1);
+	vmem_delete(Vmp);
+
+	/* more arenas in use than the pool has chunks for */
+	attr.narenas = NARENAS_MANY;
+	attr.tcache_max = 0;
+	attr.flags = VMEM_NO_TCACHE;
+	Vmp = vmem_create_ex(dir, VMEM_MIN_POOL, &attr);
+	if (Vmp == NULL)
+		UT_FATAL("!vmem_create_ex");
+	UT_ASSERTeq(vmem_stats_get(Vmp, &stats), 0);
+	UT_ASSERTeq(stats.narenas, NARENAS_MANY);
+
+	run_threads();
+	UT_ASSERTeq(vmem_stats_get(Vmp, &stats), 0);
+	UT_ASSERTeq(stats.allocated, 0);
+	UT_ASSERTeq(vmem_check(Vmp), 1);
+	vmem_delete(Vmp);
+
+	os_cond_destroy(&Cond);
+	os_mutex_destroy(&Lock);
+
+	DONE(NULL);
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * vmem_create_growable.c -- unit test for vmem_create_growable
+ *
+ * usage: vmem_create_growable directory
+ */
+
+#include "unittest.h"
+
+#define ALLOC_SIZE (1024 * 1024)
+
+/*
+ * alloc_all -- (internal) allocate all memory of the pool, return the number
+ *	of bytes allocated
+ */
+static size_t
+alloc_all(VMEM *vmp, void **list)
+{
+	size_t total = 0;
+	void *prev = NULL;
+	for (;;) {
+		void **next = vmem_malloc(vmp, ALLOC_SIZE);
+		if (next == NULL)
+			break;
+
+		*next = prev;
+		prev = next;
+		total += ALLOC_SIZE;
+	}
+
+	*list = prev;
+	return total;
+}
+
+/*
+ * free_all -- (internal) free all allocations on the list
+ */
+static void
+free_all(VMEM *vmp, void *list)
+{
+	while (list != NULL) {
+		void **act = list;
+		list = *act;
+		vmem_free(vmp, act);
+	}
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "vmem_create_growable");
+
+	if (argc != 2)
+		UT_FATAL("usage: %s directory", argv[0]);
+
+	char *dir = argv[1];
+	void *list;
+
+	/* the maximum size must not be smaller than the initial size */
+	VMEM *vmp = vmem_create_growable(dir, 2 * VMEM_MIN_POOL,
+			VMEM_MIN_POOL, 0);
+	UT_ASSERTeq(vmp, NULL);
+	UT_ASSERTeq(errno, EINVAL);
+
+	/* the fixed-size pool is a reference */
+	vmp = vmem_create(dir, VMEM_MIN_POOL);
+	if (vmp == NULL)
+		UT_FATAL("!vmem_create");
+	size_t fixed = alloc_all(vmp, &list);
+	UT_ASSERTne(fixed, 0);
+	free_all(vmp, list);
+	vmem_delete(vmp);
+
+	/* the growable pool is limited by its maximum size */
+	vmp = vmem_create_growable(dir, VMEM_MIN_POOL, 4 * VMEM_MIN_POOL,
+			VMEM_MIN_POOL);
+	if (vmp == NULL)
+		UT_FATAL("!vmem_create_growable");
+	size_t grown = alloc_all(vmp, &list);
+	UT_ASSERT(grown > 3 * fixed);
+	UT_ASSERT(grown < 4 * VMEM_MIN_POOL);
+	UT_ASSERTeq(vmem_check(vmp), 1);
+	free_all(vmp, list);
+
+	/* the freed memory is reused, so the pool does not grow anymore */
+	UT_ASSERTeq(alloc_all(vmp, &list), grown);
+	free_all(vmp, list);
+	vmem_delete(vmp);
+
+	/* an allocation larger than the growth increment */
+	vmp = vmem_create_growable(dir, VMEM_MIN_POOL, 0, 0);
+	if (vmp == NULL)
+		UT_FATAL("!vmem_create_growable");
+	void *ptr = vmem_malloc(vmp, 4 * VMEM_MIN_POOL);
+	UT_ASSERTne(ptr, NULL);
+	memset(ptr, 0xc5, 4 * VMEM_MIN_POOL);
+	UT_ASSERTeq(vmem_check(vmp), 1);
+	vmem_free(vmp, ptr);
+	vmem_delete(vmp);
+
+	DONE(NULL);
+}
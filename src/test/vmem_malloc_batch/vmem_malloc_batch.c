@@ -0,0 +1,134 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * vmem_malloc_batch.c -- unit test for vmem_malloc_batch and vmem_free_batch
+ *
+ * usage: vmem_malloc_batch directory
+ */
+
+#include "unittest.h"
+
+#define NOBJS 500
+#define SMALL_SIZE 64
+#define LARGE_SIZE (64 * 1024)
+
+/*
+ * check_objs -- (internal) check the objects allocated in a batch are usable
+ *	and do not overlap
+ */
+static void
+check_objs(VMEM *vmp, void **ptrs, size_t n, size_t size)
+{
+	for (size_t i = 0; i < n; ++i) {
+		UT_ASSERTne(ptrs[i], NULL);
+		UT_ASSERT(vmem_malloc_usable_size(vmp, ptrs[i]) >= size);
+		memset(ptrs[i], (int)(i & 0xff), size);
+	}
+
+	for (size_t i = 0; i < n; ++i) {
+		unsigned char *p = ptrs[i];
+		for (size_t j = 0; j < size; ++j)
+			UT_ASSERTeq(p[j], i & 0xff);
+	}
+}
+
+/*
+ * allocated -- (internal) return the number of bytes allocated from the pool
+ */
+static size_t
+allocated(VMEM *vmp)
+{
+	struct vmem_stats stats;
+	UT_ASSERTeq(vmem_stats_get(vmp, &stats), 0);
+	return stats.allocated;
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "vmem_malloc_batch");
+
+	if (argc != 2)
+		UT_FATAL("usage: %s directory", argv[0]);
+
+	/* without thread caches the statistics are exact */
+	struct vmem_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.flags = VMEM_NO_TCACHE;
+	VMEM *vmp = vmem_create_ex(argv[1], VMEM_MIN_POOL, &attr);
+	if (vmp == NULL)
+		UT_FATAL("!vmem_create_ex");
+
+	void **ptrs = MALLOC(2 * NOBJS * sizeof(void *));
+
+	/* small objects */
+	UT_ASSERTeq(vmem_malloc_batch(vmp, SMALL_SIZE, NOBJS, ptrs), NOBJS);
+	check_objs(vmp, ptrs, NOBJS, SMALL_SIZE);
+	UT_ASSERTeq(allocated(vmp), NOBJS * SMALL_SIZE);
+
+	/* large objects */
+	UT_ASSERTeq(vmem_malloc_batch(vmp, LARGE_SIZE, 10, ptrs + NOBJS), 10);
+	check_objs(vmp, ptrs + NOBJS, 10, LARGE_SIZE);
+
+	/* objects allocated one by one, mixed with NULL pointers */
+	for (size_t i = NOBJS + 10; i < 2 * NOBJS; ++i)
+		ptrs[i] = (i % 3) ? vmem_malloc(vmp, i % 256 + 1) : NULL;
+
+	/* free everything in one batch, in a shuffled order */
+	for (size_t i = 0; i < 2 * NOBJS; i += 7) {
+		void *tmp = ptrs[i];
+		ptrs[i] = ptrs[2 * NOBJS - 1 - i];
+		ptrs[2 * NOBJS - 1 - i] = tmp;
+	}
+	vmem_free_batch(vmp, ptrs, 2 * NOBJS);
+	UT_ASSERTeq(allocated(vmp), 0);
+	UT_ASSERTeq(vmem_check(vmp), 1);
+
+	/* the pool runs out of memory in the middle of a batch */
+	size_t n = VMEM_MIN_POOL / SMALL_SIZE;
+	void **all = MALLOC(n * sizeof(void *));
+	size_t nalloc = vmem_malloc_batch(vmp, SMALL_SIZE, n, all);
+	UT_ASSERT(nalloc > 0);
+	UT_ASSERT(nalloc < n);
+	UT_ASSERTeq(errno, ENOMEM);
+	UT_ASSERTeq(allocated(vmp), nalloc * SMALL_SIZE);
+	vmem_free_batch(vmp, all, nalloc);
+	UT_ASSERTeq(allocated(vmp), 0);
+	UT_ASSERTeq(vmem_check(vmp), 1);
+
+	FREE(all);
+	FREE(ptrs);
+	vmem_delete(vmp);
+
+	DONE(NULL);
+}
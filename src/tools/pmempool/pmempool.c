@@ -50,6 +50,7 @@
 #include "rm.h"
 #include "convert.h"
 #include "synchronize.h"
+#include "scrub.h"
 #include "transform.h"
 #include "set.h"
 
@@ -166,6 +167,12 @@ static struct command commands[] = {
 		.func = pmempool_transform_func,
 		.help = pmempool_transform_help,
 	},
+	{
+		.name = "scrub",
+		.brief = "verify pool data against recorded checksums",
+		.func = pmempool_scrub_func,
+		.help = pmempool_scrub_help,
+	},
 	{
 		.name = "help",
 		.brief = "print help text about a command",
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2017, Intel Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *
+ *     * Neither the name of the copyright holder nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * scrub.c -- pmempool scrub command source file
+ */
+
+#include "scrub.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <errno.h>
+#include <inttypes.h>
+#include "common.h"
+#include "output.h"
+#include "libpmempool.h"
+
+/*
+ * pmempool_scrub_context -- context and arguments for scrub command
+ */
+struct pmempool_scrub_context {
+	unsigned flags;		/* flags which modify the command execution */
+	size_t rate;		/* maximum number of bytes read per second */
+	char *path;		/* a path to a pool or poolset file */
+};
+
+/*
+ * pmempool_scrub_default -- default arguments for scrub command
+ */
+static const struct pmempool_scrub_context pmempool_scrub_default = {
+	.flags		= 0,
+	.rate		= 0,
+	.path		= NULL,
+};
+
+/*
+ * help_str -- string for help message
+ */
+static const char *help_str =
+"Verify the pool data against the recorded checksums\n"
+"\n"
+"Common options:\n"
+"  -u, --update         record the checksums of the master replica\n"
+"  -r, --repair         repair the damaged data from the valid replicas\n"
+"  -d, --dry-run        do not apply changes, only report them\n"
+"  -R, --rate <size>    read at most <size> bytes of the data per second\n"
+"  -v, --verbose        increase verbosity level\n"
+"  -h, --help           display this help and exit\n"
+"\n"
+"For complete documentation see %s-scrub(1) manual page.\n"
+;
+
+/*
+ * long_options -- command line options
+ */
+static const struct option long_options[] = {
+	{"dry-run",	no_argument,		NULL,	'd'},
+	{"help",	no_argument,		NULL,	'h'},
+	{"rate",	required_argument,	NULL,	'R'},
+	{"repair",	no_argument,		NULL,	'r'},
+	{"update",	no_argument,		NULL,	'u'},
+	{"verbose",	no_argument,		NULL,	'v'},
+	{NULL,		0,			NULL,	 0 },
+};
+
+/*
+ * print_usage -- (internal) print application usage short description
+ */
+static void
+print_usage(char *appname)
+{
+	printf("usage: %s scrub [<options>] <file>\n", appname);
+}
+
+/*
+ * print_version -- (internal) print version string
+ */
+static void
+print_version(char *appname)
+{
+	printf("%s %s\n", appname, SRCVERSION);
+}
+
+/*
+ * pmempool_scrub_help -- print help message for the scrub command
+ */
+void
+pmempool_scrub_help(char *appname)
+{
+	print_usage(appname);
+	print_version(appname);
+	printf(help_str, appname);
+}
+
+/*
+ * pmempool_scrub_parse_args -- (internal) parse command line arguments
+ */
+static int
+pmempool_scrub_parse_args(struct pmempool_scrub_context *ctx, char *appname,
+		int argc, char *argv[])
+{
+	int opt;
+	while ((opt = getopt_long(argc, argv, "dhR:ruv",
+			long_options, NULL)) != -1) {
+		switch (opt) {
+		case 'd':
+			ctx->flags |= PMEMPOOL_DRY_RUN;
+			break;
+		case 'h':
+			pmempool_scrub_help(appname);
+			exit(EXIT_SUCCESS);
+		case 'R':
+			if (util_parse_size(optarg, &ctx->rate)) {
+				outv_err("invalid rate value specified: %s\n",
+					optarg);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'r':
+			ctx->flags |= PMEMPOOL_SCRUB_REPAIR;
+			break;
+		case 'u':
+			ctx->flags |= PMEMPOOL_SCRUB_UPDATE;
+			break;
+		case 'v':
+			out_set_vlevel(1);
+			break;
+		default:
+			print_usage(appname);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (optind < argc) {
+		ctx->path = argv[optind];
+	} else {
+		print_usage(appname);
+		exit(EXIT_FAILURE);
+	}
+
+	return 0;
+}
+
+/*
+ * pmempool_scrub_func -- main function for the scrub command
+ */
+int
+pmempool_scrub_func(char *appname, int argc, char *argv[])
+{
+	int ret = 0;
+	struct pmempool_scrub_context ctx = pmempool_scrub_default;
+	struct pmempool_scrub_stats stats;
+
+	/* parse command line arguments */
+	if ((ret = pmempool_scrub_parse_args(&ctx, appname, argc, argv)))
+		return ret;
+
+	ret = pmempool_scrub(ctx.path, ctx.rate, ctx.flags, &stats);
+
+	if (ret) {
+		outv_err("failed to scrub: %s\n", pmempool_errormsg());
+		if (errno)
+			outv_err("%s\n", strerror(errno));
+		return -1;
+	}
+
+	outv(1, "regions: %" PRIu64 "\n", stats.nregions);
+	outv(1, "damaged: %" PRIu64 "\n", stats.nbad);
+	outv(1, "repaired: %" PRIu64 "\n", stats.nrepaired);
+	outv(1, "updated checksums: %" PRIu64 "\n", stats.nupdated);
+
+	if (stats.nbad > stats.nrepaired) {
+		outv_err("%s: %" PRIu64 " damaged region(s)\n", ctx.path,
+			stats.nbad - stats.nrepaired);
+		return -1;
+	}
+
+	outv(1, "%s: %s\n", ctx.path, stats.nrepaired ? "repaired" :
+		(ctx.flags & PMEMPOOL_SCRUB_UPDATE) ? "checksums recorded" :
+		"consistent");
+	return 0;
+}
@@ -74,6 +74,9 @@ static const char *help_str =
 "Common options:\n"
 "  -d, --dry-run        do not apply changes, only check for viability of"
 " synchronization\n"
+"  -c, --compare        compare the data with the healthy replica and write"
+" only\n"
+"                       the regions which differ\n"
 "  -v, --verbose        increase verbosity level\n"
 "  -h, --help           display this help and exit\n"
 "\n"
@@ -84,6 +87,7 @@ static const char *help_str =
  * long_options -- command line options
  */
 static const struct option long_options[] = {
+	{"compare",	no_argument,		NULL,	'c'},
 	{"dry-run",	no_argument,		NULL,	'd'},
 	{"help",	no_argument,		NULL,	'h'},
 	{"verbose",	no_argument,		NULL,	'v'},
@@ -127,11 +131,14 @@ pmempool_sync_parse_args(struct pmempool_sync_context *ctx, char *appname,
 		int argc, char *argv[])
 {
 	int opt;
-	while ((opt = getopt_long(argc, argv, "dhv",
+	while ((opt = getopt_long(argc, argv, "cdhv",
 			long_options, NULL)) != -1) {
 		switch (opt) {
+		case 'c':
+			ctx->flags |= PMEMPOOL_SYNC_COMPARE;
+			break;
 		case 'd':
-			ctx->flags = PMEMPOOL_DRY_RUN;
+			ctx->flags |= PMEMPOOL_DRY_RUN;
 			break;
 		case 'h':
 			pmempool_sync_help(appname);
@@ -117,8 +117,11 @@ uuid2str(const uuid_t uuid)
  * processing
  */
 static size_t
-rpmemd_get_nthreads(void)
+rpmemd_get_nthreads(struct rpmemd_config *config)
 {
+	if (config->nthreads)
+		return (size_t)config->nthreads;
+
 	long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
 	if (ncpus < 0) {
 		RPMEMD_LOG(ERR, "getting number of CPUs");
@@ -203,6 +206,7 @@ rpmemd_common_fip_init(struct rpmemd *rpmemd, const struct rpmem_req_attr *req,
 		.size		= req->pool_size,
 		.nlanes		= req->nlanes,
 		.nthreads	= rpmemd->nthreads,
+		.busy_poll	= rpmemd->config.busy_poll,
 		.provider	= req->provider,
 		.persist_method = rpmemd->persist_method,
 	};
@@ -696,6 +700,7 @@ rpmemd_print_info(struct rpmemd *rpmemd)
 			rpmem_persist_method_to_str(rpmemd->persist_method));
 	RPMEMD_LOG(NOTICE, RPMEMD_LOG_INDENT "number of threads: %lu",
 			rpmemd->nthreads);
+	RPMEMD_DBG("\tbusy poll: %s", bool2str(rpmemd->config.busy_poll));
 	RPMEMD_DBG("\tpersist APM: %s",
 		bool2str(rpmemd->config.persist_apm));
 	RPMEMD_DBG("\tpersist GPSPM: %s",
@@ -748,7 +753,7 @@ main(int argc, char *argv[])
 
 	RPMEMD_LOG(INFO, "%s version %s", DAEMON_NAME, SRCVERSION);
 	rpmemd->persist_method = rpmemd_get_pm(&rpmemd->config);
-	rpmemd->nthreads = rpmemd_get_nthreads();
+	rpmemd->nthreads = rpmemd_get_nthreads(&rpmemd->config);
 	if (!rpmemd->nthreads) {
 		RPMEMD_LOG(ERR, "invalid number of threads -- '%lu'",
 				rpmemd->nthreads);
@@ -69,6 +69,8 @@ enum rpmemd_option {
 	RPD_OPT_USE_SYSLOG,
 	RPD_OPT_LOG_LEVEL,
 	RPD_OPT_RM_POOLSET,
+	RPD_OPT_NTHREADS,
+	RPD_OPT_BUSY_POLL,
 
 	RPD_OPT_MAX_VALUE,
 	RPD_OPT_INVALID			= UINT64_MAX,
@@ -89,6 +91,8 @@ static const struct option options[] = {
 {"persist-general",	no_argument,		NULL, RPD_OPT_PERSIST_GENERAL},
 {"use-syslog",		no_argument,		NULL, RPD_OPT_USE_SYSLOG},
 {"log-level",		required_argument,	NULL, RPD_OPT_LOG_LEVEL},
+{"nthreads",		required_argument,	NULL, RPD_OPT_NTHREADS},
+{"busy-poll",		no_argument,		NULL, RPD_OPT_BUSY_POLL},
 {"remove",		required_argument,	NULL, 'r'},
 {"force",		no_argument,		NULL, 'f'},
 {"pool-set",		no_argument,		NULL, 's'},
@@ -116,6 +120,8 @@ VALUE_INDENT "warn    warning conditions\n"
 VALUE_INDENT "notice  normal, but significant, condition\n"
 VALUE_INDENT "info    informational message\n"
 VALUE_INDENT "debug   debug-level message\n"
+"      --nthreads <num>          number of processing threads\n"
+"      --busy-poll               busy poll completion queues\n"
 "\n"
 "For complete documentation see %s(1) manual page.";
 
@@ -181,6 +187,26 @@ parse_config_bool(bool *config_value, const char *value)
 		errno = EINVAL;
 }
 
+/*
+ * parse_config_uint -- (internal) parse unsigned integer value
+ */
+static inline void
+parse_config_uint(uint64_t *config_value, const char *value)
+{
+	if (value == NULL || !isdigit(value[0])) {
+		errno = EINVAL;
+		return;
+	}
+
+	char *end;
+	errno = 0;
+	unsigned long long v = strtoull(value, &end, 10);
+	if (errno == 0 && *end == '\0')
+		*config_value = v;
+	else
+		errno = EINVAL;
+}
+
 /*
  * set_option -- (internal) set single config option
  */
@@ -214,6 +240,12 @@ set_option(enum rpmemd_option option, const char *value,
 		if (config->log_level == MAX_RPD_LOG)
 			errno = EINVAL;
 		break;
+	case RPD_OPT_NTHREADS:
+		parse_config_uint(&config->nthreads, value);
+		break;
+	case RPD_OPT_BUSY_POLL:
+		parse_config_bool(&config->busy_poll, value);
+		break;
 	default:
 		errno = EINVAL;
 	}
@@ -577,6 +609,8 @@ config_set_default(struct rpmemd_config *config, const char *poolset_dir)
 	config->log_level	= RPD_LOG_ERR;
 	config->rm_poolset	= NULL;
 	config->force		= false;
+	config->nthreads	= 0;
+	config->busy_poll	= false;
 }
 
 /*
@@ -65,6 +65,8 @@ struct rpmemd_config {
 	bool use_syslog;
 	uint64_t max_lanes;
 	enum rpmemd_log_level log_level;
+	uint64_t nthreads;
+	bool busy_poll;
 };
 
 int rpmemd_config_read(struct rpmemd_config *config, int argc, char *argv[]);
@@ -55,6 +55,7 @@
 #include "rpmem_fip_msg.h"
 #include "rpmem_fip_common.h"
 #include "rpmemd_fip.h"
+#include "rpmemd_util.h"
 
 #include "os_thread.h"
 #include "util.h"
@@ -71,6 +72,11 @@
 	ret;\
 })
 
+/*
+ * maximum number of completions read from completion queue at once
+ */
+#define RPMEMD_FIP_CQ_BATCH	64
+
 /*
  * rpmem_fip_lane -- base lane structure
  */
@@ -116,10 +122,18 @@ struct rpmemd_fip_ops {
 	rpmemd_fip_process_fn process_stop;
 };
 
+/*
+ * rpmemd_fip_worker -- group of lanes sharing single completion queue,
+ * in GPSPM processed by a single thread
+ */
 struct rpmemd_fip_worker {
 	struct rpmemd_fip *fip;
 	os_thread_t thread;
-	struct rpmemd_fip_lane *lanep;
+	struct fid_cq *cq;		/* shared completion queue */
+	struct rpmemd_fip_lane *lanes;	/* lanes served by the worker */
+	unsigned nlanes;		/* number of lanes */
+	struct rpmemd_fip_lane **ready;	/* lanes with pending persist */
+	unsigned nready;		/* number of ready lanes */
 };
 
 /*
@@ -135,6 +149,8 @@ struct rpmemd_fip {
 	struct rpmemd_fip_ops *ops;	/* ops specific for persist method */
 
 	int (*persist)(const void *addr, size_t len);	/* persist function */
+	int (*flush)(const void *addr, size_t len);	/* flush function */
+	void (*drain)(void);				/* drain function */
 	void *addr;			/* pool's address */
 	size_t size;			/* size of the pool */
 	enum rpmem_persist_method persist_method;
@@ -142,7 +158,8 @@ struct rpmemd_fip {
 	volatile int closing;	/* flag for closing background threads */
 	unsigned nlanes;	/* number of lanes */
 	size_t nthreads;	/* number of threads for processing */
-	size_t cq_size;		/* size of completion queue */
+	size_t cq_size;		/* size of completion queue per lane */
+	bool busy_poll;		/* busy poll completion queues */
 
 	/* the following fields are used only for GPSPM */
 	struct rpmemd_fip_lane *lanes;
@@ -156,7 +173,8 @@ struct rpmemd_fip {
 	struct fid_mr *pres_mr;		/* persist response memory region */
 	void *pres_mr_desc;		/* persist response local descriptor */
 
-	struct rpmemd_fip_worker *workers;	/* process workers */
+	struct rpmemd_fip_worker *workers;	/* lane groups and workers */
+	unsigned nworkers;			/* number of workers */
 };
 
 /*
@@ -526,67 +544,100 @@ rpmemd_fip_post_gpspm(struct rpmemd_fip *fip, struct rpmemd_fip_lane *lanep)
 }
 
 /*
- * rpmemd_fip_lane_init -- initialize single lane
+ * rpmemd_fip_worker_init -- initialize worker for specified range of lanes
+ * and open completion queue shared by these lanes
  */
 static int
-rpmemd_fip_lane_init(struct rpmemd_fip *fip, struct rpmem_fip_lane *lanep)
+rpmemd_fip_worker_init(struct rpmemd_fip *fip,
+	struct rpmemd_fip_worker *worker, unsigned lane, unsigned nlanes)
 {
+	worker->fip = fip;
+	worker->lanes = &fip->lanes[lane];
+	worker->nlanes = nlanes;
+	worker->nready = 0;
+
+	worker->ready = calloc(nlanes, sizeof(*worker->ready));
+	if (!worker->ready) {
+		RPMEMD_LOG(ERR, "!allocating worker's ready lanes");
+		goto err_alloc_ready;
+	}
+
 	struct fi_cq_attr cq_attr = {
-		.size = fip->cq_size,
+		.size = fip->cq_size * nlanes,
 		.flags = 0,
 		.format = FI_CQ_FORMAT_MSG, /* need context and flags */
-		.wait_obj = FI_WAIT_UNSPEC,
+		.wait_obj = fip->busy_poll ? FI_WAIT_NONE : FI_WAIT_UNSPEC,
 		.signaling_vector = 0,
 		.wait_cond = FI_CQ_COND_NONE,
 		.wait_set = NULL,
 	};
 
-	int ret = fi_cq_open(fip->domain, &cq_attr, &lanep->cq, NULL);
+	int ret = fi_cq_open(fip->domain, &cq_attr, &worker->cq, NULL);
 	if (ret) {
 		RPMEMD_FI_ERR(ret, "opening completion queue");
 		goto err_cq_open;
 	}
 
+	for (unsigned i = 0; i < nlanes; i++) {
+		worker->lanes[i].base.cq = worker->cq;
+		worker->lanes[i].worker = worker;
+	}
+
 	return 0;
 err_cq_open:
+	free(worker->ready);
+err_alloc_ready:
 	return -1;
 }
 
 /*
- * rpmemd_fip_lane_fini -- deinitialize single lane
+ * rpmemd_fip_worker_fini -- deinitialize worker
  */
 static void
-rpmemd_fip_lane_fini(struct rpmemd_fip *fip, struct rpmem_fip_lane *lanep)
+rpmemd_fip_worker_fini(struct rpmemd_fip_worker *worker)
 {
-	RPMEMD_FI_CLOSE(lanep->cq, "closing completion queue");
+	RPMEMD_FI_CLOSE(worker->cq, "closing completion queue");
+	free(worker->ready);
 }
 
 /*
- * rpmemd_fip_lanes_init -- initialize all lanes
+ * rpmemd_fip_lanes_init -- initialize all lanes and divide them evenly
+ * between workers
  */
 static int
 rpmemd_fip_lanes_init(struct rpmemd_fip *fip)
 {
-
 	fip->lanes = calloc(fip->nlanes, sizeof(*fip->lanes));
 	if (!fip->lanes) {
 		RPMEMD_ERR("!allocating lanes");
 		goto err_alloc;
 	}
 
+	fip->workers = calloc(fip->nworkers, sizeof(*fip->workers));
+	if (!fip->workers) {
+		RPMEMD_ERR("!allocating workers");
+		goto err_alloc_workers;
+	}
+
 	int ret = 0;
 
 	unsigned i;
-	for (i = 0; i < fip->nlanes; i++) {
-		ret = rpmemd_fip_lane_init(fip, &fip->lanes[i].base);
+	for (i = 0; i < fip->nworkers; i++) {
+		unsigned first = i * fip->nlanes / fip->nworkers;
+		unsigned last = (i + 1) * fip->nlanes / fip->nworkers;
+
+		ret = rpmemd_fip_worker_init(fip, &fip->workers[i],
+				first, last - first);
 		if (ret)
-			goto err_lane_init;
+			goto err_worker_init;
 	}
 
 	return 0;
-err_lane_init:
+err_worker_init:
 	for (unsigned j = 0; j < i; j++)
-		rpmemd_fip_lane_fini(fip, &fip->lanes[j].base);
+		rpmemd_fip_worker_fini(&fip->workers[j]);
+	free(fip->workers);
+err_alloc_workers:
 	free(fip->lanes);
 err_alloc:
 	return -1;
@@ -598,9 +649,10 @@ err_alloc:
 static void
 rpmemd_fip_lanes_fini(struct rpmemd_fip *fip)
 {
-	for (unsigned i = 0; i < fip->nlanes; i++)
-		rpmemd_fip_lane_fini(fip, &fip->lanes[i].base);
+	for (unsigned i = 0; i < fip->nworkers; i++)
+		rpmemd_fip_worker_fini(&fip->workers[i]);
 
+	free(fip->workers);
 	free(fip->lanes);
 }
 
@@ -737,10 +789,12 @@ rpmemd_fip_check_pmsg(struct rpmemd_fip *fip, struct rpmem_msg_persist *pmsg)
 }
 
 /*
- * rpmemd_fip_process_one -- process single persist operation
+ * rpmemd_fip_process_flush -- verify single persist message and flush
+ * the requested range
  */
 static int
-rpmemd_fip_process_one(struct rpmemd_fip *fip, struct rpmemd_fip_lane *lanep)
+rpmemd_fip_process_flush(struct rpmemd_fip *fip,
+	struct rpmemd_fip_lane *lanep)
 {
 	int ret = 0;
 
@@ -757,51 +811,84 @@ rpmemd_fip_process_one(struct rpmemd_fip *fip, struct rpmemd_fip_lane *lanep)
 	/* verify persist message */
 	ret = rpmemd_fip_check_pmsg(fip, pmsg);
 	if (unlikely(ret))
-		goto err;
+		return ret;
 
 	/* return back the lane id */
 	pres->lane = pmsg->lane;
 
-	/*
-	 * Perform the persist operation.
-	 *
-	 * XXX
-	 *
-	 * Maybe the persist could be divided into flush + drain.
-	 * We could issue flush operation, do some other work like
-	 * posting RECV buffer and then call drain. Need to consider this.
-	 */
-	fip->persist((void *)pmsg->addr, pmsg->size);
+	fip->flush((void *)pmsg->addr, pmsg->size);
 
-	/* post lane's RECV buffer */
-	ret = rpmemd_fip_gpspm_post_msg(lanep);
-	if (unlikely(ret))
-		goto err;
+	return 0;
+}
 
-	/* post lane's SEND buffer */
-	ret = rpmemd_fip_gpspm_post_resp(lanep);
+/*
+ * rpmemd_fip_process_batch -- process persist operations of all ready lanes
+ *
+ * The requested ranges are flushed one by one and a single drain is issued
+ * for the whole batch. The RECV buffers are posted before the drain because
+ * the persist messages are no longer needed at this point, the SEND buffers
+ * with responses may be posted only when all the data is persistent.
+ */
+static int
+rpmemd_fip_process_batch(struct rpmemd_fip *fip,
+	struct rpmemd_fip_worker *worker)
+{
+	int ret;
+	unsigned i;
 
-err:
-	return ret;
+	for (i = 0; i < worker->nready; i++) {
+		ret = rpmemd_fip_process_flush(fip, worker->ready[i]);
+		if (unlikely(ret))
+			return ret;
+	}
+
+	for (i = 0; i < worker->nready; i++) {
+		struct rpmemd_fip_lane *lanep = worker->ready[i];
+
+		rpmem_fip_lane_begin(&lanep->base, FI_SEND|FI_RECV);
+
+		/* post lane's RECV buffer */
+		ret = rpmemd_fip_gpspm_post_msg(lanep);
+		if (unlikely(ret))
+			return ret;
+	}
+
+	fip->drain();
+
+	for (i = 0; i < worker->nready; i++) {
+		/* post lane's SEND buffer */
+		ret = rpmemd_fip_gpspm_post_resp(worker->ready[i]);
+		if (unlikely(ret))
+			return ret;
+	}
+
+	worker->nready = 0;
+
+	return 0;
 }
 
 /*
- * rpmemd_fip_lane_wait -- wait for specific events on completion queue
+ * rpmemd_fip_worker_wait -- wait until at least one of the worker's lanes
+ * has received a persist message and completed sending previous response
  */
 static int
-rpmemd_fip_lane_wait(struct rpmemd_fip *fip,
-	struct rpmemd_fip_lane *lanep, uint64_t e)
+rpmemd_fip_worker_wait(struct rpmemd_fip *fip,
+	struct rpmemd_fip_worker *worker)
 {
 	struct fi_cq_err_entry err;
-	struct fi_cq_msg_entry cq_entry;
+	struct fi_cq_msg_entry cq_entries[RPMEMD_FIP_CQ_BATCH];
 	const char *str_err;
 	ssize_t sret;
 	int ret;
 
-	while (!fip->closing && (lanep->base.event & e)) {
-		sret = fi_cq_sread(lanep->base.cq,
-				&cq_entry, 1, NULL,
-				RPMEM_FIP_CQ_WAIT_MS);
+	while (!fip->closing && !worker->nready) {
+		if (fip->busy_poll)
+			sret = fi_cq_read(worker->cq, cq_entries,
+					RPMEMD_FIP_CQ_BATCH);
+		else
+			sret = fi_cq_sread(worker->cq, cq_entries,
+					RPMEMD_FIP_CQ_BATCH, NULL,
+					RPMEM_FIP_CQ_WAIT_MS);
 
 		if (unlikely(fip->closing))
 			break;
@@ -814,19 +901,27 @@ rpmemd_fip_lane_wait(struct rpmemd_fip *fip,
 			goto err_cq_read;
 		}
 
-		lanep->base.event &= ~cq_entry.flags;
+		for (ssize_t i = 0; i < sret; i++) {
+			struct rpmemd_fip_lane *lanep =
+				cq_entries[i].op_context;
+			uint64_t event = lanep->base.event;
+
+			lanep->base.event &= ~cq_entries[i].flags;
+			if (event && !lanep->base.event)
+				worker->ready[worker->nready++] = lanep;
+		}
 	}
 
 	return 0;
 err_cq_read:
-	sret = fi_cq_readerr(lanep->base.cq, &err, 0);
+	sret = fi_cq_readerr(worker->cq, &err, 0);
 	if (sret < 0) {
 		RPMEMD_FI_ERR((int)sret, "error reading from completion queue: "
 			"cannot read error from completion queue");
 		goto err;
 	}
 
-	str_err = fi_cq_strerror(lanep->base.cq, err.prov_errno, NULL, NULL, 0);
+	str_err = fi_cq_strerror(worker->cq, err.prov_errno, NULL, NULL, 0);
 	RPMEMD_LOG(ERR, "error reading from completion queue: %s", str_err);
 err:
 	return ret;
@@ -841,24 +936,22 @@ rpmemd_fip_worker(void *arg)
 {
 	struct rpmemd_fip_worker *worker = arg;
 	struct rpmemd_fip *fip = worker->fip;
-	struct rpmemd_fip_lane *lanep = worker->lanep;
 	int ret = 0;
 
-	rpmem_fip_lane_begin(&lanep->base, FI_RECV);
+	for (unsigned i = 0; i < worker->nlanes; i++)
+		rpmem_fip_lane_begin(&worker->lanes[i].base, FI_RECV);
 
 	while (!fip->closing) {
-		ret = rpmemd_fip_lane_wait(fip, lanep, FI_SEND|FI_RECV);
+		ret = rpmemd_fip_worker_wait(fip, worker);
 		if (ret)
 			goto err;
 
 		if (unlikely(fip->closing))
 			break;
 
-		ret = rpmemd_fip_process_one(fip, lanep);
+		ret = rpmemd_fip_process_batch(fip, worker);
 		if (ret)
 			goto err;
-
-		rpmem_fip_lane_begin(&lanep->base, FI_SEND|FI_RECV);
 	}
 
 	return 0;
@@ -867,21 +960,50 @@ err:
 }
 
 /*
- * rpmemd_fip_process_start_gpspm -- start processing GPSPM messages
+ * rpmemd_fip_worker_stop -- stop single worker thread and return its
+ * error code
  */
 static int
-rpmemd_fip_process_start_gpspm(struct rpmemd_fip *fip)
+rpmemd_fip_worker_stop(struct rpmemd_fip *fip,
+	struct rpmemd_fip_worker *worker)
 {
-	fip->workers = malloc(fip->nlanes * sizeof(*fip->workers));
-	if (!fip->workers) {
-		RPMEMD_LOG(ERR, "!allocating workers");
-		goto err_alloc_workers;
+	int ret;
+	int lret = 0;
+
+	/* busy polling workers do not wait on completion queue */
+	if (!fip->busy_poll) {
+		ret = fi_cq_signal(worker->cq);
+		if (ret) {
+			RPMEMD_FI_ERR(ret, "sending signal to CQ");
+			lret = ret;
+		}
+	}
+
+	void *tret;
+	errno = os_thread_join(&worker->thread, &tret);
+	if (errno) {
+		RPMEMD_LOG(ERR, "!joining cq thread");
+		lret = -1;
+	} else {
+		ret = (int)(uintptr_t)tret;
+		if (ret) {
+			RPMEMD_LOG(ERR, "cq thread failed with "
+				"code -- %d", ret);
+			lret = ret;
+		}
 	}
 
+	return lret;
+}
+
+/*
+ * rpmemd_fip_process_start_gpspm -- start processing GPSPM messages
+ */
+static int
+rpmemd_fip_process_start_gpspm(struct rpmemd_fip *fip)
+{
 	unsigned i;
-	for (i = 0; i < fip->nlanes; i++) {
-		fip->workers[i].fip = fip;
-		fip->workers[i].lanep = &fip->lanes[i];
+	for (i = 0; i < fip->nworkers; i++) {
 		errno = os_thread_create(&fip->workers[i].thread, NULL,
 				rpmemd_fip_worker, &fip->workers[i]);
 		if (errno) {
@@ -892,8 +1014,9 @@ rpmemd_fip_process_start_gpspm(struct rpmemd_fip *fip)
 
 	return 0;
 err_thread_create:
-	free(fip->workers);
-err_alloc_workers:
+	util_fetch_and_or32(&fip->closing, 1);
+	for (unsigned j = 0; j < i; j++)
+		rpmemd_fip_worker_stop(fip, &fip->workers[j]);
 	return -1;
 }
 
@@ -908,30 +1031,12 @@ rpmemd_fip_process_stop_gpspm(struct rpmemd_fip *fip)
 	int ret;
 	int lret = 0;
 
-	for (unsigned i = 0; i < fip->nlanes; i++) {
-		struct rpmemd_fip_worker *worker = &fip->workers[i];
-		ret = fi_cq_signal(worker->lanep->base.cq);
-		if (ret) {
-			RPMEMD_FI_ERR(ret, "sending signal to CQ");
+	for (unsigned i = 0; i < fip->nworkers; i++) {
+		ret = rpmemd_fip_worker_stop(fip, &fip->workers[i]);
+		if (ret)
 			lret = ret;
-		}
-		void *tret;
-		errno = os_thread_join(&worker->thread, &tret);
-		if (errno) {
-			RPMEMD_LOG(ERR, "!joining cq thread");
-			lret = -1;
-		} else {
-			ret = (int)(uintptr_t)tret;
-			if (ret) {
-				RPMEMD_LOG(ERR, "cq thread failed with "
-					"code -- %d", ret);
-				lret = ret;
-			}
-		}
 	}
 
-	free(fip->workers);
-
 	return lret;
 }
 
@@ -961,11 +1066,16 @@ rpmemd_fip_set_attr(struct rpmemd_fip *fip, struct rpmemd_fip_attr *attr)
 	fip->addr = attr->addr;
 	fip->size = attr->size;
 	fip->nthreads = attr->nthreads;
+	fip->busy_poll = attr->busy_poll;
 	fip->persist_method = attr->persist_method;
 	fip->persist = attr->persist;
+	rpmemd_persist_split(fip->persist, &fip->flush, &fip->drain);
 
 	rpmemd_fip_set_nlanes(fip, attr->nlanes);
 
+	/* each worker serves at least one lane */
+	fip->nworkers = (unsigned)min(fip->nthreads, (size_t)fip->nlanes);
+
 	fip->cq_size = rpmem_fip_cq_size(fip->persist_method,
 			RPMEM_FIP_NODE_SERVER);
 
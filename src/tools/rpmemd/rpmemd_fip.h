@@ -35,6 +35,7 @@
  */
 
 #include <stddef.h>
+#include <stdbool.h>
 
 struct rpmemd_fip;
 
@@ -43,6 +44,7 @@ struct rpmemd_fip_attr {
 	size_t size;
 	unsigned nlanes;
 	size_t nthreads;
+	bool busy_poll;
 	enum rpmem_provider provider;
 	enum rpmem_persist_method persist_method;
 	int (*persist)(const void *addr, size_t len);
@@ -53,6 +53,27 @@ rpmemd_pmem_persist(const void *addr, size_t len)
 	return 0;
 }
 
+/*
+ * rpmemd_pmem_flush -- pmem_flush wrapper required to unify function
+ * pointer type with pmem_msync
+ */
+int
+rpmemd_pmem_flush(const void *addr, size_t len)
+{
+	pmem_flush(addr, len);
+	return 0;
+}
+
+/*
+ * rpmemd_drain_nop -- drain function matching flush functions which
+ * already persist the data, e.g. pmem_msync
+ */
+void
+rpmemd_drain_nop(void)
+{
+	/* nothing to do */
+}
+
 /*
  * rpmemd_flush_fatal -- APM specific flush function which should never be
  * called because APM does not require flushes
@@ -127,3 +148,22 @@ rpmemd_apply_pm_policy(enum rpmem_persist_method *persist_method,
 
 	return 0;
 }
+
+/*
+ * rpmemd_persist_split -- get flush and drain functions which together are
+ * equivalent to the persist function chosen by rpmemd_apply_pm_policy
+ */
+void
+rpmemd_persist_split(int (*persist)(const void *addr, size_t len),
+		int (**flush)(const void *addr, size_t len),
+		void (**drain)(void))
+{
+	if (persist == rpmemd_pmem_persist) {
+		*flush = rpmemd_pmem_flush;
+		*drain = pmem_drain;
+	} else {
+		/* pmem_msync and rpmemd_flush_fatal cannot be split */
+		*flush = persist;
+		*drain = rpmemd_drain_nop;
+	}
+}
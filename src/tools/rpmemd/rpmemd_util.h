@@ -35,7 +35,12 @@
  */
 
 int rpmemd_pmem_persist(const void *addr, size_t len);
+int rpmemd_pmem_flush(const void *addr, size_t len);
+void rpmemd_drain_nop(void);
 int rpmemd_flush_fatal(const void *addr, size_t len);
 int rpmemd_apply_pm_policy(enum rpmem_persist_method *persist_method,
 		int (**persist)(const void *addr, size_t len),
 		const int is_pmem);
+void rpmemd_persist_split(int (*persist)(const void *addr, size_t len),
+		int (**flush)(const void *addr, size_t len),
+		void (**drain)(void));
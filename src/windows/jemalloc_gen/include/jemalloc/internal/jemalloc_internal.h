@@ -400,6 +400,8 @@ arena_t	*arenas_extend(pool_t *pool, unsigned ind);
 bool	arenas_tsd_extend(tsd_pool_t *tsd, unsigned len);
 void	arenas_cleanup(void *arg);
 arena_t	*choose_arena_hard(pool_t *pool);
+void	*pool_ialloc_fallback(pool_t *pool, size_t size, size_t alignment,
+    bool zero);
 void	jemalloc_prefork(void);
 void	jemalloc_postfork_parent(void);
 void	jemalloc_postfork_child(void);
@@ -729,8 +731,12 @@ JEMALLOC_ALWAYS_INLINE void *
 pool_imalloc(pool_t *pool, size_t size)
 {
 	arena_t dummy;
+	void *ret;
 	DUMMY_ARENA_INITIALIZE(dummy, pool);
-	return (imalloct(size, true, &dummy));
+	ret = imalloct(size, true, &dummy);
+	if (ret == NULL)
+		ret = pool_ialloc_fallback(pool, size, 0, false);
+	return (ret);
 }
 
 JEMALLOC_ALWAYS_INLINE void *
@@ -754,8 +760,12 @@ JEMALLOC_ALWAYS_INLINE void *
 pool_icalloc(pool_t *pool, size_t size)
 {
 	arena_t dummy;
+	void *ret;
 	DUMMY_ARENA_INITIALIZE(dummy, pool);
-	return (icalloct(size, true, &dummy));
+	ret = icalloct(size, true, &dummy);
+	if (ret == NULL)
+		ret = pool_ialloc_fallback(pool, size, 0, true);
+	return (ret);
 }
 
 JEMALLOC_ALWAYS_INLINE void *
@@ -795,8 +805,12 @@ JEMALLOC_ALWAYS_INLINE void *
 pool_ipalloc(pool_t *pool, size_t usize, size_t alignment, bool zero)
 {
 	arena_t dummy;
+	void *ret;
 	DUMMY_ARENA_INITIALIZE(dummy, pool);
-	return (ipalloct(usize, alignment, zero, true, &dummy));
+	ret = ipalloct(usize, alignment, zero, true, &dummy);
+	if (ret == NULL)
+		ret = pool_ialloc_fallback(pool, usize, alignment, zero);
+	return (ret);
 }
 
 /*
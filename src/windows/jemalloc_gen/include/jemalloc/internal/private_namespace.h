@@ -449,6 +449,7 @@
 #define	pool_postfork_parent JEMALLOC_N(pool_postfork_parent)
 #define	pool_postfork_child JEMALLOC_N(pool_postfork_child)
 #define	pool_alloc JEMALLOC_N(pool_alloc)
+#define	pool_ialloc_fallback JEMALLOC_N(pool_ialloc_fallback)
 #define	vec_get JEMALLOC_N(vec_get)
 #define	vec_set JEMALLOC_N(vec_set)
 #define	vec_delete JEMALLOC_N(vec_delete)
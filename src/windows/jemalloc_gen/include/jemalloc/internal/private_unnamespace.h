@@ -449,6 +449,7 @@
 #undef pool_postfork_parent
 #undef pool_postfork_child
 #undef pool_alloc
+#undef pool_ialloc_fallback
 #undef vec_get
 #undef vec_set
 #undef vec_delete
@@ -1,15 +1,21 @@
 #define	je_pool_create JEMALLOC_N(pool_create)
+#define	je_pool_create_ex JEMALLOC_N(pool_create_ex)
 #define	je_pool_delete JEMALLOC_N(pool_delete)
 #define	je_pool_malloc JEMALLOC_N(pool_malloc)
 #define	je_pool_calloc JEMALLOC_N(pool_calloc)
 #define	je_pool_ralloc JEMALLOC_N(pool_ralloc)
 #define	je_pool_aligned_alloc JEMALLOC_N(pool_aligned_alloc)
 #define	je_pool_free JEMALLOC_N(pool_free)
+#define	je_pool_malloc_batch JEMALLOC_N(pool_malloc_batch)
+#define	je_pool_free_batch JEMALLOC_N(pool_free_batch)
 #define	je_pool_malloc_usable_size JEMALLOC_N(pool_malloc_usable_size)
 #define	je_pool_malloc_stats_print JEMALLOC_N(pool_malloc_stats_print)
 #define	je_pool_extend JEMALLOC_N(pool_extend)
 #define	je_pool_set_alloc_funcs JEMALLOC_N(pool_set_alloc_funcs)
 #define	je_pool_check JEMALLOC_N(pool_check)
+#define	je_pool_free_chunks_iter JEMALLOC_N(pool_free_chunks_iter)
+#define	je_pool_set_grow_func JEMALLOC_N(pool_set_grow_func)
+#define	je_pool_stats_get JEMALLOC_N(pool_stats_get)
 #define	je_malloc_conf JEMALLOC_N(malloc_conf)
 #define	je_malloc_message JEMALLOC_N(malloc_message)
 #define	je_malloc JEMALLOC_N(malloc)
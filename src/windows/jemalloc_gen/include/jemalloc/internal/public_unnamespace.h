@@ -1,15 +1,21 @@
 #undef je_pool_create
+#undef je_pool_create_ex
 #undef je_pool_delete
 #undef je_pool_malloc
 #undef je_pool_calloc
 #undef je_pool_ralloc
 #undef je_pool_aligned_alloc
 #undef je_pool_free
+#undef je_pool_malloc_batch
+#undef je_pool_free_batch
 #undef je_pool_malloc_usable_size
 #undef je_pool_malloc_stats_print
 #undef je_pool_extend
 #undef je_pool_set_alloc_funcs
 #undef je_pool_check
+#undef je_pool_free_chunks_iter
+#undef je_pool_set_grow_func
+#undef je_pool_stats_get
 #undef je_malloc_conf
 #undef je_malloc_message
 #undef je_malloc
@@ -57,17 +57,23 @@ extern "C" {
  */
 #ifndef JEMALLOC_NO_RENAME
 #  define je_pool_create je_vmem_pool_create
+#  define je_pool_create_ex je_vmem_pool_create_ex
 #  define je_pool_delete je_vmem_pool_delete
 #  define je_pool_malloc je_vmem_pool_malloc
 #  define je_pool_calloc je_vmem_pool_calloc
 #  define je_pool_ralloc je_vmem_pool_ralloc
 #  define je_pool_aligned_alloc je_vmem_pool_aligned_alloc
 #  define je_pool_free je_vmem_pool_free
+#  define je_pool_malloc_batch je_vmem_pool_malloc_batch
+#  define je_pool_free_batch je_vmem_pool_free_batch
 #  define je_pool_malloc_usable_size je_vmem_pool_malloc_usable_size
 #  define je_pool_malloc_stats_print je_vmem_pool_malloc_stats_print
 #  define je_pool_extend je_vmem_pool_extend
 #  define je_pool_set_alloc_funcs je_vmem_pool_set_alloc_funcs
 #  define je_pool_check je_vmem_pool_check
+#  define je_pool_free_chunks_iter je_vmem_pool_free_chunks_iter
+#  define je_pool_set_grow_func je_vmem_pool_set_grow_func
+#  define je_pool_stats_get je_vmem_pool_stats_get
 #  define je_malloc_conf je_vmem_malloc_conf
 #  define je_malloc_message je_vmem_malloc_message
 #  define je_malloc je_vmem_malloc
@@ -150,7 +156,25 @@ extern JEMALLOC_EXPORT void		(*je_malloc_message)(void *cbopaque,
 
 typedef struct pool_s pool_t;
 
+/* attributes of a pool, a zeroed structure stands for the defaults */
+typedef struct pool_attr_s {
+	unsigned narenas;	/* number of arenas */
+	int arena_per_cpu;	/* choose arenas by the CPU a thread runs on */
+	int tcache_disable;	/* do not use thread caches */
+	size_t tcache_max;	/* largest size class cached by threads */
+} pool_attr_t;
+
+/* summary statistics of a pool */
+typedef struct pool_stats_s {
+	size_t allocated;	/* bytes allocated by the application */
+	size_t active;		/* bytes in the active pages */
+	size_t mapped;		/* bytes in the chunks in use */
+	unsigned narenas;	/* number of arenas */
+} pool_stats_t;
+
 JEMALLOC_EXPORT pool_t	*je_pool_create(void *addr, size_t size, int zeroed);
+JEMALLOC_EXPORT pool_t	*je_pool_create_ex(void *addr, size_t size, int zeroed,
+							const pool_attr_t *attr);
 JEMALLOC_EXPORT int	je_pool_delete(pool_t *pool);
 JEMALLOC_EXPORT size_t	je_pool_extend(pool_t *pool, void *addr,
 					    size_t size, int zeroed);
@@ -159,6 +183,9 @@ JEMALLOC_EXPORT void	*je_pool_calloc(pool_t *pool, size_t nmemb, size_t size);
 JEMALLOC_EXPORT void	*je_pool_ralloc(pool_t *pool, void *ptr, size_t size);
 JEMALLOC_EXPORT void	*je_pool_aligned_alloc(pool_t *pool,  size_t alignment, size_t size);
 JEMALLOC_EXPORT void	je_pool_free(pool_t *pool, void *ptr);
+JEMALLOC_EXPORT size_t	je_pool_malloc_batch(pool_t *pool, size_t size,
+							size_t n, void **ptrs);
+JEMALLOC_EXPORT void	je_pool_free_batch(pool_t *pool, void **ptrs, size_t n);
 JEMALLOC_EXPORT size_t	je_pool_malloc_usable_size(pool_t *pool, void *ptr);
 JEMALLOC_EXPORT void	je_pool_malloc_stats_print(pool_t *pool,
 							void (*write_cb)(void *, const char *),
@@ -166,6 +193,13 @@ JEMALLOC_EXPORT void	je_pool_malloc_stats_print(pool_t *pool,
 JEMALLOC_EXPORT void	je_pool_set_alloc_funcs(void *(*malloc_func)(size_t),
 							void (*free_func)(void *));
 JEMALLOC_EXPORT int	je_pool_check(pool_t *pool);
+JEMALLOC_EXPORT void	je_pool_free_chunks_iter(pool_t *pool,
+							void (*cb)(void *addr, size_t size, void *arg),
+							void *arg);
+JEMALLOC_EXPORT void	je_pool_set_grow_func(pool_t *pool,
+							int (*grow)(pool_t *pool, size_t size, void *arg),
+							void *arg);
+JEMALLOC_EXPORT int	je_pool_stats_get(pool_t *pool, pool_stats_t *stats);
 
 JEMALLOC_EXPORT void	*je_malloc(size_t size) JEMALLOC_ATTR(malloc);
 JEMALLOC_EXPORT void	*je_calloc(size_t num, size_t size)
@@ -223,17 +257,23 @@ typedef bool (chunk_dalloc_t)(void *, size_t, unsigned, pool_t *);
 #    define JEMALLOC_NO_DEMANGLE
 #  endif
 #  define pool_create je_pool_create
+#  define pool_create_ex je_pool_create_ex
 #  define pool_delete je_pool_delete
 #  define pool_malloc je_pool_malloc
 #  define pool_calloc je_pool_calloc
 #  define pool_ralloc je_pool_ralloc
 #  define pool_aligned_alloc je_pool_aligned_alloc
 #  define pool_free je_pool_free
+#  define pool_malloc_batch je_pool_malloc_batch
+#  define pool_free_batch je_pool_free_batch
 #  define pool_malloc_usable_size je_pool_malloc_usable_size
 #  define pool_malloc_stats_print je_pool_malloc_stats_print
 #  define pool_extend je_pool_extend
 #  define pool_set_alloc_funcs je_pool_set_alloc_funcs
 #  define pool_check je_pool_check
+#  define pool_free_chunks_iter je_pool_free_chunks_iter
+#  define pool_set_grow_func je_pool_set_grow_func
+#  define pool_stats_get je_pool_stats_get
 #  define malloc_conf je_malloc_conf
 #  define malloc_message je_malloc_message
 #  define malloc je_malloc
@@ -265,17 +305,23 @@ typedef bool (chunk_dalloc_t)(void *, size_t, unsigned, pool_t *);
  */
 #ifndef JEMALLOC_NO_DEMANGLE
 #  undef je_pool_create
+#  undef je_pool_create_ex
 #  undef je_pool_delete
 #  undef je_pool_malloc
 #  undef je_pool_calloc
 #  undef je_pool_ralloc
 #  undef je_pool_aligned_alloc
 #  undef je_pool_free
+#  undef je_pool_malloc_batch
+#  undef je_pool_free_batch
 #  undef je_pool_malloc_usable_size
 #  undef je_pool_malloc_stats_print
 #  undef je_pool_extend
 #  undef je_pool_set_alloc_funcs
 #  undef je_pool_check
+#  undef je_pool_free_chunks_iter
+#  undef je_pool_set_grow_func
+#  undef je_pool_stats_get
 #  undef je_malloc_conf
 #  undef je_malloc_message
 #  undef je_malloc
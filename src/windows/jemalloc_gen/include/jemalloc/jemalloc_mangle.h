@@ -10,17 +10,23 @@
 #    define JEMALLOC_NO_DEMANGLE
 #  endif
 #  define pool_create je_pool_create
+#  define pool_create_ex je_pool_create_ex
 #  define pool_delete je_pool_delete
 #  define pool_malloc je_pool_malloc
 #  define pool_calloc je_pool_calloc
 #  define pool_ralloc je_pool_ralloc
 #  define pool_aligned_alloc je_pool_aligned_alloc
 #  define pool_free je_pool_free
+#  define pool_malloc_batch je_pool_malloc_batch
+#  define pool_free_batch je_pool_free_batch
 #  define pool_malloc_usable_size je_pool_malloc_usable_size
 #  define pool_malloc_stats_print je_pool_malloc_stats_print
 #  define pool_extend je_pool_extend
 #  define pool_set_alloc_funcs je_pool_set_alloc_funcs
 #  define pool_check je_pool_check
+#  define pool_free_chunks_iter je_pool_free_chunks_iter
+#  define pool_set_grow_func je_pool_set_grow_func
+#  define pool_stats_get je_pool_stats_get
 #  define malloc_conf je_malloc_conf
 #  define malloc_message je_malloc_message
 #  define malloc je_malloc
@@ -52,17 +58,23 @@
  */
 #ifndef JEMALLOC_NO_DEMANGLE
 #  undef je_pool_create
+#  undef je_pool_create_ex
 #  undef je_pool_delete
 #  undef je_pool_malloc
 #  undef je_pool_calloc
 #  undef je_pool_ralloc
 #  undef je_pool_aligned_alloc
 #  undef je_pool_free
+#  undef je_pool_malloc_batch
+#  undef je_pool_free_batch
 #  undef je_pool_malloc_usable_size
 #  undef je_pool_malloc_stats_print
 #  undef je_pool_extend
 #  undef je_pool_set_alloc_funcs
 #  undef je_pool_check
+#  undef je_pool_free_chunks_iter
+#  undef je_pool_set_grow_func
+#  undef je_pool_stats_get
 #  undef je_malloc_conf
 #  undef je_malloc_message
 #  undef je_malloc
@@ -10,17 +10,23 @@
 #    define JEMALLOC_NO_DEMANGLE
 #  endif
 #  define pool_create jet_pool_create
+#  define pool_create_ex jet_pool_create_ex
 #  define pool_delete jet_pool_delete
 #  define pool_malloc jet_pool_malloc
 #  define pool_calloc jet_pool_calloc
 #  define pool_ralloc jet_pool_ralloc
 #  define pool_aligned_alloc jet_pool_aligned_alloc
 #  define pool_free jet_pool_free
+#  define pool_malloc_batch jet_pool_malloc_batch
+#  define pool_free_batch jet_pool_free_batch
 #  define pool_malloc_usable_size jet_pool_malloc_usable_size
 #  define pool_malloc_stats_print jet_pool_malloc_stats_print
 #  define pool_extend jet_pool_extend
 #  define pool_set_alloc_funcs jet_pool_set_alloc_funcs
 #  define pool_check jet_pool_check
+#  define pool_free_chunks_iter jet_pool_free_chunks_iter
+#  define pool_set_grow_func jet_pool_set_grow_func
+#  define pool_stats_get jet_pool_stats_get
 #  define malloc_conf jet_malloc_conf
 #  define malloc_message jet_malloc_message
 #  define malloc jet_malloc
@@ -52,17 +58,23 @@
  */
 #ifndef JEMALLOC_NO_DEMANGLE
 #  undef jet_pool_create
+#  undef jet_pool_create_ex
 #  undef jet_pool_delete
 #  undef jet_pool_malloc
 #  undef jet_pool_calloc
 #  undef jet_pool_ralloc
 #  undef jet_pool_aligned_alloc
 #  undef jet_pool_free
+#  undef jet_pool_malloc_batch
+#  undef jet_pool_free_batch
 #  undef jet_pool_malloc_usable_size
 #  undef jet_pool_malloc_stats_print
 #  undef jet_pool_extend
 #  undef jet_pool_set_alloc_funcs
 #  undef jet_pool_check
+#  undef jet_pool_free_chunks_iter
+#  undef jet_pool_set_grow_func
+#  undef jet_pool_stats_get
 #  undef jet_malloc_conf
 #  undef jet_malloc_message
 #  undef jet_malloc
@@ -9,7 +9,25 @@ extern JEMALLOC_EXPORT void		(*je_malloc_message)(void *cbopaque,
 
 typedef struct pool_s pool_t;
 
+/* attributes of a pool, a zeroed structure stands for the defaults */
+typedef struct pool_attr_s {
+	unsigned narenas;	/* number of arenas */
+	int arena_per_cpu;	/* choose arenas by the CPU a thread runs on */
+	int tcache_disable;	/* do not use thread caches */
+	size_t tcache_max;	/* largest size class cached by threads */
+} pool_attr_t;
+
+/* summary statistics of a pool */
+typedef struct pool_stats_s {
+	size_t allocated;	/* bytes allocated by the application */
+	size_t active;		/* bytes in the active pages */
+	size_t mapped;		/* bytes in the chunks in use */
+	unsigned narenas;	/* number of arenas */
+} pool_stats_t;
+
 JEMALLOC_EXPORT pool_t	*je_pool_create(void *addr, size_t size, int zeroed);
+JEMALLOC_EXPORT pool_t	*je_pool_create_ex(void *addr, size_t size, int zeroed,
+							const pool_attr_t *attr);
 JEMALLOC_EXPORT int	je_pool_delete(pool_t *pool);
 JEMALLOC_EXPORT size_t	je_pool_extend(pool_t *pool, void *addr,
 					    size_t size, int zeroed);
@@ -18,6 +36,9 @@ JEMALLOC_EXPORT void	*je_pool_calloc(pool_t *pool, size_t nmemb, size_t size);
 JEMALLOC_EXPORT void	*je_pool_ralloc(pool_t *pool, void *ptr, size_t size);
 JEMALLOC_EXPORT void	*je_pool_aligned_alloc(pool_t *pool,  size_t alignment, size_t size);
 JEMALLOC_EXPORT void	je_pool_free(pool_t *pool, void *ptr);
+JEMALLOC_EXPORT size_t	je_pool_malloc_batch(pool_t *pool, size_t size,
+							size_t n, void **ptrs);
+JEMALLOC_EXPORT void	je_pool_free_batch(pool_t *pool, void **ptrs, size_t n);
 JEMALLOC_EXPORT size_t	je_pool_malloc_usable_size(pool_t *pool, void *ptr);
 JEMALLOC_EXPORT void	je_pool_malloc_stats_print(pool_t *pool,
 							void (*write_cb)(void *, const char *),
@@ -25,6 +46,13 @@ JEMALLOC_EXPORT void	je_pool_malloc_stats_print(pool_t *pool,
 JEMALLOC_EXPORT void	je_pool_set_alloc_funcs(void *(*malloc_func)(size_t),
 							void (*free_func)(void *));
 JEMALLOC_EXPORT int	je_pool_check(pool_t *pool);
+JEMALLOC_EXPORT void	je_pool_free_chunks_iter(pool_t *pool,
+							void (*cb)(void *addr, size_t size, void *arg),
+							void *arg);
+JEMALLOC_EXPORT void	je_pool_set_grow_func(pool_t *pool,
+							int (*grow)(pool_t *pool, size_t size, void *arg),
+							void *arg);
+JEMALLOC_EXPORT int	je_pool_stats_get(pool_t *pool, pool_stats_t *stats);
 
 JEMALLOC_EXPORT void	*je_malloc(size_t size) JEMALLOC_ATTR(malloc);
 JEMALLOC_EXPORT void	*je_calloc(size_t num, size_t size)
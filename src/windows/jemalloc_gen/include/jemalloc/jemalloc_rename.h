@@ -5,17 +5,23 @@
  */
 #ifndef JEMALLOC_NO_RENAME
 #  define je_pool_create je_vmem_pool_create
+#  define je_pool_create_ex je_vmem_pool_create_ex
 #  define je_pool_delete je_vmem_pool_delete
 #  define je_pool_malloc je_vmem_pool_malloc
 #  define je_pool_calloc je_vmem_pool_calloc
 #  define je_pool_ralloc je_vmem_pool_ralloc
 #  define je_pool_aligned_alloc je_vmem_pool_aligned_alloc
 #  define je_pool_free je_vmem_pool_free
+#  define je_pool_malloc_batch je_vmem_pool_malloc_batch
+#  define je_pool_free_batch je_vmem_pool_free_batch
 #  define je_pool_malloc_usable_size je_vmem_pool_malloc_usable_size
 #  define je_pool_malloc_stats_print je_vmem_pool_malloc_stats_print
 #  define je_pool_extend je_vmem_pool_extend
 #  define je_pool_set_alloc_funcs je_vmem_pool_set_alloc_funcs
 #  define je_pool_check je_vmem_pool_check
+#  define je_pool_free_chunks_iter je_vmem_pool_free_chunks_iter
+#  define je_pool_set_grow_func je_vmem_pool_set_grow_func
+#  define je_pool_stats_get je_vmem_pool_stats_get
 #  define je_malloc_conf je_vmem_malloc_conf
 #  define je_malloc_message je_vmem_malloc_message
 #  define je_malloc je_vmem_malloc